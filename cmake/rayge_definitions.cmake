@@ -2,6 +2,8 @@ set(TARGETNAME_ENGINE rayge-engine)
 set(TARGETNAME_LAUNCHER launcher)
 set(TARGETNAME_GAMELIB_SANITYTEST gamelib-sanitytest)
 set(TARGETNAME_ENGINE_TESTS engine-tests)
+set(TARGETNAME_MEMPOOL_REPLAY mempool-replay)
+set(TARGETNAME_PACK_ARCHIVE pack-archive)
 
 set(INSTALL_DEST rayge)
 set(INSTALL_DEST_SANITY_TEST sanitytest)
@@ -10,23 +10,42 @@
 #include "RayGE/APIs/Game.h"
 #include "RayGE/APIs/Resources.h"
 
+// Version 1 used 16-byte resource handles, and is no longer supported.
+// Version 2 packs resource handles into 64 bits, supports loading textures asynchronously,
+// and supports destroying entities.
+// Version 3 adds bulk access to components, and spawning entities from templates. Its API
+// struct begins with the same members as version 2, so an engine which supports version 3
+// also accepts requests for version 2.
 #define RAYGE_ENGINEAPI_VERSION_1 1
+#define RAYGE_ENGINEAPI_VERSION_2 2
+#define RAYGE_ENGINEAPI_VERSION_3 3
 
-typedef struct RayGE_Engine_API_V1
+typedef struct RayGE_Engine_API_V2
 {
 	RayGE_Log_API log;
 	RayGE_Scene_API scene;
 	RayGE_Resources_API resources;
-} RayGE_Engine_API_V1;
+} RayGE_Engine_API_V2;
 
-typedef struct RayGE_GameLib_Callbacks_V1
+typedef struct RayGE_GameLib_Callbacks_V2
 {
 	RayGE_Game_Callbacks game;
 	RayGE_Scene_Callbacks scene;
-} RayGE_GameLib_Callbacks_V1;
+} RayGE_GameLib_Callbacks_V2;
 
-typedef const RayGE_Engine_API_V1*(RAYGE_ENGINE_CDECL* RayGE_Engine_GetAPIFunc)(
+typedef struct RayGE_Engine_API_V3
+{
+	RayGE_Log_API log;
+	RayGE_Scene_API scene;
+	RayGE_Resources_API resources;
+	RayGE_SceneBulk_API sceneBulk;
+} RayGE_Engine_API_V3;
+
+// The callbacks have not changed since version 2.
+typedef RayGE_GameLib_Callbacks_V2 RayGE_GameLib_Callbacks_V3;
+
+typedef const RayGE_Engine_API_V3*(RAYGE_ENGINE_CDECL* RayGE_Engine_GetAPIFunc)(
 	uint16_t /*requestedVersion*/,
-	const RayGE_GameLib_Callbacks_V1* /*callbacks*/,
+	const RayGE_GameLib_Callbacks_V3* /*callbacks*/,
 	uint16_t* /*outSupportedVersion*/
 );
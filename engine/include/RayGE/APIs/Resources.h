@@ -14,6 +14,31 @@ typedef enum RayGE_RenderablePrimitive
 	RAYGE_RENDERABLE_PRIM__COUNT
 } RayGE_RenderablePrimitive;
 
+typedef enum RayGE_ResourceLoadState
+{
+	// The handle does not refer to a loaded resource.
+	RAYGE_RESOURCE_LOAD_STATE_INVALID = 0,
+
+	// The resource is still being loaded in the background.
+	RAYGE_RESOURCE_LOAD_STATE_PENDING,
+
+	// The resource is ready to use.
+	RAYGE_RESOURCE_LOAD_STATE_LOADED,
+
+	// The resource could not be loaded. The handle must still be
+	// unloaded, and loading the same path again will retry.
+	RAYGE_RESOURCE_LOAD_STATE_FAILED,
+} RayGE_ResourceLoadState;
+
+// Loaded resources are reference counted by path. Loading a path that is
+// already loaded returns the same handle, and each load should be matched
+// by an unload. Resources that are no longer referenced are destroyed at
+// the start of the next frame, so unloading and reloading a resource
+// within the same frame does not load it again.
+//
+// LoadTextureAsync() returns a handle immediately, and the texture is loaded
+// over subsequent frames. Until it is loaded, anything rendered using it
+// will display a placeholder texture instead.
 typedef struct RayGE_Resources_API
 {
 	RayGE_ResourceHandle (*GetPrimitiveHandle)(RayGE_RenderablePrimitive primitive);
@@ -21,4 +46,6 @@ typedef struct RayGE_Resources_API
 	void (*UnloadTexture)(RayGE_ResourceHandle handle);
 	RayGE_ResourceHandle (*LoadPixelWorld)(const char* path);
 	void (*UnloadPixelWorld)(RayGE_ResourceHandle handle);
+	RayGE_ResourceHandle (*LoadTextureAsync)(const char* path);
+	RayGE_ResourceLoadState (*GetLoadState)(RayGE_ResourceHandle handle);
 } RayGE_Resources_API;
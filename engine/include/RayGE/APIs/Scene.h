@@ -5,6 +5,14 @@
 
 #include "RayGE/SceneTypes.h"
 
+// Entity handles stay valid until the entity is destroyed. Destroying an entity
+// takes effect at the end of the frame, so its handle and components can still
+// be used until then. Components are stored contiguously, grouped with those of
+// other entities that have the same set of component types, so the component
+// pointers returned here may move: a pointer is only valid until the next time
+// a component is added to any entity, or until the end of the frame. To keep
+// hold of a component for longer, keep the entity's handle and get the
+// component again when it is needed.
 typedef struct RayGE_Scene_API
 {
 	RayGE_ResourceHandle (*CreateEntity)(void);
@@ -14,8 +22,32 @@ typedef struct RayGE_Scene_API
 	RayGE_Component_Camera* (*GetCameraComponent)(RayGE_ResourceHandle entity);
 	RayGE_Component_Renderable* (*AddRenderableComponent)(RayGE_ResourceHandle entity);
 	RayGE_Component_Renderable* (*GetRenderableComponent)(RayGE_ResourceHandle entity);
+	void (*DestroyEntity)(RayGE_ResourceHandle entity);
 } RayGE_Scene_API;
 
+// Access to the components of many entities at once, so that they can be
+// processed in tight loops. The spans follow the same rules as component
+// pointers returned by RayGE_Scene_API: they are only valid until the next
+// time a component is added to any entity, or until the end of the frame.
+typedef struct RayGE_SceneBulk_API
+{
+	// Covers every entity which has at least the required components, in no
+	// particular order. Up to maxSpans spans are written to outSpans, and the
+	// total number of spans available is returned, which may be more than
+	// maxSpans. Passing null and zero returns just the number of spans.
+	size_t (*GetComponentSpans)(RayGE_ComponentMask requiredComponents, RayGE_ComponentSpan* outSpans, size_t maxSpans);
+
+	// Creates count entities, each with a copy of the template's components, and
+	// returns the number created. If there is not enough space in the scene for
+	// all of them then none are created, and 0 is returned. If outHandles is not
+	// null, it must have space for count handles, which are written in order.
+	size_t (*CreateEntitiesFromTemplate)(
+		const RayGE_EntityTemplate* entityTemplate,
+		size_t count,
+		RayGE_ResourceHandle* outHandles
+	);
+} RayGE_SceneBulk_API;
+
 typedef struct RayGE_Scene_Callbacks
 {
 	void (*SceneBegin)(void);
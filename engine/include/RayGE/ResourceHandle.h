@@ -3,20 +3,53 @@
 #include <stdint.h>
 #include "RayGE/InterfaceUtils.h"
 
+// Handles are packed into a single 64-bit value, so that they
+// can be passed around in a register. From most significant
+// to least significant bits, the value holds:
+//
+// - Domain (or general type) of the resource being referred to.
+// - Unique index of this resource within its domain.
+// - Generation of the resource. Used to verify that this
+//   resource is the one we want, and the handle is not an
+//   old one from a previous resource that used to live at
+//   the same index.
+//
+// The fields should be accessed using the macros below,
+// rather than by manipulating the value directly.
 typedef struct RayGE_ResourceHandle
 {
-	// Domain (or general type) of the resource being referred to.
-	uint32_t domain;
+	uint64_t value;
+} RayGE_ResourceHandle;
 
-	// Unique index of this resource.
-	uint32_t index;
+#define RAYGE_RESOURCE_HANDLE_DOMAIN_BITS 8
+#define RAYGE_RESOURCE_HANDLE_INDEX_BITS 24
+#define RAYGE_RESOURCE_HANDLE_GENERATION_BITS 32
 
-	// Specific key for this resource. Used to verify that
-	// this resource is the one we want, and the handle is
-	// not an old one from a previous resource that used
-	// to live at the same index.
-	uint64_t key;
-} RayGE_ResourceHandle;
+#define RAYGE_RESOURCE_HANDLE_GENERATION_SHIFT 0
+#define RAYGE_RESOURCE_HANDLE_INDEX_SHIFT \
+	(RAYGE_RESOURCE_HANDLE_GENERATION_SHIFT + RAYGE_RESOURCE_HANDLE_GENERATION_BITS)
+#define RAYGE_RESOURCE_HANDLE_DOMAIN_SHIFT (RAYGE_RESOURCE_HANDLE_INDEX_SHIFT + RAYGE_RESOURCE_HANDLE_INDEX_BITS)
+
+#define RAYGE_RESOURCE_HANDLE_MAX_DOMAIN ((uint32_t)((1ULL << RAYGE_RESOURCE_HANDLE_DOMAIN_BITS) - 1))
+#define RAYGE_RESOURCE_HANDLE_MAX_INDEX ((uint32_t)((1ULL << RAYGE_RESOURCE_HANDLE_INDEX_BITS) - 1))
+#define RAYGE_RESOURCE_HANDLE_MAX_GENERATION ((uint32_t)((1ULL << RAYGE_RESOURCE_HANDLE_GENERATION_BITS) - 1))
+
+#define RAYGE_RESOURCE_HANDLE_DOMAIN(handle) \
+	((uint32_t)(((handle).value >> RAYGE_RESOURCE_HANDLE_DOMAIN_SHIFT) & RAYGE_RESOURCE_HANDLE_MAX_DOMAIN))
+
+#define RAYGE_RESOURCE_HANDLE_INDEX(handle) \
+	((uint32_t)(((handle).value >> RAYGE_RESOURCE_HANDLE_INDEX_SHIFT) & RAYGE_RESOURCE_HANDLE_MAX_INDEX))
+
+#define RAYGE_RESOURCE_HANDLE_GENERATION(handle) \
+	((uint32_t)(((handle).value >> RAYGE_RESOURCE_HANDLE_GENERATION_SHIFT) & RAYGE_RESOURCE_HANDLE_MAX_GENERATION))
+
+// Values outside the range of each field are truncated.
+#define RAYGE_RESOURCE_HANDLE_PACK(domain, index, generation) \
+	((((uint64_t)(domain) & RAYGE_RESOURCE_HANDLE_MAX_DOMAIN) << RAYGE_RESOURCE_HANDLE_DOMAIN_SHIFT) | \
+	 (((uint64_t)(index) & RAYGE_RESOURCE_HANDLE_MAX_INDEX) << RAYGE_RESOURCE_HANDLE_INDEX_SHIFT) | \
+	 (((uint64_t)(generation) & RAYGE_RESOURCE_HANDLE_MAX_GENERATION) << RAYGE_RESOURCE_HANDLE_GENERATION_SHIFT))
+
+#define RAYGE_RESOURCE_HANDLES_EQUAL(a, b) ((a).value == (b).value)
 
 // The first of these is valid in constant assignments.
 // The second (according to the -pedantic flag) is not.
@@ -24,6 +57,6 @@ typedef struct RayGE_ResourceHandle
 // for example, the resource it used to refer to has been
 // freed, but a null handle is guaranteed to never
 // be used to refer to any resource.
-#define RAYGE_INIT_NULL_RESOURCE_HANDLE {0, 0, 0}
+#define RAYGE_INIT_NULL_RESOURCE_HANDLE {0}
 #define RAYGE_NULL_RESOURCE_HANDLE (RAYGE_TYPE_LITERAL(RayGE_ResourceHandle) RAYGE_INIT_NULL_RESOURCE_HANDLE)
-#define RAYGE_IS_NULL_RESOURCE_HANDLE(handle) ((handle).domain == 0 && (handle).index == 0 && (handle).key == 0)
+#define RAYGE_IS_NULL_RESOURCE_HANDLE(handle) ((handle).value == 0)
@@ -14,8 +14,14 @@ typedef enum RayGE_ComponentType
 	RAYGE_COMPONENTTYPE_SPATIAL = 0,
 	RAYGE_COMPONENTTYPE_CAMERA,
 	RAYGE_COMPONENTTYPE_RENDERABLE,
+	RAYGE_COMPONENTTYPE__COUNT
 } RayGE_ComponentType;
 
+// A set of component types, with one bit per RayGE_ComponentType.
+typedef uint32_t RayGE_ComponentMask;
+
+#define RAYGE_COMPONENT_MASK_BIT(type) ((RayGE_ComponentMask)1 << (type))
+
 typedef struct RayGE_Component_Spatial
 {
 	Vector3 position;
@@ -33,3 +39,27 @@ typedef struct RayGE_Component_Renderable
 	float scale;
 	RayGE_Color color;
 } RayGE_Component_Renderable;
+
+// A run of entities whose components are stored contiguously. Element i of
+// each component array belongs to the entity whose handle is entities[i].
+// Arrays are only provided for the component types that were asked for, and
+// the others are null.
+typedef struct RayGE_ComponentSpan
+{
+	uint32_t count;
+	const RayGE_ResourceHandle* entities;
+	RayGE_Component_Spatial* spatial;
+	RayGE_Component_Camera* camera;
+	RayGE_Component_Renderable* renderable;
+} RayGE_ComponentSpan;
+
+// Describes a set of components and their initial values, so that many
+// identical entities can be created at once. Only the values for component
+// types that are in the mask are used.
+typedef struct RayGE_EntityTemplate
+{
+	RayGE_ComponentMask components;
+	RayGE_Component_Spatial spatial;
+	RayGE_Component_Camera camera;
+	RayGE_Component_Renderable renderable;
+} RayGE_EntityTemplate;
@@ -17,11 +17,12 @@ static void VisualiseEntities(RayGE_Renderer* renderer)
 
 	if ( firstEnt )
 	{
-		RayGE_ComponentHeader* cmpHeader = Entity_GetFirstComponentOfType(firstEnt, RAYGE_COMPONENTTYPE_SPATIAL);
+		RayGE_Component_Spatial* spatial =
+			COMPONENTDATA_SPATIAL(Entity_GetComponent(firstEnt, RAYGE_COMPONENTTYPE_SPATIAL));
 
-		if ( cmpHeader )
+		if ( spatial )
 		{
-			COMPONENTDATA_SPATIAL(cmpHeader)->angles.yaw += 3.0f;
+			spatial->angles.yaw += 3.0f;
 		}
 	}
 
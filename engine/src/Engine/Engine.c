@@ -1,10 +1,13 @@
+#include <assert.h>
 #include <stdbool.h>
 #include "Engine/Engine.h"
 #include "Engine/EngineAPI.h"
 #include "Logging/Logging.h"
 #include "EngineSubsystems/EngineSubsystemManager.h"
+#include "EngineSubsystems/FilesystemSubsystem.h"
 #include "EngineSubsystems/InputSubsystem.h"
 #include "EngineSubsystems/InputHookSubsystem.h"
+#include "EngineSubsystems/ResourceSubsystem.h"
 #include "EngineSubsystems/SceneSubsystem.h"
 #include "BehaviouralSubsystems/BSysManager.h"
 #include "MemPool/MemPoolManager.h"
@@ -131,12 +134,18 @@ static bool RunFrame(void)
 	const bool windowShouldClose = false;
 #endif
 
+	MemPoolManager_NewFrame();
+	Logging_DispatchDeferredMessages();
+	FilesystemSubsystem_NewFrame();
+	ResourceSubsystem_NewFrame();
+
 	BSysManager_Invoke(BSYS_STAGE_DESERIALISATION);
 	RunFrameInput();
 	BSysManager_Invoke(BSYS_STAGE_LOGIC);
 	BSysManager_Invoke(BSYS_STAGE_SIMULATION);
 	BSysManager_Invoke(BSYS_STAGE_RENDERING);
 	BSysManager_Invoke(BSYS_STAGE_SERIALISATION);
+	SceneSubsystem_EndFrame();
 
 	return windowShouldClose;
 }
@@ -1,5 +1,6 @@
 #include <stdbool.h>
 #include <stddef.h>
+#include <assert.h>
 #include "Engine/EngineAPI.h"
 #include "Logging/Logging.h"
 #include "Scene/SceneAPI.h"
@@ -20,6 +21,7 @@ const RayGE_Engine_API_Current g_EngineAPI = {
 		SceneAPI_GetCameraComponent,
 		SceneAPI_AddRenderableComponent,
 		SceneAPI_GetRenderableComponent,
+		SceneAPI_DestroyEntity,
 	},
 
 	// Resources
@@ -29,9 +31,25 @@ const RayGE_Engine_API_Current g_EngineAPI = {
 		ResourcesAPI_UnloadTexture,
 		ResourcesAPI_LoadPixelWorld,
 		ResourcesAPI_UnloadPixelWorld,
-	}
+		ResourcesAPI_LoadTextureAsync,
+		ResourcesAPI_GetLoadState,
+	},
+
+	// Scene bulk access
+	{
+		SceneAPI_GetComponentSpans,
+		SceneAPI_CreateEntitiesFromTemplate,
+	},
 };
 
+// Version 2 requests are served with the current API struct,
+// so it must begin with exactly the same members.
+static_assert(
+	offsetof(RayGE_Engine_API_Current, resources) == offsetof(RayGE_Engine_API_V2, resources) &&
+		offsetof(RayGE_Engine_API_Current, sceneBulk) == sizeof(RayGE_Engine_API_V2),
+	"Expected the current engine API to be an extension of version 2"
+);
+
 RayGE_GameLib_Callbacks_Current g_GameLibCallbacks;
 
 const RayGE_Engine_API_Current* RAYGE_ENGINE_CDECL EngineAPI_ExchangeAPIsWithGame(
@@ -46,7 +64,10 @@ const RayGE_Engine_API_Current* RAYGE_ENGINE_CDECL EngineAPI_ExchangeAPIsWithGam
 		*outSupportedVersion = RAYGE_ENGINEAPI_VERSION_CURRENT;
 	}
 
-	if ( requestedVersion != RAYGE_ENGINEAPI_VERSION_CURRENT || !callbacks )
+	const bool versionIsSupported =
+		requestedVersion == RAYGE_ENGINEAPI_VERSION_CURRENT || requestedVersion == RAYGE_ENGINEAPI_VERSION_2;
+
+	if ( !versionIsSupported || !callbacks )
 	{
 		return NULL;
 	}
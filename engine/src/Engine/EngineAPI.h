@@ -8,9 +8,9 @@
 // build uses and supports. This should be incremented between
 // different releases, if the public API has changed since
 // the last release.
-#define RAYGE_ENGINEAPI_VERSION_CURRENT RAYGE_ENGINEAPI_VERSION_1
-typedef RayGE_Engine_API_V1 RayGE_Engine_API_Current;
-typedef RayGE_GameLib_Callbacks_V1 RayGE_GameLib_Callbacks_Current;
+#define RAYGE_ENGINEAPI_VERSION_CURRENT RAYGE_ENGINEAPI_VERSION_3
+typedef RayGE_Engine_API_V3 RayGE_Engine_API_Current;
+typedef RayGE_GameLib_Callbacks_V3 RayGE_GameLib_Callbacks_Current;
 
 extern const RayGE_Engine_API_Current g_EngineAPI;
 extern RayGE_GameLib_Callbacks_Current g_GameLibCallbacks;
@@ -1,5 +1,6 @@
 #include "EngineSubsystems/CommandSubsystem.h"
 #include "MemPool/MemPoolManager.h"
+#include "MemPool/MemPoolObjectPool.h"
 #include "Logging/Logging.h"
 #include "Debugging.h"
 #include "wzl_cutl/string.h"
@@ -15,14 +16,17 @@ struct CommandSubsystem_CommandHandle
 	UT_hash_handle hh;
 };
 
+#define COMMANDS_PER_CHUNK 64
+
 typedef struct CommandRegistry
 {
 	CommandSubsystem_CommandHandle* commandHash;
+	MemPool_ObjectPool* commandPool;
 } CommandRegistry;
 
 static CommandRegistry* g_Registry = NULL;
 
-static void FreeCommandItem(CommandSubsystem_CommandHandle* item)
+static void FreeCommandItem(CommandRegistry* registry, CommandSubsystem_CommandHandle* item)
 {
 	if ( !item )
 	{
@@ -34,7 +38,7 @@ static void FreeCommandItem(CommandSubsystem_CommandHandle* item)
 		MEMPOOL_FREE(item->name);
 	}
 
-	MEMPOOL_FREE(item);
+	MemPoolObjectPool_Free(registry->commandPool, item);
 }
 
 static void FreeAllCommandItems(CommandRegistry* registry)
@@ -45,7 +49,7 @@ static void FreeAllCommandItems(CommandRegistry* registry)
 	HASH_ITER(hh, registry->commandHash, item, tmp)
 	{
 		HASH_DEL(registry->commandHash, item);
-		FreeCommandItem(item);
+		FreeCommandItem(registry, item);
 	}
 }
 
@@ -82,7 +86,7 @@ AddCommand(CommandRegistry* registry, char* name, CommandSubsystem_Callback call
 {
 	Logging_PrintLine(RAYGE_LOG_TRACE, "Adding command: %s", name);
 
-	CommandSubsystem_CommandHandle* item = MEMPOOL_CALLOC_STRUCT(MEMPOOL_COMMANDS, CommandSubsystem_CommandHandle);
+	CommandSubsystem_CommandHandle* item = MemPoolObjectPool_Calloc(registry->commandPool);
 	item->name = name;
 	item->callback = callback;
 	item->userData = userData;
@@ -100,6 +104,8 @@ void CommandSubsystem_Init(void)
 	}
 
 	g_Registry = MEMPOOL_CALLOC_STRUCT(MEMPOOL_COMMANDS, CommandRegistry);
+	g_Registry->commandPool =
+		MEMPOOL_OBJECTPOOL_CREATE(MEMPOOL_COMMANDS, CommandSubsystem_CommandHandle, COMMANDS_PER_CHUNK);
 }
 
 void CommandSubsystem_ShutDown(void)
@@ -110,6 +116,7 @@ void CommandSubsystem_ShutDown(void)
 	}
 
 	FreeAllCommandItems(g_Registry);
+	MemPoolObjectPool_Destroy(g_Registry->commandPool);
 
 	MEMPOOL_FREE(g_Registry);
 	g_Registry = NULL;
@@ -3,22 +3,50 @@
 #include "raylib.h"
 #include "RayGE/Platform.h"
 #include "EngineSubsystems/FilesystemSubsystem.h"
+#include "Filesystem/NativeFilesystem.h"
+#include "Filesystem/PackArchive.h"
 #include "MemPool/MemPoolManager.h"
+#include "Resources/TextureResources.h"
+#include "Utils/StringUtils.h"
 #include "Logging/Logging.h"
 #include "Debugging.h"
 #include "cwalk.h"
 #include "wzl_cutl/string.h"
 #include "wzl_cutl/math.h"
 
+#define UTHASH_POOLED_MEMPOOL MEMPOOL_FILESYSTEM
+#include "UTUtils/UTHash_Pooled.h"
+
 #if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
 #define PATH_SEP_CH '\\'
 #else
 #define PATH_SEP_CH '/'
 #endif
 
+#define MAX_MOUNTED_ARCHIVES 32
+#define ASYNC_READ_THREADS 2
+
+// Resolved absolute paths are interned, keyed on the relative path that
+// was passed in, so that resolving the same path again costs a single
+// hash lookup and no allocations. The cache is cleared whenever the base
+// path changes, since every resolved path depends on it.
+typedef struct ResolvedPath
+{
+	const char* relPath;
+	const char* absNativePath;
+	UT_hash_handle hh;
+} ResolvedPath;
+
 static FilesystemSubsystem_LongPath g_NativeRootDirectory;
 static FilesystemSubsystem_Path g_BaseRelDirectory;
 
+// Searched from last to first, so that later archives take priority.
+static PackArchive* g_MountedArchives[MAX_MOUNTED_ARCHIVES];
+static size_t g_NumMountedArchives = 0;
+
+static ResolvedPath* g_ResolvedPaths = NULL;
+static AsyncReadQueue* g_ReadQueue = NULL;
+
 static void EnsureApplicationDirectory(bool forceRefresh)
 {
 	if ( g_NativeRootDirectory[0] && !forceRefresh )
@@ -49,7 +77,7 @@ static void EnsureApplicationDirectory(bool forceRefresh)
 			"Not enough space to concatenate application directory with base path"
 		);
 
-		g_NativeRootDirectory[length - 1] = PATH_SEP_CH;
+		g_NativeRootDirectory[length] = PATH_SEP_CH;
 		++length;
 	}
 
@@ -67,16 +95,11 @@ static void EnsureApplicationDirectory(bool forceRefresh)
 	}
 }
 
-// Caller takes ownership of the path.
-static char* MakeAbsolutePathFromApplicationDirectory(const char* relNativePath)
+// Returns false if the path did not fit into the buffer.
+static bool MakeAbsolutePathFromApplicationDirectory(const char* relNativePath, char* outBuffer, size_t outBufferSize)
 {
 	EnsureApplicationDirectory(false);
 
-	if ( !relNativePath )
-	{
-		return wzl_strdup(g_NativeRootDirectory);
-	}
-
 	// If the path begins with a separator, treat it as being rooted at our current
 	// root directory. This essentially means we need to just skip past any leading
 	// separators and then compute the actual absolute path.
@@ -87,41 +110,45 @@ static char* MakeAbsolutePathFromApplicationDirectory(const char* relNativePath)
 
 	if ( !(*relNativePath) )
 	{
-		return wzl_strdup(g_NativeRootDirectory);
-	}
+		const size_t length = strlen(g_NativeRootDirectory);
 
-	char dummy;
-	size_t size = cwk_path_get_absolute(g_NativeRootDirectory, relNativePath, &dummy, sizeof(dummy)) + 1;
+		if ( length >= outBufferSize )
+		{
+			return false;
+		}
 
-	RAYGE_ASSERT(size > 1, "Path concatenation produced empty path");
+		memcpy(outBuffer, g_NativeRootDirectory, length + 1);
+		return true;
+	}
 
-	char* buffer = MEMPOOL_MALLOC(MEMPOOL_FILESYSTEM, size);
-	cwk_path_get_absolute(g_NativeRootDirectory, relNativePath, buffer, size);
+	// cwalk always returns the full length of the path, even if it was truncated.
+	const size_t length = cwk_path_get_absolute(g_NativeRootDirectory, relNativePath, outBuffer, outBufferSize);
 
-	RAYGE_ASSERT(buffer[size - 1] == '\0', "Path length calculation was incorrect");
+	RAYGE_ASSERT(length > 0, "Path concatenation produced empty path");
 
-	return buffer;
+	return length < outBufferSize;
 }
 
-// Caller takes ownership of the path
-static char* MakeRelativePathFromApplicationDirectory(const char* absNativePath)
+// Returns false if the path did not fit into the buffer.
+static bool MakeRelativePathFromApplicationDirectory(const char* absNativePath, char* outBuffer, size_t outBufferSize)
 {
 	EnsureApplicationDirectory(false);
 
 	if ( !absNativePath || !(*absNativePath) )
 	{
-		return wzl_strdup("");
+		outBuffer[0] = '\0';
+		return true;
 	}
 
-	char dummy;
-	size_t size = cwk_path_get_relative(g_NativeRootDirectory, absNativePath, &dummy, sizeof(dummy)) + 1;
-
-	char* buffer = MEMPOOL_MALLOC(MEMPOOL_FILESYSTEM, size);
-	cwk_path_get_relative(g_NativeRootDirectory, absNativePath, buffer, size);
-
-	RAYGE_ASSERT(buffer[size - 1] == '\0', "Path length calculation was incorrect");
+	return cwk_path_get_relative(g_NativeRootDirectory, absNativePath, outBuffer, outBufferSize) < outBufferSize;
+}
 
-	return buffer;
+// Returns a pointer to the next separator, or to the terminator
+// if this is the last segment in the path.
+static const char* FindSegmentEnd(const char* path)
+{
+	const char* end = strchr(path, PATH_SEP_CH);
+	return end ? end : path + strlen(path);
 }
 
 static bool PathBacktracksPastBaseDirectory(const char* relNativePath)
@@ -133,8 +160,8 @@ static bool PathBacktracksPastBaseDirectory(const char* relNativePath)
 
 	size_t levelsDeep = 0;
 
-	for ( const char *start = relNativePath, *end = strchr(start, PATH_SEP_CH); end;
-		  start = end + 1, end = strchr(start, PATH_SEP_CH) )
+	for ( const char *start = relNativePath, *end = FindSegmentEnd(start); *start;
+		  start = *end ? end + 1 : end, end = FindSegmentEnd(start) )
 	{
 		if ( end == start )
 		{
@@ -184,63 +211,288 @@ static void MakePathSafe(char* path)
 	}
 }
 
-// Always returns a valid pointer.
-static char* PathSeparatorsToNative(const char* path)
+// Returns false if the path did not fit into the buffer.
+static bool PathSeparatorsToNative(const char* path, char* outBuffer, size_t outBufferSize)
 {
-	char* newPath = wzl_strdup(path ? path : "");
+	const size_t length = path ? strlen(path) : 0;
 
-#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
-	for ( char* cursor = newPath; *cursor; ++cursor )
+	if ( length >= outBufferSize )
 	{
-		if ( *cursor == '/' )
-		{
-			*cursor = '\\';
-		}
+		return false;
 	}
+
+	for ( size_t index = 0; index < length; ++index )
+	{
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+		outBuffer[index] = path[index] == '/' ? '\\' : path[index];
+#else
+		outBuffer[index] = path[index];
 #endif
+	}
 
-	return newPath;
+	outBuffer[length] = '\0';
+	return true;
 }
 
-static char* PathSeparatorsFromNative(const char* path)
+static void PathSeparatorsFromNative(char* path)
 {
-	char* newPath = wzl_strdup(path ? path : "");
-
 #if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
-	for ( char* cursor = newPath; *cursor; ++cursor )
+	for ( char* cursor = path; *cursor; ++cursor )
 	{
 		if ( *cursor == '\\' )
 		{
 			*cursor = '/';
 		}
 	}
+#else
+	(void)path;
 #endif
-
-	return newPath;
 }
 
-// TODO: Tidy up allocations here? This function is often used to
-// compute a string, use it and then free the string later.
-// It could probably be swapped out for a static buffer to reduce
-// the number/frequency of dynamic allocations.
-static char* RelativePathToAbsoluteNativePath(const char* relPath)
+// Returns false if the path did not fit into the buffer.
+// Nothing here allocates, so this is safe to call as often as needed.
+static bool RelativePathToAbsoluteNativePath(const char* relPath, char* outBuffer, size_t outBufferSize)
 {
-	char* nativeRelPath = PathSeparatorsToNative(relPath);
-	MakePathSafe(nativeRelPath);
+	FilesystemSubsystem_Path nativeRelPath;
 
-	char* nativeAbsPath = MakeAbsolutePathFromApplicationDirectory(nativeRelPath);
+	if ( !PathSeparatorsToNative(relPath, nativeRelPath, sizeof(nativeRelPath)) )
+	{
+		return false;
+	}
 
-	MEMPOOL_FREE(nativeRelPath);
-	return nativeAbsPath;
+	MakePathSafe(nativeRelPath);
+	return MakeAbsolutePathFromApplicationDirectory(nativeRelPath, outBuffer, outBufferSize);
 }
 
+// Caller takes ownership of the path, which is allocated from MEMPOOL_FILESYSTEM.
 static char* AbsoluteNativePathToRelativePath(const char* absNativePath)
 {
-	char* relNativePath = MakeRelativePathFromApplicationDirectory(absNativePath);
-	char* relPath = PathSeparatorsFromNative(relNativePath);
+	FilesystemSubsystem_LongPath relPath;
+
+	if ( !MakeRelativePathFromApplicationDirectory(absNativePath, relPath, sizeof(relPath)) )
+	{
+		relPath[0] = '\0';
+	}
+
+	PathSeparatorsFromNative(relPath);
+	return StringUtils_Duplicate(MEMPOOL_FILESYSTEM, relPath);
+}
+
+static void ClearResolvedPaths(void)
+{
+	ResolvedPath* item = NULL;
+	ResolvedPath* tmp = NULL;
+
+	HASH_ITER(hh, g_ResolvedPaths, item, tmp)
+	{
+		HASH_DEL(g_ResolvedPaths, item);
+		MEMPOOL_FREE(item);
+	}
+}
+
+// The returned path is owned by the cache, and is valid until the base
+// path is changed. Returns null if the path was too long to resolve.
+static const char* ResolvePath(const char* relPath)
+{
+	if ( !relPath )
+	{
+		relPath = "";
+	}
+
+	ResolvedPath* item = NULL;
+	HASH_FIND_STR(g_ResolvedPaths, relPath, item);
+
+	if ( item )
+	{
+		return item->absNativePath;
+	}
+
+	FilesystemSubsystem_LongPath absNativePath;
+
+	if ( !RelativePathToAbsoluteNativePath(relPath, absNativePath, sizeof(absNativePath)) )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Could not resolve path \"%s\": resolved path was too long", relPath);
+		return NULL;
+	}
+
+	// Both strings are stored in the same allocation as the item itself.
+	const size_t relPathSize = strlen(relPath) + 1;
+	const size_t absNativePathSize = strlen(absNativePath) + 1;
+
+	item = (ResolvedPath*)MEMPOOL_MALLOC(MEMPOOL_FILESYSTEM, sizeof(ResolvedPath) + relPathSize + absNativePathSize);
+	memset(item, 0, sizeof(*item));
+
+	char* strings = (char*)(item + 1);
+	memcpy(strings, relPath, relPathSize);
+	memcpy(strings + relPathSize, absNativePath, absNativePathSize);
+
+	item->relPath = strings;
+	item->absNativePath = strings + relPathSize;
+
+	HASH_ADD_KEYPTR(hh, g_ResolvedPaths, item->relPath, relPathSize - 1, item);
+	return item->absNativePath;
+}
+
+// Converts a relative path into the form used in pack archives. Returns the
+// length of the converted path, or 0 if the path could not be in an archive.
+static size_t MakeArchivePath(const char* relPath, char* outBuffer, size_t outBufferSize)
+{
+	size_t length = 0;
+
+	while ( relPath && *relPath )
+	{
+		while ( *relPath == '/' || *relPath == '\\' )
+		{
+			++relPath;
+		}
+
+		const char* segment = relPath;
+
+		while ( *relPath && *relPath != '/' && *relPath != '\\' )
+		{
+			++relPath;
+		}
+
+		const size_t segmentLength = (size_t)(relPath - segment);
+
+		if ( segmentLength == 0 || (segmentLength == 1 && segment[0] == '.') )
+		{
+			continue;
+		}
+
+		if ( segmentLength == 2 && segment[0] == '.' && segment[1] == '.' )
+		{
+			// Archives never contain paths like this, so don't bother resolving them.
+			return 0;
+		}
+
+		// Leave space for a separator and the terminator.
+		if ( length + segmentLength + 2 > outBufferSize )
+		{
+			return 0;
+		}
+
+		if ( length > 0 )
+		{
+			outBuffer[length++] = '/';
+		}
+
+		memcpy(outBuffer + length, segment, segmentLength);
+		length += segmentLength;
+		outBuffer[length] = '\0';
+	}
+
+	return length;
+}
+
+static const PackArchive_IndexEntry* FindArchiveEntry(const char* relPath, const PackArchive** outArchive)
+{
+	if ( g_NumMountedArchives < 1 )
+	{
+		return NULL;
+	}
+
+	FilesystemSubsystem_Path archivePath;
+	const size_t length = MakeArchivePath(relPath, archivePath, sizeof(archivePath));
+
+	if ( length < 1 )
+	{
+		return NULL;
+	}
+
+	for ( size_t index = g_NumMountedArchives; index > 0; --index )
+	{
+		const PackArchive* archive = g_MountedArchives[index - 1];
+		const PackArchive_IndexEntry* entry = PackArchive_FindEntry(archive, archivePath, length);
+
+		if ( entry )
+		{
+			*outArchive = archive;
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+// Returns a buffer which can be freed with UnloadFileData().
+static uint8_t* ReadArchiveEntry(const PackArchive* archive, const PackArchive_IndexEntry* entry)
+{
+	uint8_t* data = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_RAYLIB, entry->size > 0 ? (size_t)entry->size : 1);
+
+	if ( !PackArchive_ReadEntry(archive, entry, data) )
+	{
+		Logging_PrintLine(
+			RAYGE_LOG_ERROR,
+			"Could not read corrupt entry from pack archive %s",
+			PackArchive_GetNativePath(archive)
+		);
+
+		MEMPOOL_FREE(data);
+		return NULL;
+	}
+
+	return data;
+}
+
+static bool MountArchiveFromNativePath(const char* nativePath)
+{
+	if ( g_NumMountedArchives >= MAX_MOUNTED_ARCHIVES )
+	{
+		Logging_PrintLine(
+			RAYGE_LOG_ERROR,
+			"Cannot mount pack archive %s: limit of %d mounted archives was reached",
+			nativePath,
+			MAX_MOUNTED_ARCHIVES
+		);
+
+		return false;
+	}
+
+	PackArchive* archive = PackArchive_Open(nativePath);
+
+	if ( !archive )
+	{
+		return false;
+	}
+
+	g_MountedArchives[g_NumMountedArchives++] = archive;
+
+	Logging_PrintLine(
+		RAYGE_LOG_DEBUG,
+		"Mounted pack archive %s with %zu files",
+		nativePath,
+		PackArchive_NumEntries(archive)
+	);
+
+	return true;
+}
+
+static int CompareNativePaths(const void* lhs, const void* rhs)
+{
+	return strcmp(*(const char* const*)lhs, *(const char* const*)rhs);
+}
+
+static void MountArchivesInRootDirectory(void)
+{
+	FilePathList list = LoadDirectoryFilesEx(g_NativeRootDirectory, PACK_ARCHIVE_FILE_EXTENSION, false);
+
+	if ( list.count > 0 )
+	{
+		qsort(list.paths, list.count, sizeof(list.paths[0]), &CompareNativePaths);
+	}
 
-	MEMPOOL_FREE(relNativePath);
-	return relPath;
+	for ( unsigned int index = 0; index < list.count; ++index )
+	{
+		if ( !IsPathFile(list.paths[index]) )
+		{
+			continue;
+		}
+
+		MountArchiveFromNativePath(list.paths[index]);
+	}
+
+	UnloadDirectoryFiles(list);
 }
 
 static void FreeEntryContents(FilesystemSubsystem_PathEntry* entry)
@@ -253,22 +505,49 @@ static void FreeEntryContents(FilesystemSubsystem_PathEntry* entry)
 
 void FilesystemSubsystem_Init(void)
 {
-	// Nothing yet.
-	// Probably want to set up application directory here.
+	// Data is allocated from the raylib category, so that it
+	// can be freed in the same way as FilesystemSubsystem_LoadFileData().
+	g_ReadQueue = AsyncReadQueue_Create(MEMPOOL_FILESYSTEM, MEMPOOL_RAYLIB, ASYNC_READ_THREADS, true);
+	RAYGE_ENSURE(g_ReadQueue, "Could not create asynchronous read queue");
+
+	Logging_PrintLine(
+		RAYGE_LOG_DEBUG,
+		"Asynchronous file reads will use %s",
+		AsyncReadQueue_UsesIoUring(g_ReadQueue) ? "io_uring" : "worker threads"
+	);
 }
 
 void FilesystemSubsystem_ShutDown(void)
 {
-	// Nothing yet.
+	if ( g_ReadQueue )
+	{
+		AsyncReadQueue_Destroy(g_ReadQueue);
+		g_ReadQueue = NULL;
+	}
+
+	FilesystemSubsystem_UnmountAllArchives();
+	ClearResolvedPaths();
 }
 
-FilesystemSubsystem_PathList* FilesystemSubsystem_ListDirectory(const char* path)
+void FilesystemSubsystem_NewFrame(void)
 {
-	char* nativeAbsPath = RelativePathToAbsoluteNativePath(path);
-	FilePathList list = LoadDirectoryFiles(nativeAbsPath);
-	MEMPOOL_FREE(nativeAbsPath);
+	if ( g_ReadQueue )
+	{
+		AsyncReadQueue_ProcessCompleted(g_ReadQueue, 0);
+	}
+}
 
+FilesystemSubsystem_PathList* FilesystemSubsystem_ListDirectory(const char* path)
+{
 	FilesystemSubsystem_PathList* outList = MEMPOOL_CALLOC_STRUCT(MEMPOOL_FILESYSTEM, FilesystemSubsystem_PathList);
+	const char* nativeAbsPath = ResolvePath(path);
+
+	if ( !nativeAbsPath )
+	{
+		return outList;
+	}
+
+	FilePathList list = LoadDirectoryFiles(nativeAbsPath);
 
 	outList->count = (size_t)WZL_MAX(list.count, 0);
 
@@ -328,29 +607,89 @@ void FilesystemSubsystem_SetBaseRelPath(const char* path)
 
 	Logging_PrintLine(RAYGE_LOG_DEBUG, "Setting filesystem base path: %s", g_BaseRelDirectory);
 
-	PathSeparatorsToNative(g_BaseRelDirectory);
+	FilesystemSubsystem_Path nativeBaseRelDirectory;
+
+	if ( !PathSeparatorsToNative(g_BaseRelDirectory, nativeBaseRelDirectory, sizeof(nativeBaseRelDirectory)) )
+	{
+		nativeBaseRelDirectory[0] = '\0';
+	}
+
+	wzl_strcpy(g_BaseRelDirectory, sizeof(g_BaseRelDirectory), nativeBaseRelDirectory);
 	EnsureApplicationDirectory(true);
+	ClearResolvedPaths();
 
 	RAYGE_ASSERT(DirectoryExists(g_NativeRootDirectory), "Specified root directory does not exist!");
+
+	FilesystemSubsystem_UnmountAllArchives();
+	MountArchivesInRootDirectory();
 }
 
-bool FilesystemSubsystem_DirectoryExists(const char* path)
+bool FilesystemSubsystem_MountArchive(const char* path)
+{
+	RAYGE_ASSERT_VALID(path);
+
+	if ( !path )
+	{
+		return false;
+	}
+
+	const char* nativePath = ResolvePath(path);
+	return nativePath ? MountArchiveFromNativePath(nativePath) : false;
+}
+
+void FilesystemSubsystem_UnmountAllArchives(void)
+{
+	// Neither reads from archives nor views into them may outlive the archives.
+	// Texture load jobs hold views while they decode on worker threads, and
+	// release them once they complete.
+	if ( g_ReadQueue )
+	{
+		AsyncReadQueue_CancelAll(g_ReadQueue);
+	}
+
+	TextureResources_FinishPendingLoads();
+
+	for ( size_t index = 0; index < g_NumMountedArchives; ++index )
+	{
+		PackArchive_Close(g_MountedArchives[index]);
+		g_MountedArchives[index] = NULL;
+	}
+
+	g_NumMountedArchives = 0;
+}
+
+size_t FilesystemSubsystem_NumMountedArchives(void)
 {
-	char* nativePath = RelativePathToAbsoluteNativePath(path);
-	const bool exists = DirectoryExists(nativePath);
-	MEMPOOL_FREE(nativePath);
+	return g_NumMountedArchives;
+}
 
-	return exists;
+bool FilesystemSubsystem_DirectoryExists(const char* path)
+{
+	const char* nativePath = ResolvePath(path);
+	return nativePath ? DirectoryExists(nativePath) : false;
 }
 
 uint8_t* FilesystemSubsystem_LoadFileData(const char* path, size_t* size)
 {
-	char* nativePath = RelativePathToAbsoluteNativePath(path);
+	const PackArchive* archive = NULL;
+	const PackArchive_IndexEntry* entry = FindArchiveEntry(path, &archive);
 
-	int dataSize = 0;
-	uint8_t* data = LoadFileData(nativePath, &dataSize);
+	if ( entry )
+	{
+		uint8_t* data = ReadArchiveEntry(archive, entry);
 
-	MEMPOOL_FREE(nativePath);
+		if ( size )
+		{
+			*size = data ? (size_t)entry->size : 0;
+		}
+
+		return data;
+	}
+
+	const char* nativePath = ResolvePath(path);
+
+	int dataSize = 0;
+	uint8_t* data = nativePath ? LoadFileData(nativePath, &dataSize) : NULL;
 
 	if ( size )
 	{
@@ -368,6 +707,96 @@ void FilesystemSubsystem_UnloadFileData(uint8_t* data)
 	}
 }
 
+bool FilesystemSubsystem_MapFile(const char* path, FilesystemSubsystem_MappedFile* outFile)
+{
+	RAYGE_ASSERT_VALID(outFile);
+
+	if ( !outFile )
+	{
+		return false;
+	}
+
+	memset(outFile, 0, sizeof(*outFile));
+
+	const PackArchive* archive = NULL;
+	const PackArchive_IndexEntry* entry = FindArchiveEntry(path, &archive);
+
+	if ( entry )
+	{
+		outFile->data = PackArchive_GetEntryView(archive, entry);
+
+		if ( !outFile->data )
+		{
+			// Compressed, so there is nothing to map directly.
+			outFile->ownedData = ReadArchiveEntry(archive, entry);
+			outFile->data = outFile->ownedData;
+		}
+
+		outFile->size = outFile->data ? (size_t)entry->size : 0;
+		outFile->modTimeNs = PackArchive_GetModTimeNs(archive);
+		return outFile->data != NULL;
+	}
+
+	// The path is made safe before it is resolved, so mapping never
+	// reaches outside of the base directory, just like loading.
+	const char* nativePath = ResolvePath(path);
+
+	if ( !nativePath || !NativeFilesystem_MapFile(nativePath, &outFile->nativeFile) )
+	{
+		return false;
+	}
+
+	outFile->data = outFile->nativeFile.data;
+	outFile->size = outFile->nativeFile.size;
+	outFile->modTimeNs = outFile->nativeFile.modTimeNs;
+
+	return true;
+}
+
+void FilesystemSubsystem_UnmapFile(FilesystemSubsystem_MappedFile* file)
+{
+	if ( !file )
+	{
+		return;
+	}
+
+	FilesystemSubsystem_UnloadFileData(file->ownedData);
+	NativeFilesystem_UnmapFile(&file->nativeFile);
+	memset(file, 0, sizeof(*file));
+}
+
+AsyncReadQueue_RequestID FilesystemSubsystem_ReadAsync(
+	const char* path,
+	AsyncReadQueue_Priority priority,
+	AsyncReadQueue_CompleteFunc completeFunc,
+	void* userData
+)
+{
+	RAYGE_ASSERT_VALID(path);
+
+	if ( !g_ReadQueue || !path )
+	{
+		return 0;
+	}
+
+	const PackArchive* archive = NULL;
+	const PackArchive_IndexEntry* entry = FindArchiveEntry(path, &archive);
+
+	if ( entry )
+	{
+		return AsyncReadQueue_SubmitArchiveEntry(g_ReadQueue, archive, entry, priority, completeFunc, userData);
+	}
+
+	const char* nativePath = ResolvePath(path);
+
+	return nativePath ? AsyncReadQueue_SubmitFile(g_ReadQueue, nativePath, priority, completeFunc, userData) : 0;
+}
+
+bool FilesystemSubsystem_CancelRead(AsyncReadQueue_RequestID id)
+{
+	return g_ReadQueue ? AsyncReadQueue_Cancel(g_ReadQueue, id) : false;
+}
+
 bool FilesystemSubsystem_MakeAbsolute(const char* relPath, char* outBuffer, size_t outBufferSize)
 {
 	if ( !outBuffer || outBufferSize < 1 )
@@ -382,14 +811,25 @@ bool FilesystemSubsystem_MakeAbsolute(const char* relPath, char* outBuffer, size
 		return false;
 	}
 
-	char* nativePath = RelativePathToAbsoluteNativePath(relPath);
-	wzl_strcpy(outBuffer, outBufferSize, nativePath);
-	MEMPOOL_FREE(nativePath);
+	const char* nativePath = ResolvePath(relPath);
+	const size_t length = nativePath ? strlen(nativePath) : 0;
+
+	if ( !nativePath || length >= outBufferSize )
+	{
+		return false;
+	}
 
+	memcpy(outBuffer, nativePath, length + 1);
 	return true;
 }
 
+const char* FilesystemSubsystem_ResolvePath(const char* relPath)
+{
+	return relPath ? ResolvePath(relPath) : NULL;
+}
+
 char* FilesystemSubsystem_MakeAbsoluteAlloc(const char* relPath)
 {
-	return relPath ? RelativePathToAbsoluteNativePath(relPath) : NULL;
+	const char* nativePath = relPath ? ResolvePath(relPath) : NULL;
+	return nativePath ? StringUtils_Duplicate(MEMPOOL_FILESYSTEM, nativePath) : NULL;
 }
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "wzl_cutl/attributes.h"
+#include "Filesystem/AsyncReadQueue.h"
+#include "Filesystem/NativeFilesystem.h"
 
 #define FILESYSTEM_MAX_REL_PATH 512
 #define FILESYSTEM_MAX_ABS_PATH 4096
@@ -27,9 +29,30 @@ typedef struct FilesystemSubsystem_PathList
 	FilesystemSubsystem_PathEntry* entries;
 } FilesystemSubsystem_PathList;
 
+// A read-only view of a whole file. The members should be treated as read-only.
+// The data is not null terminated, and is null if the file is empty.
+typedef struct FilesystemSubsystem_MappedFile
+{
+	const uint8_t* data;
+	size_t size;
+
+	// For files in archives, this is the modification time of the archive.
+	int64_t modTimeNs;
+
+	// Only one of these is used, depending on where the file came from.
+	uint8_t* ownedData;
+	NativeFilesystem_MappedFile nativeFile;
+} FilesystemSubsystem_MappedFile;
+
 void FilesystemSubsystem_Init(void);
 void FilesystemSubsystem_ShutDown(void);
 
+// Completion functions for asynchronous reads are called from here. The engine
+// calls this near the start of each frame, before resources are processed, so
+// that resource loaders can act on data that finished loading during the
+// previous frame.
+void FilesystemSubsystem_NewFrame(void);
+
 FilesystemSubsystem_PathList* FilesystemSubsystem_ListDirectory(const char* path);
 void FilesystemSubsystem_FreePathList(FilesystemSubsystem_PathList* list);
 
@@ -39,8 +62,53 @@ void FilesystemSubsystem_SetBaseRelPath(const char* path);
 
 bool FilesystemSubsystem_DirectoryExists(const char* path);
 
+// Pack archives (see Filesystem/PackArchiveFormat.h) in the root of the base
+// directory are mounted automatically when the base path is set, in order of
+// their file names. Files in archives that were mounted later take priority
+// over those in archives that were mounted earlier, and all files in archives
+// take priority over loose files on disk.
+bool FilesystemSubsystem_MountArchive(const char* path);
+void FilesystemSubsystem_UnmountAllArchives(void);
+size_t FilesystemSubsystem_NumMountedArchives(void);
+
+// Returns a copy of the file's data, which must be freed with FilesystemSubsystem_UnloadFileData().
 WZL_ATTR_NODISCARD uint8_t* FilesystemSubsystem_LoadFileData(const char* path, size_t* size);
 void FilesystemSubsystem_UnloadFileData(uint8_t* data);
 
+// Maps the file into memory without copying it, if possible. Loose files are
+// memory mapped, and files stored uncompressed in a mounted archive are returned
+// as a view into the archive's mapping. Only compressed files in archives are
+// read into memory owned by the view. The view must be released with
+// FilesystemSubsystem_UnmapFile(), which may be called from any thread. Views
+// into archives must be released before the base path is changed, since this
+// remounts all archives.
+bool FilesystemSubsystem_MapFile(const char* path, FilesystemSubsystem_MappedFile* outFile);
+void FilesystemSubsystem_UnmapFile(FilesystemSubsystem_MappedFile* file);
+
+// Reads the whole file in the background (see Filesystem/AsyncReadQueue.h), and
+// calls the completion function from FilesystemSubsystem_NewFrame() once it has
+// finished. If the read succeeded, the completion function takes ownership of
+// the data, and must free it with FilesystemSubsystem_UnloadFileData(). Returns
+// 0 if the read could not be queued, in which case the completion function is
+// not called. Changing the base path cancels all outstanding reads.
+AsyncReadQueue_RequestID FilesystemSubsystem_ReadAsync(
+	const char* path,
+	AsyncReadQueue_Priority priority,
+	AsyncReadQueue_CompleteFunc completeFunc,
+	void* userData
+);
+
+// The completion function is still called, with a status of ASYNC_READ_CANCELLED.
+bool FilesystemSubsystem_CancelRead(AsyncReadQueue_RequestID id);
+
+// Returns false if the absolute path did not fit into the buffer.
 bool FilesystemSubsystem_MakeAbsolute(const char* relPath, char* outBuffer, size_t outBufferSize);
+
+// Resolved absolute paths are cached, so resolving the same relative path again
+// does not allocate. The returned string is owned by the cache, and is valid until
+// the base path is next changed. Returns null if the path was too long to resolve.
+const char* FilesystemSubsystem_ResolvePath(const char* relPath);
+
+// Prefer FilesystemSubsystem_ResolvePath() where possible, since it avoids a copy.
+// The returned string is owned by the caller, and must be freed with MEMPOOL_FREE().
 WZL_ATTR_NODISCARD char* FilesystemSubsystem_MakeAbsoluteAlloc(const char* relPath);
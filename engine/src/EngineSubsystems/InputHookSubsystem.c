@@ -1,6 +1,7 @@
 #include "EngineSubsystems/InputHookSubsystem.h"
 #include "Logging/Logging.h"
 #include "Input/InputBufferKeyboard.h"
+#include "MemPool/MemPoolObjectPool.h"
 #include "utlist.h"
 #include "Headless.h"
 
@@ -33,16 +34,20 @@ typedef struct HookInputHashItem
 	HookItem* list;
 } HookInputHashItem;
 
+#define HOOKS_PER_CHUNK 64
+
 typedef struct Data
 {
 	HookInputHashItem* inputHash[INPUT_SOURCE__COUNT];
+	MemPool_ObjectPool* hookItemPool;
+	MemPool_ObjectPool* hashItemPool;
 } Data;
 
 static Data* g_Data = NULL;
 
 static HookItem* CreateHookItem(unsigned int modifierFlags, RayGE_InputHook hook)
 {
-	HookItem* item = MEMPOOL_CALLOC_STRUCT(MEMPOOL_INPUT, HookItem);
+	HookItem* item = (HookItem*)MemPoolObjectPool_Calloc(g_Data->hookItemPool);
 
 	item->hook = hook;
 	item->modifierFlags = modifierFlags;
@@ -57,12 +62,12 @@ static void DestroyHookItem(HookItem* item)
 		return;
 	}
 
-	MEMPOOL_FREE(item);
+	MemPoolObjectPool_Free(g_Data->hookItemPool, item);
 }
 
 static HookInputHashItem* CreateInputHashItem(int id)
 {
-	HookInputHashItem* item = MEMPOOL_CALLOC_STRUCT(MEMPOOL_INPUT, HookInputHashItem);
+	HookInputHashItem* item = (HookInputHashItem*)MemPoolObjectPool_Calloc(g_Data->hashItemPool);
 	item->id = id;
 	return item;
 }
@@ -83,12 +88,14 @@ static void DestroyInputHashItem(HookInputHashItem* item)
 		DestroyHookItem(elementToDelete);
 	}
 
-	MEMPOOL_FREE(item);
+	MemPoolObjectPool_Free(g_Data->hashItemPool, item);
 }
 
 static Data* CreateData(void)
 {
 	Data* data = MEMPOOL_CALLOC_STRUCT(MEMPOOL_INPUT, Data);
+	data->hookItemPool = MEMPOOL_OBJECTPOOL_CREATE(MEMPOOL_INPUT, HookItem, HOOKS_PER_CHUNK);
+	data->hashItemPool = MEMPOOL_OBJECTPOOL_CREATE(MEMPOOL_INPUT, HookInputHashItem, HOOKS_PER_CHUNK);
 	return data;
 }
 
@@ -111,6 +118,8 @@ static void DestroyData(Data* data)
 		}
 	}
 
+	MemPoolObjectPool_Destroy(data->hookItemPool);
+	MemPoolObjectPool_Destroy(data->hashItemPool);
 	MEMPOOL_FREE(data);
 }
 
@@ -1,17 +1,21 @@
 #include "EngineSubsystems/ResourceSubsystem.h"
 #include "Resources/TextureResources.h"
 #include "Resources/PixelWorldResources.h"
+#include "Resources/ResourceResidency.h"
 #include "Utils/Utils.h"
 
-typedef struct InitAndShutdown
+typedef struct ResourceTypeFuncs
 {
 	void (*Init)(void);
 	void (*ShutDown)(void);
-} InitAndShutdown;
+	void (*NewFrame)(void);
+} ResourceTypeFuncs;
 
-static const InitAndShutdown g_Resources[] = {
-	{TextureResources_Init, TextureResources_ShutDown},
-	{PixelWorldResources_Init, PixelWorldResources_ShutDown},
+// Resource types listed later may hold references to
+// those listed earlier, but not the other way around.
+static const ResourceTypeFuncs g_Resources[] = {
+	{TextureResources_Init, TextureResources_ShutDown, TextureResources_NewFrame},
+	{PixelWorldResources_Init, PixelWorldResources_ShutDown, PixelWorldResources_NewFrame},
 };
 
 static bool g_Initialised = false;
@@ -23,6 +27,8 @@ void ResourceSubsystem_Init(void)
 		return;
 	}
 
+	ResourceResidency_Init();
+
 	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(g_Resources); ++index )
 	{
 		if ( g_Resources[index].Init )
@@ -49,5 +55,29 @@ void ResourceSubsystem_ShutDown(void)
 		}
 	}
 
+	ResourceResidency_ShutDown();
 	g_Initialised = false;
 }
+
+void ResourceSubsystem_NewFrame(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	// Destroying a resource may release references to resources of
+	// earlier types, so these are processed last to first in order
+	// to clean them up on the same frame.
+	for ( size_t index = RAYGE_ARRAY_SIZE(g_Resources); index > 0; --index )
+	{
+		if ( g_Resources[index - 1].NewFrame )
+		{
+			g_Resources[index - 1].NewFrame();
+		}
+	}
+
+	// This is done once pending resources have been destroyed,
+	// since they may free up enough memory on their own.
+	ResourceResidency_NewFrame();
+}
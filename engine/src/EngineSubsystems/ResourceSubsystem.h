@@ -2,3 +2,6 @@
 
 void ResourceSubsystem_Init(void);
 void ResourceSubsystem_ShutDown(void);
+
+// Destroys any resources that were fully unloaded during the previous frame.
+void ResourceSubsystem_NewFrame(void);
@@ -25,6 +25,11 @@ void SceneSubsystem_ShutDown(void)
 	g_Scene = NULL;
 }
 
+void SceneSubsystem_EndFrame(void)
+{
+	Scene_ReleaseDestroyedEntities(g_Scene);
+}
+
 RayGE_Scene* SceneSubsystem_GetScene(void)
 {
 	RAYGE_ASSERT_VALID(g_Scene);
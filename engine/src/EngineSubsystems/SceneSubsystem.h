@@ -5,4 +5,8 @@
 void SceneSubsystem_Init(void);
 void SceneSubsystem_ShutDown(void);
 
+// Releases entities that were destroyed during the frame. The engine calls
+// this once all behavioural systems have run for the frame.
+void SceneSubsystem_EndFrame(void);
+
 RayGE_Scene* SceneSubsystem_GetScene(void);
@@ -0,0 +1,1183 @@
+// For syscall() and MAP_POPULATE, since io_uring has no libc wrappers.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "Filesystem/AsyncReadQueue.h"
+#include "Filesystem/NativeFilesystem.h"
+#include "Threading/Threading.h"
+#include "Threading/WorkerPool.h"
+#include "Utils/StringUtils.h"
+#include "RayGE/Platform.h"
+#include "Debugging.h"
+#include "wzl_cutl/math.h"
+#include "wzl_cutl/string.h"
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_LINUX && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+#ifndef HAVE_IO_URING
+#define HAVE_IO_URING 0
+#endif
+
+#if HAVE_IO_URING
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+// Enough reads to keep a disk busy, without the ring taking up much memory.
+#define RING_ENTRIES 64
+
+// The kernel will not read much more than this in one go anyway.
+#define MAX_RING_READ_SIZE ((size_t)0x40000000)
+#endif
+
+typedef struct Request
+{
+	struct Request* prev;
+	struct Request* next;
+
+	AsyncReadQueue_RequestID id;
+	AsyncReadQueue_Priority priority;
+	AsyncReadQueue_CompleteFunc completeFunc;
+	void* userData;
+
+	// Either the path is used, or the archive and entry.
+	char* nativePath;
+	const PackArchive* archive;
+	const PackArchive_IndexEntry* archiveEntry;
+
+	// Only written by whichever thread is servicing the request.
+	bool succeeded;
+	uint8_t* data;
+	size_t size;
+
+	// Only accessed by the thread that owns the queue.
+	bool cancelled;
+
+#if HAVE_IO_URING
+	int fd;
+	size_t bytesRead;
+	struct iovec iov;
+#endif
+} Request;
+
+typedef struct RequestList
+{
+	Request* head;
+	Request* tail;
+} RequestList;
+
+#if HAVE_IO_URING
+typedef struct IoUring
+{
+	int fd;
+	unsigned int numEntries;
+
+	void* sqRing;
+	size_t sqRingSize;
+	unsigned int* sqHead;
+	unsigned int* sqTail;
+	unsigned int* sqMask;
+	unsigned int* sqArray;
+
+	struct io_uring_sqe* sqes;
+	size_t sqesSize;
+
+	// If the kernel supports it, this is the same mapping as the submission ring.
+	void* cqRing;
+	size_t cqRingSize;
+	unsigned int* cqHead;
+	unsigned int* cqTail;
+	unsigned int* cqMask;
+	struct io_uring_cqe* cqes;
+
+	// Reads which have been queued, and whose completions have not yet been reaped.
+	size_t numInFlight;
+} IoUring;
+#endif
+
+struct AsyncReadQueue
+{
+	MemPool_Category category;
+	MemPool_Category dataCategory;
+
+	// Only accessed by the thread that owns the queue.
+	AsyncReadQueue_RequestID nextID;
+	size_t numOutstanding;
+	RequestList finished;
+
+	// Guards the worker lists, which are shared with the worker threads. Each
+	// request in the pending lists has a matching job in the worker pool, which
+	// services whichever pending request has the highest priority when it runs.
+	Threading_Mutex lock;
+	Threading_CondVar readFinished;
+	RequestList workerPending[ASYNC_READ_PRIORITY__COUNT];
+	RequestList workerRunning;
+	RequestList workerFinished;
+	WorkerPool* workerPool;
+
+#if HAVE_IO_URING
+	// Only accessed by the thread that owns the queue.
+	bool ringValid;
+	IoUring ring;
+	RequestList ringPending[ASYNC_READ_PRIORITY__COUNT];
+	RequestList ringRunning;
+#endif
+};
+
+static void PushRequest(RequestList* list, Request* request)
+{
+	request->prev = list->tail;
+	request->next = NULL;
+
+	if ( list->tail )
+	{
+		list->tail->next = request;
+	}
+	else
+	{
+		list->head = request;
+	}
+
+	list->tail = request;
+}
+
+static void RemoveRequest(RequestList* list, Request* request)
+{
+	if ( request->prev )
+	{
+		request->prev->next = request->next;
+	}
+	else
+	{
+		list->head = request->next;
+	}
+
+	if ( request->next )
+	{
+		request->next->prev = request->prev;
+	}
+	else
+	{
+		list->tail = request->prev;
+	}
+
+	request->prev = NULL;
+	request->next = NULL;
+}
+
+static Request* PopRequest(RequestList* list)
+{
+	Request* request = list->head;
+
+	if ( request )
+	{
+		RemoveRequest(list, request);
+	}
+
+	return request;
+}
+
+static Request* PopHighestPriorityRequest(RequestList* lists)
+{
+	for ( size_t index = ASYNC_READ_PRIORITY__COUNT; index > 0; --index )
+	{
+		Request* request = PopRequest(&lists[index - 1]);
+
+		if ( request )
+		{
+			return request;
+		}
+	}
+
+	return NULL;
+}
+
+static void AppendRequests(RequestList* dest, RequestList* source)
+{
+	if ( !source->head )
+	{
+		return;
+	}
+
+	if ( dest->tail )
+	{
+		dest->tail->next = source->head;
+		source->head->prev = dest->tail;
+	}
+	else
+	{
+		dest->head = source->head;
+	}
+
+	dest->tail = source->tail;
+	source->head = NULL;
+	source->tail = NULL;
+}
+
+static Request* FindRequest(RequestList* list, AsyncReadQueue_RequestID id)
+{
+	for ( Request* request = list->head; request; request = request->next )
+	{
+		if ( request->id == id )
+		{
+			return request;
+		}
+	}
+
+	return NULL;
+}
+
+static void MarkCancelled(RequestList* list)
+{
+	for ( Request* request = list->head; request; request = request->next )
+	{
+		request->cancelled = true;
+	}
+}
+
+static void CancelPending(AsyncReadQueue* queue, RequestList* lists)
+{
+	for ( size_t index = 0; index < ASYNC_READ_PRIORITY__COUNT; ++index )
+	{
+		MarkCancelled(&lists[index]);
+		AppendRequests(&queue->finished, &lists[index]);
+	}
+}
+
+static Request* CreateRequest(
+	AsyncReadQueue* queue,
+	AsyncReadQueue_Priority priority,
+	AsyncReadQueue_CompleteFunc completeFunc,
+	void* userData
+)
+{
+	RAYGE_ASSERT((size_t)priority < ASYNC_READ_PRIORITY__COUNT, "Invalid read priority");
+
+	if ( (size_t)priority >= ASYNC_READ_PRIORITY__COUNT )
+	{
+		priority = ASYNC_READ_PRIORITY_NORMAL;
+	}
+
+	Request* request = MEMPOOL_CALLOC_STRUCT(queue->category, Request);
+	request->id = queue->nextID++;
+	request->priority = priority;
+	request->completeFunc = completeFunc;
+	request->userData = userData;
+
+#if HAVE_IO_URING
+	request->fd = -1;
+#endif
+
+	++queue->numOutstanding;
+	return request;
+}
+
+static void CompleteRequest(AsyncReadQueue* queue, Request* request)
+{
+	AsyncReadQueue_Result result;
+	memset(&result, 0, sizeof(result));
+
+	result.id = request->id;
+
+	if ( request->cancelled )
+	{
+		result.status = ASYNC_READ_CANCELLED;
+	}
+	else if ( request->succeeded )
+	{
+		// Ownership of the data passes to the completion function.
+		result.status = ASYNC_READ_SUCCEEDED;
+		result.data = request->data;
+		result.size = request->size;
+		request->data = NULL;
+	}
+	else
+	{
+		result.status = ASYNC_READ_FAILED;
+	}
+
+	if ( request->data )
+	{
+		MEMPOOL_FREE(request->data);
+	}
+
+	if ( request->completeFunc )
+	{
+		request->completeFunc(request->userData, &result);
+	}
+
+	if ( request->nativePath )
+	{
+		MEMPOOL_FREE(request->nativePath);
+	}
+
+	MEMPOOL_FREE(request);
+	--queue->numOutstanding;
+}
+
+// Called on a worker thread.
+static void ReadRequest(AsyncReadQueue* queue, Request* request)
+{
+	if ( !request->archive )
+	{
+		request->succeeded =
+			NativeFilesystem_ReadFile(request->nativePath, queue->dataCategory, &request->data, &request->size);
+
+		return;
+	}
+
+	request->size = (size_t)request->archiveEntry->size;
+
+	if ( request->size < 1 )
+	{
+		request->succeeded = true;
+		return;
+	}
+
+	request->data = (uint8_t*)MEMPOOL_MALLOC(queue->dataCategory, request->size);
+	request->succeeded = PackArchive_ReadEntry(request->archive, request->archiveEntry, request->data);
+}
+
+static void RunWorkerJob(void* userData)
+{
+	AsyncReadQueue* queue = (AsyncReadQueue*)userData;
+
+	Threading_Mutex_Lock(&queue->lock);
+
+	Request* request = PopHighestPriorityRequest(queue->workerPending);
+
+	if ( request )
+	{
+		PushRequest(&queue->workerRunning, request);
+	}
+
+	Threading_Mutex_Unlock(&queue->lock);
+
+	// If there is nothing left, the request this job was
+	// submitted for must have been cancelled before it started.
+	if ( !request )
+	{
+		return;
+	}
+
+	ReadRequest(queue, request);
+
+	Threading_Mutex_Lock(&queue->lock);
+	RemoveRequest(&queue->workerRunning, request);
+	PushRequest(&queue->workerFinished, request);
+	Threading_CondVar_Broadcast(&queue->readFinished);
+	Threading_Mutex_Unlock(&queue->lock);
+}
+
+static void SubmitToWorkers(AsyncReadQueue* queue, Request* request)
+{
+	Threading_Mutex_Lock(&queue->lock);
+	PushRequest(&queue->workerPending[request->priority], request);
+	Threading_Mutex_Unlock(&queue->lock);
+
+	WorkerPool_Submit(queue->workerPool, &RunWorkerJob, NULL, queue);
+}
+
+#if HAVE_IO_URING
+static void DestroyRing(IoUring* ring)
+{
+	if ( ring->sqes )
+	{
+		munmap(ring->sqes, ring->sqesSize);
+	}
+
+	if ( ring->cqRing && ring->cqRing != ring->sqRing )
+	{
+		munmap(ring->cqRing, ring->cqRingSize);
+	}
+
+	if ( ring->sqRing )
+	{
+		munmap(ring->sqRing, ring->sqRingSize);
+	}
+
+	if ( ring->fd >= 0 )
+	{
+		close(ring->fd);
+	}
+
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = -1;
+}
+
+static void* MapRing(const IoUring* ring, size_t size, off_t offset)
+{
+	void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, offset);
+	return mapping != MAP_FAILED ? mapping : NULL;
+}
+
+// Returns false if io_uring is not supported by the kernel, or has been disabled.
+static bool InitRing(IoUring* ring)
+{
+	memset(ring, 0, sizeof(*ring));
+
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	const long fd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+
+	if ( fd < 0 )
+	{
+		ring->fd = -1;
+		return false;
+	}
+
+	ring->fd = (int)fd;
+	ring->numEntries = params.sq_entries;
+	ring->sqRingSize = params.sq_off.array + (params.sq_entries * sizeof(unsigned int));
+	ring->cqRingSize = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+	ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+	if ( singleMapping )
+	{
+		ring->sqRingSize = WZL_MAX(ring->sqRingSize, ring->cqRingSize);
+		ring->cqRingSize = ring->sqRingSize;
+	}
+
+	ring->sqRing = MapRing(ring, ring->sqRingSize, IORING_OFF_SQ_RING);
+	ring->cqRing = singleMapping ? ring->sqRing : MapRing(ring, ring->cqRingSize, IORING_OFF_CQ_RING);
+	ring->sqes = (struct io_uring_sqe*)MapRing(ring, ring->sqesSize, IORING_OFF_SQES);
+
+	if ( !ring->sqRing || !ring->cqRing || !ring->sqes )
+	{
+		DestroyRing(ring);
+		return false;
+	}
+
+	uint8_t* sqRing = (uint8_t*)ring->sqRing;
+	ring->sqHead = (unsigned int*)(sqRing + params.sq_off.head);
+	ring->sqTail = (unsigned int*)(sqRing + params.sq_off.tail);
+	ring->sqMask = (unsigned int*)(sqRing + params.sq_off.ring_mask);
+	ring->sqArray = (unsigned int*)(sqRing + params.sq_off.array);
+
+	uint8_t* cqRing = (uint8_t*)ring->cqRing;
+	ring->cqHead = (unsigned int*)(cqRing + params.cq_off.head);
+	ring->cqTail = (unsigned int*)(cqRing + params.cq_off.tail);
+	ring->cqMask = (unsigned int*)(cqRing + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe*)(cqRing + params.cq_off.cqes);
+
+	return true;
+}
+
+// The caller must make sure there is space in the ring.
+static void QueueRingRead(IoUring* ring, Request* request)
+{
+	const unsigned int tail = *ring->sqTail;
+
+	RAYGE_ASSERT(
+		tail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) < ring->numEntries,
+		"Submission ring was full"
+	);
+
+	const unsigned int index = tail & *ring->sqMask;
+	struct io_uring_sqe* sqe = &ring->sqes[index];
+
+	request->iov.iov_base = request->data + request->bytesRead;
+	request->iov.iov_len = WZL_MIN(request->size - request->bytesRead, MAX_RING_READ_SIZE);
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = request->fd;
+	sqe->off = (uint64_t)request->bytesRead;
+	sqe->addr = (uint64_t)(uintptr_t)&request->iov;
+	sqe->len = 1;
+	sqe->user_data = (uint64_t)(uintptr_t)request;
+
+	ring->sqArray[index] = index;
+	__atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+	++ring->numInFlight;
+}
+
+// Submits everything that has been queued, and optionally waits for completions.
+static void EnterRing(IoUring* ring, unsigned int minComplete)
+{
+	const unsigned int toSubmit = *ring->sqTail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+	const unsigned int flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+
+	if ( toSubmit < 1 && minComplete < 1 )
+	{
+		return;
+	}
+
+	while ( syscall(__NR_io_uring_enter, ring->fd, toSubmit, minComplete, flags, NULL, 0) < 0 && errno == EINTR )
+	{
+	}
+}
+
+static void FinishRingRequest(AsyncReadQueue* queue, Request* request, bool succeeded)
+{
+	if ( request->fd >= 0 )
+	{
+		close(request->fd);
+		request->fd = -1;
+	}
+
+	request->succeeded = succeeded;
+	RemoveRequest(&queue->ringRunning, request);
+	PushRequest(&queue->finished, request);
+}
+
+// Returns false if the file could not be opened.
+static bool OpenRingRequest(AsyncReadQueue* queue, Request* request)
+{
+	struct stat info;
+
+	request->fd = open(request->nativePath, O_RDONLY | O_CLOEXEC);
+
+	if ( request->fd < 0 || fstat(request->fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+		 (uint64_t)info.st_size > (uint64_t)SIZE_MAX )
+	{
+		return false;
+	}
+
+	request->size = (size_t)info.st_size;
+
+	if ( request->size > 0 )
+	{
+		request->data = (uint8_t*)MEMPOOL_MALLOC(queue->dataCategory, request->size);
+	}
+
+	return true;
+}
+
+// Files are only opened once their reads are about to start, so that
+// the number of open files is limited by the size of the ring.
+static void StartRingRequests(AsyncReadQueue* queue)
+{
+	IoUring* ring = &queue->ring;
+
+	// The completion ring is larger than the submission ring, so limiting the
+	// number of reads in flight like this means completions can never overflow.
+	while ( ring->numInFlight < ring->numEntries )
+	{
+		Request* request = PopHighestPriorityRequest(queue->ringPending);
+
+		if ( !request )
+		{
+			break;
+		}
+
+		PushRequest(&queue->ringRunning, request);
+
+		if ( !OpenRingRequest(queue, request) )
+		{
+			FinishRingRequest(queue, request, false);
+			continue;
+		}
+
+		if ( request->size < 1 )
+		{
+			FinishRingRequest(queue, request, true);
+			continue;
+		}
+
+		QueueRingRead(ring, request);
+	}
+
+	EnterRing(ring, 0);
+}
+
+static void ReapRingCompletions(AsyncReadQueue* queue)
+{
+	IoUring* ring = &queue->ring;
+	unsigned int head = *ring->cqHead;
+	const unsigned int tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+
+	for ( ; head != tail; ++head )
+	{
+		const struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cqMask];
+		Request* request = (Request*)(uintptr_t)cqe->user_data;
+		const int result = cqe->res;
+
+		--ring->numInFlight;
+
+		if ( result > 0 )
+		{
+			request->bytesRead += (size_t)result;
+		}
+
+		if ( request->bytesRead >= request->size )
+		{
+			FinishRingRequest(queue, request, true);
+			continue;
+		}
+
+		// A read of zero bytes means the file was truncated while we were reading it.
+		const bool canContinue = result > 0 || result == -EINTR || result == -EAGAIN;
+
+		if ( !canContinue || request->cancelled )
+		{
+			FinishRingRequest(queue, request, false);
+			continue;
+		}
+
+		// Short read, so carry on from where it left off.
+		QueueRingRead(ring, request);
+	}
+
+	__atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+}
+#endif
+
+static AsyncReadQueue_RequestID SubmitRequest(AsyncReadQueue* queue, Request* request)
+{
+	const AsyncReadQueue_RequestID id = request->id;
+
+#if HAVE_IO_URING
+	if ( queue->ringValid && !request->archive )
+	{
+		PushRequest(&queue->ringPending[request->priority], request);
+		StartRingRequests(queue);
+		return id;
+	}
+#endif
+
+	SubmitToWorkers(queue, request);
+	return id;
+}
+
+AsyncReadQueue* AsyncReadQueue_Create(
+	MemPool_Category category,
+	MemPool_Category dataCategory,
+	size_t numThreads,
+	bool allowIoUring
+)
+{
+	WorkerPool* workerPool = WorkerPool_Create(category, numThreads);
+
+	if ( !workerPool )
+	{
+		return NULL;
+	}
+
+	AsyncReadQueue* queue = MEMPOOL_CALLOC_STRUCT(category, AsyncReadQueue);
+
+	queue->category = category;
+	queue->dataCategory = dataCategory;
+	queue->nextID = 1;
+	queue->workerPool = workerPool;
+
+	Threading_Mutex_Init(&queue->lock);
+	Threading_CondVar_Init(&queue->readFinished);
+
+#if HAVE_IO_URING
+	queue->ringValid = allowIoUring && InitRing(&queue->ring);
+#else
+	(void)allowIoUring;
+#endif
+
+	return queue;
+}
+
+void AsyncReadQueue_Destroy(AsyncReadQueue* queue)
+{
+	RAYGE_ASSERT_VALID(queue);
+
+	if ( !queue )
+	{
+		return;
+	}
+
+	AsyncReadQueue_CancelAll(queue);
+
+	// No reads are running now. Any jobs left in the pool have nothing to do.
+	WorkerPool_Destroy(queue->workerPool);
+	queue->workerPool = NULL;
+
+#if HAVE_IO_URING
+	if ( queue->ringValid )
+	{
+		// Reads that the kernel already has must finish before their buffers can be freed.
+		while ( queue->ring.numInFlight > 0 )
+		{
+			EnterRing(&queue->ring, 1);
+			ReapRingCompletions(queue);
+		}
+
+		DestroyRing(&queue->ring);
+		queue->ringValid = false;
+	}
+#endif
+
+	// The workers have all exited, so this no longer needs to be locked.
+	AppendRequests(&queue->finished, &queue->workerFinished);
+
+	Request* request = NULL;
+
+	while ( (request = PopRequest(&queue->finished)) != NULL )
+	{
+		CompleteRequest(queue, request);
+	}
+
+	RAYGE_ASSERT(queue->numOutstanding == 0, "Async read queue still had outstanding requests after being destroyed");
+
+	Threading_CondVar_Destroy(&queue->readFinished);
+	Threading_Mutex_Destroy(&queue->lock);
+	MEMPOOL_FREE(queue);
+}
+
+bool AsyncReadQueue_UsesIoUring(const AsyncReadQueue* queue)
+{
+	RAYGE_ASSERT_VALID(queue);
+
+#if HAVE_IO_URING
+	return queue && queue->ringValid;
+#else
+	return false;
+#endif
+}
+
+AsyncReadQueue_RequestID AsyncReadQueue_SubmitFile(
+	AsyncReadQueue* queue,
+	const char* nativePath,
+	AsyncReadQueue_Priority priority,
+	AsyncReadQueue_CompleteFunc completeFunc,
+	void* userData
+)
+{
+	RAYGE_ASSERT_VALID(queue);
+	RAYGE_ASSERT_VALID(nativePath);
+
+	if ( !queue || !nativePath )
+	{
+		return 0;
+	}
+
+	Request* request = CreateRequest(queue, priority, completeFunc, userData);
+	request->nativePath = StringUtils_Duplicate(queue->category, nativePath);
+
+	return SubmitRequest(queue, request);
+}
+
+AsyncReadQueue_RequestID AsyncReadQueue_SubmitArchiveEntry(
+	AsyncReadQueue* queue,
+	const PackArchive* archive,
+	const PackArchive_IndexEntry* entry,
+	AsyncReadQueue_Priority priority,
+	AsyncReadQueue_CompleteFunc completeFunc,
+	void* userData
+)
+{
+	RAYGE_ASSERT_VALID(queue);
+	RAYGE_ASSERT_VALID(archive);
+	RAYGE_ASSERT_VALID(entry);
+
+	if ( !queue || !archive || !entry )
+	{
+		return 0;
+	}
+
+	Request* request = CreateRequest(queue, priority, completeFunc, userData);
+	request->archive = archive;
+	request->archiveEntry = entry;
+
+	return SubmitRequest(queue, request);
+}
+
+bool AsyncReadQueue_Cancel(AsyncReadQueue* queue, AsyncReadQueue_RequestID id)
+{
+	RAYGE_ASSERT_VALID(queue);
+
+	if ( !queue || id == 0 )
+	{
+		return false;
+	}
+
+	Request* request = FindRequest(&queue->finished, id);
+
+#if HAVE_IO_URING
+	for ( size_t index = 0; !request && index < ASYNC_READ_PRIORITY__COUNT; ++index )
+	{
+		request = FindRequest(&queue->ringPending[index], id);
+
+		if ( request )
+		{
+			RemoveRequest(&queue->ringPending[index], request);
+			PushRequest(&queue->finished, request);
+		}
+	}
+
+	// Reads that the kernel already has are left to finish, but their results are discarded.
+	if ( !request )
+	{
+		request = FindRequest(&queue->ringRunning, id);
+	}
+#endif
+
+	if ( request )
+	{
+		request->cancelled = true;
+		return true;
+	}
+
+	Threading_Mutex_Lock(&queue->lock);
+
+	for ( size_t index = 0; !request && index < ASYNC_READ_PRIORITY__COUNT; ++index )
+	{
+		request = FindRequest(&queue->workerPending[index], id);
+
+		if ( request )
+		{
+			RemoveRequest(&queue->workerPending[index], request);
+			PushRequest(&queue->finished, request);
+		}
+	}
+
+	if ( !request )
+	{
+		request = FindRequest(&queue->workerRunning, id);
+	}
+
+	if ( !request )
+	{
+		request = FindRequest(&queue->workerFinished, id);
+	}
+
+	if ( request )
+	{
+		request->cancelled = true;
+	}
+
+	Threading_Mutex_Unlock(&queue->lock);
+
+	return request != NULL;
+}
+
+void AsyncReadQueue_CancelAll(AsyncReadQueue* queue)
+{
+	RAYGE_ASSERT_VALID(queue);
+
+	if ( !queue )
+	{
+		return;
+	}
+
+	MarkCancelled(&queue->finished);
+
+#if HAVE_IO_URING
+	CancelPending(queue, queue->ringPending);
+	MarkCancelled(&queue->ringRunning);
+#endif
+
+	Threading_Mutex_Lock(&queue->lock);
+
+	CancelPending(queue, queue->workerPending);
+	MarkCancelled(&queue->workerRunning);
+	MarkCancelled(&queue->workerFinished);
+
+	// Reads that are already running may be using an archive that is about to be closed.
+	while ( queue->workerRunning.head )
+	{
+		Threading_CondVar_Wait(&queue->readFinished, &queue->lock);
+	}
+
+	Threading_Mutex_Unlock(&queue->lock);
+}
+
+size_t AsyncReadQueue_ProcessCompleted(AsyncReadQueue* queue, uint64_t budgetNs)
+{
+	RAYGE_ASSERT_VALID(queue);
+
+	if ( !queue )
+	{
+		return 0;
+	}
+
+	const uint64_t startNs = Threading_GetTimeNs();
+
+#if HAVE_IO_URING
+	if ( queue->ringValid )
+	{
+		ReapRingCompletions(queue);
+		StartRingRequests(queue);
+	}
+#endif
+
+	Threading_Mutex_Lock(&queue->lock);
+	AppendRequests(&queue->finished, &queue->workerFinished);
+	Threading_Mutex_Unlock(&queue->lock);
+
+	// The pool's jobs have no completion functions, but they still need cleaning up.
+	WorkerPool_ProcessCompleted(queue->workerPool, 0);
+
+	size_t numProcessed = 0;
+
+	do
+	{
+		Request* request = PopRequest(&queue->finished);
+
+		if ( !request )
+		{
+			break;
+		}
+
+		CompleteRequest(queue, request);
+		++numProcessed;
+	}
+	while ( budgetNs == 0 || Threading_GetTimeNs() - startNs < budgetNs );
+
+	return numProcessed;
+}
+
+size_t AsyncReadQueue_NumOutstandingRequests(const AsyncReadQueue* queue)
+{
+	RAYGE_ASSERT_VALID(queue);
+	return queue ? queue->numOutstanding : 0;
+}
+
+#if RAYGE_BUILD_TESTING()
+#define TEST_DIRECTORY "rayge_async_read_queue_test"
+#define TEST_NUM_FILES 16
+#define TEST_LARGE_FILE_SIZE (256 * 1024)
+#define TEST_TIMEOUT_NS (10ull * 1000000000ull)
+
+typedef struct TestRead
+{
+	AsyncReadQueue_Result result;
+	size_t numCalls;
+} TestRead;
+
+static void CompleteTestRead(void* userData, const AsyncReadQueue_Result* result)
+{
+	TestRead* read = (TestRead*)userData;
+
+	read->result = *result;
+	++read->numCalls;
+}
+
+static void GetTestFilePath(size_t index, char* buffer, size_t bufferSize)
+{
+	wzl_sprintf(buffer, bufferSize, TEST_DIRECTORY "/file_%zu.bin", index);
+}
+
+// Files get larger as the index increases, and the last one is empty.
+static size_t GetTestFileSize(size_t index)
+{
+	return index + 1 < TEST_NUM_FILES ? (index * TEST_LARGE_FILE_SIZE) / TEST_NUM_FILES : 0;
+}
+
+static uint8_t GetTestFileByte(size_t fileIndex, size_t byteIndex)
+{
+	return (uint8_t)((fileIndex * 31) + (byteIndex * 7));
+}
+
+static bool WriteTestFiles(void)
+{
+	if ( !NativeFilesystem_CreateDirectories(TEST_DIRECTORY) )
+	{
+		return false;
+	}
+
+	for ( size_t fileIndex = 0; fileIndex < TEST_NUM_FILES; ++fileIndex )
+	{
+		char path[128];
+		GetTestFilePath(fileIndex, path, sizeof(path));
+
+		FILE* file = fopen(path, "wb");
+
+		if ( !file )
+		{
+			return false;
+		}
+
+		for ( size_t byteIndex = 0; byteIndex < GetTestFileSize(fileIndex); ++byteIndex )
+		{
+			fputc(GetTestFileByte(fileIndex, byteIndex), file);
+		}
+
+		fclose(file);
+	}
+
+	return true;
+}
+
+static bool TestFileContentsMatch(size_t fileIndex, const AsyncReadQueue_Result* result)
+{
+	if ( result->size != GetTestFileSize(fileIndex) || (result->size > 0 && !result->data) )
+	{
+		return false;
+	}
+
+	for ( size_t byteIndex = 0; byteIndex < result->size; ++byteIndex )
+	{
+		if ( result->data[byteIndex] != GetTestFileByte(fileIndex, byteIndex) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void WaitForRequests(AsyncReadQueue* queue)
+{
+	const uint64_t startNs = Threading_GetTimeNs();
+
+	while ( AsyncReadQueue_NumOutstandingRequests(queue) > 0 && Threading_GetTimeNs() - startNs < TEST_TIMEOUT_NS )
+	{
+		AsyncReadQueue_ProcessCompleted(queue, 0);
+	}
+}
+
+static void SubmitTestReads(AsyncReadQueue* queue, TestRead* reads, AsyncReadQueue_RequestID* ids)
+{
+	for ( size_t index = 0; index < TEST_NUM_FILES; ++index )
+	{
+		char path[128];
+		GetTestFilePath(index, path, sizeof(path));
+
+		const AsyncReadQueue_Priority priority = (AsyncReadQueue_Priority)(index % ASYNC_READ_PRIORITY__COUNT);
+		ids[index] = AsyncReadQueue_SubmitFile(queue, path, priority, &CompleteTestRead, &reads[index]);
+	}
+}
+
+static void TestReadFiles(bool allowIoUring)
+{
+	AsyncReadQueue* queue = AsyncReadQueue_Create(MEMPOOL_TEST_MANAGER, MEMPOOL_TEST_MANAGER, 2, allowIoUring);
+
+	if ( !TEST_EXPECT_TRUE(queue) )
+	{
+		return;
+	}
+
+	TestRead reads[TEST_NUM_FILES];
+	AsyncReadQueue_RequestID ids[TEST_NUM_FILES];
+	TestRead missingRead;
+
+	memset(reads, 0, sizeof(reads));
+	memset(&missingRead, 0, sizeof(missingRead));
+
+	SubmitTestReads(queue, reads, ids);
+
+	const AsyncReadQueue_RequestID missingID = AsyncReadQueue_SubmitFile(
+		queue,
+		TEST_DIRECTORY "/missing.bin",
+		ASYNC_READ_PRIORITY_NORMAL,
+		&CompleteTestRead,
+		&missingRead
+	);
+
+	TEST_EXPECT_EQL_INT(AsyncReadQueue_NumOutstandingRequests(queue), TEST_NUM_FILES + 1);
+
+	WaitForRequests(queue);
+
+	TEST_EXPECT_EQL_INT(AsyncReadQueue_NumOutstandingRequests(queue), 0);
+	TEST_EXPECT_EQL_INT(missingRead.numCalls, 1);
+	TEST_EXPECT_TRUE(missingRead.result.id == missingID);
+	TEST_EXPECT_EQL_INT(missingRead.result.status, ASYNC_READ_FAILED);
+	TEST_EXPECT_TRUE(missingRead.result.data == NULL);
+
+	size_t failures = 0;
+
+	for ( size_t index = 0; index < TEST_NUM_FILES; ++index )
+	{
+		const TestRead* read = &reads[index];
+
+		if ( read->numCalls != 1 || read->result.id != ids[index] || read->result.status != ASYNC_READ_SUCCEEDED ||
+			 !TestFileContentsMatch(index, &read->result) )
+		{
+			++failures;
+		}
+
+		if ( read->result.data )
+		{
+			MEMPOOL_FREE(read->result.data);
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+
+	// Requests are forgotten once they have completed.
+	TEST_EXPECT_FALSE(AsyncReadQueue_Cancel(queue, ids[0]));
+
+	AsyncReadQueue_Destroy(queue);
+}
+
+static void TestCancelledReadsAreReported(bool allowIoUring)
+{
+	AsyncReadQueue* queue = AsyncReadQueue_Create(MEMPOOL_TEST_MANAGER, MEMPOOL_TEST_MANAGER, 2, allowIoUring);
+
+	if ( !TEST_EXPECT_TRUE(queue) )
+	{
+		return;
+	}
+
+	TestRead reads[TEST_NUM_FILES];
+	AsyncReadQueue_RequestID ids[TEST_NUM_FILES];
+
+	memset(reads, 0, sizeof(reads));
+	SubmitTestReads(queue, reads, ids);
+
+	size_t failures = 0;
+
+	// However far each read has got, cancelling it should always be reported.
+	for ( size_t index = 0; index < TEST_NUM_FILES; ++index )
+	{
+		if ( !AsyncReadQueue_Cancel(queue, ids[index]) )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+	TEST_EXPECT_FALSE(AsyncReadQueue_Cancel(queue, 0));
+
+	WaitForRequests(queue);
+
+	for ( size_t index = 0; index < TEST_NUM_FILES; ++index )
+	{
+		if ( reads[index].numCalls != 1 || reads[index].result.status != ASYNC_READ_CANCELLED ||
+			 reads[index].result.data != NULL )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+
+	// Destroying the queue should cancel everything that is still outstanding.
+	memset(reads, 0, sizeof(reads));
+	SubmitTestReads(queue, reads, ids);
+	AsyncReadQueue_Destroy(queue);
+
+	for ( size_t index = 0; index < TEST_NUM_FILES; ++index )
+	{
+		if ( reads[index].numCalls != 1 || reads[index].result.status != ASYNC_READ_CANCELLED )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+}
+
+void AsyncReadQueue_RunTests(void)
+{
+	TEST_EXPECT_TRUE(WriteTestFiles());
+
+	TestReadFiles(false);
+	TestReadFiles(true);
+	TestCancelledReadsAreReported(false);
+	TestCancelledReadsAreReported(true);
+}
+#endif
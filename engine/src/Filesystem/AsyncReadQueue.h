@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "Filesystem/PackArchive.h"
+#include "MemPool/MemPoolManager.h"
+#include "Testing/Testing.h"
+#include "wzl_cutl/attributes.h"
+
+// A queue of whole-file reads which are serviced in the background. On Linux,
+// reads of files on disk are handed to the kernel through io_uring where it is
+// available, so that no threads are held up waiting on the disk. Otherwise, and
+// for entries in pack archives (which need copying or decompressing rather than
+// waiting on the disk), reads are serviced by a worker pool.
+//
+// Requests with a higher priority are started before requests with a lower
+// priority, but a read which has already started is never interrupted. Once a
+// read has finished, its completion function is called from within
+// AsyncReadQueue_ProcessCompleted(), so that the data can be handed over to
+// systems which are not thread-safe. Apart from this, the queue must only be
+// used from the thread that created it.
+typedef struct AsyncReadQueue AsyncReadQueue;
+
+typedef enum AsyncReadQueue_Priority
+{
+	ASYNC_READ_PRIORITY_LOW = 0,
+	ASYNC_READ_PRIORITY_NORMAL,
+	ASYNC_READ_PRIORITY_HIGH,
+	ASYNC_READ_PRIORITY__COUNT
+} AsyncReadQueue_Priority;
+
+typedef enum AsyncReadQueue_Status
+{
+	ASYNC_READ_SUCCEEDED = 0,
+	ASYNC_READ_FAILED,
+	ASYNC_READ_CANCELLED
+} AsyncReadQueue_Status;
+
+// Zero is never a valid request ID.
+typedef uint64_t AsyncReadQueue_RequestID;
+
+typedef struct AsyncReadQueue_Result
+{
+	AsyncReadQueue_RequestID id;
+	AsyncReadQueue_Status status;
+
+	// Only set if the read succeeded. The data is null if the file was empty.
+	uint8_t* data;
+	size_t size;
+} AsyncReadQueue_Result;
+
+// Called from AsyncReadQueue_ProcessCompleted(). This is always called exactly
+// once per submitted request, whether or not the read succeeded. If it did,
+// the completion function takes ownership of the data, and must free it with
+// MEMPOOL_FREE().
+typedef void (*AsyncReadQueue_CompleteFunc)(void* userData, const AsyncReadQueue_Result* result);
+
+// Request bookkeeping is allocated from the first category, and file data from the second.
+// If io_uring is not allowed or not available, all reads are serviced by the worker pool.
+WZL_ATTR_NODISCARD AsyncReadQueue* AsyncReadQueue_Create(
+	MemPool_Category category,
+	MemPool_Category dataCategory,
+	size_t numThreads,
+	bool allowIoUring
+);
+
+// Cancels all outstanding requests, waits for any reads that are already
+// running to finish, and calls all outstanding completion functions before
+// returning.
+void AsyncReadQueue_Destroy(AsyncReadQueue* queue);
+
+bool AsyncReadQueue_UsesIoUring(const AsyncReadQueue* queue);
+
+// The path is copied. Returns 0 if the request could not be queued,
+// in which case the completion function will not be called.
+AsyncReadQueue_RequestID AsyncReadQueue_SubmitFile(
+	AsyncReadQueue* queue,
+	const char* nativePath,
+	AsyncReadQueue_Priority priority,
+	AsyncReadQueue_CompleteFunc completeFunc,
+	void* userData
+);
+
+// The archive must stay open until the read has finished. AsyncReadQueue_CancelAll()
+// can be used to make sure that no reads are using an archive before it is closed.
+AsyncReadQueue_RequestID AsyncReadQueue_SubmitArchiveEntry(
+	AsyncReadQueue* queue,
+	const PackArchive* archive,
+	const PackArchive_IndexEntry* entry,
+	AsyncReadQueue_Priority priority,
+	AsyncReadQueue_CompleteFunc completeFunc,
+	void* userData
+);
+
+// The completion function is still called, with a status of ASYNC_READ_CANCELLED,
+// the next time completed requests are processed. Returns false if the request
+// was not found, eg. because its completion function had already been called.
+bool AsyncReadQueue_Cancel(AsyncReadQueue* queue, AsyncReadQueue_RequestID id);
+
+// Cancels all outstanding requests, and waits for any reads of pack
+// archives that are already running to finish before returning.
+void AsyncReadQueue_CancelAll(AsyncReadQueue* queue);
+
+// Collects any reads that have finished, starts the highest priority requests
+// that are waiting, and calls completion functions until none are left, or until
+// the given time budget is used up. At least one completion function is always
+// called if any are ready, so that progress is made. A budget of zero means
+// unlimited. Returns the number of completion functions that were called.
+size_t AsyncReadQueue_ProcessCompleted(AsyncReadQueue* queue, uint64_t budgetNs);
+
+// Returns the number of requests which have been submitted
+// but whose completion functions have not yet been called.
+size_t AsyncReadQueue_NumOutstandingRequests(const AsyncReadQueue* queue);
+
+#if RAYGE_BUILD_TESTING()
+void AsyncReadQueue_RunTests(void);
+#endif
@@ -0,0 +1,504 @@
+// For mmap(), and st_mtim on stat results.
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "Filesystem/NativeFilesystem.h"
+#include "EngineSubsystems/FilesystemSubsystem.h"
+#include "RayGE/Platform.h"
+#include "Debugging.h"
+#include "wzl_cutl/math.h"
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#define PATH_SEP_CH '\\'
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define PATH_SEP_CH '/'
+#endif
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+// Difference between the Windows epoch (1601) and the Unix epoch, in 100ns intervals.
+#define WINDOWS_TO_UNIX_EPOCH_TICKS 116444736000000000ll
+#define NANOSECONDS_PER_WINDOWS_TICK 100ll
+#endif
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+static int64_t FileTimeToUnixNs(FILETIME fileTime)
+{
+	const int64_t ticks = (int64_t)(((uint64_t)fileTime.dwHighDateTime << 32) | fileTime.dwLowDateTime);
+	return (ticks - WINDOWS_TO_UNIX_EPOCH_TICKS) * NANOSECONDS_PER_WINDOWS_TICK;
+}
+#else
+static int64_t StatModTimeToNs(const struct stat* info)
+{
+	return ((int64_t)info->st_mtim.tv_sec * 1000000000ll) + (int64_t)info->st_mtim.tv_nsec;
+}
+#endif
+
+static bool IsPathSeparator(char ch)
+{
+	// Windows accepts both kinds of separator.
+	return ch == '/' || ch == PATH_SEP_CH;
+}
+
+static bool CreateSingleDirectory(const char* nativePath)
+{
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	if ( CreateDirectoryA(nativePath, NULL) )
+	{
+		return true;
+	}
+
+	return GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+	if ( mkdir(nativePath, 0755) == 0 )
+	{
+		return true;
+	}
+
+	struct stat info;
+	return errno == EEXIST && stat(nativePath, &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
+
+bool NativeFilesystem_GetFileInfo(const char* nativePath, NativeFilesystem_FileInfo* outInfo)
+{
+	RAYGE_ASSERT_VALID(nativePath);
+	RAYGE_ASSERT_VALID(outInfo);
+
+	if ( !nativePath || !outInfo )
+	{
+		return false;
+	}
+
+	memset(outInfo, 0, sizeof(*outInfo));
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+	if ( !GetFileAttributesExA(nativePath, GetFileExInfoStandard, &attributes) ||
+		 (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) )
+	{
+		return false;
+	}
+
+	outInfo->size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	outInfo->modTimeNs = FileTimeToUnixNs(attributes.ftLastWriteTime);
+#else
+	struct stat info;
+
+	if ( stat(nativePath, &info) != 0 || !S_ISREG(info.st_mode) )
+	{
+		return false;
+	}
+
+	outInfo->size = (uint64_t)info.st_size;
+	outInfo->modTimeNs = StatModTimeToNs(&info);
+#endif
+
+	return true;
+}
+
+bool NativeFilesystem_MapFile(const char* nativePath, NativeFilesystem_MappedFile* outFile)
+{
+	RAYGE_ASSERT_VALID(nativePath);
+	RAYGE_ASSERT_VALID(outFile);
+
+	if ( !nativePath || !outFile )
+	{
+		return false;
+	}
+
+	memset(outFile, 0, sizeof(*outFile));
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	HANDLE file = CreateFileA(
+		nativePath,
+		GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_DELETE,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		NULL
+	);
+
+	if ( file == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	FILETIME modTime;
+
+	if ( !GetFileSizeEx(file, &size) || (uint64_t)size.QuadPart > (uint64_t)SIZE_MAX ||
+		 !GetFileTime(file, NULL, NULL, &modTime) )
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	outFile->modTimeNs = FileTimeToUnixNs(modTime);
+
+	if ( size.QuadPart == 0 )
+	{
+		CloseHandle(file);
+		return true;
+	}
+
+	// The view keeps the file open, so the handles can be closed once it exists.
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+
+	if ( !mapping )
+	{
+		return false;
+	}
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if ( !view )
+	{
+		CloseHandle(mapping);
+		return false;
+	}
+
+	outFile->data = (const uint8_t*)view;
+	outFile->size = (size_t)size.QuadPart;
+	outFile->platformHandle = (void*)mapping;
+#else
+	const int fd = open(nativePath, O_RDONLY);
+
+	if ( fd < 0 )
+	{
+		return false;
+	}
+
+	struct stat info;
+
+	if ( fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) )
+	{
+		close(fd);
+		return false;
+	}
+
+	outFile->modTimeNs = StatModTimeToNs(&info);
+
+	if ( info.st_size == 0 )
+	{
+		close(fd);
+		return true;
+	}
+
+	// The mapping keeps its own reference to the file, so the descriptor can be closed.
+	void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if ( view == MAP_FAILED )
+	{
+		return false;
+	}
+
+	outFile->data = (const uint8_t*)view;
+	outFile->size = (size_t)info.st_size;
+#endif
+
+	return true;
+}
+
+void NativeFilesystem_UnmapFile(NativeFilesystem_MappedFile* file)
+{
+	if ( !file )
+	{
+		return;
+	}
+
+	if ( file->data )
+	{
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+		UnmapViewOfFile(file->data);
+		CloseHandle((HANDLE)file->platformHandle);
+#else
+		munmap((void*)file->data, file->size);
+#endif
+	}
+
+	memset(file, 0, sizeof(*file));
+}
+
+bool NativeFilesystem_ReadFile(const char* nativePath, MemPool_Category category, uint8_t** outData, size_t* outSize)
+{
+	RAYGE_ASSERT_VALID(nativePath);
+	RAYGE_ASSERT_VALID(outData);
+	RAYGE_ASSERT_VALID(outSize);
+
+	if ( !nativePath || !outData || !outSize )
+	{
+		return false;
+	}
+
+	*outData = NULL;
+	*outSize = 0;
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	HANDLE file = CreateFileA(
+		nativePath,
+		GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_DELETE,
+		NULL,
+		OPEN_EXISTING,
+		FILE_FLAG_SEQUENTIAL_SCAN,
+		NULL
+	);
+
+	if ( file == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if ( !GetFileSizeEx(file, &fileSize) || (uint64_t)fileSize.QuadPart > (uint64_t)SIZE_MAX )
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const size_t size = (size_t)fileSize.QuadPart;
+#else
+	const int fd = open(nativePath, O_RDONLY);
+
+	if ( fd < 0 )
+	{
+		return false;
+	}
+
+	struct stat info;
+
+	if ( fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || (uint64_t)info.st_size > (uint64_t)SIZE_MAX )
+	{
+		close(fd);
+		return false;
+	}
+
+	const size_t size = (size_t)info.st_size;
+#endif
+
+	uint8_t* data = size > 0 ? (uint8_t*)MEMPOOL_MALLOC(category, size) : NULL;
+	size_t bytesRead = 0;
+
+	// Reads are limited to a chunk at a time, since the OS calls take smaller
+	// size types than size_t. They may also return fewer bytes than were asked
+	// for, in which case we just keep going.
+	while ( bytesRead < size )
+	{
+		const size_t chunkSize = WZL_MIN(size - bytesRead, (size_t)0x40000000);
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+		DWORD chunkRead = 0;
+
+		if ( !ReadFile(file, data + bytesRead, (DWORD)chunkSize, &chunkRead, NULL) || chunkRead == 0 )
+		{
+			break;
+		}
+#else
+		const ssize_t chunkRead = read(fd, data + bytesRead, chunkSize);
+
+		if ( chunkRead < 0 && errno == EINTR )
+		{
+			continue;
+		}
+
+		if ( chunkRead <= 0 )
+		{
+			break;
+		}
+#endif
+
+		bytesRead += (size_t)chunkRead;
+	}
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	CloseHandle(file);
+#else
+	close(fd);
+#endif
+
+	// If the file was truncated while we were reading it, treat this as a failure,
+	// since the caller would otherwise get a mixture of old and new contents.
+	if ( bytesRead < size )
+	{
+		MEMPOOL_FREE(data);
+		return false;
+	}
+
+	*outData = data;
+	*outSize = size;
+	return true;
+}
+
+bool NativeFilesystem_CreateDirectories(const char* nativePath)
+{
+	RAYGE_ASSERT_VALID(nativePath);
+
+	if ( !nativePath || !(*nativePath) )
+	{
+		return false;
+	}
+
+	FilesystemSubsystem_LongPath path;
+	const size_t length = strlen(nativePath);
+
+	if ( length >= sizeof(path) )
+	{
+		return false;
+	}
+
+	memcpy(path, nativePath, length + 1);
+
+	// Create each parent in turn, by temporarily terminating the path after it.
+	// The first character is skipped, since it may be the root separator.
+	for ( size_t index = 1; index < length; ++index )
+	{
+		if ( !IsPathSeparator(path[index]) || IsPathSeparator(path[index - 1]) )
+		{
+			continue;
+		}
+
+		const char separator = path[index];
+		path[index] = '\0';
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+		// Skip drive specifiers like "C:".
+		const bool isDrive = index == 2 && path[1] == ':';
+#else
+		const bool isDrive = false;
+#endif
+
+		if ( !isDrive && !CreateSingleDirectory(path) )
+		{
+			return false;
+		}
+
+		path[index] = separator;
+	}
+
+	return CreateSingleDirectory(path);
+}
+
+bool NativeFilesystem_ReplaceFile(const char* sourcePath, const char* destPath)
+{
+	RAYGE_ASSERT_VALID(sourcePath);
+	RAYGE_ASSERT_VALID(destPath);
+
+	if ( !sourcePath || !destPath )
+	{
+		return false;
+	}
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	return MoveFileExA(sourcePath, destPath, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(sourcePath, destPath) == 0;
+#endif
+}
+
+bool NativeFilesystem_DeleteFile(const char* nativePath)
+{
+	RAYGE_ASSERT_VALID(nativePath);
+	return nativePath && remove(nativePath) == 0;
+}
+
+#if RAYGE_BUILD_TESTING()
+#define TEST_DIRECTORY "rayge_native_filesystem_test"
+#define TEST_FILE_PATH TEST_DIRECTORY "/nested/file.bin"
+#define TEST_TEMP_PATH TEST_DIRECTORY "/nested/file.bin.tmp"
+
+static bool WriteTestFile(const char* path, const char* contents)
+{
+	FILE* file = fopen(path, "wb");
+
+	if ( !file )
+	{
+		return false;
+	}
+
+	const size_t length = strlen(contents);
+	const bool success = fwrite(contents, 1, length, file) == length;
+
+	fclose(file);
+	return success;
+}
+
+static void TestMapFile(void)
+{
+	TEST_EXPECT_TRUE(NativeFilesystem_CreateDirectories(TEST_DIRECTORY "/nested"));
+
+	// Creating directories that already exist should succeed.
+	TEST_EXPECT_TRUE(NativeFilesystem_CreateDirectories(TEST_DIRECTORY "/nested"));
+
+	TEST_EXPECT_TRUE(WriteTestFile(TEST_FILE_PATH, "First contents"));
+
+	NativeFilesystem_FileInfo info;
+	TEST_EXPECT_TRUE(NativeFilesystem_GetFileInfo(TEST_FILE_PATH, &info));
+	TEST_EXPECT_EQL_INT(info.size, strlen("First contents"));
+	TEST_EXPECT_TRUE(info.modTimeNs > 0);
+
+	uint8_t* data = NULL;
+	size_t size = 0;
+
+	TEST_EXPECT_TRUE(NativeFilesystem_ReadFile(TEST_FILE_PATH, MEMPOOL_TEST_MANAGER, &data, &size));
+	TEST_EXPECT_EQL_INT(size, strlen("First contents"));
+	TEST_EXPECT_TRUE(data && memcmp(data, "First contents", size) == 0);
+	MEMPOOL_FREE(data);
+
+	TEST_EXPECT_FALSE(NativeFilesystem_ReadFile(TEST_DIRECTORY "/missing.bin", MEMPOOL_TEST_MANAGER, &data, &size));
+	TEST_EXPECT_TRUE(data == NULL);
+
+	// Directories are not files.
+	TEST_EXPECT_FALSE(NativeFilesystem_GetFileInfo(TEST_DIRECTORY, &info));
+
+	NativeFilesystem_MappedFile mapped;
+	TEST_EXPECT_TRUE(NativeFilesystem_MapFile(TEST_FILE_PATH, &mapped));
+	TEST_EXPECT_EQL_INT(mapped.size, strlen("First contents"));
+	TEST_EXPECT_TRUE(mapped.data && memcmp(mapped.data, "First contents", mapped.size) == 0);
+	TEST_EXPECT_TRUE(NativeFilesystem_GetFileInfo(TEST_FILE_PATH, &info));
+	TEST_EXPECT_TRUE(mapped.modTimeNs == info.modTimeNs);
+
+	// Replacing the file should not affect the existing mapping.
+	TEST_EXPECT_TRUE(WriteTestFile(TEST_TEMP_PATH, "Second"));
+	TEST_EXPECT_TRUE(NativeFilesystem_ReplaceFile(TEST_TEMP_PATH, TEST_FILE_PATH));
+	TEST_EXPECT_TRUE(mapped.data && memcmp(mapped.data, "First contents", mapped.size) == 0);
+
+	NativeFilesystem_UnmapFile(&mapped);
+	TEST_EXPECT_TRUE(mapped.data == NULL);
+
+	TEST_EXPECT_TRUE(NativeFilesystem_MapFile(TEST_FILE_PATH, &mapped));
+	TEST_EXPECT_EQL_INT(mapped.size, strlen("Second"));
+	NativeFilesystem_UnmapFile(&mapped);
+
+	TEST_EXPECT_TRUE(WriteTestFile(TEST_FILE_PATH, ""));
+	TEST_EXPECT_TRUE(NativeFilesystem_MapFile(TEST_FILE_PATH, &mapped));
+	TEST_EXPECT_TRUE(mapped.data == NULL);
+	TEST_EXPECT_EQL_INT(mapped.size, 0);
+	NativeFilesystem_UnmapFile(&mapped);
+
+	TEST_EXPECT_TRUE(NativeFilesystem_DeleteFile(TEST_FILE_PATH));
+	TEST_EXPECT_FALSE(NativeFilesystem_MapFile(TEST_FILE_PATH, &mapped));
+
+	NativeFilesystem_DeleteFile(TEST_DIRECTORY "/nested");
+	NativeFilesystem_DeleteFile(TEST_DIRECTORY);
+}
+
+void NativeFilesystem_RunTests(void)
+{
+	TestMapFile();
+}
+#endif
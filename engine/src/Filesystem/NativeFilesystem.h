@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "MemPool/MemPoolManager.h"
+#include "Testing/Testing.h"
+
+// Thin wrappers over the operating system's file functions. These take native
+// paths, which are not resolved against the game's base directory, and unlike
+// the filesystem subsystem they may be called from any thread.
+
+typedef struct NativeFilesystem_FileInfo
+{
+	uint64_t size;
+
+	// Last modification time, in nanoseconds since the Unix epoch.
+	// The actual precision depends on the filesystem.
+	int64_t modTimeNs;
+} NativeFilesystem_FileInfo;
+
+// A read-only view of a whole file. The members should be treated as read-only.
+typedef struct NativeFilesystem_MappedFile
+{
+	const uint8_t* data;
+	size_t size;
+
+	// As with NativeFilesystem_FileInfo, taken when the file was mapped.
+	int64_t modTimeNs;
+
+	// Windows needs the file mapping object to be kept until the view is unmapped.
+	void* platformHandle;
+} NativeFilesystem_MappedFile;
+
+bool NativeFilesystem_GetFileInfo(const char* nativePath, NativeFilesystem_FileInfo* outInfo);
+
+// Returns false if the file could not be mapped. An empty file is mapped
+// successfully, but its data pointer will be null.
+bool NativeFilesystem_MapFile(const char* nativePath, NativeFilesystem_MappedFile* outFile);
+void NativeFilesystem_UnmapFile(NativeFilesystem_MappedFile* file);
+
+// Reads the whole file into memory allocated from the given category, which the
+// caller must free with MEMPOOL_FREE(). An empty file is read successfully, but
+// its data pointer will be null.
+bool NativeFilesystem_ReadFile(const char* nativePath, MemPool_Category category, uint8_t** outData, size_t* outSize);
+
+// Creates the directory and any of its parents that do not exist.
+// Returns true if the directory exists afterwards.
+bool NativeFilesystem_CreateDirectories(const char* nativePath);
+
+// Renames the source file to the destination, replacing the destination if
+// it already exists. Writing to a temporary file and then replacing the real
+// one means readers never see a partially written file.
+bool NativeFilesystem_ReplaceFile(const char* sourcePath, const char* destPath);
+
+bool NativeFilesystem_DeleteFile(const char* nativePath);
+
+#if RAYGE_BUILD_TESTING()
+void NativeFilesystem_RunTests(void);
+#endif
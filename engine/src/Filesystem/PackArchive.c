@@ -0,0 +1,531 @@
+#include <string.h>
+#include "Filesystem/PackArchive.h"
+#include "Filesystem/NativeFilesystem.h"
+#include "Logging/Logging.h"
+#include "MemPool/MemPoolManager.h"
+#include "Utils/LZ4Utils.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Utils.h"
+#include "Debugging.h"
+
+struct PackArchive
+{
+	char* nativePath;
+	NativeFilesystem_MappedFile file;
+	const PackArchive_FileHeader* header;
+	const PackArchive_IndexEntry* entries;
+	const char* paths;
+};
+
+static int ComparePaths(const char* lhs, size_t lhsLength, const char* rhs, size_t rhsLength)
+{
+	const int result = memcmp(lhs, rhs, lhsLength < rhsLength ? lhsLength : rhsLength);
+
+	if ( result != 0 )
+	{
+		return result;
+	}
+
+	return lhsLength < rhsLength ? -1 : (lhsLength > rhsLength ? 1 : 0);
+}
+
+static int CompareEntryToKey(
+	const PackArchive* archive,
+	const PackArchive_IndexEntry* entry,
+	uint64_t pathHash,
+	const char* path,
+	size_t pathLength
+)
+{
+	if ( entry->pathHash != pathHash )
+	{
+		return entry->pathHash < pathHash ? -1 : 1;
+	}
+
+	return ComparePaths(archive->paths + entry->pathOffset, entry->pathLength, path, pathLength);
+}
+
+// Returns a description of the problem, or null if the entry is valid.
+static const char* ValidateEntry(const PackArchive* archive, size_t index)
+{
+	const PackArchive_IndexEntry* entry = &archive->entries[index];
+	const uint64_t fileSize = archive->file.size;
+
+	if ( (uint64_t)entry->pathOffset + entry->pathLength > archive->header->pathsSize )
+	{
+		return "entry path was out of range";
+	}
+
+	if ( entry->dataOffset % PACK_ARCHIVE_ALIGNMENT != 0 )
+	{
+		return "entry data was not aligned";
+	}
+
+	if ( entry->dataOffset > fileSize || entry->storedSize > fileSize - entry->dataOffset )
+	{
+		return "entry data was out of range";
+	}
+
+	if ( entry->size > SIZE_MAX )
+	{
+		return "entry was too large";
+	}
+
+	switch ( entry->compression )
+	{
+		case PACK_ARCHIVE_COMPRESSION_NONE:
+		{
+			if ( entry->storedSize != entry->size )
+			{
+				return "uncompressed entry sizes did not match";
+			}
+
+			break;
+		}
+
+		case PACK_ARCHIVE_COMPRESSION_LZ4:
+		{
+			break;
+		}
+
+		default:
+		{
+			return "entry compression type was not recognised";
+		}
+	}
+
+	const char* path = archive->paths + entry->pathOffset;
+
+	if ( entry->pathHash != PackArchive_HashPath(path, entry->pathLength) )
+	{
+		return "entry path hash did not match";
+	}
+
+	if ( index > 0 )
+	{
+		const PackArchive_IndexEntry* previous = &archive->entries[index - 1];
+
+		// Sorted order must be strict, or binary searches might find the wrong entry.
+		if ( CompareEntryToKey(archive, previous, entry->pathHash, path, entry->pathLength) >= 0 )
+		{
+			return "entries were not sorted, or were duplicated";
+		}
+	}
+
+	return NULL;
+}
+
+// Returns a description of the problem, or null if the archive is valid.
+static const char* ValidateArchive(PackArchive* archive)
+{
+	const uint64_t fileSize = archive->file.size;
+
+	if ( !archive->file.data || fileSize < sizeof(PackArchive_FileHeader) )
+	{
+		return "file was too small";
+	}
+
+	const PackArchive_FileHeader* header = (const PackArchive_FileHeader*)archive->file.data;
+
+	if ( memcmp(header->magic, PACK_ARCHIVE_MAGIC, sizeof(header->magic)) != 0 )
+	{
+		return "file was not a pack archive";
+	}
+
+	if ( header->version != PACK_ARCHIVE_VERSION )
+	{
+		return "archive version is not supported";
+	}
+
+	if ( header->indexOffset % PACK_ARCHIVE_ALIGNMENT != 0 || header->indexOffset > fileSize ||
+		 (uint64_t)header->numEntries > (fileSize - header->indexOffset) / sizeof(PackArchive_IndexEntry) )
+	{
+		return "index was out of range";
+	}
+
+	if ( header->pathsOffset > fileSize || header->pathsSize > fileSize - header->pathsOffset ||
+		 header->pathsSize > UINT32_MAX )
+	{
+		return "path table was out of range";
+	}
+
+	archive->header = header;
+	archive->entries = (const PackArchive_IndexEntry*)(archive->file.data + header->indexOffset);
+	archive->paths = (const char*)(archive->file.data + header->pathsOffset);
+
+	for ( size_t index = 0; index < header->numEntries; ++index )
+	{
+		const char* problem = ValidateEntry(archive, index);
+
+		if ( problem )
+		{
+			return problem;
+		}
+	}
+
+	return NULL;
+}
+
+PackArchive* PackArchive_Open(const char* nativePath)
+{
+	RAYGE_ASSERT_VALID(nativePath);
+
+	if ( !nativePath )
+	{
+		return NULL;
+	}
+
+	PackArchive* archive = MEMPOOL_CALLOC_STRUCT(MEMPOOL_FILESYSTEM, PackArchive);
+
+	if ( !NativeFilesystem_MapFile(nativePath, &archive->file) )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Could not open pack archive %s", nativePath);
+		MEMPOOL_FREE(archive);
+		return NULL;
+	}
+
+	const char* problem = ValidateArchive(archive);
+
+	if ( problem )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Could not open pack archive %s: %s", nativePath, problem);
+		NativeFilesystem_UnmapFile(&archive->file);
+		MEMPOOL_FREE(archive);
+		return NULL;
+	}
+
+	archive->nativePath = StringUtils_Duplicate(MEMPOOL_FILESYSTEM, nativePath);
+	return archive;
+}
+
+void PackArchive_Close(PackArchive* archive)
+{
+	if ( !archive )
+	{
+		return;
+	}
+
+	NativeFilesystem_UnmapFile(&archive->file);
+	MEMPOOL_FREE(archive->nativePath);
+	MEMPOOL_FREE(archive);
+}
+
+const char* PackArchive_GetNativePath(const PackArchive* archive)
+{
+	RAYGE_ASSERT_VALID(archive);
+	return archive ? archive->nativePath : NULL;
+}
+
+size_t PackArchive_NumEntries(const PackArchive* archive)
+{
+	RAYGE_ASSERT_VALID(archive);
+	return archive ? archive->header->numEntries : 0;
+}
+
+int64_t PackArchive_GetModTimeNs(const PackArchive* archive)
+{
+	RAYGE_ASSERT_VALID(archive);
+	return archive ? archive->file.modTimeNs : 0;
+}
+
+const PackArchive_IndexEntry* PackArchive_FindEntry(const PackArchive* archive, const char* path, size_t pathLength)
+{
+	RAYGE_ASSERT_VALID(archive);
+	RAYGE_ASSERT_VALID(path);
+
+	if ( !archive || !path )
+	{
+		return NULL;
+	}
+
+	const uint64_t pathHash = PackArchive_HashPath(path, pathLength);
+	size_t begin = 0;
+	size_t end = archive->header->numEntries;
+
+	while ( begin < end )
+	{
+		const size_t middle = begin + ((end - begin) / 2);
+		const PackArchive_IndexEntry* entry = &archive->entries[middle];
+		const int result = CompareEntryToKey(archive, entry, pathHash, path, pathLength);
+
+		if ( result == 0 )
+		{
+			return entry;
+		}
+
+		if ( result < 0 )
+		{
+			begin = middle + 1;
+		}
+		else
+		{
+			end = middle;
+		}
+	}
+
+	return NULL;
+}
+
+const uint8_t* PackArchive_GetEntryView(const PackArchive* archive, const PackArchive_IndexEntry* entry)
+{
+	RAYGE_ASSERT_VALID(archive);
+	RAYGE_ASSERT_VALID(entry);
+
+	if ( !archive || !entry || entry->compression != PACK_ARCHIVE_COMPRESSION_NONE )
+	{
+		return NULL;
+	}
+
+	return archive->file.data + entry->dataOffset;
+}
+
+bool PackArchive_ReadEntry(const PackArchive* archive, const PackArchive_IndexEntry* entry, uint8_t* outBuffer)
+{
+	RAYGE_ASSERT_VALID(archive);
+	RAYGE_ASSERT_VALID(entry);
+	RAYGE_ASSERT_VALID(outBuffer || entry->size == 0);
+
+	if ( !archive || !entry || (!outBuffer && entry->size > 0) )
+	{
+		return false;
+	}
+
+	const uint8_t* storedData = archive->file.data + entry->dataOffset;
+
+	if ( entry->compression == PACK_ARCHIVE_COMPRESSION_LZ4 )
+	{
+		return LZ4Utils_Decompress(storedData, (size_t)entry->storedSize, outBuffer, (size_t)entry->size);
+	}
+
+	if ( entry->size > 0 )
+	{
+		memcpy(outBuffer, storedData, (size_t)entry->size);
+	}
+
+	return true;
+}
+
+#if RAYGE_BUILD_TESTING()
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_DIRECTORY "rayge_pack_archive_test"
+#define TEST_ARCHIVE_PATH TEST_DIRECTORY "/test" PACK_ARCHIVE_FILE_EXTENSION
+
+typedef struct TestFile
+{
+	const char* path;
+	const char* contents;
+	bool compress;
+} TestFile;
+
+static const TestFile TEST_FILES[] = {
+	{"textures/wall.png", "Stored wall texture data", false},
+	{"scripts/readme.txt", "Compressed text compressed text compressed text compressed text", true},
+	{"empty.bin", "", false},
+};
+
+static int CompareTestEntries(const void* lhs, const void* rhs)
+{
+	const PackArchive_IndexEntry* a = (const PackArchive_IndexEntry*)lhs;
+	const PackArchive_IndexEntry* b = (const PackArchive_IndexEntry*)rhs;
+
+	if ( a->pathHash != b->pathHash )
+	{
+		return a->pathHash < b->pathHash ? -1 : 1;
+	}
+
+	// Only the test files' paths are compared, which all have different hashes.
+	return 0;
+}
+
+static void WritePadding(FILE* file)
+{
+	static const uint8_t zeroes[PACK_ARCHIVE_ALIGNMENT] = {0};
+	const long position = ftell(file);
+	const uint64_t aligned = PackArchive_AlignOffset((uint64_t)position);
+
+	fwrite(zeroes, 1, (size_t)(aligned - (uint64_t)position), file);
+}
+
+// A minimal version of what the pack-archive tool writes.
+static bool WriteTestArchive(const char* path)
+{
+	FILE* file = fopen(path, "wb");
+
+	if ( !file )
+	{
+		return false;
+	}
+
+	PackArchive_FileHeader header;
+	PackArchive_IndexEntry entries[RAYGE_ARRAY_SIZE(TEST_FILES)];
+	uint32_t pathOffset = 0;
+
+	memset(&header, 0, sizeof(header));
+	memset(entries, 0, sizeof(entries));
+	fwrite(&header, sizeof(header), 1, file);
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(TEST_FILES); ++index )
+	{
+		const TestFile* testFile = &TEST_FILES[index];
+		PackArchive_IndexEntry* entry = &entries[index];
+		const size_t size = strlen(testFile->contents);
+
+		uint8_t compressed[256];
+		size_t storedSize = size;
+
+		if ( testFile->compress )
+		{
+			storedSize = LZ4Utils_Compress(testFile->contents, size, compressed, sizeof(compressed));
+		}
+
+		WritePadding(file);
+
+		entry->pathHash = PackArchive_HashPath(testFile->path, strlen(testFile->path));
+		entry->dataOffset = (uint64_t)ftell(file);
+		entry->storedSize = storedSize;
+		entry->size = size;
+		entry->pathOffset = pathOffset;
+		entry->pathLength = (uint32_t)strlen(testFile->path);
+		entry->compression = testFile->compress ? PACK_ARCHIVE_COMPRESSION_LZ4 : PACK_ARCHIVE_COMPRESSION_NONE;
+
+		fwrite(testFile->compress ? (const void*)compressed : (const void*)testFile->contents, 1, storedSize, file);
+		pathOffset += entry->pathLength;
+	}
+
+	qsort(entries, RAYGE_ARRAY_SIZE(entries), sizeof(entries[0]), &CompareTestEntries);
+
+	WritePadding(file);
+	header.indexOffset = (uint64_t)ftell(file);
+	fwrite(entries, sizeof(entries[0]), RAYGE_ARRAY_SIZE(entries), file);
+
+	header.pathsOffset = (uint64_t)ftell(file);
+	header.pathsSize = pathOffset;
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(TEST_FILES); ++index )
+	{
+		fwrite(TEST_FILES[index].path, 1, strlen(TEST_FILES[index].path), file);
+	}
+
+	memcpy(header.magic, PACK_ARCHIVE_MAGIC, sizeof(header.magic));
+	header.version = PACK_ARCHIVE_VERSION;
+	header.numEntries = (uint32_t)RAYGE_ARRAY_SIZE(entries);
+
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, file);
+
+	return fclose(file) == 0;
+}
+
+static void TestReadEntries(void)
+{
+	PackArchive* archive = PackArchive_Open(TEST_ARCHIVE_PATH);
+
+	if ( !TEST_EXPECT_TRUE(archive) )
+	{
+		return;
+	}
+
+	TEST_EXPECT_EQL_INT(PackArchive_NumEntries(archive), RAYGE_ARRAY_SIZE(TEST_FILES));
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(TEST_FILES); ++index )
+	{
+		const TestFile* testFile = &TEST_FILES[index];
+		const size_t size = strlen(testFile->contents);
+		const PackArchive_IndexEntry* entry = PackArchive_FindEntry(archive, testFile->path, strlen(testFile->path));
+
+		if ( !TEST_EXPECT_TRUE(entry) )
+		{
+			continue;
+		}
+
+		TEST_EXPECT_EQL_INT(entry->size, size);
+		TEST_EXPECT_EQL_INT(entry->dataOffset % PACK_ARCHIVE_ALIGNMENT, 0);
+
+		const uint8_t* view = PackArchive_GetEntryView(archive, entry);
+
+		if ( testFile->compress )
+		{
+			TEST_EXPECT_TRUE(view == NULL);
+		}
+		else
+		{
+			TEST_EXPECT_TRUE(view && memcmp(view, testFile->contents, size) == 0);
+		}
+
+		uint8_t buffer[256];
+		TEST_EXPECT_TRUE(PackArchive_ReadEntry(archive, entry, buffer));
+		TEST_EXPECT_TRUE(memcmp(buffer, testFile->contents, size) == 0);
+	}
+
+	TEST_EXPECT_TRUE(PackArchive_FindEntry(archive, "textures/missing.png", strlen("textures/missing.png")) == NULL);
+
+	// Lengths are respected, rather than relying on null terminators.
+	TEST_EXPECT_TRUE(PackArchive_FindEntry(archive, "empty.bin.extra", strlen("empty.bin")) != NULL);
+
+	PackArchive_Close(archive);
+}
+
+static void TestInvalidArchivesAreRejected(void)
+{
+	NativeFilesystem_MappedFile original;
+	TEST_EXPECT_TRUE(NativeFilesystem_MapFile(TEST_ARCHIVE_PATH, &original));
+
+	if ( !original.data )
+	{
+		return;
+	}
+
+	uint8_t* contents = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_TEST_MANAGER, original.size);
+	const size_t size = original.size;
+
+	memcpy(contents, original.data, size);
+	NativeFilesystem_UnmapFile(&original);
+
+	const char* corruptPath = TEST_DIRECTORY "/corrupt" PACK_ARCHIVE_FILE_EXTENSION;
+	FILE* file = NULL;
+
+	// Truncated, so that the path table runs past the end of the file.
+	file = fopen(corruptPath, "wb");
+	fwrite(contents, 1, size - 1, file);
+	fclose(file);
+	TEST_EXPECT_TRUE(PackArchive_Open(corruptPath) == NULL);
+
+	// Wrong magic.
+	contents[0] = 'X';
+	file = fopen(corruptPath, "wb");
+	fwrite(contents, 1, size, file);
+	fclose(file);
+	TEST_EXPECT_TRUE(PackArchive_Open(corruptPath) == NULL);
+	contents[0] = PACK_ARCHIVE_MAGIC[0];
+
+	// Entry data which is not aligned.
+	PackArchive_FileHeader header;
+	PackArchive_IndexEntry entry;
+	memcpy(&header, contents, sizeof(header));
+	memcpy(&entry, contents + header.indexOffset, sizeof(entry));
+	entry.dataOffset += 1;
+	memcpy(contents + header.indexOffset, &entry, sizeof(entry));
+
+	file = fopen(corruptPath, "wb");
+	fwrite(contents, 1, size, file);
+	fclose(file);
+	TEST_EXPECT_TRUE(PackArchive_Open(corruptPath) == NULL);
+
+	NativeFilesystem_DeleteFile(corruptPath);
+	MEMPOOL_FREE(contents);
+}
+
+void PackArchive_RunTests(void)
+{
+	TEST_EXPECT_TRUE(NativeFilesystem_CreateDirectories(TEST_DIRECTORY));
+	TEST_EXPECT_TRUE(WriteTestArchive(TEST_ARCHIVE_PATH));
+
+	TestReadEntries();
+	TestInvalidArchivesAreRejected();
+
+	NativeFilesystem_DeleteFile(TEST_ARCHIVE_PATH);
+	NativeFilesystem_DeleteFile(TEST_DIRECTORY);
+}
+#endif
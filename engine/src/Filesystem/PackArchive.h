@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "Filesystem/PackArchiveFormat.h"
+#include "Testing/Testing.h"
+
+// A pack archive (see Filesystem/PackArchiveFormat.h) which has been memory mapped.
+// The whole archive is validated when it is opened, so that looking up and reading
+// its entries afterwards never needs to check the archive's structure again.
+// Once opened, an archive is read-only, so may be read from any thread.
+typedef struct PackArchive PackArchive;
+
+// Returns null if the archive could not be opened or was invalid. The reason is logged.
+PackArchive* PackArchive_Open(const char* nativePath);
+void PackArchive_Close(PackArchive* archive);
+
+const char* PackArchive_GetNativePath(const PackArchive* archive);
+size_t PackArchive_NumEntries(const PackArchive* archive);
+
+// Modification time of the archive file, in nanoseconds since the Unix epoch.
+int64_t PackArchive_GetModTimeNs(const PackArchive* archive);
+
+// The path must be in the form stored in the archive: relative, using forward
+// slashes, and without any "." or ".." components. Returns null if not found.
+const PackArchive_IndexEntry* PackArchive_FindEntry(const PackArchive* archive, const char* path, size_t pathLength);
+
+// If the entry's data is stored uncompressed, returns a pointer to it within the
+// mapped archive, which is valid until the archive is closed. Otherwise, returns null.
+const uint8_t* PackArchive_GetEntryView(const PackArchive* archive, const PackArchive_IndexEntry* entry);
+
+// Copies the entry's data into the buffer, decompressing it if required.
+// The buffer must be at least entry->size bytes.
+bool PackArchive_ReadEntry(const PackArchive* archive, const PackArchive_IndexEntry* entry, uint8_t* outBuffer);
+
+#if RAYGE_BUILD_TESTING()
+void PackArchive_RunTests(void);
+#endif
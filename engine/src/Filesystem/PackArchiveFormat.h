@@ -0,0 +1,76 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "Utils/HashUtils.h"
+
+// Binary format for pack archives. This is shared between the engine,
+// which reads archives, and the pack-archive tool, which writes them.
+//
+// An archive begins with a file header. The data for each file follows,
+// then the index, then the path table. The index and every file's data
+// begin on a PACK_ARCHIVE_ALIGNMENT boundary, so that they stay aligned
+// when the archive is memory mapped, and each index entry is exactly
+// PACK_ARCHIVE_ALIGNMENT bytes.
+//
+// Index entries are sorted by path hash, and then by path, so that files
+// can be found with a binary search. Paths in the path table are not null
+// terminated. They are relative to the directory that was packed, and use
+// forward slashes.
+//
+// File data is either stored as-is, or as a single LZ4 block (see
+// Utils/LZ4Utils.h). Only stored data can be read without a copy.
+
+#define PACK_ARCHIVE_MAGIC "RGPK"
+#define PACK_ARCHIVE_VERSION 1
+#define PACK_ARCHIVE_ALIGNMENT 64
+#define PACK_ARCHIVE_FILE_EXTENSION ".rgpak"
+
+typedef enum PackArchive_Compression
+{
+	PACK_ARCHIVE_COMPRESSION_NONE = 0,
+	PACK_ARCHIVE_COMPRESSION_LZ4,
+} PackArchive_Compression;
+
+// All fields are little-endian.
+typedef struct PackArchive_FileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t numEntries;
+	uint32_t reserved0;
+	uint64_t indexOffset;
+	uint64_t pathsOffset;
+	uint64_t pathsSize;
+	uint8_t reserved[24];
+} PackArchive_FileHeader;
+
+typedef struct PackArchive_IndexEntry
+{
+	uint64_t pathHash;
+	uint64_t dataOffset;
+
+	// Size of the data in the archive, and once decompressed.
+	// These are the same if the data is not compressed.
+	uint64_t storedSize;
+	uint64_t size;
+
+	uint32_t pathOffset;
+	uint32_t pathLength;
+	uint32_t compression;
+	uint8_t reserved[20];
+} PackArchive_IndexEntry;
+
+static_assert(sizeof(PackArchive_FileHeader) == PACK_ARCHIVE_ALIGNMENT, "Unexpected pack archive header size");
+static_assert(sizeof(PackArchive_IndexEntry) == PACK_ARCHIVE_ALIGNMENT, "Unexpected pack archive entry size");
+
+static inline uint64_t PackArchive_HashPath(const char* path, size_t length)
+{
+	return HashUtils_Hash64(path, length, PACK_ARCHIVE_VERSION);
+}
+
+static inline uint64_t PackArchive_AlignOffset(uint64_t offset)
+{
+	return (offset + (PACK_ARCHIVE_ALIGNMENT - 1)) & ~(uint64_t)(PACK_ARCHIVE_ALIGNMENT - 1);
+}
@@ -24,16 +24,17 @@ static bool g_IsLoaded = false;
 
 static cJSON* ParseJSONFromFile(const char* path)
 {
-	size_t size = 0;
-	uint8_t* fileData = FilesystemSubsystem_LoadFileData(path, &size);
+	FilesystemSubsystem_MappedFile file;
 
-	if ( !fileData )
+	if ( !FilesystemSubsystem_MapFile(path, &file) || !file.data )
 	{
 		Logging_PrintLine(RAYGE_LOG_ERROR, "Could not load game JSON from %s", path);
+		FilesystemSubsystem_UnmapFile(&file);
 		return NULL;
 	}
 
-	cJSON* out = cJSON_ParseWithLength((const char*)fileData, size);
+	// cJSON respects the length, so the data does not need to be null terminated.
+	cJSON* out = cJSON_ParseWithLength((const char*)file.data, file.size);
 
 	if ( !out )
 	{
@@ -45,11 +46,11 @@ static cJSON* ParseJSONFromFile(const char* path)
 			RAYGE_LOG_ERROR,
 			"Failed to parse %s. Parse failed at character %zu",
 			path,
-			errorPtr - (const char*)fileData
+			errorPtr - (const char*)file.data
 		);
 	}
 
-	FilesystemSubsystem_UnloadFileData(fileData);
+	FilesystemSubsystem_UnmapFile(&file);
 	return out;
 }
 
@@ -1,6 +1,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "Hooks/HookManager.h"
+#include "Hooks/MemPoolHooks.h"
 #include "Utils/Utils.h"
 #include "Headless.h"
 
@@ -14,20 +15,11 @@ typedef struct HookRegisterAndUnregister
 	void (*Unregister)(void);
 } HookRegisterAndUnregister;
 
-// TODO: Remove once we have something non-headless to put in the hooks array
-static void DummyInit(void)
-{
-}
-
-static void DummyShutDown(void)
-{
-}
-
 static const HookRegisterAndUnregister g_Hooks[] = {
 #if !RAYGE_HEADLESS()
 	{MenuHooks_Register, MenuHooks_Unregister},
 #endif
-	{DummyInit, DummyShutDown},
+	{MemPoolHooks_Register, MemPoolHooks_Unregister},
 };
 
 static bool g_Initialised = false;
@@ -0,0 +1,168 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include "Hooks/MemPoolHooks.h"
+#include "EngineSubsystems/CommandSubsystem.h"
+#include "MemPool/MemPoolManager.h"
+#include "MemPool/MemPoolProfiler.h"
+#include "MemPool/MemPoolTrace.h"
+#include "Logging/Logging.h"
+#include "Utils/Utils.h"
+
+#define NUM_SITES_TO_DUMP 32
+#define TRACE_FILE_NAME "mempool.trace"
+
+typedef struct MemPoolCommand
+{
+	const char* name;
+	CommandSubsystem_Callback callback;
+} MemPoolCommand;
+
+static bool g_Registered = false;
+
+static void HandleEnable(const char* commandName, void* userData)
+{
+	(void)commandName;
+	(void)userData;
+
+	MemPoolProfiler_SetEnabled(true);
+	Logging_PrintLine(
+		RAYGE_LOG_INFO,
+		"Mem pool profiler enabled (sample rate 1 in %zu)",
+		MemPoolProfiler_GetSampleRate()
+	);
+}
+
+static void HandleDisable(const char* commandName, void* userData)
+{
+	(void)commandName;
+	(void)userData;
+
+	MemPoolProfiler_SetEnabled(false);
+	Logging_PrintLine(RAYGE_LOG_INFO, "Mem pool profiler disabled");
+}
+
+static void HandleReset(const char* commandName, void* userData)
+{
+	(void)commandName;
+	(void)userData;
+
+	MemPoolProfiler_Reset();
+	Logging_PrintLine(RAYGE_LOG_INFO, "Mem pool profiler statistics reset");
+}
+
+static void HandleDumpLive(const char* commandName, void* userData)
+{
+	(void)commandName;
+	(void)userData;
+
+	MemPoolProfiler_DumpToLog(MEMPOOL_PROFILER_SORT_LIVE_BYTES, NUM_SITES_TO_DUMP);
+}
+
+static void HandleDumpChurn(const char* commandName, void* userData)
+{
+	(void)commandName;
+	(void)userData;
+
+	MemPoolProfiler_DumpToLog(MEMPOOL_PROFILER_SORT_ALLOCATIONS_PER_FRAME, NUM_SITES_TO_DUMP);
+}
+
+static void HandleDumpStats(const char* commandName, void* userData)
+{
+	(void)commandName;
+	(void)userData;
+
+	for ( size_t index = 0; index < MEMPOOL__COUNT; ++index )
+	{
+		MemPool_CategoryStats stats;
+		MemPoolManager_GetCategoryStats((MemPool_Category)index, &stats);
+
+		Logging_PrintLine(
+			RAYGE_LOG_INFO,
+			"%-20s %10zu bytes (peak %10zu), %7zu live, %8.1f allocs/s, %8.1f frees/s%s",
+			MemPoolManager_CategoryName((MemPool_Category)index),
+			stats.totalBytes,
+			stats.peakTotalBytes,
+			stats.liveAllocations,
+			stats.allocationsPerSecond,
+			stats.freesPerSecond,
+			stats.overBudget ? " [OVER BUDGET]" : ""
+		);
+
+		if ( stats.budgetBytes > 0 )
+		{
+			Logging_PrintLine(
+				RAYGE_LOG_INFO,
+				"%-20s budget %zu bytes (%.1f%% used, %s)",
+				"",
+				stats.budgetBytes,
+				100.0 * (double)stats.totalBytes / (double)stats.budgetBytes,
+				stats.budgetAction == MEMPOOL_BUDGET_FATAL ? "fatal" : "warn"
+			);
+		}
+	}
+}
+
+static void HandleResetPeaks(const char* commandName, void* userData)
+{
+	(void)commandName;
+	(void)userData;
+
+	MemPoolManager_ResetPeaks();
+	Logging_PrintLine(RAYGE_LOG_INFO, "Mem pool high-water marks reset");
+}
+
+static void HandleTraceStart(const char* commandName, void* userData)
+{
+	(void)commandName;
+	(void)userData;
+
+	// Logs on success or failure.
+	MemPoolTrace_Start(TRACE_FILE_NAME);
+}
+
+static void HandleTraceStop(const char* commandName, void* userData)
+{
+	(void)commandName;
+	(void)userData;
+
+	if ( !MemPoolTrace_IsRecording() )
+	{
+		Logging_PrintLine(RAYGE_LOG_WARNING, "No mem pool trace is being recorded");
+		return;
+	}
+
+	MemPoolTrace_Stop();
+}
+
+static const MemPoolCommand g_Commands[] = {
+	{"Engine.MemPool.Stats", HandleDumpStats},
+	{"Engine.MemPool.ResetPeaks", HandleResetPeaks},
+	{"Engine.MemPool.Profiler.Enable", HandleEnable},
+	{"Engine.MemPool.Profiler.Disable", HandleDisable},
+	{"Engine.MemPool.Profiler.Reset", HandleReset},
+	{"Engine.MemPool.Profiler.DumpLive", HandleDumpLive},
+	{"Engine.MemPool.Profiler.DumpChurn", HandleDumpChurn},
+	{"Engine.MemPool.Trace.Start", HandleTraceStart},
+	{"Engine.MemPool.Trace.Stop", HandleTraceStop},
+};
+
+void MemPoolHooks_Register(void)
+{
+	if ( g_Registered )
+	{
+		return;
+	}
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(g_Commands); ++index )
+	{
+		CommandSubsystem_AddCommand(g_Commands[index].name, g_Commands[index].callback, NULL);
+	}
+
+	g_Registered = true;
+}
+
+void MemPoolHooks_Unregister(void)
+{
+	// Commands are cleaned up when the command subsystem shuts down.
+	g_Registered = false;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+void MemPoolHooks_Register(void);
+void MemPoolHooks_Unregister(void);
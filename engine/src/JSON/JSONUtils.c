@@ -1,7 +1,6 @@
 #include "JSON/JSONUtils.h"
 #include "Logging/Logging.h"
 #include "EngineSubsystems/FilesystemSubsystem.h"
-#include "MemPool/MemPoolManager.h"
 
 static cJSON* GetItem(
 	const char* context,
@@ -59,21 +58,14 @@ cJSON* JSONUtils_ExpectStringItem(const char* context, cJSON* parent, const char
 
 cJSON* JSONUtils_LoadFromFile(const char* relPath)
 {
-	char* fullPath = FilesystemSubsystem_MakeAbsoluteAlloc(relPath);
+	FilesystemSubsystem_MappedFile file;
+	cJSON* json = NULL;
 
-	size_t length = 0;
-	uint8_t* fileData = FilesystemSubsystem_LoadFileData(fullPath, &length);
-
-	cJSON* json = cJSON_ParseWithLength((const char*)fileData, length);
-
-	if ( fileData )
-	{
-		FilesystemSubsystem_UnloadFileData(fileData);
-	}
-
-	if ( fullPath )
+	// cJSON respects the length, so the data does not need to be null terminated.
+	if ( FilesystemSubsystem_MapFile(relPath, &file) )
 	{
-		MEMPOOL_FREE(fullPath);
+		json = cJSON_ParseWithLength((const char*)file.data, file.size);
+		FilesystemSubsystem_UnmapFile(&file);
 	}
 
 	if ( !json )
@@ -20,6 +20,15 @@ typedef enum OptionIdentifier
 	ID_HELP = (int)'A',
 	ID_VERSION,
 	ID_DEBUG_MEMPOOL,
+	ID_PROFILE_MEMPOOL,
+	ID_MEMPOOL_BUDGET,
+	ID_MEMPOOL_BUDGET_FILE,
+	ID_TRACE_MEMPOOL,
+	ID_RESOURCE_CPU_BUDGET,
+	ID_RESOURCE_GPU_BUDGET,
+	ID_TEXTURE_CACHE_DIR,
+	ID_DISABLE_TEXTURE_CACHE,
+	ID_TEXTURE_MIPMAPS,
 	ID_RUN_TESTS,
 	ID_VERBOSE_TESTS,
 	ID_DEV_LEVEL,
@@ -47,6 +56,81 @@ static const struct cag_option LaunchOptionDefs[] = {
 			"Enables debugging of memory pool allocations (default for this build: " MEMPOOL_DEBUG_DEFAULT_STR
 			"). This may affect performance.",
 	},
+	{
+		.identifier = (char)ID_PROFILE_MEMPOOL,
+		.access_letters = NULL,
+		.access_name = "profile-mempool",
+		.value_name = "SAMPLE_RATE",
+		.description =
+			"Enables the memory pool allocation profiler, which records one in every SAMPLE_RATE allocations "
+			"(defaults to 1, ie. every allocation). Higher rates reduce the overhead.",
+	},
+	{
+		.identifier = (char)ID_MEMPOOL_BUDGET,
+		.access_letters = NULL,
+		.access_name = "mempool-budget",
+		.value_name = "BUDGETS",
+		.description =
+			"Sets memory budgets for mempool categories, as a comma-separated list of CATEGORY=SIZE[:ACTION]. "
+			"SIZE may have a K, M or G suffix, and ACTION is either warn (the default) or fatal.",
+	},
+	{
+		.identifier = (char)ID_MEMPOOL_BUDGET_FILE,
+		.access_letters = NULL,
+		.access_name = "mempool-budget-file",
+		.value_name = "PATH",
+		.description =
+			"Loads memory budgets for mempool categories from a JSON file. Budgets passed with --mempool-budget "
+			"take precedence.",
+	},
+	{
+		.identifier = (char)ID_TRACE_MEMPOOL,
+		.access_letters = NULL,
+		.access_name = "trace-mempool",
+		.value_name = "PATH",
+		.description =
+			"Records every memory pool allocation, reallocation and free to a binary trace file, which can be "
+			"replayed offline with the mempool-replay tool.",
+	},
+	{
+		.identifier = (char)ID_RESOURCE_CPU_BUDGET,
+		.access_letters = NULL,
+		.access_name = "resource-cpu-budget",
+		.value_name = "SIZE",
+		.description =
+			"Sets the amount of CPU memory that loaded resources may use before the least recently used ones are "
+			"evicted. SIZE may have a K, M or G suffix. Defaults to unlimited.",
+	},
+	{
+		.identifier = (char)ID_RESOURCE_GPU_BUDGET,
+		.access_letters = NULL,
+		.access_name = "resource-gpu-budget",
+		.value_name = "SIZE",
+		.description =
+			"Sets the amount of GPU memory that loaded resources may use before the least recently used ones are "
+			"evicted. SIZE may have a K, M or G suffix. Defaults to unlimited.",
+	},
+	{
+		.identifier = (char)ID_TEXTURE_CACHE_DIR,
+		.access_letters = NULL,
+		.access_name = "texture-cache-dir",
+		.value_name = "DIR",
+		.description =
+			"Sets the directory in which decoded textures are cached. Defaults to the texturecache directory next "
+			"to the executable.",
+	},
+	{
+		.identifier = (char)ID_DISABLE_TEXTURE_CACHE,
+		.access_letters = NULL,
+		.access_name = "disable-texture-cache",
+		.description = "If set, textures are always decoded from their source files, and are not cached.",
+	},
+	{
+		.identifier = (char)ID_TEXTURE_MIPMAPS,
+		.access_letters = NULL,
+		.access_name = "texture-mipmaps",
+		.description = "If set, mipmaps are generated for textures when they are loaded.",
+	},
 #if RAYGE_BUILD_TESTING()
 	{
 		.identifier = (char)ID_RUN_TESTS,
@@ -76,6 +160,16 @@ static void SetDefaults(RayGE_LaunchState* state)
 	state->defaultLogLevel = RAYGE_LOG_INFO;
 	state->enableBackendDebugLogs = false;
 	state->enableMemPoolDebugging = MEMPOOL_DEBUG_DEFAULT;
+	state->enableMemPoolProfiler = false;
+	state->memPoolProfilerSampleRate = 1;
+	state->memPoolBudgets = NULL;
+	state->memPoolBudgetFile = NULL;
+	state->memPoolTracePath = NULL;
+	state->resourceCpuBudget = NULL;
+	state->resourceGpuBudget = NULL;
+	state->textureCacheDir = NULL;
+	state->disableTextureCache = false;
+	state->generateTextureMipmaps = false;
 }
 
 bool LaunchParams_Parse(const RayGE_LaunchParams* params)
@@ -153,6 +247,65 @@ bool LaunchParams_Parse(const RayGE_LaunchParams* params)
 				break;
 			}
 
+			case ID_PROFILE_MEMPOOL:
+			{
+				const char* value = cag_option_get_value(&context);
+				const int rate = value ? atoi(value) : 1;
+
+				g_LaunchState.enableMemPoolProfiler = true;
+				g_LaunchState.memPoolProfilerSampleRate = rate > 0 ? (size_t)rate : 1;
+				break;
+			}
+
+			case ID_MEMPOOL_BUDGET:
+			{
+				// The launch params outlive the engine, so the value can be referenced directly.
+				g_LaunchState.memPoolBudgets = cag_option_get_value(&context);
+				break;
+			}
+
+			case ID_MEMPOOL_BUDGET_FILE:
+			{
+				g_LaunchState.memPoolBudgetFile = cag_option_get_value(&context);
+				break;
+			}
+
+			case ID_TRACE_MEMPOOL:
+			{
+				g_LaunchState.memPoolTracePath = cag_option_get_value(&context);
+				break;
+			}
+
+			case ID_RESOURCE_CPU_BUDGET:
+			{
+				g_LaunchState.resourceCpuBudget = cag_option_get_value(&context);
+				break;
+			}
+
+			case ID_RESOURCE_GPU_BUDGET:
+			{
+				g_LaunchState.resourceGpuBudget = cag_option_get_value(&context);
+				break;
+			}
+
+			case ID_TEXTURE_CACHE_DIR:
+			{
+				g_LaunchState.textureCacheDir = cag_option_get_value(&context);
+				break;
+			}
+
+			case ID_DISABLE_TEXTURE_CACHE:
+			{
+				g_LaunchState.disableTextureCache = true;
+				break;
+			}
+
+			case ID_TEXTURE_MIPMAPS:
+			{
+				g_LaunchState.generateTextureMipmaps = true;
+				break;
+			}
+
 #if RAYGE_BUILD_TESTING()
 			case ID_RUN_TESTS:
 			{
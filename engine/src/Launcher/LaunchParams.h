@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "RayGE/Private/Launcher.h"
 #include "Logging/Logging.h"
 
@@ -9,6 +10,16 @@ typedef struct RayGE_LaunchState
 	RayGE_Log_Level defaultLogLevel;
 	bool enableBackendDebugLogs;
 	bool enableMemPoolDebugging;
+	bool enableMemPoolProfiler;
+	size_t memPoolProfilerSampleRate;
+	const char* memPoolBudgets;
+	const char* memPoolBudgetFile;
+	const char* memPoolTracePath;
+	const char* resourceCpuBudget;
+	const char* resourceGpuBudget;
+	const char* textureCacheDir;
+	bool disableTextureCache;
+	bool generateTextureMipmaps;
 	bool runTestsAndExit;
 	bool runTestsVerbose;
 } RayGE_LaunchState;
@@ -1,10 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "RayGE/APIs/Logging.h"
 #include "RayGE/Private/Launcher.h"
 #include "Logging/Logging.h"
 #include "Launcher/LaunchParams.h"
 #include "MemPool//MemPoolManager.h"
+#include "Threading/Threading.h"
 #include "Debugging.h"
 #include "raylib.h"
 #include "wzl_cutl/string.h"
@@ -21,15 +23,32 @@ typedef struct Listener
 	void* userData;
 } Listener;
 
+// Listeners are only ever invoked on the main thread, so messages
+// printed from other threads are held here until they are dispatched.
+typedef struct DeferredMessage
+{
+	struct DeferredMessage* next;
+	RayGE_Log_Level level;
+	size_t length;
+	char message[];
+} DeferredMessage;
+
 typedef struct LogData
 {
 	RayGE_Log_Level logLevel;
-	bool printing;
 	Listener* listeners;
+
+	// Guards the deferred message list, and serialises printing
+	// so that lines from different threads are not interleaved.
+	Threading_Mutex lock;
+	DeferredMessage* deferredHead;
+	DeferredMessage* deferredTail;
 } LogData;
 
 static LogData g_LogData;
 static bool g_Initialised = false;
+static RAYGE_THREAD_LOCAL bool g_IsMainThread = false;
+static RAYGE_THREAD_LOCAL bool g_Printing = false;
 
 static const char* LogPrefix(RayGE_Log_Level level)
 {
@@ -130,6 +149,48 @@ static void EmitOnAllListeners(RayGE_Log_Level level, const char* message, size_
 	}
 }
 
+static void DeferMessage(RayGE_Log_Level level, const char* message, size_t length)
+{
+	// This uses the system allocator, since messages may be
+	// printed while the mem pool manager is being shut down.
+	DeferredMessage* deferred = (DeferredMessage*)malloc(sizeof(DeferredMessage) + length + 1);
+
+	if ( !deferred )
+	{
+		return;
+	}
+
+	deferred->next = NULL;
+	deferred->level = level;
+	deferred->length = length;
+	memcpy(deferred->message, message, length);
+	deferred->message[length] = '\0';
+
+	if ( g_LogData.deferredTail )
+	{
+		g_LogData.deferredTail->next = deferred;
+	}
+	else
+	{
+		g_LogData.deferredHead = deferred;
+	}
+
+	g_LogData.deferredTail = deferred;
+}
+
+static DeferredMessage* TakeDeferredMessages(void)
+{
+	Threading_Mutex_Lock(&g_LogData.lock);
+
+	DeferredMessage* head = g_LogData.deferredHead;
+	g_LogData.deferredHead = NULL;
+	g_LogData.deferredTail = NULL;
+
+	Threading_Mutex_Unlock(&g_LogData.lock);
+
+	return head;
+}
+
 static size_t AppendToLogBufferV(char** buffer, size_t* bufferSize, const char* format, va_list args)
 {
 	if ( *bufferSize < 1 )
@@ -174,7 +235,7 @@ static void PrintLogMessageLine(RayGE_Log_Level level, const char* source, const
 		return;
 	}
 
-	if ( g_LogData.printing )
+	if ( g_Printing )
 	{
 		// Something weird has happened, and we've ended up re-entering this function.
 		// Make sure we know about it, and just exit - this should never happen.
@@ -183,7 +244,7 @@ static void PrintLogMessageLine(RayGE_Log_Level level, const char* source, const
 		exit(RAYGE_LAUNCHER_EXIT_LOG_FATAL_ERROR);
 	}
 
-	g_LogData.printing = true;
+	g_Printing = true;
 
 	char messageBuffer[LOG_MESSAGE_MAX_LENGTH];
 	char* cursor = messageBuffer;
@@ -203,8 +264,21 @@ static void PrintLogMessageLine(RayGE_Log_Level level, const char* source, const
 	// The difference between its current and original value is the length.
 	const size_t messageLength = sizeof(messageBuffer) - bytesLeft;
 
+	Threading_Mutex_Lock(&g_LogData.lock);
+
 	printf("%s", messageBuffer);
-	EmitOnAllListeners(level, messageBuffer, messageLength);
+
+	if ( !g_IsMainThread )
+	{
+		DeferMessage(level, messageBuffer, messageLength);
+	}
+
+	Threading_Mutex_Unlock(&g_LogData.lock);
+
+	if ( g_IsMainThread )
+	{
+		EmitOnAllListeners(level, messageBuffer, messageLength);
+	}
 
 	if ( level == RAYGE_LOG_FATAL )
 	{
@@ -217,7 +291,7 @@ static void PrintLogMessageLine(RayGE_Log_Level level, const char* source, const
 		exit(RAYGE_LAUNCHER_EXIT_LOG_FATAL_ERROR);
 	}
 
-	g_LogData.printing = false;
+	g_Printing = false;
 }
 
 static void RaylibLogCallback(int logLevel, const char* format, va_list args)
@@ -234,6 +308,9 @@ void Logging_Init(void)
 		return;
 	}
 
+	Threading_Mutex_Init(&g_LogData.lock);
+	g_IsMainThread = true;
+
 	SetBackendDebugLogsEnabled(LaunchParams_GetLaunchState()->enableBackendDebugLogs);
 	SetTraceLogCallback(&RaylibLogCallback);
 
@@ -251,7 +328,18 @@ void Logging_ShutDown(void)
 		return;
 	}
 
-	RAYGE_ASSERT_BREAK(!g_LogData.printing);
+	RAYGE_ASSERT_BREAK(!g_Printing);
+
+	// Any threads that log should have been stopped by now,
+	// so there is nobody left to hear these messages.
+	DeferredMessage* deferred = TakeDeferredMessages();
+
+	while ( deferred )
+	{
+		DeferredMessage* next = deferred->next;
+		free(deferred);
+		deferred = next;
+	}
 
 	DeleteAllListeners();
 
@@ -260,6 +348,8 @@ void Logging_ShutDown(void)
 
 	SetTraceLogLevel(LOG_NONE);
 	SetTraceLogCallback(NULL);
+
+	Threading_Mutex_Destroy(&g_LogData.lock);
 }
 
 void Logging_SetLogLevel(RayGE_Log_Level level)
@@ -271,7 +361,7 @@ void Logging_SetLogLevel(RayGE_Log_Level level)
 		return;
 	}
 
-	RAYGE_ASSERT_BREAK(!g_LogData.printing);
+	RAYGE_ASSERT_BREAK(!g_Printing);
 
 	g_LogData.logLevel = level;
 }
@@ -285,7 +375,7 @@ void Logging_SetBackendDebugLogsEnabled(bool enabled)
 		return;
 	}
 
-	RAYGE_ASSERT_BREAK(!g_LogData.printing);
+	RAYGE_ASSERT_BREAK(!g_Printing);
 
 	SetBackendDebugLogsEnabled(enabled);
 }
@@ -299,11 +389,34 @@ void Logging_PrintLineV(RayGE_Log_Level level, const char* format, va_list args)
 		return;
 	}
 
-	RAYGE_ASSERT_BREAK(!g_LogData.printing);
+	RAYGE_ASSERT_BREAK(!g_Printing);
 
 	PrintLogMessageLine(level, NULL, format, args);
 }
 
+void Logging_DispatchDeferredMessages(void)
+{
+	RAYGE_ASSERT_BREAK(g_Initialised);
+	RAYGE_ASSERT(g_IsMainThread, "Deferred log messages must be dispatched on the main thread");
+
+	if ( !g_Initialised || !g_IsMainThread )
+	{
+		return;
+	}
+
+	DeferredMessage* deferred = TakeDeferredMessages();
+
+	while ( deferred )
+	{
+		DeferredMessage* next = deferred->next;
+
+		EmitOnAllListeners(deferred->level, deferred->message, deferred->length);
+		free(deferred);
+
+		deferred = next;
+	}
+}
+
 void Logging_AddListener(Logging_Callback callback, void* userData)
 {
 	RAYGE_ASSERT_BREAK(g_Initialised);
@@ -314,7 +427,7 @@ void Logging_AddListener(Logging_Callback callback, void* userData)
 		return;
 	}
 
-	RAYGE_ASSERT_BREAK(!g_LogData.printing);
+	RAYGE_ASSERT_BREAK(!g_Printing);
 
 	Listener* listener = MEMPOOL_CALLOC_STRUCT(MEMPOOL_LOGGING, Listener);
 	listener->callback = callback;
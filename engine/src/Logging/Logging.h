@@ -21,6 +21,12 @@ void Logging_SetLogLevel(RayGE_Log_Level level);
 void Logging_SetBackendDebugLogsEnabled(bool enabled);
 void Logging_PrintLineV(RayGE_Log_Level level, const char* format, va_list args) WZL_ATTR_FORMAT_PRINTF(2, 0);
 
+// Messages may be printed from any thread. The thread that calls
+// Logging_Init() is treated as the main thread, and listeners are
+// only ever invoked on it: messages printed from other threads are
+// passed to listeners when deferred messages are next dispatched.
+void Logging_DispatchDeferredMessages(void);
+
 // Must be initialised beforehand.
 // On shutdown, all listeners are unregistered.
 void Logging_AddListener(Logging_Callback callback, void* userData);
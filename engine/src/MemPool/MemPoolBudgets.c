@@ -0,0 +1,504 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include "MemPool/MemPoolBudgets.h"
+#include "Launcher/LaunchParams.h"
+#include "Logging/Logging.h"
+#include "cJSON.h"
+
+#define JSON_KEY_BUDGETS "budgets"
+#define JSON_KEY_SIZE "size"
+#define JSON_KEY_ACTION "action"
+
+static const char* SkipSpace(const char* begin, const char* end)
+{
+	while ( begin < end && isspace((unsigned char)*begin) )
+	{
+		++begin;
+	}
+
+	return begin;
+}
+
+static const char* TrimSpace(const char* begin, const char* end)
+{
+	while ( end > begin && isspace((unsigned char)end[-1]) )
+	{
+		--end;
+	}
+
+	return end;
+}
+
+static bool TokenEquals(const char* begin, const char* end, const char* str)
+{
+	const size_t length = (size_t)(end - begin);
+
+	if ( strlen(str) != length )
+	{
+		return false;
+	}
+
+	for ( size_t index = 0; index < length; ++index )
+	{
+		if ( tolower((unsigned char)begin[index]) != str[index] )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool ParseAction(const char* begin, const char* end, MemPool_BudgetAction* outAction)
+{
+	if ( TokenEquals(begin, end, "warn") )
+	{
+		*outAction = MEMPOOL_BUDGET_WARN;
+		return true;
+	}
+
+	if ( TokenEquals(begin, end, "fatal") )
+	{
+		*outAction = MEMPOOL_BUDGET_FATAL;
+		return true;
+	}
+
+	return false;
+}
+
+static bool ApplyBudget(
+	const char* source,
+	const char* name,
+	size_t nameLength,
+	size_t bytes,
+	MemPool_BudgetAction action
+)
+{
+	const MemPool_Category category = MemPoolManager_CategoryFromName(name, nameLength);
+
+	if ( category == MEMPOOL__COUNT )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "%s: Unknown mempool category \"%.*s\"", source, (int)nameLength, name);
+		return false;
+	}
+
+	Logging_PrintLine(
+		RAYGE_LOG_INFO,
+		"Setting budget for mempool %s: %zu bytes (%s)",
+		MemPoolManager_CategoryName(category),
+		bytes,
+		action == MEMPOOL_BUDGET_FATAL ? "fatal" : "warn"
+	);
+
+	MemPoolManager_SetBudget(category, bytes, action);
+	return true;
+}
+
+static bool ApplySpec(const char* begin, const char* end)
+{
+	const char* equals = memchr(begin, '=', (size_t)(end - begin));
+
+	if ( !equals )
+	{
+		Logging_PrintLine(
+			RAYGE_LOG_ERROR,
+			"Mempool budget \"%.*s\" was not of the form CATEGORY=SIZE[:ACTION]",
+			(int)(end - begin),
+			begin
+		);
+
+		return false;
+	}
+
+	const char* nameBegin = SkipSpace(begin, equals);
+	const char* nameEnd = TrimSpace(nameBegin, equals);
+
+	const char* sizeBegin = equals + 1;
+	const char* sizeEnd = end;
+	const char* colon = memchr(sizeBegin, ':', (size_t)(end - sizeBegin));
+	MemPool_BudgetAction action = MEMPOOL_BUDGET_WARN;
+
+	if ( colon )
+	{
+		sizeEnd = colon;
+
+		const char* actionBegin = SkipSpace(colon + 1, end);
+
+		if ( !ParseAction(actionBegin, TrimSpace(actionBegin, end), &action) )
+		{
+			Logging_PrintLine(
+				RAYGE_LOG_ERROR,
+				"Mempool budget \"%.*s\" had an invalid action (expected \"warn\" or \"fatal\")",
+				(int)(end - begin),
+				begin
+			);
+
+			return false;
+		}
+	}
+
+	size_t bytes = 0;
+
+	if ( !MemPoolBudgets_ParseSize(sizeBegin, sizeEnd, &bytes) )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Mempool budget \"%.*s\" had an invalid size", (int)(end - begin), begin);
+		return false;
+	}
+
+	return ApplyBudget("Mempool budget", nameBegin, (size_t)(nameEnd - nameBegin), bytes, action);
+}
+
+static bool ApplyJSONEntry(const char* path, const cJSON* entry)
+{
+	const cJSON* sizeItem = entry;
+	MemPool_BudgetAction action = MEMPOOL_BUDGET_WARN;
+
+	if ( cJSON_IsObject(entry) )
+	{
+		sizeItem = cJSON_GetObjectItemCaseSensitive(entry, JSON_KEY_SIZE);
+
+		const cJSON* actionItem = cJSON_GetObjectItemCaseSensitive(entry, JSON_KEY_ACTION);
+
+		if ( actionItem )
+		{
+			const char* actionStr = cJSON_IsString(actionItem) ? cJSON_GetStringValue(actionItem) : NULL;
+
+			if ( !actionStr || !ParseAction(actionStr, actionStr + strlen(actionStr), &action) )
+			{
+				Logging_PrintLine(
+					RAYGE_LOG_ERROR,
+					"%s: Budget for \"%s\" had an invalid action (expected \"warn\" or \"fatal\")",
+					path,
+					entry->string
+				);
+
+				return false;
+			}
+		}
+	}
+
+	size_t bytes = 0;
+	bool validSize = false;
+
+	if ( cJSON_IsNumber(sizeItem) )
+	{
+		const double value = cJSON_GetNumberValue(sizeItem);
+
+		if ( value >= 0.0 && value <= (double)SIZE_MAX )
+		{
+			bytes = (size_t)value;
+			validSize = true;
+		}
+	}
+	else if ( cJSON_IsString(sizeItem) )
+	{
+		const char* sizeStr = cJSON_GetStringValue(sizeItem);
+		validSize = MemPoolBudgets_ParseSize(sizeStr, sizeStr + strlen(sizeStr), &bytes);
+	}
+
+	if ( !validSize )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "%s: Budget for \"%s\" had an invalid size", path, entry->string);
+		return false;
+	}
+
+	return ApplyBudget(path, entry->string, strlen(entry->string), bytes, action);
+}
+
+static char* LoadFileAsString(const char* path, size_t* outLength)
+{
+	FILE* file = fopen(path, "rb");
+
+	if ( !file )
+	{
+		return NULL;
+	}
+
+	char* data = NULL;
+
+	do
+	{
+		if ( fseek(file, 0, SEEK_END) != 0 )
+		{
+			break;
+		}
+
+		const long length = ftell(file);
+
+		if ( length < 0 || fseek(file, 0, SEEK_SET) != 0 )
+		{
+			break;
+		}
+
+		data = (char*)MEMPOOL_MALLOC(MEMPOOL_UNCATEGORISED, (size_t)length + 1);
+
+		if ( fread(data, 1, (size_t)length, file) != (size_t)length )
+		{
+			MEMPOOL_FREE(data);
+			data = NULL;
+			break;
+		}
+
+		data[length] = '\0';
+		*outLength = (size_t)length;
+	}
+	while ( false );
+
+	fclose(file);
+	return data;
+}
+
+void MemPoolBudgets_ApplyLaunchParams(void)
+{
+	const RayGE_LaunchState* launchState = LaunchParams_GetLaunchState();
+
+	if ( launchState->memPoolBudgetFile )
+	{
+		MemPoolBudgets_ApplyFromFile(launchState->memPoolBudgetFile);
+	}
+
+	if ( launchState->memPoolBudgets )
+	{
+		MemPoolBudgets_ApplyFromString(launchState->memPoolBudgets);
+	}
+}
+
+bool MemPoolBudgets_ApplyFromString(const char* specs)
+{
+	if ( !specs )
+	{
+		return false;
+	}
+
+	bool success = true;
+	const char* cursor = specs;
+
+	while ( *cursor )
+	{
+		const char* end = strchr(cursor, ',');
+
+		if ( !end )
+		{
+			end = cursor + strlen(cursor);
+		}
+
+		const char* specBegin = SkipSpace(cursor, end);
+		const char* specEnd = TrimSpace(specBegin, end);
+
+		// Allow empty entries, eg. from a trailing comma.
+		if ( specBegin < specEnd && !ApplySpec(specBegin, specEnd) )
+		{
+			success = false;
+		}
+
+		cursor = *end ? end + 1 : end;
+	}
+
+	return success;
+}
+
+bool MemPoolBudgets_ApplyFromFile(const char* path)
+{
+	if ( !path )
+	{
+		return false;
+	}
+
+	size_t length = 0;
+	char* fileData = LoadFileAsString(path, &length);
+
+	if ( !fileData )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Could not load mempool budgets from %s", path);
+		return false;
+	}
+
+	cJSON* json = cJSON_ParseWithLength(fileData, length);
+	MEMPOOL_FREE(fileData);
+
+	if ( !json )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Failed to parse mempool budgets from %s", path);
+		return false;
+	}
+
+	bool success = true;
+	const cJSON* budgets = cJSON_GetObjectItemCaseSensitive(json, JSON_KEY_BUDGETS);
+
+	if ( cJSON_IsObject(budgets) )
+	{
+		const cJSON* entry = NULL;
+
+		cJSON_ArrayForEach(entry, budgets)
+		{
+			if ( !ApplyJSONEntry(path, entry) )
+			{
+				success = false;
+			}
+		}
+	}
+	else
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "%s: Expected \"" JSON_KEY_BUDGETS "\" object", path);
+		success = false;
+	}
+
+	cJSON_Delete(json);
+	return success;
+}
+
+bool MemPoolBudgets_ParseSize(const char* begin, const char* end, size_t* outBytes)
+{
+	if ( !begin || !end || !outBytes )
+	{
+		return false;
+	}
+
+	begin = SkipSpace(begin, end);
+	end = TrimSpace(begin, end);
+
+	if ( begin >= end || !isdigit((unsigned char)*begin) )
+	{
+		return false;
+	}
+
+	size_t value = 0;
+
+	for ( ; begin < end && isdigit((unsigned char)*begin); ++begin )
+	{
+		const size_t digit = (size_t)(*begin - '0');
+
+		if ( value > (SIZE_MAX - digit) / 10 )
+		{
+			return false;
+		}
+
+		value = (value * 10) + digit;
+	}
+
+	begin = SkipSpace(begin, end);
+
+	size_t multiplier = 1;
+
+	if ( begin < end )
+	{
+		switch ( toupper((unsigned char)*begin) )
+		{
+			case 'K':
+			{
+				multiplier = (size_t)1 << 10;
+				break;
+			}
+
+			case 'M':
+			{
+				multiplier = (size_t)1 << 20;
+				break;
+			}
+
+			case 'G':
+			{
+				multiplier = (size_t)1 << 30;
+				break;
+			}
+
+			case 'B':
+			{
+				break;
+			}
+
+			default:
+			{
+				return false;
+			}
+		}
+
+		if ( multiplier > 1 )
+		{
+			++begin;
+
+			// Allow "KB" and "KiB" as well as "K".
+			if ( begin < end && toupper((unsigned char)*begin) == 'I' )
+			{
+				++begin;
+			}
+		}
+
+		if ( begin < end && toupper((unsigned char)*begin) == 'B' )
+		{
+			++begin;
+		}
+
+		if ( begin != end )
+		{
+			return false;
+		}
+	}
+
+	if ( value > SIZE_MAX / multiplier )
+	{
+		return false;
+	}
+
+	*outBytes = value * multiplier;
+	return true;
+}
+
+#if RAYGE_BUILD_TESTING()
+static bool ParseSizeStr(const char* str, size_t* outBytes)
+{
+	return MemPoolBudgets_ParseSize(str, str + strlen(str), outBytes);
+}
+
+void MemPoolBudgets_RunTests(void)
+{
+	size_t bytes = 0;
+
+	TEST_EXPECT_TRUE(ParseSizeStr("1234", &bytes));
+	TEST_EXPECT_EQL_INT(bytes, 1234);
+
+	TEST_EXPECT_TRUE(ParseSizeStr(" 16K ", &bytes));
+	TEST_EXPECT_EQL_INT(bytes, 16 * 1024);
+
+	TEST_EXPECT_TRUE(ParseSizeStr("64mb", &bytes));
+	TEST_EXPECT_EQL_INT(bytes, 64 * 1024 * 1024);
+
+	TEST_EXPECT_TRUE(ParseSizeStr("1 GiB", &bytes));
+	TEST_EXPECT_EQL_INT(bytes, (size_t)1 << 30);
+
+	TEST_EXPECT_TRUE(ParseSizeStr("100B", &bytes));
+	TEST_EXPECT_EQL_INT(bytes, 100);
+
+	TEST_EXPECT_FALSE(ParseSizeStr("", &bytes));
+	TEST_EXPECT_FALSE(ParseSizeStr("M", &bytes));
+	TEST_EXPECT_FALSE(ParseSizeStr("-5", &bytes));
+	TEST_EXPECT_FALSE(ParseSizeStr("12Q", &bytes));
+	TEST_EXPECT_FALSE(ParseSizeStr("12MBs", &bytes));
+	TEST_EXPECT_FALSE(ParseSizeStr("99999999999999999999999", &bytes));
+
+	MemPool_CategoryStats stats;
+
+	TEST_EXPECT_TRUE(MemPoolBudgets_ApplyFromString("test_manager = 2M, Frame=1G:fatal,"));
+
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_MANAGER, &stats);
+	TEST_EXPECT_EQL_INT(stats.budgetBytes, 2 * 1024 * 1024);
+	TEST_EXPECT_EQL_INT(stats.budgetAction, MEMPOOL_BUDGET_WARN);
+
+	MemPoolManager_GetCategoryStats(MEMPOOL_FRAME, &stats);
+	TEST_EXPECT_EQL_INT(stats.budgetBytes, (size_t)1 << 30);
+	TEST_EXPECT_EQL_INT(stats.budgetAction, MEMPOOL_BUDGET_FATAL);
+
+	// Valid entries are still applied if others are not.
+	TEST_EXPECT_FALSE(MemPoolBudgets_ApplyFromString("NotACategory=1M,Frame=0,Test Manager=4M:explode"));
+
+	MemPoolManager_GetCategoryStats(MEMPOOL_FRAME, &stats);
+	TEST_EXPECT_EQL_INT(stats.budgetBytes, 0);
+
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_MANAGER, &stats);
+	TEST_EXPECT_EQL_INT(stats.budgetBytes, 2 * 1024 * 1024);
+
+	MemPoolManager_SetBudget(MEMPOOL_TEST_MANAGER, 0, MEMPOOL_BUDGET_WARN);
+}
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "MemPool/MemPoolManager.h"
+#include "Testing/Testing.h"
+
+// Budgets for mem pool categories can be specified on the command line
+// as a comma-separated list of entries, each of the form:
+//
+//   CATEGORY=SIZE[:ACTION]
+//
+// CATEGORY is matched as per MemPoolManager_CategoryFromName(). SIZE is
+// a number of bytes, optionally followed by a K, M or G suffix (powers
+// of 1024). ACTION is either "warn" (the default) or "fatal". Entries
+// which fail to parse are reported and skipped.
+//
+// Budgets can also be loaded from a JSON file of the form:
+//
+//   {
+//     "budgets": {
+//       "Renderer": "256M",
+//       "Scene": { "size": "64M", "action": "fatal" }
+//     }
+//   }
+//
+// Sizes in the file may also be given as plain numbers of bytes. The file
+// is loaded first, so budgets on the command line take precedence.
+
+// Called by the mem pool manager once it has been initialised.
+void MemPoolBudgets_ApplyLaunchParams(void);
+
+// Returns false if any part of the input was invalid.
+bool MemPoolBudgets_ApplyFromString(const char* specs);
+bool MemPoolBudgets_ApplyFromFile(const char* path);
+
+// Returns false if the string was not a valid size.
+bool MemPoolBudgets_ParseSize(const char* begin, const char* end, size_t* outBytes);
+
+#if RAYGE_BUILD_TESTING()
+void MemPoolBudgets_RunTests(void);
+#endif
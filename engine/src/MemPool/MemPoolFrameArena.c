@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "MemPool/MemPoolFrameArena.h"
+#include "Debugging.h"
+#include "Utils/Utils.h"
+
+#define ALIGN_SIZE(size) \
+	((((size) + MEMPOOL_FRAMEARENA_ALIGNMENT - 1) / MEMPOOL_FRAMEARENA_ALIGNMENT) * MEMPOOL_FRAMEARENA_ALIGNMENT)
+
+#define CHUNK_HEADER_SIZE ALIGN_SIZE(sizeof(MemPoolFrameArena_Chunk))
+
+static bool CreateOverflowChunk(MemPoolFrameArena* arena, size_t minSize)
+{
+	const size_t chunkSize = CHUNK_HEADER_SIZE + RAYGE_MAX(minSize, MEMPOOL_FRAMEARENA_INITIAL_CAPACITY);
+	MemPoolFrameArena_Chunk* chunk = (MemPoolFrameArena_Chunk*)malloc(chunkSize);
+
+	if ( !chunk )
+	{
+		return false;
+	}
+
+	chunk->next = arena->overflowChunks;
+	arena->overflowChunks = chunk;
+
+	arena->overflowCursor = (uint8_t*)chunk + CHUNK_HEADER_SIZE;
+	arena->overflowEnd = (uint8_t*)chunk + chunkSize;
+
+	arena->overflowReservedBytes += chunkSize;
+	return true;
+}
+
+static void FreeOverflowChunks(MemPoolFrameArena* arena)
+{
+	MemPoolFrameArena_Chunk* chunk = arena->overflowChunks;
+
+	while ( chunk )
+	{
+		MemPoolFrameArena_Chunk* next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+
+	arena->overflowChunks = NULL;
+	arena->overflowCursor = NULL;
+	arena->overflowEnd = NULL;
+	arena->overflowBytes = 0;
+	arena->overflowReservedBytes = 0;
+}
+
+static void* AllocFromOverflow(MemPoolFrameArena* arena, size_t size)
+{
+	if ( (size_t)(arena->overflowEnd - arena->overflowCursor) < size && !CreateOverflowChunk(arena, size) )
+	{
+		return NULL;
+	}
+
+	void* ptr = arena->overflowCursor;
+	arena->overflowCursor += size;
+	arena->overflowBytes += size;
+
+	return ptr;
+}
+
+void* MemPoolFrameArena_Alloc(MemPoolFrameArena* arena, size_t size)
+{
+	RAYGE_ASSERT_VALID(arena);
+
+	if ( !arena )
+	{
+		return NULL;
+	}
+
+	size = ALIGN_SIZE(size);
+
+	if ( !arena->base )
+	{
+		arena->base = (uint8_t*)malloc(MEMPOOL_FRAMEARENA_INITIAL_CAPACITY);
+
+		if ( !arena->base )
+		{
+			return NULL;
+		}
+
+		arena->capacity = MEMPOOL_FRAMEARENA_INITIAL_CAPACITY;
+		arena->used = 0;
+	}
+
+	if ( arena->capacity - arena->used < size )
+	{
+		return AllocFromOverflow(arena, size);
+	}
+
+	void* ptr = arena->base + arena->used;
+	arena->used += size;
+
+	return ptr;
+}
+
+void MemPoolFrameArena_Reset(MemPoolFrameArena* arena)
+{
+	RAYGE_ASSERT_VALID(arena);
+
+	if ( !arena )
+	{
+		return;
+	}
+
+	if ( arena->overflowChunks )
+	{
+		// Grow the main block so that next time,
+		// everything fits without needing to overflow.
+		const size_t newCapacity =
+			RAYGE_MIN(ALIGN_SIZE(arena->used + arena->overflowBytes), MEMPOOL_FRAMEARENA_MAX_CAPACITY);
+
+		FreeOverflowChunks(arena);
+
+		if ( newCapacity > arena->capacity )
+		{
+			uint8_t* newBase = (uint8_t*)malloc(newCapacity);
+
+			if ( newBase )
+			{
+				free(arena->base);
+				arena->base = newBase;
+				arena->capacity = newCapacity;
+			}
+		}
+	}
+
+	arena->used = 0;
+}
+
+void MemPoolFrameArena_Release(MemPoolFrameArena* arena)
+{
+	RAYGE_ASSERT_VALID(arena);
+
+	if ( !arena )
+	{
+		return;
+	}
+
+	FreeOverflowChunks(arena);
+	free(arena->base);
+	memset(arena, 0, sizeof(*arena));
+}
+
+size_t MemPoolFrameArena_ReservedBytes(const MemPoolFrameArena* arena)
+{
+	if ( !arena )
+	{
+		return 0;
+	}
+
+	return arena->capacity + arena->overflowReservedBytes;
+}
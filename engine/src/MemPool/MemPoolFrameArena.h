@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bump-pointer arena used for short-lived allocations.
+// Individual allocations are never freed; instead, the whole
+// arena is reset at once. If an arena runs out of space, extra
+// chunks are allocated to hold the overflow, and on the next
+// reset the arena is grown so that it can hold everything that
+// was allocated. This means that once the arena has grown to
+// fit the typical workload, it no longer touches the heap.
+
+#define MEMPOOL_FRAMEARENA_ALIGNMENT ((size_t)16)
+#define MEMPOOL_FRAMEARENA_INITIAL_CAPACITY ((size_t)(64 * 1024))
+
+// The arena will not grow its main block past this size.
+// Any allocations beyond this will always use overflow chunks.
+#define MEMPOOL_FRAMEARENA_MAX_CAPACITY ((size_t)(16 * 1024 * 1024))
+
+typedef struct MemPoolFrameArena_Chunk
+{
+	struct MemPoolFrameArena_Chunk* next;
+} MemPoolFrameArena_Chunk;
+
+typedef struct MemPoolFrameArena
+{
+	uint8_t* base;
+	size_t capacity;
+	size_t used;
+
+	MemPoolFrameArena_Chunk* overflowChunks;
+	uint8_t* overflowCursor;
+	uint8_t* overflowEnd;
+	size_t overflowBytes;
+	size_t overflowReservedBytes;
+} MemPoolFrameArena;
+
+// Returns NULL if the arena needed more memory but could not allocate it.
+// Returned memory is aligned to MEMPOOL_FRAMEARENA_ALIGNMENT bytes.
+void* MemPoolFrameArena_Alloc(MemPoolFrameArena* arena, size_t size);
+
+// Invalidates all memory previously allocated from the arena.
+void MemPoolFrameArena_Reset(MemPoolFrameArena* arena);
+
+// Frees all memory owned by the arena.
+void MemPoolFrameArena_Release(MemPoolFrameArena* arena);
+
+// Total memory reserved by the arena, including overflow chunks.
+size_t MemPoolFrameArena_ReservedBytes(const MemPoolFrameArena* arena);
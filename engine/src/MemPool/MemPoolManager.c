@@ -5,12 +5,20 @@
 #include <stddef.h>
 #include <ctype.h>
 #include "MemPool/MemPoolManager.h"
+#include "MemPool/MemPoolSlab.h"
+#include "MemPool/MemPoolFrameArena.h"
+#include "MemPool/MemPoolObjectPool.h"
+#include "MemPool/MemPoolProfiler.h"
+#include "MemPool/MemPoolBudgets.h"
+#include "MemPool/MemPoolTrace.h"
+#include "Threading/Threading.h"
 #include "Launcher/LaunchParams.h"
 #include "Logging/Logging.h"
 #include "Debugging.h"
 #include "Utils/Utils.h"
 #include "utlist.h"
 #include "Testing/Testing.h"
+#include "wzl_cutl/time.h"
 
 #if RAYGE_BUILD_TESTING()
 #define MEMPOOL_TEST_POOL MEMPOOL__COUNT
@@ -29,6 +37,35 @@
 #define TAIL_SENTINEL_VALUE ~(HEAD_SENTINEL_VALUE)
 #define TAIL_DEAD_SENTINEL_VALUE 0xDEAD7A12
 
+// Set if the item was allocated while debugging was enabled.
+// These items are preceded by a MemPoolItemDebugInfo struct,
+// followed by a MemPoolItemTail struct, and are linked into
+// their pool's list of allocations.
+#define ITEMFLAG_TRACKED (1 << 0)
+
+// Set if the item was allocated from the frame arena.
+// Freeing these items is a no-op.
+#define ITEMFLAG_FRAME (1 << 1)
+
+// Set if the item was sampled by the profiler,
+// which must be notified when the item is freed.
+#define ITEMFLAG_SAMPLED (1 << 2)
+
+#define NUM_FRAME_ARENAS 2
+
+// Each thread caches up to this many free blocks per size class.
+// Blocks are moved between the cache and the slab in batches,
+// which is the only time the global lock needs to be taken.
+#define THREAD_CACHE_MAX_BLOCKS 64
+#define THREAD_CACHE_TRANSFER_BLOCKS 32
+
+// Once a pool has gone over budget, it must drop below
+// this fraction of its budget before it is reported again.
+#define BUDGET_REARM_NUMERATOR 7
+#define BUDGET_REARM_DENOMINATOR 8
+
+#define RATE_WINDOW_MS 1000
+
 #define ENSURE_INITIALISED() RAYGE_ENSURE(g_Initialised, "MemPool manager was not initialised")
 
 static const char* const g_MemPoolNames[] = {
@@ -37,19 +74,26 @@ static const char* const g_MemPoolNames[] = {
 #undef LIST_ITEM
 };
 
-struct MemPool;
-
+// Present immediately before every allocation. This is kept to 16 bytes
+// so that the client memory after it is suitably aligned for any type.
 typedef struct MemPoolItemHead
 {
-	struct MemPool* pool;
-	struct MemPoolItemHead* prev;
-	struct MemPoolItemHead* next;
+	uint64_t requestedSize;
+	uint16_t category;
+	uint8_t sizeClass;  // MEMPOOL_SLAB_NO_SIZE_CLASS if allocated from the system allocator
+	uint8_t flags;
+	uint32_t sentinel;
+} MemPoolItemHead;
+
+// Only present for tracked items, immediately before the head.
+typedef struct MemPoolItemDebugInfo
+{
+	struct MemPoolItemDebugInfo* prev;
+	struct MemPoolItemDebugInfo* next;
 
 	const char* allocFile;
 	int allocLine;
-	size_t requestedSize;
-	uint32_t sentinel;
-} MemPoolItemHead;
+} MemPoolItemDebugInfo;
 
 typedef struct MemPoolItemTail
 {
@@ -59,21 +103,98 @@ typedef struct MemPoolItemTail
 typedef struct MemPool
 {
 	MemPool_Category category;
-	MemPoolItemHead* head;
-	size_t totalClientMemory;  // Sizes of all allocations requested
-	size_t totalMemory;  // Total memory used, including head and tail structs.
-	size_t totalAllocations;
+	MemPoolItemDebugInfo* head;  // Only tracked items are held in this list.
+	MemPoolSlab slab;
+
+	// These are modified atomically.
+	volatile size_t totalClientMemory;  // Sizes of all allocations requested
+	volatile size_t totalMemory;  // Total memory used, including head and tail structs.
+	volatile size_t totalAllocations;
+
+	// High-water marks, also modified atomically.
+	volatile size_t peakClientMemory;
+	volatile size_t peakMemory;
+
+	// Counters which only ever increase, so that rates can be calculated.
+	volatile size_t lifetimeAllocations;
+	volatile size_t lifetimeFrees;
+
+	// Zero if there is no budget. The over budget flag is
+	// set when the budget action is taken for an overrun.
+	volatile size_t budget;
+	MemPool_BudgetAction budgetAction;
+	volatile size_t overBudget;
+
+	// Only written by MemPoolManager_NewFrame().
+	size_t allocationsAtFrameStart;
+	size_t freesAtFrameStart;
+	volatile size_t allocationsLastFrame;
+	volatile size_t freesLastFrame;
+	volatile size_t peakAllocationsPerFrame;
+
+	size_t allocationsAtWindowStart;
+	size_t freesAtWindowStart;
+	double allocationsPerSecond;
+	double freesPerSecond;
 } MemPool;
 
+typedef struct ThreadCacheBin
+{
+	MemPoolSlab_FreeBlock* head;
+	size_t count;
+} ThreadCacheBin;
+
+typedef struct ThreadCache
+{
+	struct ThreadCache* prev;
+	struct ThreadCache* next;
+
+	ThreadCacheBin bins[TOTAL_MEMPOOLS][MEMPOOL_SLAB_NUM_SIZE_CLASSES];
+} ThreadCache;
+
+typedef struct FrameArenaData
+{
+	MemPoolFrameArena arena;
+
+	// Counters for the allocations made from this arena,
+	// so that they can be removed from the pool on reset.
+	size_t clientMemory;
+	size_t totalMemory;
+	size_t allocations;
+} FrameArenaData;
+
 typedef struct ManagerData
 {
 	MemPool pools[TOTAL_MEMPOOLS];
 	bool debuggingEnabled;
+
+	// Guards the slabs, the lists of tracked items,
+	// and the list of thread caches.
+	Threading_Mutex lock;
+	ThreadCache* threadCaches;
+
+	// Guards the frame arenas.
+	Threading_Mutex frameArenaLock;
+
+	// Double-buffered, so that memory allocated in
+	// one frame is still valid during the next.
+	FrameArenaData frameArenas[NUM_FRAME_ARENAS];
+	size_t currentFrameArena;
+
+	// When the current window for measuring rates per second began.
+	uint64_t rateWindowStartMs;
 } ManagerData;
 
 static ManagerData g_Data;
 static bool g_Initialised = false;
 
+// Incremented each time the manager is initialised, so that
+// threads can tell if their cache belongs to an earlier session.
+static size_t g_Generation = 0;
+
+static RAYGE_THREAD_LOCAL ThreadCache* g_ThreadCache = NULL;
+static RAYGE_THREAD_LOCAL size_t g_ThreadCacheGeneration = 0;
+
 static const char* MemPoolName(MemPool_Category category)
 {
 #if RAYGE_BUILD_TESTING()
@@ -86,25 +207,42 @@ static const char* MemPoolName(MemPool_Category category)
 	return (category >= MEMPOOL_UNCATEGORISED && category < RAYGE_ARRAY_SIZE(g_MemPoolNames)) ? g_MemPoolNames[category] : "UNKNOWN";
 }
 
+static bool ItemIsTracked(const MemPoolItemHead* item)
+{
+	return (item->flags & ITEMFLAG_TRACKED) != 0;
+}
+
+static MemPoolItemDebugInfo* ItemDebugInfo(MemPoolItemHead* item)
+{
+	return ItemIsTracked(item) ? ((MemPoolItemDebugInfo*)item - 1) : NULL;
+}
+
+static MemPoolItemHead* DebugInfoToItem(MemPoolItemDebugInfo* debugInfo)
+{
+	return (MemPoolItemHead*)(debugInfo + 1);
+}
+
 static const char* SafeFileNameString(MemPoolItemHead* item)
 {
 	static const char* const CORRUPTED = "<corrupted>";
 	static const size_t MAX_LENGTH = 128;
 
-	if ( !item || !item->allocFile )
+	MemPoolItemDebugInfo* debugInfo = item ? ItemDebugInfo(item) : NULL;
+
+	if ( !debugInfo || !debugInfo->allocFile )
 	{
 		return "<null>";
 	}
 
 	for ( size_t index = 0; index < MAX_LENGTH; ++index )
 	{
-		if ( !item->allocFile[index] )
+		if ( !debugInfo->allocFile[index] )
 		{
 			// We found a null, so everything was OK.
-			return item->allocFile;
+			return debugInfo->allocFile;
 		}
 
-		if ( !isprint(item->allocFile[index]) )
+		if ( !isprint(debugInfo->allocFile[index]) )
 		{
 			return CORRUPTED;
 		}
@@ -115,7 +253,8 @@ static const char* SafeFileNameString(MemPoolItemHead* item)
 
 static int SafeFileLineNumber(MemPoolItemHead* item)
 {
-	return item ? item->allocLine : 0;
+	MemPoolItemDebugInfo* debugInfo = item ? ItemDebugInfo(item) : NULL;
+	return debugInfo ? debugInfo->allocLine : 0;
 }
 
 static void* ItemToMemPtr(MemPoolItemHead* item)
@@ -125,20 +264,30 @@ static void* ItemToMemPtr(MemPoolItemHead* item)
 
 static MemPoolItemTail* ItemTail(MemPoolItemHead* item)
 {
-	return (MemPoolItemTail*)((uint8_t*)item + sizeof(MemPoolItemHead) + item->requestedSize);
+	return ItemIsTracked(item)
+		? (MemPoolItemTail*)((uint8_t*)item + sizeof(MemPoolItemHead) + (size_t)item->requestedSize)
+		: NULL;
 }
 
-static bool VerifyPoolValid(MemPool* pool)
+// Returns the start of the memory block that holds the item.
+static void* ItemBlock(MemPoolItemHead* item)
 {
-	const size_t poolNum = (size_t)pool;
-	const size_t poolMin = (size_t)g_Data.pools;
-	const size_t poolMax = (size_t)(g_Data.pools + TOTAL_MEMPOOLS);
-
-	return poolNum >= poolMin && poolNum < poolMax && poolNum % sizeof(void*) == 0;
+	return ItemIsTracked(item) ? (void*)ItemDebugInfo(item) : (void*)item;
 }
 
 static void VerifyIntegrity(MemPoolItemHead* item, const char* file, int line)
 {
+	// The category is used to look up the pool, so this is always checked.
+	RAYGE_ENSURE(
+		item->category < TOTAL_MEMPOOLS,
+		"Mem pool invocation from %s:%d: Mem pool category was trashed for 0x%p allocated from %s:%d.",
+		file,
+		line,
+		ItemToMemPtr(item),
+		SafeFileNameString(item),
+		SafeFileLineNumber(item)
+	);
+
 	if ( !g_Data.debuggingEnabled )
 	{
 		return;
@@ -157,18 +306,15 @@ static void VerifyIntegrity(MemPoolItemHead* item, const char* file, int line)
 		item->sentinel
 	);
 
-	RAYGE_ENSURE(
-		VerifyPoolValid(item->pool),
-		"Mem pool invocation from %s:%d: Mem pool pointer was trashed for 0x%p allocated from %s:%d.",
-		file,
-		line,
-		ItemToMemPtr(item),
-		SafeFileNameString(item),
-		SafeFileLineNumber(item)
-	);
-
 	MemPoolItemTail* tail = ItemTail(item);
 
+	if ( !tail )
+	{
+		// Item was allocated before debugging was enabled,
+		// so there is nothing more to check.
+		return;
+	}
+
 	RAYGE_ENSURE(
 		tail->sentinel == TAIL_SENTINEL_VALUE,
 		"Mem pool invocation from %s:%d: Tail sentinel was trashed for 0x%p allocated from %s:%d. Expected 0x%08X, got "
@@ -195,218 +341,889 @@ static MemPoolItemHead* MemPtrToItemChecked(void* ptr, const char* file, int lin
 	return item;
 }
 
-static size_t ItemAllocationSize(size_t coreSize)
+static MemPool* ItemPool(MemPoolItemHead* item)
+{
+	return &g_Data.pools[item->category];
+}
+
+static size_t ItemAllocationSize(size_t coreSize, bool tracked)
 {
-	return sizeof(MemPoolItemHead) + coreSize + sizeof(MemPoolItemTail);
+	return tracked ? (sizeof(MemPoolItemDebugInfo) + sizeof(MemPoolItemHead) + coreSize + sizeof(MemPoolItemTail))
+				   : (sizeof(MemPoolItemHead) + coreSize);
 }
 
-static void FreeChain(MemPoolItemHead** chain, const char* file, int line)
+// Must not be called while any lock is held, since
+// reporting the overrun may cause more allocations.
+static void CheckBudget(MemPool* pool, size_t totalMemory)
 {
-	MemPoolItemHead* item = NULL;
-	MemPoolItemHead* temp1 = NULL;
+	const size_t budget = Threading_AtomicLoadSize(&pool->budget);
 
-	DL_FOREACH_SAFE(*chain, item, temp1)
+	if ( budget == 0 || totalMemory <= budget )
 	{
-		VerifyIntegrity(item, file, line);
-		free(item);
+		return;
+	}
+
+	// Only the first allocation over the budget reports it. This also
+	// stops a budget on the logging category from recursing forever.
+	if ( Threading_AtomicExchangeSize(&pool->overBudget, 1) != 0 )
+	{
+		return;
+	}
+
+	if ( pool->budgetAction == MEMPOOL_BUDGET_FATAL )
+	{
+		RAYGE_FATAL(
+			"Mempool %s went over its budget: %zu bytes used, budget is %zu bytes",
+			MemPoolManager_CategoryName(pool->category),
+			totalMemory,
+			budget
+		);
+	}
+	else
+	{
+		Logging_PrintLine(
+			RAYGE_LOG_WARNING,
+			"Mempool %s went over its budget: %zu bytes used, budget is %zu bytes",
+			MemPoolManager_CategoryName(pool->category),
+			totalMemory,
+			budget
+		);
 	}
 }
 
-static void CheckCountersForNewAllocation(MemPool* pool, size_t size, const char* file, int line)
+static void RearmBudget(MemPool* pool, size_t totalMemory)
 {
-	RAYGE_ENSURE(
-		SIZE_MAX - pool->totalClientMemory >= size,
-		"Mem pool invocation from %s:%d: Request to allocate %zu client bytes would overflow pool's client memory "
-		"counter.",
-		file,
-		line,
-		size
-	);
-
-	size_t totalSize = ItemAllocationSize(size);
+	if ( !Threading_AtomicLoadSize(&pool->overBudget) )
+	{
+		return;
+	}
 
-	RAYGE_ENSURE(
-		SIZE_MAX - pool->totalMemory >= totalSize,
-		"Mem pool invocation from %s:%d: Request to allocate %zu client bytes would overflow pool's total memory "
-		"counter.",
-		file,
-		line,
-		size
-	);
+	const size_t budget = Threading_AtomicLoadSize(&pool->budget);
 
-	RAYGE_ENSURE(
-		pool->totalAllocations < SIZE_MAX,
-		"Mem pool invocation from %s:%d: Request to allocate %zu client bytes would overflow pool's total allocations "
-		"counter.",
-		file,
-		line,
-		size
-	);
+	if ( totalMemory < (budget / BUDGET_REARM_DENOMINATOR) * BUDGET_REARM_NUMERATOR )
+	{
+		Threading_AtomicStoreSize(&pool->overBudget, 0);
+	}
 }
 
-static void CheckCountersForAllocationRemoval(MemPool* pool, size_t clientAllocSize, const char* file, int line)
+static void AddToCounters(MemPool* pool, size_t clientSize, size_t totalSize)
 {
-	RAYGE_ENSURE(
-		clientAllocSize <= pool->totalClientMemory,
-		"Mem pool invocation from %s:%d: Freeing %zu bytes underflows pool's client memory counter.",
-		file,
-		line,
-		clientAllocSize
-	);
+	const size_t clientMemory = Threading_AtomicAddSize(&pool->totalClientMemory, clientSize);
+	const size_t totalMemory = Threading_AtomicAddSize(&pool->totalMemory, totalSize);
+	Threading_AtomicAddSize(&pool->totalAllocations, 1);
+	Threading_AtomicAddSize(&pool->lifetimeAllocations, 1);
 
-	const size_t totalBytesToFree = ItemAllocationSize(clientAllocSize);
+	Threading_AtomicMaxSize(&pool->peakClientMemory, clientMemory);
+	Threading_AtomicMaxSize(&pool->peakMemory, totalMemory);
 
-	RAYGE_ENSURE(
-		totalBytesToFree <= pool->totalMemory,
-		"Mem pool invocation from %s:%d: Freeing %zu total bytes underflows pool's total memory counter.",
-		file,
-		line,
-		totalBytesToFree
-	);
+	CheckBudget(pool, totalMemory);
+}
 
-	RAYGE_ENSURE(
-		pool->totalAllocations > 0,
-		"Mem pool invocation from %s:%d: Allocation to free but total allocations counter was zero.",
-		file,
-		line
-	);
+static void RemoveFromCounters(MemPool* pool, size_t clientSize, size_t totalSize)
+{
+	Threading_AtomicSubSize(&pool->totalClientMemory, clientSize);
+	const size_t totalMemory = Threading_AtomicSubSize(&pool->totalMemory, totalSize);
+	Threading_AtomicSubSize(&pool->totalAllocations, 1);
+	Threading_AtomicAddSize(&pool->lifetimeFrees, 1);
+
+	RearmBudget(pool, totalMemory);
 }
 
-static MemPoolItemHead* CreateItemInPool(MemPool* pool, size_t size, const char* file, int line)
+// Only called from MemPoolManager_NewFrame().
+static void UpdateRates(MemPool* pool, uint64_t windowElapsedMs)
 {
-	RAYGE_ENSURE(size > 0, "Mem pool invocation from %s:%d: Invalid request to allocate zero bytes", file, line);
+	const size_t allocations = Threading_AtomicLoadSize(&pool->lifetimeAllocations);
+	const size_t frees = Threading_AtomicLoadSize(&pool->lifetimeFrees);
+	const size_t allocationsLastFrame = allocations - pool->allocationsAtFrameStart;
 
-	RAYGE_ENSURE(
-		SIZE_MAX - pool->totalClientMemory >= size,
-		"Mem pool invocation from %s:%d: Request to allocate %zu bytes would overflow pool's client memory counter.",
-		file,
-		line,
-		size
-	);
+	Threading_AtomicStoreSize(&pool->allocationsLastFrame, allocationsLastFrame);
+	Threading_AtomicStoreSize(&pool->freesLastFrame, frees - pool->freesAtFrameStart);
+	Threading_AtomicMaxSize(&pool->peakAllocationsPerFrame, allocationsLastFrame);
 
-	CheckCountersForNewAllocation(pool, size, file, line);
+	pool->allocationsAtFrameStart = allocations;
+	pool->freesAtFrameStart = frees;
 
-	const size_t totalSize = ItemAllocationSize(size);
-	MemPoolItemHead* item = (MemPoolItemHead*)calloc(1, totalSize);
+	if ( windowElapsedMs >= RATE_WINDOW_MS )
+	{
+		const double seconds = (double)windowElapsedMs / 1000.0;
 
-	RAYGE_ENSURE(
-		item,
-		"Mem pool invocation from %s:%d: Could not allocate %zu total bytes (%zu requested as payload)",
-		file,
-		line,
-		totalSize,
-		size
-	);
+		pool->allocationsPerSecond = (double)(allocations - pool->allocationsAtWindowStart) / seconds;
+		pool->freesPerSecond = (double)(frees - pool->freesAtWindowStart) / seconds;
+		pool->allocationsAtWindowStart = allocations;
+		pool->freesAtWindowStart = frees;
+	}
+}
 
-	item->sentinel = HEAD_SENTINEL_VALUE;
-	item->requestedSize = size;
-	item->allocFile = file;
-	item->allocLine = line;
+// Returns NULL if the cache could not be created.
+static ThreadCache* GetThreadCache(void)
+{
+	if ( g_ThreadCache && g_ThreadCacheGeneration == g_Generation )
+	{
+		return g_ThreadCache;
+	}
 
-	ItemTail(item)->sentinel = TAIL_SENTINEL_VALUE;
+	// Any cache from a previous session was freed on shut down.
+	ThreadCache* cache = (ThreadCache*)calloc(1, sizeof(ThreadCache));
 
-	item->pool = pool;
+	if ( cache )
+	{
+		Threading_Mutex_Lock(&g_Data.lock);
+		DL_APPEND(g_Data.threadCaches, cache);
+		Threading_Mutex_Unlock(&g_Data.lock);
+	}
 
-	DL_APPEND(pool->head, item);
+	g_ThreadCache = cache;
+	g_ThreadCacheGeneration = g_Generation;
 
-	// Keep track of how much memory is being used in this pool.
-	pool->totalClientMemory += item->requestedSize;
-	pool->totalMemory += totalSize;
-	++pool->totalAllocations;
+	return cache;
+}
 
-	return item;
+// Global lock must be held.
+static void DrainBin(MemPool* pool, uint8_t sizeClass, ThreadCacheBin* bin, size_t count)
+{
+	for ( ; count > 0 && bin->head; --count )
+	{
+		MemPoolSlab_FreeBlock* block = bin->head;
+		bin->head = block->next;
+		--bin->count;
+
+		MemPoolSlab_Free(&pool->slab, sizeClass, block);
+	}
 }
 
-static void DestroyItemInPool(MemPool* pool, MemPoolItemHead* item, const char* file, int line)
+static void* AllocateSlabBlock(MemPool* pool, uint8_t sizeClass)
 {
-	CheckCountersForAllocationRemoval(pool, item->requestedSize, file, line);
+	ThreadCache* cache = GetThreadCache();
+
+	if ( !cache )
+	{
+		Threading_Mutex_Lock(&g_Data.lock);
+		void* block = MemPoolSlab_Alloc(&pool->slab, sizeClass);
+		Threading_Mutex_Unlock(&g_Data.lock);
+
+		return block;
+	}
+
+	ThreadCacheBin* bin = &cache->bins[pool->category][sizeClass];
+
+	if ( !bin->head )
+	{
+		Threading_Mutex_Lock(&g_Data.lock);
+
+		for ( size_t index = 0; index < THREAD_CACHE_TRANSFER_BLOCKS; ++index )
+		{
+			MemPoolSlab_FreeBlock* block = (MemPoolSlab_FreeBlock*)MemPoolSlab_Alloc(&pool->slab, sizeClass);
+
+			if ( !block )
+			{
+				break;
+			}
+
+			block->next = bin->head;
+			bin->head = block;
+			++bin->count;
+		}
 
-	const size_t totalBytesToFree = ItemAllocationSize(item->requestedSize);
+		Threading_Mutex_Unlock(&g_Data.lock);
+	}
 
-	pool->totalClientMemory -= item->requestedSize;
-	pool->totalMemory -= totalBytesToFree;
-	--pool->totalAllocations;
+	MemPoolSlab_FreeBlock* block = bin->head;
 
-	DL_DELETE(pool->head, item);
+	if ( block )
+	{
+		bin->head = block->next;
+		--bin->count;
+	}
 
-	free(item);
+	return block;
 }
 
-static void InitData(ManagerData* data)
+static void FreeSlabBlock(MemPool* pool, uint8_t sizeClass, void* block)
 {
-	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(data->pools); ++index )
+	ThreadCache* cache = GetThreadCache();
+
+	if ( !cache )
 	{
-		memset(&data->pools[index], 0, sizeof(MemPool));
-		data->pools[index].category = (MemPool_Category)index;
+		Threading_Mutex_Lock(&g_Data.lock);
+		MemPoolSlab_Free(&pool->slab, sizeClass, block);
+		Threading_Mutex_Unlock(&g_Data.lock);
+
+		return;
 	}
 
-	data->debuggingEnabled = LaunchParams_GetLaunchState()->enableMemPoolDebugging;
+	// Blocks may be freed on a different thread to the one they were
+	// allocated on. This is fine, since they all go back to the same slab.
+	ThreadCacheBin* bin = &cache->bins[pool->category][sizeClass];
+	MemPoolSlab_FreeBlock* freeBlock = (MemPoolSlab_FreeBlock*)block;
 
-	if ( data->debuggingEnabled )
+	freeBlock->next = bin->head;
+	bin->head = freeBlock;
+	++bin->count;
+
+	if ( bin->count > THREAD_CACHE_MAX_BLOCKS )
 	{
-		Logging_PrintLine(RAYGE_LOG_WARNING, "Mempool debugging is enabled. This may affect performance.");
+		Threading_Mutex_Lock(&g_Data.lock);
+		DrainBin(pool, sizeClass, bin, THREAD_CACHE_TRANSFER_BLOCKS);
+		Threading_Mutex_Unlock(&g_Data.lock);
 	}
 }
 
-static void FreeData(ManagerData* data)
+// If the item is tracked, the global lock must be held.
+// Tracked items bypass the thread cache, since the
+// lock has to be taken to maintain the item list anyway.
+static MemPoolItemHead* AllocateItemMemory(MemPool* pool, size_t totalSize, bool tracked)
 {
-	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(data->pools); ++index )
+	const uint8_t sizeClass = MemPoolSlab_SizeClassForSize(totalSize);
+	uint8_t* block = NULL;
+
+	if ( sizeClass == MEMPOOL_SLAB_NO_SIZE_CLASS )
+	{
+		// Anything too large for the slab goes straight to the system allocator.
+		block = (uint8_t*)malloc(totalSize);
+	}
+	else if ( tracked )
 	{
-		FreeChain(&data->pools[index].head, __FILE__, __LINE__);
+		block = (uint8_t*)MemPoolSlab_Alloc(&pool->slab, sizeClass);
+	}
+	else
+	{
+		block = (uint8_t*)AllocateSlabBlock(pool, sizeClass);
 	}
 
-	memset(data, 0, sizeof(*data));
+	if ( !block )
+	{
+		return NULL;
+	}
+
+	if ( tracked )
+	{
+		memset(block, 0, sizeof(MemPoolItemDebugInfo));
+		block += sizeof(MemPoolItemDebugInfo);
+	}
+
+	MemPoolItemHead* item = (MemPoolItemHead*)block;
+
+	item->requestedSize = 0;
+	item->category = (uint16_t)pool->category;
+	item->sizeClass = sizeClass;
+	item->flags = tracked ? ITEMFLAG_TRACKED : 0;
+	item->sentinel = HEAD_SENTINEL_VALUE;
+
+	return item;
 }
 
-bool MemPoolManager_DebuggingEnabled(void)
+// If the item is tracked, the global lock must be held.
+static void FreeItemMemory(MemPool* pool, MemPoolItemHead* item)
 {
-	return g_Data.debuggingEnabled;
+	if ( item->sizeClass == MEMPOOL_SLAB_NO_SIZE_CLASS )
+	{
+		free(ItemBlock(item));
+	}
+	else if ( ItemIsTracked(item) )
+	{
+		MemPoolSlab_Free(&pool->slab, item->sizeClass, ItemBlock(item));
+	}
+	else
+	{
+		FreeSlabBlock(pool, item->sizeClass, ItemBlock(item));
+	}
 }
 
-void MemPoolManager_SetDebuggingEnabled(bool enabled)
+// If the item is tracked, the global lock must be held.
+// Returns NULL if the reallocation failed, in which case
+// the original item is left untouched.
+static MemPoolItemHead* ReallocItemMemory(MemPool* pool, MemPoolItemHead* item, size_t newTotalSize)
 {
-	g_Data.debuggingEnabled = g_Initialised && enabled;
+	const bool tracked = ItemIsTracked(item);
+
+	if ( item->sizeClass == MEMPOOL_SLAB_NO_SIZE_CLASS &&
+		 MemPoolSlab_SizeClassForSize(newTotalSize) == MEMPOOL_SLAB_NO_SIZE_CLASS )
+	{
+		// Large allocations stay with the system allocator.
+		uint8_t* block = (uint8_t*)realloc(ItemBlock(item), newTotalSize);
+
+		if ( block && tracked )
+		{
+			block += sizeof(MemPoolItemDebugInfo);
+		}
+
+		return (MemPoolItemHead*)block;
+	}
+
+	MemPoolItemHead* newItem = AllocateItemMemory(pool, newTotalSize, tracked);
+
+	if ( newItem )
+	{
+		// Only copy as much as the new payload can hold, or a shrinking
+		// reallocation would overrun the end of the new block.
+		const size_t newPayloadSize = newTotalSize - ItemAllocationSize(0, tracked);
+		memcpy(ItemToMemPtr(newItem), ItemToMemPtr(item), RAYGE_MIN((size_t)item->requestedSize, newPayloadSize));
+		FreeItemMemory(pool, item);
+	}
+
+	return newItem;
 }
 
-void MemPoolManager_Init(void)
+static bool ItemCanHoldAllocation(MemPoolItemHead* item, size_t totalSize)
 {
-	if ( g_Initialised )
+	// Items from the system allocator are resized with realloc() instead.
+	return item->sizeClass != MEMPOOL_SLAB_NO_SIZE_CLASS && totalSize <= MemPoolSlab_BlockSize(item->sizeClass);
+}
+
+static void FreeThreadCaches(ManagerData* data)
+{
+	ThreadCache* cache = NULL;
+	ThreadCache* temp1 = NULL;
+
+	// Blocks held in the caches are owned by the slabs,
+	// so are freed when the slabs are released.
+	DL_FOREACH_SAFE(data->threadCaches, cache, temp1)
 	{
-		return;
+		free(cache);
 	}
 
-	InitData(&g_Data);
-	g_Initialised = true;
+	data->threadCaches = NULL;
+	g_ThreadCache = NULL;
 }
 
-void MemPoolManager_ShutDown(void)
+static void FreeChain(MemPool* pool, const char* file, int line)
 {
-	if ( !g_Initialised )
+	MemPoolItemDebugInfo* debugInfo = NULL;
+	MemPoolItemDebugInfo* temp1 = NULL;
+
+	DL_FOREACH_SAFE(pool->head, debugInfo, temp1)
 	{
-		return;
+		MemPoolItemHead* item = DebugInfoToItem(debugInfo);
+		VerifyIntegrity(item, file, line);
+
+		// Items in the slab are freed all at once below.
+		if ( item->sizeClass == MEMPOOL_SLAB_NO_SIZE_CLASS )
+		{
+			free(debugInfo);
+		}
 	}
 
-	FreeData(&g_Data);
-	g_Initialised = false;
+	// Untracked items from the system allocator cannot be found here,
+	// so any that were not freed by their owners are leaked.
+	pool->head = NULL;
+	MemPoolSlab_Release(&pool->slab);
 }
 
-void* MemPoolManager_Malloc(const char* file, int line, MemPool_Category category, size_t size)
+static void CheckCountersForNewAllocation(MemPool* pool, size_t size, bool tracked, const char* file, int line)
 {
-	ENSURE_INITIALISED();
-
 	RAYGE_ENSURE(
-		(size_t)category < TOTAL_MEMPOOLS,
-		"Mem pool invocation from %s:%d: Invalid category provided to MemPoolManager_Malloc",
+		SIZE_MAX - Threading_AtomicLoadSize(&pool->totalClientMemory) >= size,
+		"Mem pool invocation from %s:%d: Request to allocate %zu client bytes would overflow pool's client memory "
+		"counter.",
 		file,
-		line
+		line,
+		size
 	);
 
-	MemPoolItemHead* head = CreateItemInPool(&g_Data.pools[(size_t)category], size, file, line);
-	return ItemToMemPtr(head);
-}
+	size_t totalSize = ItemAllocationSize(size, tracked);
 
-void* MemPoolManager_Calloc(
-	const char* file,
+	RAYGE_ENSURE(
+		SIZE_MAX - Threading_AtomicLoadSize(&pool->totalMemory) >= totalSize,
+		"Mem pool invocation from %s:%d: Request to allocate %zu client bytes would overflow pool's total memory "
+		"counter.",
+		file,
+		line,
+		size
+	);
+
+	RAYGE_ENSURE(
+		Threading_AtomicLoadSize(&pool->totalAllocations) < SIZE_MAX,
+		"Mem pool invocation from %s:%d: Request to allocate %zu client bytes would overflow pool's total allocations "
+		"counter.",
+		file,
+		line,
+		size
+	);
+}
+
+static void
+CheckCountersForAllocationRemoval(MemPool* pool, size_t clientAllocSize, bool tracked, const char* file, int line)
+{
+	RAYGE_ENSURE(
+		clientAllocSize <= Threading_AtomicLoadSize(&pool->totalClientMemory),
+		"Mem pool invocation from %s:%d: Freeing %zu bytes underflows pool's client memory counter.",
+		file,
+		line,
+		clientAllocSize
+	);
+
+	const size_t totalBytesToFree = ItemAllocationSize(clientAllocSize, tracked);
+
+	RAYGE_ENSURE(
+		totalBytesToFree <= Threading_AtomicLoadSize(&pool->totalMemory),
+		"Mem pool invocation from %s:%d: Freeing %zu total bytes underflows pool's total memory counter.",
+		file,
+		line,
+		totalBytesToFree
+	);
+
+	RAYGE_ENSURE(
+		Threading_AtomicLoadSize(&pool->totalAllocations) > 0,
+		"Mem pool invocation from %s:%d: Allocation to free but total allocations counter was zero.",
+		file,
+		line
+	);
+}
+
+// Global lock must be held.
+static void TrackItem(MemPool* pool, MemPoolItemHead* item, const char* file, int line)
+{
+	MemPoolItemDebugInfo* debugInfo = ItemDebugInfo(item);
+
+	if ( !debugInfo )
+	{
+		return;
+	}
+
+	debugInfo->allocFile = file;
+	debugInfo->allocLine = line;
+	ItemTail(item)->sentinel = TAIL_SENTINEL_VALUE;
+
+	DL_APPEND(pool->head, debugInfo);
+}
+
+// Global lock must be held.
+static void UntrackItem(MemPool* pool, MemPoolItemHead* item)
+{
+	MemPoolItemDebugInfo* debugInfo = ItemDebugInfo(item);
+
+	if ( !debugInfo )
+	{
+		return;
+	}
+
+	DL_DELETE(pool->head, debugInfo);
+	debugInfo->prev = NULL;
+	debugInfo->next = NULL;
+	ItemTail(item)->sentinel = TAIL_DEAD_SENTINEL_VALUE;
+}
+
+static MemPoolItemHead* CreateFrameItem(MemPool* pool, size_t size, const char* file, int line)
+{
+	RAYGE_ENSURE(size > 0, "Mem pool invocation from %s:%d: Invalid request to allocate zero bytes", file, line);
+
+	// Frame items are never tracked, since they are never freed individually.
+	CheckCountersForNewAllocation(pool, size, false, file, line);
+
+	const size_t totalSize = ItemAllocationSize(size, false);
+
+	Threading_Mutex_Lock(&g_Data.frameArenaLock);
+
+	FrameArenaData* frameArena = &g_Data.frameArenas[g_Data.currentFrameArena];
+	MemPoolItemHead* item = (MemPoolItemHead*)MemPoolFrameArena_Alloc(&frameArena->arena, totalSize);
+
+	if ( item )
+	{
+		frameArena->clientMemory += size;
+		frameArena->totalMemory += totalSize;
+		++frameArena->allocations;
+	}
+
+	Threading_Mutex_Unlock(&g_Data.frameArenaLock);
+
+	RAYGE_ENSURE(
+		item,
+		"Mem pool invocation from %s:%d: Could not allocate %zu total bytes (%zu requested as payload) "
+		"from frame arena",
+		file,
+		line,
+		totalSize,
+		size
+	);
+
+	item->requestedSize = size;
+	item->category = (uint16_t)pool->category;
+	item->sizeClass = MEMPOOL_SLAB_NO_SIZE_CLASS;
+	item->flags = ITEMFLAG_FRAME;
+	item->sentinel = HEAD_SENTINEL_VALUE;
+
+	AddToCounters(pool, size, totalSize);
+	return item;
+}
+
+// Frame arena lock must be held.
+static void ResetFrameArena(FrameArenaData* frameArena)
+{
+	MemPool* pool = &g_Data.pools[MEMPOOL_FRAME];
+
+	Threading_AtomicSubSize(&pool->totalClientMemory, frameArena->clientMemory);
+	const size_t totalMemory = Threading_AtomicSubSize(&pool->totalMemory, frameArena->totalMemory);
+	Threading_AtomicSubSize(&pool->totalAllocations, frameArena->allocations);
+	Threading_AtomicAddSize(&pool->lifetimeFrees, frameArena->allocations);
+
+	RearmBudget(pool, totalMemory);
+
+	frameArena->clientMemory = 0;
+	frameArena->totalMemory = 0;
+	frameArena->allocations = 0;
+
+	MemPoolFrameArena_Reset(&frameArena->arena);
+}
+
+static MemPoolItemHead* CreateItemInPool(MemPool* pool, size_t size, const char* file, int line)
+{
+	if ( pool->category == MEMPOOL_FRAME )
+	{
+		return CreateFrameItem(pool, size, file, line);
+	}
+
+	RAYGE_ENSURE(size > 0, "Mem pool invocation from %s:%d: Invalid request to allocate zero bytes", file, line);
+
+	const bool tracked = g_Data.debuggingEnabled;
+	CheckCountersForNewAllocation(pool, size, tracked, file, line);
+
+	const size_t totalSize = ItemAllocationSize(size, tracked);
+
+	if ( tracked )
+	{
+		Threading_Mutex_Lock(&g_Data.lock);
+	}
+
+	MemPoolItemHead* item = AllocateItemMemory(pool, totalSize, tracked);
+
+	if ( item )
+	{
+		item->requestedSize = size;
+		TrackItem(pool, item, file, line);
+	}
+
+	if ( tracked )
+	{
+		Threading_Mutex_Unlock(&g_Data.lock);
+	}
+
+	RAYGE_ENSURE(
+		item,
+		"Mem pool invocation from %s:%d: Could not allocate %zu total bytes (%zu requested as payload)",
+		file,
+		line,
+		totalSize,
+		size
+	);
+
+	// Keep track of how much memory is being used in this pool.
+	AddToCounters(pool, size, totalSize);
+
+	if ( MemPoolProfiler_ShouldSample() )
+	{
+		item->flags |= ITEMFLAG_SAMPLED;
+		MemPoolProfiler_RecordAlloc(ItemToMemPtr(item), size, file, line);
+	}
+
+	return item;
+}
+
+static void DestroyItemInPool(MemPool* pool, MemPoolItemHead* item, const char* file, int line)
+{
+	const size_t requestedSize = (size_t)item->requestedSize;
+	const bool tracked = ItemIsTracked(item);
+
+	CheckCountersForAllocationRemoval(pool, requestedSize, tracked, file, line);
+	RemoveFromCounters(pool, requestedSize, ItemAllocationSize(requestedSize, tracked));
+
+	if ( item->flags & ITEMFLAG_SAMPLED )
+	{
+		MemPoolProfiler_RecordFree(ItemToMemPtr(item));
+	}
+
+	if ( tracked )
+	{
+		Threading_Mutex_Lock(&g_Data.lock);
+		UntrackItem(pool, item);
+		FreeItemMemory(pool, item);
+		Threading_Mutex_Unlock(&g_Data.lock);
+	}
+	else
+	{
+		FreeItemMemory(pool, item);
+	}
+}
+
+static void InitData(ManagerData* data)
+{
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(data->pools); ++index )
+	{
+		memset(&data->pools[index], 0, sizeof(MemPool));
+		data->pools[index].category = (MemPool_Category)index;
+	}
+
+	data->debuggingEnabled = LaunchParams_GetLaunchState()->enableMemPoolDebugging;
+
+	Threading_Mutex_Init(&data->lock);
+	Threading_Mutex_Init(&data->frameArenaLock);
+	data->threadCaches = NULL;
+	data->rateWindowStartMs = wzl_get_milliseconds_monotonic();
+
+	if ( data->debuggingEnabled )
+	{
+		Logging_PrintLine(RAYGE_LOG_WARNING, "Mempool debugging is enabled. This may affect performance.");
+	}
+}
+
+static void FreeData(ManagerData* data)
+{
+	FreeThreadCaches(data);
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(data->pools); ++index )
+	{
+		FreeChain(&data->pools[index], __FILE__, __LINE__);
+	}
+
+	for ( size_t index = 0; index < NUM_FRAME_ARENAS; ++index )
+	{
+		MemPoolFrameArena_Release(&data->frameArenas[index].arena);
+	}
+
+	Threading_Mutex_Destroy(&data->lock);
+	Threading_Mutex_Destroy(&data->frameArenaLock);
+
+	memset(data, 0, sizeof(*data));
+}
+
+bool MemPoolManager_DebuggingEnabled(void)
+{
+	return g_Data.debuggingEnabled;
+}
+
+void MemPoolManager_SetDebuggingEnabled(bool enabled)
+{
+	g_Data.debuggingEnabled = g_Initialised && enabled;
+}
+
+const char* MemPoolManager_CategoryName(MemPool_Category category)
+{
+	return MemPoolName(category);
+}
+
+MemPool_Category MemPoolManager_CategoryFromName(const char* name, size_t length)
+{
+	if ( !name )
+	{
+		return MEMPOOL__COUNT;
+	}
+
+	for ( size_t index = 0; index < MEMPOOL__COUNT; ++index )
+	{
+		const char* candidate = g_MemPoolNames[index];
+		size_t charIndex = 0;
+
+		for ( ; charIndex < length && candidate[charIndex]; ++charIndex )
+		{
+			const char a = name[charIndex] == '_' ? ' ' : (char)tolower((unsigned char)name[charIndex]);
+			const char b = candidate[charIndex] == '_' ? ' ' : (char)tolower((unsigned char)candidate[charIndex]);
+
+			if ( a != b )
+			{
+				break;
+			}
+		}
+
+		if ( charIndex == length && !candidate[charIndex] )
+		{
+			return (MemPool_Category)index;
+		}
+	}
+
+	return MEMPOOL__COUNT;
+}
+
+void MemPoolManager_SetBudget(MemPool_Category category, size_t budgetBytes, MemPool_BudgetAction action)
+{
+	ENSURE_INITIALISED();
+
+	RAYGE_ASSERT((size_t)category < TOTAL_MEMPOOLS, "Invalid category provided to MemPoolManager_SetBudget");
+
+	if ( (size_t)category >= TOTAL_MEMPOOLS )
+	{
+		return;
+	}
+
+	MemPool* pool = &g_Data.pools[(size_t)category];
+
+	pool->budgetAction = action;
+	Threading_AtomicStoreSize(&pool->budget, budgetBytes);
+	Threading_AtomicStoreSize(&pool->overBudget, 0);
+
+	// Report straight away if the pool is already over the new budget.
+	CheckBudget(pool, Threading_AtomicLoadSize(&pool->totalMemory));
+}
+
+bool MemPoolManager_GetCategoryStats(MemPool_Category category, MemPool_CategoryStats* outStats)
+{
+	ENSURE_INITIALISED();
+
+	if ( (size_t)category >= TOTAL_MEMPOOLS || !outStats )
+	{
+		return false;
+	}
+
+	MemPool* pool = &g_Data.pools[(size_t)category];
+
+	outStats->clientBytes = Threading_AtomicLoadSize(&pool->totalClientMemory);
+	outStats->totalBytes = Threading_AtomicLoadSize(&pool->totalMemory);
+	outStats->liveAllocations = Threading_AtomicLoadSize(&pool->totalAllocations);
+	outStats->peakClientBytes = Threading_AtomicLoadSize(&pool->peakClientMemory);
+	outStats->peakTotalBytes = Threading_AtomicLoadSize(&pool->peakMemory);
+	outStats->lifetimeAllocations = Threading_AtomicLoadSize(&pool->lifetimeAllocations);
+	outStats->lifetimeFrees = Threading_AtomicLoadSize(&pool->lifetimeFrees);
+	outStats->allocationsLastFrame = Threading_AtomicLoadSize(&pool->allocationsLastFrame);
+	outStats->freesLastFrame = Threading_AtomicLoadSize(&pool->freesLastFrame);
+	outStats->peakAllocationsPerFrame = Threading_AtomicLoadSize(&pool->peakAllocationsPerFrame);
+	outStats->allocationsPerSecond = pool->allocationsPerSecond;
+	outStats->freesPerSecond = pool->freesPerSecond;
+	outStats->budgetBytes = Threading_AtomicLoadSize(&pool->budget);
+	outStats->budgetAction = pool->budgetAction;
+	outStats->overBudget = Threading_AtomicLoadSize(&pool->overBudget) != 0;
+
+	return true;
+}
+
+void MemPoolManager_ResetPeaks(void)
+{
+	ENSURE_INITIALISED();
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(g_Data.pools); ++index )
+	{
+		MemPool* pool = &g_Data.pools[index];
+
+		Threading_AtomicStoreSize(&pool->peakClientMemory, Threading_AtomicLoadSize(&pool->totalClientMemory));
+		Threading_AtomicStoreSize(&pool->peakMemory, Threading_AtomicLoadSize(&pool->totalMemory));
+		Threading_AtomicStoreSize(&pool->peakAllocationsPerFrame, 0);
+	}
+}
+
+void MemPoolManager_Init(void)
+{
+	if ( g_Initialised )
+	{
+		return;
+	}
+
+	++g_Generation;
+	InitData(&g_Data);
+
+	const RayGE_LaunchState* launchState = LaunchParams_GetLaunchState();
+
+	MemPoolObjectPool_Init();
+	MemPoolProfiler_Init();
+	MemPoolProfiler_SetSampleRate(launchState->memPoolProfilerSampleRate);
+	MemPoolProfiler_SetEnabled(launchState->enableMemPoolProfiler);
+	MemPoolTrace_Init();
+
+	g_Initialised = true;
+
+	// Applying budgets may log, so the manager must be usable first.
+	MemPoolBudgets_ApplyLaunchParams();
+
+	if ( launchState->memPoolTracePath )
+	{
+		MemPoolTrace_Start(launchState->memPoolTracePath);
+	}
+}
+
+void MemPoolManager_ShutDown(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	MemPoolTrace_ShutDown();
+	MemPoolProfiler_ShutDown();
+	MemPoolObjectPool_ShutDown();
+	FreeData(&g_Data);
+	g_Initialised = false;
+}
+
+void MemPoolManager_NewFrame(void)
+{
+	ENSURE_INITIALISED();
+
+	Threading_Mutex_Lock(&g_Data.frameArenaLock);
+
+	// The arena that was used two frames ago is now free to be reused.
+	g_Data.currentFrameArena = (g_Data.currentFrameArena + 1) % NUM_FRAME_ARENAS;
+	ResetFrameArena(&g_Data.frameArenas[g_Data.currentFrameArena]);
+
+	Threading_Mutex_Unlock(&g_Data.frameArenaLock);
+
+	const uint64_t nowMs = wzl_get_milliseconds_monotonic();
+	const uint64_t windowElapsedMs = nowMs - g_Data.rateWindowStartMs;
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(g_Data.pools); ++index )
+	{
+		UpdateRates(&g_Data.pools[index], windowElapsedMs);
+	}
+
+	if ( windowElapsedMs >= RATE_WINDOW_MS )
+	{
+		g_Data.rateWindowStartMs = nowMs;
+	}
+
+	MemPoolProfiler_NewFrame();
+
+	if ( MemPoolTrace_IsRecording() )
+	{
+		MemPoolTrace_RecordFrame();
+	}
+}
+
+void MemPoolManager_ReleaseThreadCache(void)
+{
+	if ( !g_Initialised || !g_ThreadCache || g_ThreadCacheGeneration != g_Generation )
+	{
+		g_ThreadCache = NULL;
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Data.lock);
+
+	for ( size_t poolIndex = 0; poolIndex < TOTAL_MEMPOOLS; ++poolIndex )
+	{
+		for ( uint8_t sizeClass = 0; sizeClass < MEMPOOL_SLAB_NUM_SIZE_CLASSES; ++sizeClass )
+		{
+			ThreadCacheBin* bin = &g_ThreadCache->bins[poolIndex][sizeClass];
+			DrainBin(&g_Data.pools[poolIndex], sizeClass, bin, bin->count);
+		}
+	}
+
+	DL_DELETE(g_Data.threadCaches, g_ThreadCache);
+
+	Threading_Mutex_Unlock(&g_Data.lock);
+
+	free(g_ThreadCache);
+	g_ThreadCache = NULL;
+}
+
+void* MemPoolManager_Malloc(const char* file, int line, MemPool_Category category, size_t size)
+{
+	ENSURE_INITIALISED();
+
+	RAYGE_ENSURE(
+		(size_t)category < TOTAL_MEMPOOLS,
+		"Mem pool invocation from %s:%d: Invalid category provided to MemPoolManager_Malloc",
+		file,
+		line
+	);
+
+	MemPoolItemHead* head = CreateItemInPool(&g_Data.pools[(size_t)category], size, file, line);
+	void* ptr = ItemToMemPtr(head);
+
+	if ( MemPoolTrace_IsRecording() )
+	{
+		MemPoolTrace_RecordAlloc(category, size, ptr, file, line);
+	}
+
+	return ptr;
+}
+
+void* MemPoolManager_Calloc(
+	const char* file,
 	int line,
 	MemPool_Category category,
 	size_t numElements,
@@ -427,6 +1244,11 @@ void* MemPoolManager_Calloc(
 	void* ptr = ItemToMemPtr(head);
 	memset(ptr, 0, numElements * elementSize);
 
+	if ( MemPoolTrace_IsRecording() )
+	{
+		MemPoolTrace_RecordAlloc(category, numElements * elementSize, ptr, file, line);
+	}
+
 	return ptr;
 }
 
@@ -447,37 +1269,99 @@ void* MemPoolManager_Realloc(const char* file, int line, MemPool_Category catego
 	}
 
 	MemPoolItemHead* item = MemPtrToItemChecked(memory, file, line);
-	CheckCountersForAllocationRemoval(item->pool, item->requestedSize, file, line);
+	MemPool* pool = ItemPool(item);
 
-	DL_DELETE(item->pool->head, item);
-	item->prev = NULL;
-	item->next = NULL;
-	ItemTail(item)->sentinel = TAIL_DEAD_SENTINEL_VALUE;
+	if ( item->flags & ITEMFLAG_FRAME )
+	{
+		// The old memory is left where it is until the arena is reset.
+		MemPoolItemHead* newItem = CreateFrameItem(pool, newSize, file, line);
+		memcpy(ItemToMemPtr(newItem), memory, RAYGE_MIN((size_t)item->requestedSize, newSize));
 
-	item->pool->totalClientMemory -= item->requestedSize;
-	item->pool->totalMemory -= ItemAllocationSize(item->requestedSize);
-	--item->pool->totalAllocations;
+		if ( MemPoolTrace_IsRecording() )
+		{
+			MemPoolTrace_RecordRealloc(
+				(MemPool_Category)newItem->category,
+				newSize,
+				memory,
+				ItemToMemPtr(newItem),
+				file,
+				line
+			);
+		}
 
-	CheckCountersForNewAllocation(item->pool, newSize, file, line);
+		return ItemToMemPtr(newItem);
+	}
 
-	const size_t newPtrMemSize = ItemAllocationSize(newSize);
-	item = (MemPoolItemHead*)realloc(item, newPtrMemSize);
+	// The item keeps whichever layout it was originally allocated with.
+	const bool tracked = ItemIsTracked(item);
+	const bool sampled = (item->flags & ITEMFLAG_SAMPLED) != 0;
+	const size_t oldSize = (size_t)item->requestedSize;
 
-	// This must be set first, before we get the tail.
-	item->requestedSize = newSize;
+	CheckCountersForAllocationRemoval(pool, oldSize, tracked, file, line);
+	RemoveFromCounters(pool, oldSize, ItemAllocationSize(oldSize, tracked));
 
-	item->allocFile = file;
-	item->allocLine = line;
+	CheckCountersForNewAllocation(pool, newSize, tracked, file, line);
 
-	ItemTail(item)->sentinel = TAIL_SENTINEL_VALUE;
+	const size_t newPtrMemSize = ItemAllocationSize(newSize, tracked);
 
-	DL_APPEND(item->pool->head, item);
+	if ( tracked )
+	{
+		Threading_Mutex_Lock(&g_Data.lock);
+		UntrackItem(pool, item);
+	}
 
-	item->pool->totalClientMemory += item->requestedSize;
-	item->pool->totalMemory += newPtrMemSize;
-	++item->pool->totalAllocations;
+	MemPoolItemHead* newItem =
+		ItemCanHoldAllocation(item, newPtrMemSize) ? item : ReallocItemMemory(pool, item, newPtrMemSize);
 
-	return ItemToMemPtr(item);
+	if ( newItem )
+	{
+		// This must be set first, before we get the tail.
+		newItem->requestedSize = newSize;
+		TrackItem(pool, newItem, file, line);
+	}
+	else
+	{
+		// Put the original item back before bailing out.
+		TrackItem(pool, item, file, line);
+	}
+
+	if ( tracked )
+	{
+		Threading_Mutex_Unlock(&g_Data.lock);
+	}
+
+	// Must not be called while the lock is held, since
+	// the error may cause more allocations to be made.
+	RAYGE_ENSURE(
+		newItem,
+		"Mem pool invocation from %s:%d: Could not reallocate to %zu total bytes (%zu requested as payload)",
+		file,
+		line,
+		newPtrMemSize,
+		newSize
+	);
+
+	AddToCounters(pool, newSize, newPtrMemSize);
+
+	if ( sampled )
+	{
+		newItem->flags |= ITEMFLAG_SAMPLED;
+		MemPoolProfiler_RecordRealloc(memory, ItemToMemPtr(newItem), newSize, file, line);
+	}
+
+	if ( MemPoolTrace_IsRecording() )
+	{
+		MemPoolTrace_RecordRealloc(
+			(MemPool_Category)newItem->category,
+			newSize,
+			memory,
+			ItemToMemPtr(newItem),
+			file,
+			line
+		);
+	}
+
+	return ItemToMemPtr(newItem);
 }
 
 void MemPoolManager_Free(const char* file, int line, void* memory)
@@ -486,7 +1370,19 @@ void MemPoolManager_Free(const char* file, int line, void* memory)
 	RAYGE_ENSURE(memory, "Mem pool invocation from %s:%d: Null pointer provided to MemPoolManager_Free", file, line);
 
 	MemPoolItemHead* item = MemPtrToItemChecked(memory, file, line);
-	DestroyItemInPool(item->pool, item, file, line);
+
+	if ( item->flags & ITEMFLAG_FRAME )
+	{
+		// Released when the frame arena is reset.
+		return;
+	}
+
+	if ( MemPoolTrace_IsRecording() )
+	{
+		MemPoolTrace_RecordFree(memory, file, line);
+	}
+
+	DestroyItemInPool(ItemPool(item), item, file, line);
 }
 
 void MemPoolManager_DumpAllocInfo(void* memory)
@@ -508,11 +1404,18 @@ void MemPoolManager_DumpAllocInfo(void* memory)
 
 	LOG("==== Allocation info for 0x%p ====", memory);
 	LOG("  Head sentinel: 0x%08X", item->sentinel);
-	LOG("  Tail sentinel: 0x%08X", tail->sentinel);
-	LOG("  Pool: %s (%d)",
-		item->pool ? MemPoolName(item->pool->category) : "UNKNOWN",
-		item->pool ? (int)item->pool->category : -1);
-	LOG("  Requested allocation size: %zu bytes", item->requestedSize);
+
+	if ( tail )
+	{
+		LOG("  Tail sentinel: 0x%08X", tail->sentinel);
+	}
+	else
+	{
+		LOG("  Tail sentinel: <none, allocated while debugging was disabled>");
+	}
+
+	LOG("  Pool: %s (%d)", MemPoolName((MemPool_Category)item->category), (int)item->category);
+	LOG("  Requested allocation size: %zu bytes", (size_t)item->requestedSize);
 	LOG("  Allocated from: %s:%d", SafeFileNameString(item), SafeFileLineNumber(item));
 
 #undef LOG
@@ -534,17 +1437,52 @@ void MemPoolManager_DumpAllAllocInfo(void)
 
 		Logging_PrintLine(
 			RAYGE_LOG_INFO,
-			"Mempool %s (%zu) has %zu bytes allocated (%zu including overhead) across %zu allocations",
+			"Mempool %s (%zu) has %zu bytes allocated (%zu including overhead, peak %zu) across %zu allocations, "
+			"using %zu slab pages",
 			MemPoolName((MemPool_Category)index),
 			index,
 			pool->totalClientMemory,
 			pool->totalMemory,
-			pool->totalAllocations
+			pool->peakMemory,
+			pool->totalAllocations,
+			pool->slab.numPages
 		);
 
-		for ( MemPoolItemHead* item = pool->head; item; item = item->next )
+		MemPool_ObjectPoolStats objectPoolStats;
+		MemPoolObjectPool_GetCategoryStats((MemPool_Category)index, &objectPoolStats);
+
+		if ( objectPoolStats.numPools > 0 )
+		{
+			const size_t slotsUsed = objectPoolStats.liveObjects + objectPoolStats.freeSlots;
+
+			Logging_PrintLine(
+				RAYGE_LOG_INFO,
+				"%zu object pools have %zu of %zu slots in use across %zu chunks (%.1f%% occupancy, %.1f%% "
+				"fragmentation)",
+				objectPoolStats.numPools,
+				objectPoolStats.liveObjects,
+				objectPoolStats.capacity,
+				objectPoolStats.numChunks,
+				objectPoolStats.capacity > 0
+					? 100.0 * (double)objectPoolStats.liveObjects / (double)objectPoolStats.capacity
+					: 0.0,
+				slotsUsed > 0 ? 100.0 * (double)objectPoolStats.freeSlots / (double)slotsUsed : 0.0
+			);
+		}
+
+		for ( MemPoolItemDebugInfo* debugInfo = pool->head; debugInfo; debugInfo = debugInfo->next )
+		{
+			MemPoolManager_DumpAllocInfo(ItemToMemPtr(DebugInfoToItem(debugInfo)));
+		}
+
+		if ( index == MEMPOOL_FRAME )
 		{
-			MemPoolManager_DumpAllocInfo((uint8_t*)item + sizeof(*item));
+			Logging_PrintLine(
+				RAYGE_LOG_INFO,
+				"Frame arenas have %zu and %zu bytes reserved",
+				MemPoolFrameArena_ReservedBytes(&g_Data.frameArenas[0].arena),
+				MemPoolFrameArena_ReservedBytes(&g_Data.frameArenas[1].arena)
+			);
 		}
 
 		Logging_PrintLineStr(RAYGE_LOG_INFO, "");
@@ -563,6 +1501,7 @@ void MemPoolManager_TestRealloc(void)
 	size_t allocationsBefore = pool->totalAllocations;
 	size_t clientMemoryBefore = pool->totalClientMemory;
 	size_t totalMemoryBefore = pool->totalMemory;
+	const bool tracked = g_Data.debuggingEnabled;
 
 	TEST_EXPECT_EQL_INT(allocationsBefore, 0);
 	TEST_EXPECT_EQL_INT(clientMemoryBefore, 0);
@@ -572,13 +1511,13 @@ void MemPoolManager_TestRealloc(void)
 
 	TEST_EXPECT_EQL_INT(pool->totalAllocations, allocationsBefore + 1);
 	TEST_EXPECT_EQL_INT(pool->totalClientMemory, clientMemoryBefore + 32);
-	TEST_EXPECT_EQL_INT(pool->totalMemory, totalMemoryBefore + sizeof(MemPoolItemHead) + 32 + sizeof(MemPoolItemTail));
+	TEST_EXPECT_EQL_INT(pool->totalMemory, totalMemoryBefore + ItemAllocationSize(32, tracked));
 
 	ptr = MEMPOOL_REALLOC(MEMPOOL_TEST_POOL, ptr, 64);
 
 	TEST_EXPECT_EQL_INT(pool->totalAllocations, allocationsBefore + 1);
 	TEST_EXPECT_EQL_INT(pool->totalClientMemory, clientMemoryBefore + 64);
-	TEST_EXPECT_EQL_INT(pool->totalMemory, totalMemoryBefore + sizeof(MemPoolItemHead) + 64 + sizeof(MemPoolItemTail));
+	TEST_EXPECT_EQL_INT(pool->totalMemory, totalMemoryBefore + ItemAllocationSize(64, tracked));
 
 	MEMPOOL_FREE(ptr);
 
@@ -586,4 +1525,338 @@ void MemPoolManager_TestRealloc(void)
 	TEST_EXPECT_EQL_INT(pool->totalClientMemory, clientMemoryBefore);
 	TEST_EXPECT_EQL_INT(pool->totalMemory, totalMemoryBefore);
 }
+
+void MemPoolManager_TestSlabAllocations(void)
+{
+	if ( !TEST_EXPECT_TRUE(g_Initialised) )
+	{
+		return;
+	}
+
+	MemPool* pool = &g_Data.pools[MEMPOOL_TEST_POOL];
+
+	uint8_t* neighbours[16];
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(neighbours) / 2; ++index )
+	{
+		neighbours[index] = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_TEST_POOL, 16);
+		memset(neighbours[index], 0xAB, 16);
+	}
+
+	// Small allocations should come from the slab,
+	// and freed blocks should be reused straight away.
+	uint8_t* small = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_TEST_POOL, 16);
+	TEST_EXPECT_NEQL_INT(MemPtrToItem(small)->sizeClass, MEMPOOL_SLAB_NO_SIZE_CLASS);
+	TEST_EXPECT_TRUE(pool->slab.numPages > 0);
+
+	MEMPOOL_FREE(small);
+
+	uint8_t* reused = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_TEST_POOL, 16);
+	TEST_EXPECT_TRUE(reused == small);
+
+	for ( size_t index = 0; index < 16; ++index )
+	{
+		reused[index] = (uint8_t)index;
+	}
+
+	// These surround the block that the shrinking reallocation below
+	// ends up in, whichever order the slab hands out blocks in, and
+	// must not be trashed by it.
+	for ( size_t index = RAYGE_ARRAY_SIZE(neighbours) / 2; index < RAYGE_ARRAY_SIZE(neighbours); ++index )
+	{
+		neighbours[index] = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_TEST_POOL, 16);
+		memset(neighbours[index], 0xAB, 16);
+	}
+
+	// Growing past the largest size class should move the
+	// allocation to the system allocator, and back again.
+	uint8_t* large = (uint8_t*)MEMPOOL_REALLOC(MEMPOOL_TEST_POOL, reused, 4 * MEMPOOL_SLAB_MAX_BLOCK_SIZE);
+	TEST_EXPECT_EQL_INT(MemPtrToItem(large)->sizeClass, MEMPOOL_SLAB_NO_SIZE_CLASS);
+	TEST_EXPECT_EQL_INT(large[15], 15);
+
+	uint8_t* shrunk = (uint8_t*)MEMPOOL_REALLOC(MEMPOOL_TEST_POOL, large, 16);
+	TEST_EXPECT_NEQL_INT(MemPtrToItem(shrunk)->sizeClass, MEMPOOL_SLAB_NO_SIZE_CLASS);
+	TEST_EXPECT_EQL_INT(shrunk[0], 0);
+	TEST_EXPECT_EQL_INT(shrunk[15], 15);
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(neighbours); ++index )
+	{
+		TEST_EXPECT_EQL_INT(MemPtrToItem(neighbours[index])->category, MEMPOOL_TEST_POOL);
+		TEST_EXPECT_EQL_INT(neighbours[index][0], 0xAB);
+		MEMPOOL_FREE(neighbours[index]);
+	}
+
+	MEMPOOL_FREE(shrunk);
+
+	TEST_EXPECT_EQL_INT(pool->totalAllocations, 0);
+	TEST_EXPECT_EQL_INT(pool->totalClientMemory, 0);
+	TEST_EXPECT_EQL_INT(pool->totalMemory, 0);
+}
+
+void MemPoolManager_TestCompactLayout(void)
+{
+	if ( !TEST_EXPECT_TRUE(g_Initialised) )
+	{
+		return;
+	}
+
+	MemPool* pool = &g_Data.pools[MEMPOOL_TEST_POOL];
+	const bool debuggingWasEnabled = g_Data.debuggingEnabled;
+
+	TEST_EXPECT_EQL_INT(sizeof(MemPoolItemHead), 16);
+
+	// Items allocated without debugging only pay for the head.
+	MemPoolManager_SetDebuggingEnabled(false);
+	uint8_t* compact = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_TEST_POOL, 24);
+	TEST_EXPECT_FALSE(ItemIsTracked(MemPtrToItem(compact)));
+	TEST_EXPECT_EQL_INT(MemPtrToItem(compact)->category, MEMPOOL_TEST_POOL);
+	TEST_EXPECT_EQL_INT(pool->totalMemory, sizeof(MemPoolItemHead) + 24);
+	TEST_EXPECT_TRUE(pool->head == NULL);
+
+	// Items with either layout must be able to be freed
+	// regardless of whether debugging is currently enabled.
+	MemPoolManager_SetDebuggingEnabled(true);
+	uint8_t* tracked = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_TEST_POOL, 24);
+	TEST_EXPECT_TRUE(ItemIsTracked(MemPtrToItem(tracked)));
+	TEST_EXPECT_TRUE(pool->head != NULL);
+
+	compact = (uint8_t*)MEMPOOL_REALLOC(MEMPOOL_TEST_POOL, compact, 48);
+	TEST_EXPECT_FALSE(ItemIsTracked(MemPtrToItem(compact)));
+
+	MEMPOOL_FREE(compact);
+
+	MemPoolManager_SetDebuggingEnabled(false);
+	MEMPOOL_FREE(tracked);
+
+	TEST_EXPECT_TRUE(pool->head == NULL);
+	TEST_EXPECT_EQL_INT(pool->totalAllocations, 0);
+	TEST_EXPECT_EQL_INT(pool->totalMemory, 0);
+
+	MemPoolManager_SetDebuggingEnabled(debuggingWasEnabled);
+}
+
+void MemPoolManager_TestFrameArena(void)
+{
+	if ( !TEST_EXPECT_TRUE(g_Initialised) )
+	{
+		return;
+	}
+
+	MemPool* pool = &g_Data.pools[MEMPOOL_FRAME];
+
+	// Make sure we start from a clean slate.
+	MemPoolManager_NewFrame();
+	MemPoolManager_NewFrame();
+
+	TEST_EXPECT_EQL_INT(pool->totalAllocations, 0);
+
+	uint32_t* values = (uint32_t*)MEMPOOL_MALLOC(MEMPOOL_FRAME, 4 * sizeof(uint32_t));
+	TEST_EXPECT_TRUE(MemPtrToItem(values)->flags & ITEMFLAG_FRAME);
+	TEST_EXPECT_EQL_INT((size_t)values % MEMPOOL_FRAMEARENA_ALIGNMENT, 0);
+	TEST_EXPECT_EQL_INT(pool->totalAllocations, 1);
+
+	for ( uint32_t index = 0; index < 4; ++index )
+	{
+		values[index] = index + 1;
+	}
+
+	// Freeing does nothing until the arena is reset.
+	MEMPOOL_FREE(values);
+	TEST_EXPECT_EQL_INT(pool->totalAllocations, 1);
+
+	values = (uint32_t*)MEMPOOL_REALLOC(MEMPOOL_FRAME, values, 8 * sizeof(uint32_t));
+	TEST_EXPECT_EQL_INT(values[3], 4);
+	TEST_EXPECT_EQL_INT(pool->totalAllocations, 2);
+
+	// Overflow the arena, so that it must grow.
+	const size_t overflowSize = 2 * MEMPOOL_FRAMEARENA_INITIAL_CAPACITY;
+	uint8_t* large = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_FRAME, overflowSize);
+	large[overflowSize - 1] = 0xFF;
+
+	// Memory from the previous frame must still be valid.
+	MemPoolManager_NewFrame();
+	TEST_EXPECT_EQL_INT(values[3], 4);
+	TEST_EXPECT_EQL_INT(large[overflowSize - 1], 0xFF);
+	TEST_EXPECT_EQL_INT(pool->totalAllocations, 3);
+
+	MemPoolManager_NewFrame();
+	TEST_EXPECT_EQL_INT(pool->totalAllocations, 0);
+	TEST_EXPECT_EQL_INT(pool->totalClientMemory, 0);
+	TEST_EXPECT_EQL_INT(pool->totalMemory, 0);
+
+	MemPoolFrameArena* arena = &g_Data.frameArenas[g_Data.currentFrameArena].arena;
+	TEST_EXPECT_TRUE(arena->capacity > overflowSize);
+	TEST_EXPECT_TRUE(arena->overflowChunks == NULL);
+
+	// Now that the arena has grown, the same workload should not overflow.
+	uint8_t* again = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_FRAME, overflowSize);
+	TEST_EXPECT_TRUE(again >= arena->base && again < arena->base + arena->capacity);
+	TEST_EXPECT_TRUE(arena->overflowChunks == NULL);
+
+	MemPoolManager_NewFrame();
+	MemPoolManager_NewFrame();
+}
+
+#define TEST_NUM_THREADS 4
+#define TEST_NUM_ITERATIONS 2000
+#define TEST_NUM_LIVE_ITEMS 32
+
+static void TestThreadCachesWorker(void* userData)
+{
+	(void)userData;
+
+	void* items[TEST_NUM_LIVE_ITEMS];
+	memset(items, 0, sizeof(items));
+
+	for ( size_t iteration = 0; iteration < TEST_NUM_ITERATIONS; ++iteration )
+	{
+		const size_t index = iteration % TEST_NUM_LIVE_ITEMS;
+
+		if ( items[index] )
+		{
+			MEMPOOL_FREE(items[index]);
+		}
+
+		// Cover a spread of size classes, plus the odd large allocation.
+		const size_t size = iteration % 97 == 0 ? 4096 : 8 + ((iteration * 37) % 512);
+		items[index] = MEMPOOL_MALLOC(MEMPOOL_TEST_POOL, size);
+		memset(items[index], (int)(iteration & 0xFF), size);
+	}
+
+	for ( size_t index = 0; index < TEST_NUM_LIVE_ITEMS; ++index )
+	{
+		if ( items[index] )
+		{
+			MEMPOOL_FREE(items[index]);
+		}
+	}
+
+	MemPoolManager_ReleaseThreadCache();
+}
+
+void MemPoolManager_TestThreadCaches(void)
+{
+	if ( !TEST_EXPECT_TRUE(g_Initialised) )
+	{
+		return;
+	}
+
+	MemPool* pool = &g_Data.pools[MEMPOOL_TEST_POOL];
+	const size_t initialAllocations = pool->totalAllocations;
+	const size_t initialMemory = pool->totalMemory;
+
+	Threading_Thread threads[TEST_NUM_THREADS];
+
+	for ( size_t index = 0; index < TEST_NUM_THREADS; ++index )
+	{
+		TEST_EXPECT_TRUE(Threading_Thread_Create(&threads[index], &TestThreadCachesWorker, NULL));
+	}
+
+	// Churn on this thread at the same time.
+	TestThreadCachesWorker(NULL);
+
+	for ( size_t index = 0; index < TEST_NUM_THREADS; ++index )
+	{
+		Threading_Thread_Join(&threads[index]);
+	}
+
+	TEST_EXPECT_EQL_INT(pool->totalAllocations, initialAllocations);
+	TEST_EXPECT_EQL_INT(pool->totalMemory, initialMemory);
+
+	// All caches should have been released.
+	TEST_EXPECT_TRUE(g_ThreadCache == NULL);
+	TEST_EXPECT_TRUE(g_Data.threadCaches == NULL);
+}
+
+void MemPoolManager_TestBudgets(void)
+{
+	if ( !TEST_EXPECT_TRUE(g_Initialised) )
+	{
+		return;
+	}
+
+	TEST_EXPECT_EQL_INT(MemPoolManager_CategoryFromName("Renderer", 8), MEMPOOL_RENDERER);
+	TEST_EXPECT_EQL_INT(MemPoolManager_CategoryFromName("resource_management", 19), MEMPOOL_RESOURCE_MANAGEMENT);
+	TEST_EXPECT_EQL_INT(MemPoolManager_CategoryFromName("Render", 6), MEMPOOL__COUNT);
+	TEST_EXPECT_EQL_INT(MemPoolManager_CategoryFromName("Renderers", 9), MEMPOOL__COUNT);
+
+	// Start from a clean frame, so that the rates only include what we do here.
+	MemPoolManager_NewFrame();
+	MemPoolManager_ResetPeaks();
+
+	MemPool_CategoryStats before;
+	TEST_EXPECT_TRUE(MemPoolManager_GetCategoryStats(MEMPOOL_TEST_POOL, &before));
+	TEST_EXPECT_EQL_INT(before.totalBytes, 0);
+	TEST_EXPECT_EQL_INT(before.peakTotalBytes, 0);
+	TEST_EXPECT_EQL_INT(before.budgetBytes, 0);
+
+	void* items[4];
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(items); ++index )
+	{
+		items[index] = MEMPOOL_MALLOC(MEMPOOL_TEST_POOL, 64);
+	}
+
+	MemPool_CategoryStats stats;
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_POOL, &stats);
+	const size_t fullUsage = stats.totalBytes;
+
+	TEST_EXPECT_EQL_INT(stats.clientBytes, 4 * 64);
+	TEST_EXPECT_EQL_INT(stats.peakClientBytes, 4 * 64);
+	TEST_EXPECT_EQL_INT(stats.peakTotalBytes, fullUsage);
+	TEST_EXPECT_EQL_INT(stats.lifetimeAllocations, before.lifetimeAllocations + 4);
+
+	// The high-water mark stays put when memory is freed.
+	MEMPOOL_FREE(items[3]);
+	items[3] = NULL;
+
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_POOL, &stats);
+	TEST_EXPECT_EQL_INT(stats.clientBytes, 3 * 64);
+	TEST_EXPECT_EQL_INT(stats.peakTotalBytes, fullUsage);
+	TEST_EXPECT_EQL_INT(stats.lifetimeFrees, before.lifetimeFrees + 1);
+
+	MemPoolManager_NewFrame();
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_POOL, &stats);
+	TEST_EXPECT_EQL_INT(stats.allocationsLastFrame, 4);
+	TEST_EXPECT_EQL_INT(stats.freesLastFrame, 1);
+	TEST_EXPECT_TRUE(stats.peakAllocationsPerFrame >= 4);
+
+	// Going over the budget should be reported once.
+	const size_t budget = stats.totalBytes;
+	MemPoolManager_SetBudget(MEMPOOL_TEST_POOL, budget, MEMPOOL_BUDGET_WARN);
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_POOL, &stats);
+	TEST_EXPECT_EQL_INT(stats.budgetBytes, budget);
+	TEST_EXPECT_EQL_INT(stats.budgetAction, MEMPOOL_BUDGET_WARN);
+	TEST_EXPECT_FALSE(stats.overBudget);
+
+	items[3] = MEMPOOL_MALLOC(MEMPOOL_TEST_POOL, 64);
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_POOL, &stats);
+	TEST_EXPECT_TRUE(stats.overBudget);
+
+	// Dropping back to the budget is not enough to re-arm the report.
+	MEMPOOL_FREE(items[3]);
+	items[3] = NULL;
+
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_POOL, &stats);
+	TEST_EXPECT_TRUE(stats.overBudget);
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(items); ++index )
+	{
+		if ( items[index] )
+		{
+			MEMPOOL_FREE(items[index]);
+		}
+	}
+
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_POOL, &stats);
+	TEST_EXPECT_FALSE(stats.overBudget);
+	TEST_EXPECT_EQL_INT(stats.totalBytes, 0);
+
+	MemPoolManager_SetBudget(MEMPOOL_TEST_POOL, 0, MEMPOOL_BUDGET_WARN);
+	MemPoolManager_ResetPeaks();
+
+	MemPoolManager_GetCategoryStats(MEMPOOL_TEST_POOL, &stats);
+	TEST_EXPECT_EQL_INT(stats.budgetBytes, 0);
+	TEST_EXPECT_EQL_INT(stats.peakTotalBytes, 0);
+}
 #endif
@@ -20,6 +20,7 @@
 	LIST_ITEM(MEMPOOL_RESOURCE_MANAGEMENT, "Resource Management") \
 	LIST_ITEM(MEMPOOL_RAYLIB, "Raylib") \
 	LIST_ITEM(MEMPOOL_TEST_MANAGER, "Test Manager") \
+	LIST_ITEM(MEMPOOL_FRAME, "Frame") \
 	LIST_ITEM(MEMPOOL__COUNT, "##COUNT##")
 
 typedef enum MemPool_Category
@@ -29,15 +30,95 @@ typedef enum MemPool_Category
 #undef LIST_ITEM
 } MemPool_Category;
 
+// What happens when a category's memory usage goes over its budget.
+typedef enum MemPool_BudgetAction
+{
+	MEMPOOL_BUDGET_WARN = 0,
+	MEMPOOL_BUDGET_FATAL
+} MemPool_BudgetAction;
+
+typedef struct MemPool_CategoryStats
+{
+	size_t clientBytes;  // Sizes of all allocations requested
+	size_t totalBytes;  // Including per-allocation overhead
+	size_t liveAllocations;
+
+	// High-water marks, since initialisation or since the
+	// last call to MemPoolManager_ResetPeaks().
+	size_t peakClientBytes;
+	size_t peakTotalBytes;
+
+	// Reallocations count as both a free and an allocation.
+	size_t lifetimeAllocations;
+	size_t lifetimeFrees;
+
+	// Measured over the most recently completed frame.
+	size_t allocationsLastFrame;
+	size_t freesLastFrame;
+	size_t peakAllocationsPerFrame;
+
+	// Measured over roughly the last second of frames.
+	double allocationsPerSecond;
+	double freesPerSecond;
+
+	// Zero if the category has no budget.
+	size_t budgetBytes;
+	MemPool_BudgetAction budgetAction;
+	bool overBudget;
+} MemPool_CategoryStats;
+
 void MemPoolManager_Init(void);
 void MemPoolManager_ShutDown(void);
 
+// Should be called once at the beginning of each frame.
+// Allocations made in the MEMPOOL_FRAME category come from a
+// per-frame arena, and remain valid until the end of the frame
+// after the one in which they were allocated. Calling
+// MEMPOOL_FREE() on these allocations is allowed, but does
+// nothing, so they can be passed to code that expects to
+// free what it is given.
+void MemPoolManager_NewFrame(void);
+
+// Allocation and free functions may be called from any thread.
+// Each thread keeps a small cache of free blocks, which should
+// be returned by calling this function before the thread exits.
+// If it is not called, the blocks are reclaimed on shut down.
+void MemPoolManager_ReleaseThreadCache(void);
+
 // Reset once the manager is shut down.
 // Defaults to true if the engine is built in debug mode,
-// or false otherwise.
+// or false otherwise. Allocations made while debugging is
+// enabled record where they were allocated from and are
+// guarded by sentinels; other allocations only record
+// their category and size.
 bool MemPoolManager_DebuggingEnabled(void);
 void MemPoolManager_SetDebuggingEnabled(bool enabled);
 
+const char* MemPoolManager_CategoryName(MemPool_Category category);
+
+// Matching is case-insensitive, and spaces and underscores are
+// treated as equivalent, so "resource_management" matches
+// "Resource Management". Returns MEMPOOL__COUNT if no category
+// matched.
+MemPool_Category MemPoolManager_CategoryFromName(const char* name, size_t length);
+
+// The budget applies to the total memory used by the category,
+// including per-allocation overhead. A budget of zero removes
+// any existing budget. When an allocation takes a category over
+// its budget, the action is taken once; it is not taken again
+// until the category's usage has dropped back below seven eighths
+// of the budget. Budgets are reset once the manager is shut down.
+void MemPoolManager_SetBudget(MemPool_Category category, size_t budgetBytes, MemPool_BudgetAction action);
+
+// May be called from any thread, though the values
+// in the struct are not guaranteed to be consistent
+// with each other if other threads are allocating.
+// Returns false if the category was not valid.
+bool MemPoolManager_GetCategoryStats(MemPool_Category category, MemPool_CategoryStats* outStats);
+
+// Resets the high-water marks for all categories to their current usage.
+void MemPoolManager_ResetPeaks(void);
+
 WZL_ATTR_NODISCARD void* MemPoolManager_Malloc(const char* file, int line, MemPool_Category category, size_t size);
 
 WZL_ATTR_NODISCARD void*
@@ -50,6 +131,7 @@ void MemPoolManager_Free(const char* file, int line, void* memory);
 
 // Prints information about the allocation to the logs.
 // Debugging must be enabled (see MemPoolManager_DebuggingEnabled()).
+// These should only be called while no other threads are allocating.
 void MemPoolManager_DumpAllocInfo(void* memory);
 void MemPoolManager_DumpAllAllocInfo(void);
 
@@ -65,4 +147,9 @@ void MemPoolManager_DumpAllAllocInfo(void);
 
 #if RAYGE_BUILD_TESTING()
 void MemPoolManager_TestRealloc(void);
+void MemPoolManager_TestSlabAllocations(void);
+void MemPoolManager_TestCompactLayout(void);
+void MemPoolManager_TestFrameArena(void);
+void MemPoolManager_TestThreadCaches(void);
+void MemPoolManager_TestBudgets(void);
 #endif
@@ -0,0 +1,369 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "MemPool/MemPoolObjectPool.h"
+#include "Threading/Threading.h"
+#include "Debugging.h"
+#include "Utils/Utils.h"
+#include "utlist.h"
+
+#define ALIGN_SIZE(size) \
+	((((size) + MEMPOOL_OBJECTPOOL_ALIGNMENT - 1) / MEMPOOL_OBJECTPOOL_ALIGNMENT) * MEMPOOL_OBJECTPOOL_ALIGNMENT)
+
+typedef struct Chunk
+{
+	struct Chunk* next;
+} Chunk;
+
+#define CHUNK_HEADER_SIZE ALIGN_SIZE(sizeof(Chunk))
+
+typedef struct FreeSlot
+{
+	struct FreeSlot* next;
+} FreeSlot;
+
+struct MemPool_ObjectPool
+{
+	struct MemPool_ObjectPool* prev;
+	struct MemPool_ObjectPool* next;
+
+	MemPool_Category category;
+	size_t slotSize;
+	size_t objectsPerChunk;
+
+	Chunk* chunks;
+	size_t numChunks;
+
+	// Slots in the most recent chunk which have not yet been used.
+	uint8_t* carveBegin;
+	uint8_t* carveEnd;
+
+	FreeSlot* freeList;
+	size_t numFreeSlots;
+	size_t numLiveObjects;
+};
+
+typedef struct Registry
+{
+	Threading_Mutex lock;
+	MemPool_ObjectPool* pools;
+} Registry;
+
+static Registry g_Registry;
+static bool g_Initialised = false;
+
+static bool CreateChunk(MemPool_ObjectPool* pool)
+{
+	const size_t chunkSize = CHUNK_HEADER_SIZE + (pool->slotSize * pool->objectsPerChunk);
+	Chunk* chunk = (Chunk*)MEMPOOL_MALLOC(pool->category, chunkSize);
+
+	if ( !chunk )
+	{
+		return false;
+	}
+
+	chunk->next = pool->chunks;
+	pool->chunks = chunk;
+	++pool->numChunks;
+
+	pool->carveBegin = (uint8_t*)chunk + CHUNK_HEADER_SIZE;
+	pool->carveEnd = (uint8_t*)chunk + chunkSize;
+
+	return true;
+}
+
+static bool PoolOwnsObject(const MemPool_ObjectPool* pool, const void* object)
+{
+	const size_t chunkDataSize = pool->slotSize * pool->objectsPerChunk;
+
+	for ( const Chunk* chunk = pool->chunks; chunk; chunk = chunk->next )
+	{
+		const uint8_t* begin = (const uint8_t*)chunk + CHUNK_HEADER_SIZE;
+
+		if ( (const uint8_t*)object >= begin && (const uint8_t*)object < begin + chunkDataSize )
+		{
+			return ((size_t)((const uint8_t*)object - begin) % pool->slotSize) == 0;
+		}
+	}
+
+	return false;
+}
+
+static void AddToStats(const MemPool_ObjectPool* pool, MemPool_ObjectPoolStats* stats)
+{
+	++stats->numPools;
+	stats->numChunks += pool->numChunks;
+	stats->capacity += pool->numChunks * pool->objectsPerChunk;
+	stats->liveObjects += pool->numLiveObjects;
+	stats->freeSlots += pool->numFreeSlots;
+}
+
+void MemPoolObjectPool_Init(void)
+{
+	if ( g_Initialised )
+	{
+		return;
+	}
+
+	memset(&g_Registry, 0, sizeof(g_Registry));
+	Threading_Mutex_Init(&g_Registry.lock);
+
+	g_Initialised = true;
+}
+
+void MemPoolObjectPool_ShutDown(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	// Pools which were not destroyed by their owners must be destroyed
+	// here. Their chunks may come from the system allocator, and the mem
+	// pool manager cannot find untracked items in order to free them.
+	while ( g_Registry.pools )
+	{
+		MemPoolObjectPool_Destroy(g_Registry.pools);
+	}
+
+	Threading_Mutex_Destroy(&g_Registry.lock);
+	memset(&g_Registry, 0, sizeof(g_Registry));
+
+	g_Initialised = false;
+}
+
+MemPool_ObjectPool* MemPoolObjectPool_Create(MemPool_Category category, size_t objectSize, size_t objectsPerChunk)
+{
+	RAYGE_ENSURE(g_Initialised, "Object pool module was not initialised");
+	RAYGE_ENSURE(objectSize > 0, "Object pool: Expected a non-zero object size");
+	RAYGE_ENSURE(objectsPerChunk > 0, "Object pool: Expected a non-zero number of objects per chunk");
+
+	MemPool_ObjectPool* pool = MEMPOOL_CALLOC_STRUCT(category, MemPool_ObjectPool);
+
+	pool->category = category;
+	pool->slotSize = ALIGN_SIZE(objectSize < sizeof(FreeSlot) ? sizeof(FreeSlot) : objectSize);
+	pool->objectsPerChunk = objectsPerChunk;
+
+	Threading_Mutex_Lock(&g_Registry.lock);
+	DL_APPEND(g_Registry.pools, pool);
+	Threading_Mutex_Unlock(&g_Registry.lock);
+
+	return pool;
+}
+
+void MemPoolObjectPool_Destroy(MemPool_ObjectPool* pool)
+{
+	if ( !pool )
+	{
+		return;
+	}
+
+	if ( g_Initialised )
+	{
+		Threading_Mutex_Lock(&g_Registry.lock);
+		DL_DELETE(g_Registry.pools, pool);
+		Threading_Mutex_Unlock(&g_Registry.lock);
+	}
+
+	Chunk* chunk = pool->chunks;
+
+	while ( chunk )
+	{
+		Chunk* next = chunk->next;
+		MEMPOOL_FREE(chunk);
+		chunk = next;
+	}
+
+	MEMPOOL_FREE(pool);
+}
+
+void* MemPoolObjectPool_Alloc(MemPool_ObjectPool* pool)
+{
+	RAYGE_ASSERT_VALID(pool);
+
+	if ( !pool )
+	{
+		return NULL;
+	}
+
+	void* object = NULL;
+
+	if ( pool->freeList )
+	{
+		FreeSlot* slot = pool->freeList;
+		pool->freeList = slot->next;
+		--pool->numFreeSlots;
+
+		object = slot;
+	}
+	else
+	{
+		if ( pool->carveBegin >= pool->carveEnd && !CreateChunk(pool) )
+		{
+			return NULL;
+		}
+
+		object = pool->carveBegin;
+		pool->carveBegin += pool->slotSize;
+	}
+
+	++pool->numLiveObjects;
+	return object;
+}
+
+void* MemPoolObjectPool_Calloc(MemPool_ObjectPool* pool)
+{
+	void* object = MemPoolObjectPool_Alloc(pool);
+
+	if ( object )
+	{
+		memset(object, 0, pool->slotSize);
+	}
+
+	return object;
+}
+
+void MemPoolObjectPool_Free(MemPool_ObjectPool* pool, void* object)
+{
+	RAYGE_ASSERT_VALID(pool);
+
+	if ( !pool || !object )
+	{
+		return;
+	}
+
+	RAYGE_ASSERT(PoolOwnsObject(pool, object), "Object pool: Object %p was not allocated from this pool", object);
+	RAYGE_ASSERT(pool->numLiveObjects > 0, "Object pool: Attempted to free more objects than were allocated");
+
+	FreeSlot* slot = (FreeSlot*)object;
+	slot->next = pool->freeList;
+	pool->freeList = slot;
+	++pool->numFreeSlots;
+
+	--pool->numLiveObjects;
+}
+
+void MemPoolObjectPool_GetStats(const MemPool_ObjectPool* pool, MemPool_ObjectPoolStats* outStats)
+{
+	if ( !outStats )
+	{
+		return;
+	}
+
+	memset(outStats, 0, sizeof(*outStats));
+
+	if ( pool )
+	{
+		AddToStats(pool, outStats);
+	}
+}
+
+void MemPoolObjectPool_GetCategoryStats(MemPool_Category category, MemPool_ObjectPoolStats* outStats)
+{
+	if ( !outStats )
+	{
+		return;
+	}
+
+	memset(outStats, 0, sizeof(*outStats));
+
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Registry.lock);
+
+	MemPool_ObjectPool* pool = NULL;
+
+	DL_FOREACH(g_Registry.pools, pool)
+	{
+		if ( pool->category == category )
+		{
+			AddToStats(pool, outStats);
+		}
+	}
+
+	Threading_Mutex_Unlock(&g_Registry.lock);
+}
+
+#if RAYGE_BUILD_TESTING()
+void MemPoolObjectPool_RunTests(void)
+{
+	if ( !TEST_EXPECT_TRUE(g_Initialised) )
+	{
+		return;
+	}
+
+	typedef struct TestObject
+	{
+		uint32_t values[5];
+	} TestObject;
+
+	MemPool_ObjectPool* pool = MEMPOOL_OBJECTPOOL_CREATE(MEMPOOL_TEST_MANAGER, TestObject, 4);
+
+	if ( !TEST_EXPECT_TRUE(pool) )
+	{
+		return;
+	}
+
+	TEST_EXPECT_EQL_INT(pool->slotSize % MEMPOOL_OBJECTPOOL_ALIGNMENT, 0);
+
+	TestObject* objects[6];
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(objects); ++index )
+	{
+		objects[index] = (TestObject*)MemPoolObjectPool_Calloc(pool);
+		TEST_EXPECT_TRUE(objects[index]);
+		TEST_EXPECT_EQL_INT((size_t)objects[index] % MEMPOOL_OBJECTPOOL_ALIGNMENT, 0);
+		TEST_EXPECT_EQL_INT(objects[index]->values[4], 0);
+		objects[index]->values[4] = (uint32_t)index + 1;
+	}
+
+	// Objects within a chunk should be contiguous.
+	TEST_EXPECT_TRUE((uint8_t*)objects[1] == (uint8_t*)objects[0] + pool->slotSize);
+	TEST_EXPECT_TRUE((uint8_t*)objects[3] == (uint8_t*)objects[0] + (3 * pool->slotSize));
+
+	MemPool_ObjectPoolStats stats;
+	MemPoolObjectPool_GetStats(pool, &stats);
+
+	TEST_EXPECT_EQL_INT(stats.numChunks, 2);
+	TEST_EXPECT_EQL_INT(stats.capacity, 8);
+	TEST_EXPECT_EQL_INT(stats.liveObjects, 6);
+	TEST_EXPECT_EQL_INT(stats.freeSlots, 0);
+
+	// Freed slots are recycled in LIFO order.
+	MemPoolObjectPool_Free(pool, objects[1]);
+	MemPoolObjectPool_Free(pool, objects[4]);
+
+	MemPoolObjectPool_GetStats(pool, &stats);
+	TEST_EXPECT_EQL_INT(stats.liveObjects, 4);
+	TEST_EXPECT_EQL_INT(stats.freeSlots, 2);
+
+	TEST_EXPECT_TRUE(MemPoolObjectPool_Alloc(pool) == objects[4]);
+	TEST_EXPECT_TRUE(MemPoolObjectPool_Alloc(pool) == objects[1]);
+
+	// Once the free list is empty, the rest of the chunk is used.
+	TestObject* next = (TestObject*)MemPoolObjectPool_Alloc(pool);
+	TEST_EXPECT_TRUE((uint8_t*)next == (uint8_t*)objects[5] + pool->slotSize);
+
+	MemPoolObjectPool_GetStats(pool, &stats);
+	TEST_EXPECT_EQL_INT(stats.numChunks, 2);
+	TEST_EXPECT_EQL_INT(stats.liveObjects, 7);
+	TEST_EXPECT_EQL_INT(stats.freeSlots, 0);
+
+	// Values in other objects must not have been disturbed.
+	TEST_EXPECT_EQL_INT(objects[0]->values[4], 1);
+	TEST_EXPECT_EQL_INT(objects[5]->values[4], 6);
+
+	MemPool_ObjectPoolStats categoryStats;
+	MemPoolObjectPool_GetCategoryStats(MEMPOOL_TEST_MANAGER, &categoryStats);
+	TEST_EXPECT_TRUE(categoryStats.numPools >= 1);
+	TEST_EXPECT_TRUE(categoryStats.liveObjects >= 7);
+
+	MemPoolObjectPool_Destroy(pool);
+
+	MemPoolObjectPool_GetCategoryStats(MEMPOOL_TEST_MANAGER, &stats);
+	TEST_EXPECT_EQL_INT(stats.numPools, categoryStats.numPools - 1);
+}
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stddef.h>
+#include "MemPool/MemPoolManager.h"
+#include "Testing/Testing.h"
+#include "wzl_cutl/attributes.h"
+
+// Pool of fixed-size objects, for structs which are created and
+// destroyed often. Objects are carved out of contiguous chunks,
+// each of which holds a fixed number of objects, and freed objects
+// are recycled in LIFO order so that recently used (and therefore
+// likely cached) memory is handed out first. Chunks are allocated
+// from the mem pool category that the object pool was created with,
+// and are only released when the object pool is destroyed.
+//
+// An individual object pool is not thread-safe.
+
+// Objects are aligned to this many bytes.
+#define MEMPOOL_OBJECTPOOL_ALIGNMENT ((size_t)16)
+
+typedef struct MemPool_ObjectPool MemPool_ObjectPool;
+
+typedef struct MemPool_ObjectPoolStats
+{
+	size_t numPools;
+	size_t numChunks;
+
+	// Total number of object slots across all chunks.
+	size_t capacity;
+
+	// Number of slots currently in use.
+	size_t liveObjects;
+
+	// Number of slots which were previously used but have since
+	// been freed, and are waiting to be recycled. A high proportion
+	// of these relative to live objects indicates fragmentation.
+	size_t freeSlots;
+} MemPool_ObjectPoolStats;
+
+// Called by the mem pool manager.
+void MemPoolObjectPool_Init(void);
+void MemPoolObjectPool_ShutDown(void);
+
+WZL_ATTR_NODISCARD MemPool_ObjectPool*
+MemPoolObjectPool_Create(MemPool_Category category, size_t objectSize, size_t objectsPerChunk);
+
+void MemPoolObjectPool_Destroy(MemPool_ObjectPool* pool);
+
+// Memory returned from Alloc is uninitialised; Calloc zeroes it.
+WZL_ATTR_NODISCARD void* MemPoolObjectPool_Alloc(MemPool_ObjectPool* pool);
+WZL_ATTR_NODISCARD void* MemPoolObjectPool_Calloc(MemPool_ObjectPool* pool);
+void MemPoolObjectPool_Free(MemPool_ObjectPool* pool, void* object);
+
+void MemPoolObjectPool_GetStats(const MemPool_ObjectPool* pool, MemPool_ObjectPoolStats* outStats);
+
+// Sums the statistics for all object pools in the given category.
+void MemPoolObjectPool_GetCategoryStats(MemPool_Category category, MemPool_ObjectPoolStats* outStats);
+
+#define MEMPOOL_OBJECTPOOL_CREATE(category, type, objectsPerChunk) \
+	MemPoolObjectPool_Create((category), sizeof(type), (objectsPerChunk))
+
+#if RAYGE_BUILD_TESTING()
+void MemPoolObjectPool_RunTests(void);
+#endif
@@ -0,0 +1,852 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MemPool/MemPoolProfiler.h"
+#include "MemPool/MemPoolManager.h"
+#include "Threading/Threading.h"
+#include "Logging/Logging.h"
+#include "Debugging.h"
+#include "Utils/Utils.h"
+
+#define INITIAL_SITE_CAPACITY 256
+#define INITIAL_LIVE_CAPACITY 1024
+
+// Tables are grown once they become this full (as a fraction of 8).
+#define MAX_LOAD_EIGHTHS 6
+
+#define NO_SITE UINT32_MAX
+
+typedef struct SiteRecord
+{
+	MemPoolProfiler_Site stats;
+	size_t allocationsThisFrame;
+} SiteRecord;
+
+// Records an allocation that was sampled, so that
+// it can be counted against its site when freed.
+typedef struct LiveEntry
+{
+	void* ptr;
+	size_t size;
+	size_t weight;
+	uint32_t siteIndex;
+} LiveEntry;
+
+typedef struct ProfilerData
+{
+	Threading_Mutex lock;
+
+	SiteRecord* sites;
+	size_t numSites;
+	size_t sitesCapacity;
+
+	// Open-addressed table of indices into the sites array.
+	uint32_t* siteTable;
+	size_t siteTableCapacity;
+
+	// Open-addressed table of live allocations, keyed by pointer.
+	LiveEntry* liveTable;
+	size_t liveTableCount;
+	size_t liveTableCapacity;
+
+	// These are accessed atomically.
+	volatile size_t enabled;
+	volatile size_t sampleRate;
+	volatile size_t sampleCounter;
+} ProfilerData;
+
+static ProfilerData g_Data;
+static bool g_Initialised = false;
+
+static size_t HashPointer(const void* ptr)
+{
+	uint64_t value = (uint64_t)(uintptr_t)ptr;
+
+	value ^= value >> 33;
+	value *= 0xFF51AFD7ED558CCDull;
+	value ^= value >> 33;
+
+	return (size_t)value;
+}
+
+static size_t HashSite(const char* file, int line)
+{
+	return HashPointer(file) ^ ((size_t)(unsigned int)line * 0x9E3779B9u);
+}
+
+static size_t Saturate(size_t value, size_t amount)
+{
+	return value >= amount ? value - amount : 0;
+}
+
+static bool GrowSiteTable(ProfilerData* data)
+{
+	const size_t newCapacity = data->siteTableCapacity > 0 ? data->siteTableCapacity * 2 : INITIAL_SITE_CAPACITY;
+	uint32_t* newTable = (uint32_t*)malloc(newCapacity * sizeof(uint32_t));
+
+	if ( !newTable )
+	{
+		return false;
+	}
+
+	memset(newTable, 0xFF, newCapacity * sizeof(uint32_t));
+
+	for ( size_t index = 0; index < data->numSites; ++index )
+	{
+		const MemPoolProfiler_Site* site = &data->sites[index].stats;
+		size_t slot = HashSite(site->file, site->line) & (newCapacity - 1);
+
+		while ( newTable[slot] != NO_SITE )
+		{
+			slot = (slot + 1) & (newCapacity - 1);
+		}
+
+		newTable[slot] = (uint32_t)index;
+	}
+
+	free(data->siteTable);
+	data->siteTable = newTable;
+	data->siteTableCapacity = newCapacity;
+
+	return true;
+}
+
+static uint32_t FindOrAddSite(ProfilerData* data, const char* file, int line)
+{
+	if ( (data->numSites + 1) * 8 > data->siteTableCapacity * MAX_LOAD_EIGHTHS && !GrowSiteTable(data) )
+	{
+		return NO_SITE;
+	}
+
+	size_t slot = HashSite(file, line) & (data->siteTableCapacity - 1);
+
+	while ( data->siteTable[slot] != NO_SITE )
+	{
+		const MemPoolProfiler_Site* site = &data->sites[data->siteTable[slot]].stats;
+
+		if ( site->file == file && site->line == line )
+		{
+			return data->siteTable[slot];
+		}
+
+		slot = (slot + 1) & (data->siteTableCapacity - 1);
+	}
+
+	if ( data->numSites >= data->sitesCapacity )
+	{
+		const size_t newCapacity = data->sitesCapacity > 0 ? data->sitesCapacity * 2 : INITIAL_SITE_CAPACITY;
+		SiteRecord* newSites = (SiteRecord*)realloc(data->sites, newCapacity * sizeof(SiteRecord));
+
+		if ( !newSites )
+		{
+			return NO_SITE;
+		}
+
+		data->sites = newSites;
+		data->sitesCapacity = newCapacity;
+	}
+
+	const uint32_t index = (uint32_t)data->numSites++;
+	SiteRecord* record = &data->sites[index];
+
+	memset(record, 0, sizeof(*record));
+	record->stats.file = file;
+	record->stats.line = line;
+
+	data->siteTable[slot] = index;
+	return index;
+}
+
+static bool GrowLiveTable(ProfilerData* data)
+{
+	const size_t newCapacity = data->liveTableCapacity > 0 ? data->liveTableCapacity * 2 : INITIAL_LIVE_CAPACITY;
+	LiveEntry* newTable = (LiveEntry*)calloc(newCapacity, sizeof(LiveEntry));
+
+	if ( !newTable )
+	{
+		return false;
+	}
+
+	for ( size_t index = 0; index < data->liveTableCapacity; ++index )
+	{
+		const LiveEntry* entry = &data->liveTable[index];
+
+		if ( !entry->ptr )
+		{
+			continue;
+		}
+
+		size_t slot = HashPointer(entry->ptr) & (newCapacity - 1);
+
+		while ( newTable[slot].ptr )
+		{
+			slot = (slot + 1) & (newCapacity - 1);
+		}
+
+		newTable[slot] = *entry;
+	}
+
+	free(data->liveTable);
+	data->liveTable = newTable;
+	data->liveTableCapacity = newCapacity;
+
+	return true;
+}
+
+static bool InsertLiveEntry(ProfilerData* data, const LiveEntry* entry)
+{
+	if ( (data->liveTableCount + 1) * 8 > data->liveTableCapacity * MAX_LOAD_EIGHTHS && !GrowLiveTable(data) )
+	{
+		return false;
+	}
+
+	size_t slot = HashPointer(entry->ptr) & (data->liveTableCapacity - 1);
+
+	while ( data->liveTable[slot].ptr )
+	{
+		slot = (slot + 1) & (data->liveTableCapacity - 1);
+	}
+
+	data->liveTable[slot] = *entry;
+	++data->liveTableCount;
+
+	return true;
+}
+
+// Returns false if the pointer was not found.
+static bool RemoveLiveEntry(ProfilerData* data, void* ptr, LiveEntry* outEntry)
+{
+	if ( data->liveTableCount < 1 )
+	{
+		return false;
+	}
+
+	const size_t mask = data->liveTableCapacity - 1;
+	size_t slot = HashPointer(ptr) & mask;
+
+	while ( data->liveTable[slot].ptr != ptr )
+	{
+		if ( !data->liveTable[slot].ptr )
+		{
+			return false;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	*outEntry = data->liveTable[slot];
+
+	// Shift back any following entries which would no longer
+	// be reachable once this slot is emptied.
+	size_t hole = slot;
+
+	for ( size_t next = (hole + 1) & mask; data->liveTable[next].ptr; next = (next + 1) & mask )
+	{
+		const size_t home = HashPointer(data->liveTable[next].ptr) & mask;
+
+		if ( ((next - home) & mask) >= ((next - hole) & mask) )
+		{
+			data->liveTable[hole] = data->liveTable[next];
+			hole = next;
+		}
+	}
+
+	memset(&data->liveTable[hole], 0, sizeof(LiveEntry));
+	--data->liveTableCount;
+
+	return true;
+}
+
+// Lock must be held.
+static void AddAllocation(ProfilerData* data, void* ptr, size_t size, size_t weight, const char* file, int line)
+{
+	const uint32_t siteIndex = FindOrAddSite(data, file, line);
+
+	if ( siteIndex == NO_SITE )
+	{
+		return;
+	}
+
+	const LiveEntry entry = {ptr, size, weight, siteIndex};
+
+	if ( !InsertLiveEntry(data, &entry) )
+	{
+		return;
+	}
+
+	SiteRecord* record = &data->sites[siteIndex];
+
+	record->stats.liveBytes += size * weight;
+	record->stats.liveCount += weight;
+	record->stats.totalAllocations += weight;
+	record->allocationsThisFrame += weight;
+}
+
+// Lock must be held.
+static void RemoveAllocation(ProfilerData* data, void* ptr)
+{
+	LiveEntry entry;
+
+	if ( !RemoveLiveEntry(data, ptr, &entry) )
+	{
+		return;
+	}
+
+	// Counters may have been reset while the allocation was live.
+	MemPoolProfiler_Site* site = &data->sites[entry.siteIndex].stats;
+
+	site->liveBytes = Saturate(site->liveBytes, entry.size * entry.weight);
+	site->liveCount = Saturate(site->liveCount, entry.weight);
+}
+
+static int CompareSize(size_t a, size_t b)
+{
+	return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static int CompareLocation(const void* a, const void* b)
+{
+	const MemPoolProfiler_Site* siteA = (const MemPoolProfiler_Site*)a;
+	const MemPoolProfiler_Site* siteB = (const MemPoolProfiler_Site*)b;
+
+	const int result = strcmp(siteA->file, siteB->file);
+	return result != 0 ? result : (siteA->line < siteB->line ? -1 : (siteA->line > siteB->line ? 1 : 0));
+}
+
+static int CompareLiveBytes(const void* a, const void* b)
+{
+	const int result =
+		CompareSize(((const MemPoolProfiler_Site*)a)->liveBytes, ((const MemPoolProfiler_Site*)b)->liveBytes);
+	return result != 0 ? result : CompareLocation(a, b);
+}
+
+static int CompareLiveCount(const void* a, const void* b)
+{
+	const int result =
+		CompareSize(((const MemPoolProfiler_Site*)a)->liveCount, ((const MemPoolProfiler_Site*)b)->liveCount);
+	return result != 0 ? result : CompareLocation(a, b);
+}
+
+static int CompareTotalAllocations(const void* a, const void* b)
+{
+	const int result = CompareSize(
+		((const MemPoolProfiler_Site*)a)->totalAllocations,
+		((const MemPoolProfiler_Site*)b)->totalAllocations
+	);
+
+	return result != 0 ? result : CompareLocation(a, b);
+}
+
+static int CompareAllocationsPerFrame(const void* a, const void* b)
+{
+	const int result = CompareSize(
+		((const MemPoolProfiler_Site*)a)->allocationsPerFrame,
+		((const MemPoolProfiler_Site*)b)->allocationsPerFrame
+	);
+
+	return result != 0 ? result : CompareLocation(a, b);
+}
+
+static int ComparePeakAllocationsPerFrame(const void* a, const void* b)
+{
+	const int result = CompareSize(
+		((const MemPoolProfiler_Site*)a)->peakAllocationsPerFrame,
+		((const MemPoolProfiler_Site*)b)->peakAllocationsPerFrame
+	);
+
+	return result != 0 ? result : CompareLocation(a, b);
+}
+
+static const char* ShortFileName(const char* path)
+{
+	const char* name = path;
+
+	for ( const char* cursor = path; *cursor; ++cursor )
+	{
+		if ( *cursor == '/' || *cursor == '\\' )
+		{
+			name = cursor + 1;
+		}
+	}
+
+	return name;
+}
+
+void MemPoolProfiler_Init(void)
+{
+	if ( g_Initialised )
+	{
+		return;
+	}
+
+	memset(&g_Data, 0, sizeof(g_Data));
+	Threading_Mutex_Init(&g_Data.lock);
+	g_Data.sampleRate = 1;
+
+	g_Initialised = true;
+}
+
+void MemPoolProfiler_ShutDown(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	free(g_Data.sites);
+	free(g_Data.siteTable);
+	free(g_Data.liveTable);
+
+	Threading_Mutex_Destroy(&g_Data.lock);
+	memset(&g_Data, 0, sizeof(g_Data));
+
+	g_Initialised = false;
+}
+
+bool MemPoolProfiler_IsEnabled(void)
+{
+	return g_Initialised && Threading_AtomicLoadSize(&g_Data.enabled) != 0;
+}
+
+void MemPoolProfiler_SetEnabled(bool enabled)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	Threading_AtomicStoreSize(&g_Data.enabled, enabled ? 1 : 0);
+}
+
+size_t MemPoolProfiler_GetSampleRate(void)
+{
+	return g_Initialised ? Threading_AtomicLoadSize(&g_Data.sampleRate) : 1;
+}
+
+void MemPoolProfiler_SetSampleRate(size_t rate)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	Threading_AtomicStoreSize(&g_Data.sampleRate, rate > 0 ? rate : 1);
+}
+
+void MemPoolProfiler_Reset(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Data.lock);
+
+	for ( size_t index = 0; index < g_Data.numSites; ++index )
+	{
+		SiteRecord* record = &g_Data.sites[index];
+		const char* file = record->stats.file;
+		const int line = record->stats.line;
+
+		memset(record, 0, sizeof(*record));
+		record->stats.file = file;
+		record->stats.line = line;
+	}
+
+	Threading_Mutex_Unlock(&g_Data.lock);
+}
+
+bool MemPoolProfiler_ShouldSample(void)
+{
+	if ( !MemPoolProfiler_IsEnabled() )
+	{
+		return false;
+	}
+
+	const size_t rate = Threading_AtomicLoadSize(&g_Data.sampleRate);
+	return rate <= 1 || Threading_AtomicAddSize(&g_Data.sampleCounter, 1) % rate == 0;
+}
+
+void MemPoolProfiler_RecordAlloc(void* ptr, size_t size, const char* file, int line)
+{
+	if ( !g_Initialised || !ptr || !file )
+	{
+		return;
+	}
+
+	const size_t weight = Threading_AtomicLoadSize(&g_Data.sampleRate);
+
+	Threading_Mutex_Lock(&g_Data.lock);
+	AddAllocation(&g_Data, ptr, size, weight, file, line);
+	Threading_Mutex_Unlock(&g_Data.lock);
+}
+
+void MemPoolProfiler_RecordFree(void* ptr)
+{
+	if ( !g_Initialised || !ptr )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Data.lock);
+	RemoveAllocation(&g_Data, ptr);
+	Threading_Mutex_Unlock(&g_Data.lock);
+}
+
+void MemPoolProfiler_RecordRealloc(void* oldPtr, void* newPtr, size_t newSize, const char* file, int line)
+{
+	if ( !g_Initialised || !oldPtr || !newPtr || !file )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Data.lock);
+
+	// Keep the weight the allocation was originally sampled with.
+	LiveEntry entry;
+	const bool found = RemoveLiveEntry(&g_Data, oldPtr, &entry);
+
+	if ( found )
+	{
+		MemPoolProfiler_Site* site = &g_Data.sites[entry.siteIndex].stats;
+
+		site->liveBytes = Saturate(site->liveBytes, entry.size * entry.weight);
+		site->liveCount = Saturate(site->liveCount, entry.weight);
+
+		AddAllocation(&g_Data, newPtr, newSize, entry.weight, file, line);
+	}
+
+	Threading_Mutex_Unlock(&g_Data.lock);
+}
+
+void MemPoolProfiler_NewFrame(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Data.lock);
+
+	for ( size_t index = 0; index < g_Data.numSites; ++index )
+	{
+		SiteRecord* record = &g_Data.sites[index];
+
+		record->stats.allocationsPerFrame = record->allocationsThisFrame;
+		record->stats.peakAllocationsPerFrame =
+			RAYGE_MAX(record->stats.peakAllocationsPerFrame, record->allocationsThisFrame);
+		record->allocationsThisFrame = 0;
+	}
+
+	Threading_Mutex_Unlock(&g_Data.lock);
+}
+
+size_t MemPoolProfiler_GetSites(MemPoolProfiler_Site* sites, size_t maxSites)
+{
+	if ( !g_Initialised )
+	{
+		return 0;
+	}
+
+	Threading_Mutex_Lock(&g_Data.lock);
+
+	const size_t numSites = g_Data.numSites;
+
+	if ( sites )
+	{
+		const size_t numToCopy = RAYGE_MIN(numSites, maxSites);
+
+		for ( size_t index = 0; index < numToCopy; ++index )
+		{
+			sites[index] = g_Data.sites[index].stats;
+		}
+	}
+
+	Threading_Mutex_Unlock(&g_Data.lock);
+
+	return numSites;
+}
+
+void MemPoolProfiler_SortSites(MemPoolProfiler_Site* sites, size_t count, MemPoolProfiler_SortKey key, bool descending)
+{
+	if ( !sites || count < 2 )
+	{
+		return;
+	}
+
+	int (*compare)(const void*, const void*) = NULL;
+
+	switch ( key )
+	{
+		case MEMPOOL_PROFILER_SORT_LIVE_COUNT:
+		{
+			compare = &CompareLiveCount;
+			break;
+		}
+
+		case MEMPOOL_PROFILER_SORT_TOTAL_ALLOCATIONS:
+		{
+			compare = &CompareTotalAllocations;
+			break;
+		}
+
+		case MEMPOOL_PROFILER_SORT_ALLOCATIONS_PER_FRAME:
+		{
+			compare = &CompareAllocationsPerFrame;
+			break;
+		}
+
+		case MEMPOOL_PROFILER_SORT_PEAK_ALLOCATIONS_PER_FRAME:
+		{
+			compare = &ComparePeakAllocationsPerFrame;
+			break;
+		}
+
+		case MEMPOOL_PROFILER_SORT_LOCATION:
+		{
+			compare = &CompareLocation;
+			break;
+		}
+
+		default:
+		{
+			compare = &CompareLiveBytes;
+			break;
+		}
+	}
+
+	qsort(sites, count, sizeof(MemPoolProfiler_Site), compare);
+
+	if ( descending )
+	{
+		for ( size_t begin = 0, end = count - 1; begin < end; ++begin, --end )
+		{
+			const MemPoolProfiler_Site temp = sites[begin];
+			sites[begin] = sites[end];
+			sites[end] = temp;
+		}
+	}
+}
+
+const char* MemPoolProfiler_ShortFileName(const char* path)
+{
+	return path ? ShortFileName(path) : "<unknown>";
+}
+
+void MemPoolProfiler_DumpToLog(MemPoolProfiler_SortKey key, size_t maxSites)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	// Take a copy so that the lock is not held while logging,
+	// since logging may itself allocate.
+	const size_t numSites = MemPoolProfiler_GetSites(NULL, 0);
+	MemPoolProfiler_Site* sites = numSites > 0 ? (MemPoolProfiler_Site*)malloc(numSites * sizeof(*sites)) : NULL;
+	const size_t numCopied = sites ? RAYGE_MIN(MemPoolProfiler_GetSites(sites, numSites), numSites) : 0;
+
+	MemPoolProfiler_SortSites(sites, numCopied, key, key != MEMPOOL_PROFILER_SORT_LOCATION);
+
+	const size_t numToPrint = maxSites > 0 ? RAYGE_MIN(maxSites, numCopied) : numCopied;
+
+	Logging_PrintLine(
+		RAYGE_LOG_INFO,
+		"Mem pool profiler: %s, sample rate 1 in %zu, %zu sites (showing %zu)",
+		MemPoolProfiler_IsEnabled() ? "enabled" : "disabled",
+		MemPoolProfiler_GetSampleRate(),
+		numCopied,
+		numToPrint
+	);
+
+	Logging_PrintLine(
+		RAYGE_LOG_INFO,
+		"  %12s %10s %12s %10s %10s  %s",
+		"Live bytes",
+		"Live count",
+		"Total",
+		"Per frame",
+		"Peak/frame",
+		"Location"
+	);
+
+	for ( size_t index = 0; index < numToPrint; ++index )
+	{
+		const MemPoolProfiler_Site* site = &sites[index];
+
+		Logging_PrintLine(
+			RAYGE_LOG_INFO,
+			"  %12zu %10zu %12zu %10zu %10zu  %s:%d",
+			site->liveBytes,
+			site->liveCount,
+			site->totalAllocations,
+			site->allocationsPerFrame,
+			site->peakAllocationsPerFrame,
+			ShortFileName(site->file),
+			site->line
+		);
+	}
+
+	free(sites);
+}
+
+#if RAYGE_BUILD_TESTING()
+static const MemPoolProfiler_Site* FindTestSite(const MemPoolProfiler_Site* sites, size_t count, const char* file)
+{
+	for ( size_t index = 0; index < count; ++index )
+	{
+		if ( sites[index].file == file )
+		{
+			return &sites[index];
+		}
+	}
+
+	return NULL;
+}
+
+void MemPoolProfiler_RunTests(void)
+{
+	if ( !TEST_EXPECT_TRUE(g_Initialised) )
+	{
+		return;
+	}
+
+	// Fake allocations are used here, so that the results
+	// are not affected by anything else going on in the engine.
+	static const char fileA[] = "TestA.c";
+	static const char fileB[] = "TestB.c";
+	static uint8_t fakeMemory[4];
+
+	const size_t oldRate = MemPoolProfiler_GetSampleRate();
+	MemPoolProfiler_SetSampleRate(1);
+
+	MemPoolProfiler_RecordAlloc(&fakeMemory[0], 100, fileA, 1);
+	MemPoolProfiler_RecordAlloc(&fakeMemory[1], 50, fileA, 1);
+	MemPoolProfiler_RecordAlloc(&fakeMemory[2], 10, fileB, 2);
+
+	MemPoolProfiler_Site sites[512];
+	size_t count = RAYGE_MIN(MemPoolProfiler_GetSites(sites, RAYGE_ARRAY_SIZE(sites)), RAYGE_ARRAY_SIZE(sites));
+
+	const MemPoolProfiler_Site* siteA = FindTestSite(sites, count, fileA);
+	const MemPoolProfiler_Site* siteB = FindTestSite(sites, count, fileB);
+
+	if ( !TEST_EXPECT_TRUE(siteA) || !TEST_EXPECT_TRUE(siteB) )
+	{
+		MemPoolProfiler_SetSampleRate(oldRate);
+		return;
+	}
+
+	TEST_EXPECT_EQL_INT(siteA->liveBytes, 150);
+	TEST_EXPECT_EQL_INT(siteA->liveCount, 2);
+	TEST_EXPECT_EQL_INT(siteA->totalAllocations, 2);
+	TEST_EXPECT_EQL_INT(siteB->liveBytes, 10);
+
+	// Freeing reduces the live counters, but not the total.
+	MemPoolProfiler_RecordFree(&fakeMemory[0]);
+	MemPoolProfiler_RecordRealloc(&fakeMemory[2], &fakeMemory[3], 40, fileB, 2);
+	MemPoolProfiler_NewFrame();
+
+	count = RAYGE_MIN(MemPoolProfiler_GetSites(sites, RAYGE_ARRAY_SIZE(sites)), RAYGE_ARRAY_SIZE(sites));
+	siteA = FindTestSite(sites, count, fileA);
+	siteB = FindTestSite(sites, count, fileB);
+
+	TEST_EXPECT_EQL_INT(siteA->liveBytes, 50);
+	TEST_EXPECT_EQL_INT(siteA->liveCount, 1);
+	TEST_EXPECT_EQL_INT(siteA->totalAllocations, 2);
+	TEST_EXPECT_EQL_INT(siteA->allocationsPerFrame, 2);
+	TEST_EXPECT_EQL_INT(siteB->liveBytes, 40);
+	TEST_EXPECT_EQL_INT(siteB->liveCount, 1);
+	TEST_EXPECT_EQL_INT(siteB->totalAllocations, 2);
+
+	// Sampled allocations are weighted by the sample rate.
+	MemPoolProfiler_SetSampleRate(8);
+	MemPoolProfiler_RecordAlloc(&fakeMemory[0], 4, fileA, 1);
+	MemPoolProfiler_SetSampleRate(1);
+	MemPoolProfiler_NewFrame();
+
+	count = RAYGE_MIN(MemPoolProfiler_GetSites(sites, RAYGE_ARRAY_SIZE(sites)), RAYGE_ARRAY_SIZE(sites));
+	siteA = FindTestSite(sites, count, fileA);
+
+	TEST_EXPECT_EQL_INT(siteA->liveBytes, 50 + (4 * 8));
+	TEST_EXPECT_EQL_INT(siteA->liveCount, 9);
+	TEST_EXPECT_EQL_INT(siteA->allocationsPerFrame, 8);
+	TEST_EXPECT_EQL_INT(siteA->peakAllocationsPerFrame, 8);
+
+	// The weight is remembered even if the rate changes.
+	MemPoolProfiler_RecordFree(&fakeMemory[0]);
+	MemPoolProfiler_RecordFree(&fakeMemory[1]);
+	MemPoolProfiler_RecordFree(&fakeMemory[3]);
+
+	count = RAYGE_MIN(MemPoolProfiler_GetSites(sites, RAYGE_ARRAY_SIZE(sites)), RAYGE_ARRAY_SIZE(sites));
+	siteA = FindTestSite(sites, count, fileA);
+	siteB = FindTestSite(sites, count, fileB);
+
+	TEST_EXPECT_EQL_INT(siteA->liveBytes, 0);
+	TEST_EXPECT_EQL_INT(siteA->liveCount, 0);
+	TEST_EXPECT_EQL_INT(siteB->liveBytes, 0);
+
+	// Sorting
+	MemPoolProfiler_Site sortSites[3] = {
+		{.file = fileA, .line = 1, .liveBytes = 20},
+		{.file = fileA, .line = 2, .liveBytes = 30},
+		{.file = fileB, .line = 1, .liveBytes = 10},
+	};
+
+	MemPoolProfiler_SortSites(sortSites, 3, MEMPOOL_PROFILER_SORT_LIVE_BYTES, true);
+	TEST_EXPECT_EQL_INT(sortSites[0].liveBytes, 30);
+	TEST_EXPECT_EQL_INT(sortSites[2].liveBytes, 10);
+
+	MemPoolProfiler_SortSites(sortSites, 3, MEMPOOL_PROFILER_SORT_LOCATION, false);
+	TEST_EXPECT_EQL_INT(sortSites[0].line, 1);
+	TEST_EXPECT_TRUE(sortSites[0].file == fileA);
+	TEST_EXPECT_TRUE(sortSites[2].file == fileB);
+
+	// Allocations made through the mem pool are recorded against their call site.
+	const bool wasEnabled = MemPoolProfiler_IsEnabled();
+	MemPoolProfiler_SetEnabled(true);
+
+	const int allocLine = __LINE__ + 1;
+	void* memory = MEMPOOL_MALLOC(MEMPOOL_TEST_MANAGER, 24);
+	memory = MEMPOOL_REALLOC(MEMPOOL_TEST_MANAGER, memory, 4096);
+
+	MemPoolProfiler_SetEnabled(wasEnabled);
+
+	count = RAYGE_MIN(MemPoolProfiler_GetSites(sites, RAYGE_ARRAY_SIZE(sites)), RAYGE_ARRAY_SIZE(sites));
+	const MemPoolProfiler_Site* allocSite = NULL;
+	const MemPoolProfiler_Site* reallocSite = NULL;
+
+	for ( size_t index = 0; index < count; ++index )
+	{
+		if ( strcmp(sites[index].file, __FILE__) == 0 && sites[index].line == allocLine )
+		{
+			allocSite = &sites[index];
+		}
+		else if ( strcmp(sites[index].file, __FILE__) == 0 && sites[index].line == allocLine + 1 )
+		{
+			reallocSite = &sites[index];
+		}
+	}
+
+	if ( TEST_EXPECT_TRUE(allocSite) && TEST_EXPECT_TRUE(reallocSite) )
+	{
+		TEST_EXPECT_EQL_INT(allocSite->liveCount, 0);
+		TEST_EXPECT_EQL_INT(allocSite->totalAllocations, 1);
+		TEST_EXPECT_EQL_INT(reallocSite->liveCount, 1);
+		TEST_EXPECT_EQL_INT(reallocSite->liveBytes, 4096);
+	}
+
+	MEMPOOL_FREE(memory);
+
+	count = RAYGE_MIN(MemPoolProfiler_GetSites(sites, RAYGE_ARRAY_SIZE(sites)), RAYGE_ARRAY_SIZE(sites));
+
+	for ( size_t index = 0; index < count; ++index )
+	{
+		if ( strcmp(sites[index].file, __FILE__) == 0 && sites[index].line == allocLine + 1 )
+		{
+			TEST_EXPECT_EQL_INT(sites[index].liveCount, 0);
+		}
+	}
+
+	MemPoolProfiler_SetSampleRate(oldRate);
+}
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "Testing/Testing.h"
+
+// Aggregates mem pool allocations by the site (file and line) that they
+// were made from. One in every N allocations is sampled, where N is the
+// sample rate; a rate of 1 records every allocation. Higher rates keep
+// the overhead low enough to run in release builds, at the cost of the
+// statistics becoming estimates.
+//
+// The profiler never allocates from the mem pool itself. Allocations
+// from the frame arena are not profiled, since they do not touch the heap.
+
+typedef enum MemPoolProfiler_SortKey
+{
+	MEMPOOL_PROFILER_SORT_LIVE_BYTES = 0,
+	MEMPOOL_PROFILER_SORT_LIVE_COUNT,
+	MEMPOOL_PROFILER_SORT_TOTAL_ALLOCATIONS,
+	MEMPOOL_PROFILER_SORT_ALLOCATIONS_PER_FRAME,
+	MEMPOOL_PROFILER_SORT_PEAK_ALLOCATIONS_PER_FRAME,
+	MEMPOOL_PROFILER_SORT_LOCATION,
+} MemPoolProfiler_SortKey;
+
+// Values are scaled by the sample rate that was in effect
+// when each allocation was recorded.
+typedef struct MemPoolProfiler_Site
+{
+	const char* file;
+	int line;
+
+	size_t liveBytes;
+	size_t liveCount;
+	size_t totalAllocations;
+
+	// Allocations made during the last complete frame.
+	size_t allocationsPerFrame;
+	size_t peakAllocationsPerFrame;
+} MemPoolProfiler_Site;
+
+void MemPoolProfiler_Init(void);
+void MemPoolProfiler_ShutDown(void);
+
+bool MemPoolProfiler_IsEnabled(void);
+void MemPoolProfiler_SetEnabled(bool enabled);
+
+size_t MemPoolProfiler_GetSampleRate(void);
+void MemPoolProfiler_SetSampleRate(size_t rate);
+
+// Clears the statistics for all sites. Allocations which are still
+// live continue to be counted against their site when freed.
+void MemPoolProfiler_Reset(void);
+
+// Called by the mem pool manager.
+bool MemPoolProfiler_ShouldSample(void);
+void MemPoolProfiler_RecordAlloc(void* ptr, size_t size, const char* file, int line);
+void MemPoolProfiler_RecordFree(void* ptr);
+void MemPoolProfiler_RecordRealloc(void* oldPtr, void* newPtr, size_t newSize, const char* file, int line);
+void MemPoolProfiler_NewFrame(void);
+
+// Copies up to maxSites entries into the provided array, and returns
+// the total number of sites (which may be larger than maxSites).
+size_t MemPoolProfiler_GetSites(MemPoolProfiler_Site* sites, size_t maxSites);
+void MemPoolProfiler_SortSites(MemPoolProfiler_Site* sites, size_t count, MemPoolProfiler_SortKey key, bool descending);
+
+// Returns the portion of the path after the last separator.
+const char* MemPoolProfiler_ShortFileName(const char* path);
+
+// Prints the top sites to the logs, ordered by the given key.
+// If maxSites is zero, all sites are printed.
+void MemPoolProfiler_DumpToLog(MemPoolProfiler_SortKey key, size_t maxSites);
+
+#if RAYGE_BUILD_TESTING()
+void MemPoolProfiler_RunTests(void);
+#endif
@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "MemPool/MemPoolSlab.h"
+#include "Debugging.h"
+#include "Utils/Utils.h"
+
+// Page headers are padded so that the first block in the page
+// is aligned in the same way as the blocks that follow it.
+#define PAGE_HEADER_SIZE \
+	(((sizeof(MemPoolSlab_Page) + MEMPOOL_SLAB_BLOCK_ALIGNMENT - 1) / MEMPOOL_SLAB_BLOCK_ALIGNMENT) * \
+	 MEMPOOL_SLAB_BLOCK_ALIGNMENT)
+
+#define SIZE_LOOKUP_ENTRIES ((MEMPOOL_SLAB_MAX_BLOCK_SIZE / MEMPOOL_SLAB_BLOCK_ALIGNMENT) + 1)
+
+// Classes are spaced more widely as they get larger,
+// to keep the wasted space in each block proportionally small.
+static const uint16_t g_SizeClassBlockSizes[MEMPOOL_SLAB_NUM_SIZE_CLASSES] = {
+	32,  48,  64,  80,  96,  112,  128,  160,  192,  224,  256,  320,
+	384, 448, 512, 640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+};
+
+// Maps a size, in units of the block alignment, to its size class.
+static uint8_t g_SizeLookup[SIZE_LOOKUP_ENTRIES];
+static bool g_SizeLookupInitialised = false;
+
+static void InitSizeLookup(void)
+{
+	uint8_t sizeClass = 0;
+
+	for ( size_t index = 0; index < SIZE_LOOKUP_ENTRIES; ++index )
+	{
+		const size_t size = index * MEMPOOL_SLAB_BLOCK_ALIGNMENT;
+
+		while ( g_SizeClassBlockSizes[sizeClass] < size )
+		{
+			++sizeClass;
+		}
+
+		g_SizeLookup[index] = sizeClass;
+	}
+
+	g_SizeLookupInitialised = true;
+}
+
+static bool CreatePage(MemPoolSlab* slab, MemPoolSlab_SizeClass* sizeClass)
+{
+	MemPoolSlab_Page* page = (MemPoolSlab_Page*)malloc(MEMPOOL_SLAB_PAGE_SIZE);
+
+	if ( !page )
+	{
+		return false;
+	}
+
+	page->next = slab->pages;
+	slab->pages = page;
+	++slab->numPages;
+
+	sizeClass->carveBegin = (uint8_t*)page + PAGE_HEADER_SIZE;
+	sizeClass->carveEnd = (uint8_t*)page + MEMPOOL_SLAB_PAGE_SIZE;
+
+	return true;
+}
+
+uint8_t MemPoolSlab_SizeClassForSize(size_t size)
+{
+	if ( size > MEMPOOL_SLAB_MAX_BLOCK_SIZE )
+	{
+		return MEMPOOL_SLAB_NO_SIZE_CLASS;
+	}
+
+	if ( !g_SizeLookupInitialised )
+	{
+		InitSizeLookup();
+	}
+
+	return g_SizeLookup[(size + MEMPOOL_SLAB_BLOCK_ALIGNMENT - 1) / MEMPOOL_SLAB_BLOCK_ALIGNMENT];
+}
+
+size_t MemPoolSlab_BlockSize(uint8_t sizeClass)
+{
+	RAYGE_ASSERT_VALID(sizeClass < MEMPOOL_SLAB_NUM_SIZE_CLASSES);
+	return sizeClass < MEMPOOL_SLAB_NUM_SIZE_CLASSES ? (size_t)g_SizeClassBlockSizes[sizeClass] : 0;
+}
+
+void* MemPoolSlab_Alloc(MemPoolSlab* slab, uint8_t sizeClass)
+{
+	RAYGE_ASSERT_VALID(slab);
+	RAYGE_ASSERT_VALID(sizeClass < MEMPOOL_SLAB_NUM_SIZE_CLASSES);
+
+	if ( !slab || sizeClass >= MEMPOOL_SLAB_NUM_SIZE_CLASSES )
+	{
+		return NULL;
+	}
+
+	MemPoolSlab_SizeClass* classData = &slab->sizeClasses[sizeClass];
+
+	if ( classData->freeList )
+	{
+		MemPoolSlab_FreeBlock* block = classData->freeList;
+		classData->freeList = block->next;
+		return block;
+	}
+
+	const size_t blockSize = g_SizeClassBlockSizes[sizeClass];
+
+	if ( (size_t)(classData->carveEnd - classData->carveBegin) < blockSize && !CreatePage(slab, classData) )
+	{
+		return NULL;
+	}
+
+	void* block = classData->carveBegin;
+	classData->carveBegin += blockSize;
+	return block;
+}
+
+void MemPoolSlab_Free(MemPoolSlab* slab, uint8_t sizeClass, void* block)
+{
+	RAYGE_ASSERT_VALID(slab);
+	RAYGE_ASSERT_VALID(sizeClass < MEMPOOL_SLAB_NUM_SIZE_CLASSES);
+	RAYGE_ASSERT_VALID(block);
+
+	if ( !slab || sizeClass >= MEMPOOL_SLAB_NUM_SIZE_CLASSES || !block )
+	{
+		return;
+	}
+
+	MemPoolSlab_SizeClass* classData = &slab->sizeClasses[sizeClass];
+	MemPoolSlab_FreeBlock* freeBlock = (MemPoolSlab_FreeBlock*)block;
+
+	freeBlock->next = classData->freeList;
+	classData->freeList = freeBlock;
+}
+
+void MemPoolSlab_Release(MemPoolSlab* slab)
+{
+	RAYGE_ASSERT_VALID(slab);
+
+	if ( !slab )
+	{
+		return;
+	}
+
+	MemPoolSlab_Page* page = slab->pages;
+
+	while ( page )
+	{
+		MemPoolSlab_Page* next = page->next;
+		free(page);
+		page = next;
+	}
+
+	memset(slab, 0, sizeof(*slab));
+}
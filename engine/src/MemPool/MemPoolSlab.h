@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Slab backend for the mem pool manager. Allocations are grouped into
+// size classes, and each size class carves its blocks out of fixed-size
+// pages. Freed blocks are kept on an intrusive free list for the size
+// class, so both allocating and freeing a block are O(1).
+// Pages are retained for reuse until the slab is released.
+
+#define MEMPOOL_SLAB_PAGE_SIZE ((size_t)(64 * 1024))
+#define MEMPOOL_SLAB_BLOCK_ALIGNMENT ((size_t)16)
+#define MEMPOOL_SLAB_MAX_BLOCK_SIZE ((size_t)2048)
+#define MEMPOOL_SLAB_NUM_SIZE_CLASSES 23
+#define MEMPOOL_SLAB_NO_SIZE_CLASS 0xFF
+
+typedef struct MemPoolSlab_FreeBlock
+{
+	struct MemPoolSlab_FreeBlock* next;
+} MemPoolSlab_FreeBlock;
+
+typedef struct MemPoolSlab_Page
+{
+	struct MemPoolSlab_Page* next;
+} MemPoolSlab_Page;
+
+typedef struct MemPoolSlab_SizeClass
+{
+	MemPoolSlab_FreeBlock* freeList;
+
+	// Remaining space in the most recently allocated page
+	// that has not yet been handed out as a block.
+	uint8_t* carveBegin;
+	uint8_t* carveEnd;
+} MemPoolSlab_SizeClass;
+
+typedef struct MemPoolSlab
+{
+	MemPoolSlab_SizeClass sizeClasses[MEMPOOL_SLAB_NUM_SIZE_CLASSES];
+	MemPoolSlab_Page* pages;
+	size_t numPages;
+} MemPoolSlab;
+
+// Returns MEMPOOL_SLAB_NO_SIZE_CLASS if the size is too large
+// to be serviced by the slab.
+uint8_t MemPoolSlab_SizeClassForSize(size_t size);
+size_t MemPoolSlab_BlockSize(uint8_t sizeClass);
+
+// Returns NULL if a new page was required but could not be allocated.
+void* MemPoolSlab_Alloc(MemPoolSlab* slab, uint8_t sizeClass);
+void MemPoolSlab_Free(MemPoolSlab* slab, uint8_t sizeClass, void* block);
+
+// Frees all pages owned by the slab. Any blocks that were
+// allocated from the slab are invalid after this call.
+void MemPoolSlab_Release(MemPoolSlab* slab);
@@ -0,0 +1,557 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MemPool/MemPoolTrace.h"
+#include "MemPool/MemPoolTraceFormat.h"
+#include "Threading/Threading.h"
+#include "Logging/Logging.h"
+#include "Debugging.h"
+#include "Utils/Utils.h"
+
+#define BUFFER_SIZE (64 * 1024)
+#define MAX_FILE_NAME_LENGTH 1024
+#define MAX_RECORD_SIZE (1 + (6 * MEMPOOL_TRACE_MAX_VARINT_SIZE))
+#define MAX_SITE_RECORD_SIZE (1 + (3 * MEMPOOL_TRACE_MAX_VARINT_SIZE) + MAX_FILE_NAME_LENGTH)
+#define INITIAL_SITE_TABLE_CAPACITY 1024
+
+typedef struct SiteEntry
+{
+	const char* file;
+	int line;
+	uint32_t id;
+	bool used;
+} SiteEntry;
+
+typedef struct Recorder
+{
+	// Guards everything below.
+	Threading_Mutex lock;
+
+	// Checked without the lock, so that allocations
+	// are not slowed down when nothing is recording.
+	volatile size_t recording;
+
+	FILE* file;
+	bool writeFailed;
+	uint64_t lastTimestampNs;
+
+	uint8_t buffer[BUFFER_SIZE];
+	size_t bufferUsed;
+
+	// Open-addressed, keyed on the file name pointer and line.
+	SiteEntry* sites;
+	size_t sitesCapacity;
+	size_t numSites;
+} Recorder;
+
+static Recorder g_Recorder;
+static bool g_Initialised = false;
+
+static size_t HashSite(const char* file, int line)
+{
+	const uint64_t fileHash = (uint64_t)(uintptr_t)file * 0x9E3779B97F4A7C15ull;
+	const uint64_t lineHash = (uint64_t)(unsigned int)line * 0xC2B2AE3D27D4EB4Full;
+	const uint64_t hash = fileHash ^ lineHash;
+
+	return (size_t)(hash ^ (hash >> 29));
+}
+
+// Lock must be held.
+static void FlushBuffer(Recorder* recorder)
+{
+	if ( recorder->bufferUsed > 0 && !recorder->writeFailed &&
+		 fwrite(recorder->buffer, 1, recorder->bufferUsed, recorder->file) != recorder->bufferUsed )
+	{
+		// Reported when recording is stopped, since
+		// logging here could cause more allocations.
+		recorder->writeFailed = true;
+	}
+
+	recorder->bufferUsed = 0;
+}
+
+// Lock must be held.
+static uint8_t* ReserveBytes(Recorder* recorder, size_t maxBytes)
+{
+	if ( recorder->bufferUsed + maxBytes > BUFFER_SIZE )
+	{
+		FlushBuffer(recorder);
+	}
+
+	return recorder->buffer + recorder->bufferUsed;
+}
+
+// Lock must be held.
+static void WriteTimestamp(Recorder* recorder, uint8_t* record, size_t* length)
+{
+	const uint64_t now = MemPoolTrace_GetTimeNs();
+	const uint64_t delta = now > recorder->lastTimestampNs ? now - recorder->lastTimestampNs : 0;
+
+	recorder->lastTimestampNs = now;
+	*length += MemPoolTrace_EncodeVarint(record + *length, delta);
+}
+
+// Lock must be held. Returns false if the table could not be grown.
+static bool GrowSiteTable(Recorder* recorder)
+{
+	const size_t newCapacity = recorder->sitesCapacity > 0 ? recorder->sitesCapacity * 2 : INITIAL_SITE_TABLE_CAPACITY;
+	SiteEntry* newSites = (SiteEntry*)calloc(newCapacity, sizeof(SiteEntry));
+
+	if ( !newSites )
+	{
+		return false;
+	}
+
+	for ( size_t index = 0; index < recorder->sitesCapacity; ++index )
+	{
+		const SiteEntry* entry = &recorder->sites[index];
+
+		if ( !entry->used )
+		{
+			continue;
+		}
+
+		size_t slot = HashSite(entry->file, entry->line) & (newCapacity - 1);
+
+		while ( newSites[slot].used )
+		{
+			slot = (slot + 1) & (newCapacity - 1);
+		}
+
+		newSites[slot] = *entry;
+	}
+
+	free(recorder->sites);
+	recorder->sites = newSites;
+	recorder->sitesCapacity = newCapacity;
+
+	return true;
+}
+
+// Lock must be held. Writes a SITE record if this is the
+// first time the site has been seen. Returns the site ID.
+static uint32_t GetSiteId(Recorder* recorder, const char* file, int line)
+{
+	if ( !file )
+	{
+		file = "<unknown>";
+	}
+
+	if ( (recorder->numSites + 1) * 2 > recorder->sitesCapacity && !GrowSiteTable(recorder) )
+	{
+		// Out of memory - this site will not be described.
+		return (uint32_t)recorder->numSites;
+	}
+
+	const size_t mask = recorder->sitesCapacity - 1;
+	size_t slot = HashSite(file, line) & mask;
+
+	while ( recorder->sites[slot].used )
+	{
+		if ( recorder->sites[slot].file == file && recorder->sites[slot].line == line )
+		{
+			return recorder->sites[slot].id;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	SiteEntry* entry = &recorder->sites[slot];
+	entry->file = file;
+	entry->line = line;
+	entry->id = (uint32_t)recorder->numSites++;
+	entry->used = true;
+
+	const size_t fileNameLength = RAYGE_MIN(strlen(file), (size_t)MAX_FILE_NAME_LENGTH);
+	uint8_t* record = ReserveBytes(recorder, MAX_SITE_RECORD_SIZE);
+	size_t length = 0;
+
+	record[length++] = MEMPOOL_TRACE_RECORD_SITE;
+	length += MemPoolTrace_EncodeVarint(record + length, entry->id);
+	length += MemPoolTrace_EncodeVarint(record + length, (uint64_t)(line > 0 ? line : 0));
+	length += MemPoolTrace_EncodeVarint(record + length, fileNameLength);
+	memcpy(record + length, file, fileNameLength);
+	length += fileNameLength;
+
+	recorder->bufferUsed += length;
+	return entry->id;
+}
+
+static void WriteUint32(uint8_t* buffer, uint32_t value)
+{
+	buffer[0] = (uint8_t)(value & 0xFF);
+	buffer[1] = (uint8_t)((value >> 8) & 0xFF);
+	buffer[2] = (uint8_t)((value >> 16) & 0xFF);
+	buffer[3] = (uint8_t)((value >> 24) & 0xFF);
+}
+
+// Lock must be held.
+static void CloseTraceFile(Recorder* recorder)
+{
+	if ( !recorder->file )
+	{
+		return;
+	}
+
+	FlushBuffer(recorder);
+	fclose(recorder->file);
+
+	recorder->file = NULL;
+	recorder->bufferUsed = 0;
+
+	// Site IDs are only meaningful within a single trace.
+	free(recorder->sites);
+	recorder->sites = NULL;
+	recorder->sitesCapacity = 0;
+	recorder->numSites = 0;
+}
+
+void MemPoolTrace_Init(void)
+{
+	if ( g_Initialised )
+	{
+		return;
+	}
+
+	memset(&g_Recorder, 0, sizeof(g_Recorder));
+	Threading_Mutex_Init(&g_Recorder.lock);
+
+	g_Initialised = true;
+}
+
+void MemPoolTrace_ShutDown(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	MemPoolTrace_Stop();
+	Threading_Mutex_Destroy(&g_Recorder.lock);
+
+	g_Initialised = false;
+}
+
+bool MemPoolTrace_Start(const char* path)
+{
+	RAYGE_ENSURE(g_Initialised, "Mem pool trace recorder was not initialised");
+	RAYGE_ASSERT_VALID(path);
+
+	if ( !path )
+	{
+		return false;
+	}
+
+	MemPoolTrace_Stop();
+
+	FILE* file = fopen(path, "wb");
+
+	if ( !file )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Could not open %s to record mem pool trace", path);
+		return false;
+	}
+
+	uint8_t header[sizeof(MemPoolTrace_FileHeader)];
+	memcpy(header, MEMPOOL_TRACE_MAGIC, 4);
+	WriteUint32(header + 4, MEMPOOL_TRACE_VERSION);
+	WriteUint32(header + 8, (uint32_t)MEMPOOL__COUNT);
+	WriteUint32(header + 12, 0);
+
+	if ( fwrite(header, 1, sizeof(header), file) != sizeof(header) )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Could not write mem pool trace header to %s", path);
+		fclose(file);
+		return false;
+	}
+
+	Threading_Mutex_Lock(&g_Recorder.lock);
+
+	g_Recorder.file = file;
+	g_Recorder.writeFailed = false;
+	g_Recorder.bufferUsed = 0;
+	g_Recorder.lastTimestampNs = MemPoolTrace_GetTimeNs();
+	Threading_AtomicStoreSize(&g_Recorder.recording, 1);
+
+	Threading_Mutex_Unlock(&g_Recorder.lock);
+
+	Logging_PrintLine(RAYGE_LOG_INFO, "Recording mem pool trace to %s", path);
+	return true;
+}
+
+void MemPoolTrace_Stop(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Recorder.lock);
+
+	const bool wasRecording = g_Recorder.file != NULL;
+
+	Threading_AtomicStoreSize(&g_Recorder.recording, 0);
+	CloseTraceFile(&g_Recorder);
+
+	const bool writeFailed = g_Recorder.writeFailed;
+	g_Recorder.writeFailed = false;
+
+	Threading_Mutex_Unlock(&g_Recorder.lock);
+
+	if ( writeFailed )
+	{
+		Logging_PrintLine(RAYGE_LOG_WARNING, "Some records could not be written to the mem pool trace");
+	}
+
+	if ( wasRecording )
+	{
+		Logging_PrintLine(RAYGE_LOG_INFO, "Stopped recording mem pool trace");
+	}
+}
+
+bool MemPoolTrace_IsRecording(void)
+{
+	return Threading_AtomicLoadSize(&g_Recorder.recording) != 0;
+}
+
+void MemPoolTrace_RecordAlloc(MemPool_Category category, size_t size, const void* memory, const char* file, int line)
+{
+	if ( !MemPoolTrace_IsRecording() )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Recorder.lock);
+
+	if ( g_Recorder.file )
+	{
+		const uint32_t siteId = GetSiteId(&g_Recorder, file, line);
+		uint8_t* record = ReserveBytes(&g_Recorder, MAX_RECORD_SIZE);
+		size_t length = 0;
+
+		record[length++] = MEMPOOL_TRACE_RECORD_ALLOC;
+		WriteTimestamp(&g_Recorder, record, &length);
+		length += MemPoolTrace_EncodeVarint(record + length, (uint64_t)category);
+		length += MemPoolTrace_EncodeVarint(record + length, size);
+		length += MemPoolTrace_EncodeVarint(record + length, (uint64_t)(uintptr_t)memory);
+		length += MemPoolTrace_EncodeVarint(record + length, siteId);
+
+		g_Recorder.bufferUsed += length;
+	}
+
+	Threading_Mutex_Unlock(&g_Recorder.lock);
+}
+
+void MemPoolTrace_RecordRealloc(
+	MemPool_Category category,
+	size_t size,
+	const void* oldMemory,
+	const void* newMemory,
+	const char* file,
+	int line
+)
+{
+	if ( !MemPoolTrace_IsRecording() )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Recorder.lock);
+
+	if ( g_Recorder.file )
+	{
+		const uint32_t siteId = GetSiteId(&g_Recorder, file, line);
+		uint8_t* record = ReserveBytes(&g_Recorder, MAX_RECORD_SIZE);
+		size_t length = 0;
+
+		record[length++] = MEMPOOL_TRACE_RECORD_REALLOC;
+		WriteTimestamp(&g_Recorder, record, &length);
+		length += MemPoolTrace_EncodeVarint(record + length, (uint64_t)category);
+		length += MemPoolTrace_EncodeVarint(record + length, size);
+		length += MemPoolTrace_EncodeVarint(record + length, (uint64_t)(uintptr_t)oldMemory);
+		length += MemPoolTrace_EncodeVarint(record + length, (uint64_t)(uintptr_t)newMemory);
+		length += MemPoolTrace_EncodeVarint(record + length, siteId);
+
+		g_Recorder.bufferUsed += length;
+	}
+
+	Threading_Mutex_Unlock(&g_Recorder.lock);
+}
+
+void MemPoolTrace_RecordFree(const void* memory, const char* file, int line)
+{
+	if ( !MemPoolTrace_IsRecording() )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Recorder.lock);
+
+	if ( g_Recorder.file )
+	{
+		const uint32_t siteId = GetSiteId(&g_Recorder, file, line);
+		uint8_t* record = ReserveBytes(&g_Recorder, MAX_RECORD_SIZE);
+		size_t length = 0;
+
+		record[length++] = MEMPOOL_TRACE_RECORD_FREE;
+		WriteTimestamp(&g_Recorder, record, &length);
+		length += MemPoolTrace_EncodeVarint(record + length, (uint64_t)(uintptr_t)memory);
+		length += MemPoolTrace_EncodeVarint(record + length, siteId);
+
+		g_Recorder.bufferUsed += length;
+	}
+
+	Threading_Mutex_Unlock(&g_Recorder.lock);
+}
+
+void MemPoolTrace_RecordFrame(void)
+{
+	if ( !MemPoolTrace_IsRecording() )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&g_Recorder.lock);
+
+	if ( g_Recorder.file )
+	{
+		uint8_t* record = ReserveBytes(&g_Recorder, MAX_RECORD_SIZE);
+		size_t length = 0;
+
+		record[length++] = MEMPOOL_TRACE_RECORD_FRAME;
+		WriteTimestamp(&g_Recorder, record, &length);
+
+		g_Recorder.bufferUsed += length;
+	}
+
+	Threading_Mutex_Unlock(&g_Recorder.lock);
+}
+
+uint64_t MemPoolTrace_GetTimeNs(void)
+{
+	return Threading_GetTimeNs();
+}
+
+#if RAYGE_BUILD_TESTING()
+#define TEST_TRACE_PATH "rayge_mempool_trace_test.bin"
+
+static uint8_t* LoadTestTrace(size_t* outLength)
+{
+	FILE* file = fopen(TEST_TRACE_PATH, "rb");
+
+	if ( !file )
+	{
+		return NULL;
+	}
+
+	uint8_t* data = (uint8_t*)malloc(BUFFER_SIZE);
+	*outLength = data ? fread(data, 1, BUFFER_SIZE, file) : 0;
+
+	fclose(file);
+	return data;
+}
+
+static uint64_t ExpectVarint(const uint8_t** cursor, const uint8_t* end)
+{
+	uint64_t value = 0;
+	TEST_EXPECT_TRUE(MemPoolTrace_DecodeVarint(cursor, end, &value));
+	return value;
+}
+
+void MemPoolTrace_RunTests(void)
+{
+	uint8_t varint[MEMPOOL_TRACE_MAX_VARINT_SIZE];
+	const uint64_t values[] = {0, 127, 128, 300, UINT32_MAX, UINT64_MAX};
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(values); ++index )
+	{
+		const size_t length = MemPoolTrace_EncodeVarint(varint, values[index]);
+		const uint8_t* cursor = varint;
+		uint64_t decoded = 0;
+
+		TEST_EXPECT_TRUE(length <= MEMPOOL_TRACE_MAX_VARINT_SIZE);
+		TEST_EXPECT_TRUE(MemPoolTrace_DecodeVarint(&cursor, varint + length, &decoded));
+		TEST_EXPECT_TRUE(decoded == values[index]);
+		TEST_EXPECT_TRUE(cursor == varint + length);
+
+		// Truncated varints must be rejected.
+		cursor = varint;
+		TEST_EXPECT_FALSE(MemPoolTrace_DecodeVarint(&cursor, varint + length - 1, &decoded));
+	}
+
+	if ( !TEST_EXPECT_TRUE(g_Initialised) || !TEST_EXPECT_TRUE(MemPoolTrace_Start(TEST_TRACE_PATH)) )
+	{
+		return;
+	}
+
+	TEST_EXPECT_TRUE(MemPoolTrace_IsRecording());
+
+	void* memory = MEMPOOL_MALLOC(MEMPOOL_TEST_MANAGER, 24);
+	void* reallocated = MEMPOOL_REALLOC(MEMPOOL_TEST_MANAGER, memory, 48);
+	MemPoolTrace_RecordFrame();
+	MEMPOOL_FREE(reallocated);
+
+	MemPoolTrace_Stop();
+	TEST_EXPECT_FALSE(MemPoolTrace_IsRecording());
+
+	size_t length = 0;
+	uint8_t* data = LoadTestTrace(&length);
+	remove(TEST_TRACE_PATH);
+
+	if ( !TEST_EXPECT_TRUE(data) || !TEST_EXPECT_TRUE(length > sizeof(MemPoolTrace_FileHeader)) )
+	{
+		free(data);
+		return;
+	}
+
+	TEST_EXPECT_EQL_INT(memcmp(data, MEMPOOL_TRACE_MAGIC, 4), 0);
+	TEST_EXPECT_EQL_INT(data[4], MEMPOOL_TRACE_VERSION);
+	TEST_EXPECT_EQL_INT(data[8], MEMPOOL__COUNT);
+
+	const uint8_t* cursor = data + sizeof(MemPoolTrace_FileHeader);
+	const uint8_t* end = data + length;
+
+	// Each call was made from a different line, so gets its own site.
+	TEST_EXPECT_EQL_INT(*cursor++, MEMPOOL_TRACE_RECORD_SITE);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), 0);
+	ExpectVarint(&cursor, end);
+	cursor += ExpectVarint(&cursor, end);
+
+	TEST_EXPECT_EQL_INT(*cursor++, MEMPOOL_TRACE_RECORD_ALLOC);
+	ExpectVarint(&cursor, end);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), MEMPOOL_TEST_MANAGER);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), 24);
+	TEST_EXPECT_TRUE(ExpectVarint(&cursor, end) == (uint64_t)(uintptr_t)memory);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), 0);
+
+	TEST_EXPECT_EQL_INT(*cursor++, MEMPOOL_TRACE_RECORD_SITE);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), 1);
+	ExpectVarint(&cursor, end);
+	cursor += ExpectVarint(&cursor, end);
+
+	TEST_EXPECT_EQL_INT(*cursor++, MEMPOOL_TRACE_RECORD_REALLOC);
+	ExpectVarint(&cursor, end);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), MEMPOOL_TEST_MANAGER);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), 48);
+	TEST_EXPECT_TRUE(ExpectVarint(&cursor, end) == (uint64_t)(uintptr_t)memory);
+	TEST_EXPECT_TRUE(ExpectVarint(&cursor, end) == (uint64_t)(uintptr_t)reallocated);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), 1);
+
+	TEST_EXPECT_EQL_INT(*cursor++, MEMPOOL_TRACE_RECORD_FRAME);
+	ExpectVarint(&cursor, end);
+
+	TEST_EXPECT_EQL_INT(*cursor++, MEMPOOL_TRACE_RECORD_SITE);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), 2);
+	ExpectVarint(&cursor, end);
+	cursor += ExpectVarint(&cursor, end);
+
+	TEST_EXPECT_EQL_INT(*cursor++, MEMPOOL_TRACE_RECORD_FREE);
+	ExpectVarint(&cursor, end);
+	TEST_EXPECT_TRUE(ExpectVarint(&cursor, end) == (uint64_t)(uintptr_t)reallocated);
+	TEST_EXPECT_EQL_INT(ExpectVarint(&cursor, end), 2);
+
+	TEST_EXPECT_TRUE(cursor == end);
+
+	free(data);
+}
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "MemPool/MemPoolManager.h"
+#include "Testing/Testing.h"
+
+// Records every mem pool allocation, reallocation and free to a binary
+// trace file (see MemPoolTraceFormat.h), so that real allocation patterns
+// can be replayed offline against different allocators.
+//
+// Records from all threads are written to the same file, in the order in
+// which they were recorded. Like the profiler, the recorder never allocates
+// from the mem pool itself.
+
+// Called by the mem pool manager.
+void MemPoolTrace_Init(void);
+void MemPoolTrace_ShutDown(void);
+
+// Any trace that is already being recorded is stopped first.
+// Returns false if the file could not be opened.
+bool MemPoolTrace_Start(const char* path);
+void MemPoolTrace_Stop(void);
+bool MemPoolTrace_IsRecording(void);
+
+// Called by the mem pool manager.
+void MemPoolTrace_RecordAlloc(MemPool_Category category, size_t size, const void* memory, const char* file, int line);
+
+void MemPoolTrace_RecordRealloc(
+	MemPool_Category category,
+	size_t size,
+	const void* oldMemory,
+	const void* newMemory,
+	const char* file,
+	int line
+);
+
+void MemPoolTrace_RecordFree(const void* memory, const char* file, int line);
+void MemPoolTrace_RecordFrame(void);
+
+// Monotonic clock used for trace timestamps.
+uint64_t MemPoolTrace_GetTimeNs(void);
+
+#if RAYGE_BUILD_TESTING()
+void MemPoolTrace_RunTests(void);
+#endif
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Binary format for mem pool allocation traces. This is shared between
+// the engine, which writes traces, and the replay tool, which reads them.
+//
+// A trace begins with a file header, followed by a stream of records.
+// Each record begins with a single type byte, followed by its fields,
+// each of which is encoded as an unsigned LEB128 varint:
+//
+//   SITE:    siteId, line, fileNameLength, followed by the file name bytes
+//   ALLOC:   deltaNs, category, size, address, siteId
+//   REALLOC: deltaNs, category, size, oldAddress, newAddress, siteId
+//   FREE:    deltaNs, address, siteId
+//   FRAME:   deltaNs
+//
+// deltaNs is the time since the previous record that had a timestamp.
+// A SITE record is written the first time that each allocation site is
+// referenced, before the record which references it. Site IDs start at
+// zero and are sequential. Addresses are only meaningful for matching up
+// allocations with later reallocations and frees.
+//
+// Allocations from the frame arena are never individually freed, so no
+// FREE records are written for them. They are released on the second
+// FRAME record after the one which preceded their allocation.
+
+#define MEMPOOL_TRACE_MAGIC "RGMT"
+#define MEMPOOL_TRACE_VERSION 1
+
+// A varint for a 64-bit value never needs more than this many bytes.
+#define MEMPOOL_TRACE_MAX_VARINT_SIZE 10
+
+typedef enum MemPoolTrace_RecordType
+{
+	MEMPOOL_TRACE_RECORD_SITE = 1,
+	MEMPOOL_TRACE_RECORD_ALLOC,
+	MEMPOOL_TRACE_RECORD_REALLOC,
+	MEMPOOL_TRACE_RECORD_FREE,
+	MEMPOOL_TRACE_RECORD_FRAME,
+} MemPoolTrace_RecordType;
+
+// All fields are little-endian.
+typedef struct MemPoolTrace_FileHeader
+{
+	char magic[4];
+	uint32_t version;
+
+	// Number of categories in the MemPool_Category enum when
+	// the trace was written, so that readers can check that
+	// category values still mean the same thing.
+	uint32_t numCategories;
+	uint32_t reserved;
+} MemPoolTrace_FileHeader;
+
+// Returns the number of bytes written, which is at most MEMPOOL_TRACE_MAX_VARINT_SIZE.
+static inline size_t MemPoolTrace_EncodeVarint(uint8_t* buffer, uint64_t value)
+{
+	size_t length = 0;
+
+	do
+	{
+		uint8_t byte = (uint8_t)(value & 0x7F);
+		value >>= 7;
+
+		if ( value )
+		{
+			byte |= 0x80;
+		}
+
+		buffer[length++] = byte;
+	}
+	while ( value );
+
+	return length;
+}
+
+// Advances the cursor past the varint. Returns false
+// if the varint was truncated or malformed.
+static inline bool MemPoolTrace_DecodeVarint(const uint8_t** cursor, const uint8_t* end, uint64_t* outValue)
+{
+	uint64_t value = 0;
+
+	for ( unsigned int shift = 0; shift < 64 && *cursor < end; shift += 7 )
+	{
+		const uint8_t byte = *((*cursor)++);
+		value |= (uint64_t)(byte & 0x7F) << shift;
+
+		if ( !(byte & 0x80) )
+		{
+			*outValue = value;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -9,6 +9,7 @@
 #include "Non-Headless/UI/ImGuiDemo.h"
 #include "Non-Headless/UI/DeveloperConsole.h"
 #include "Non-Headless/UI/ResourceViewer.h"
+#include "Non-Headless/UI/MemPoolProfilerUI.h"
 #include "Debugging.h"
 #include "wzl_cutl/string.h"
 #include "utlist.h"
@@ -188,6 +189,7 @@ static void RegisterMenus(void)
 	RegisterMenu(KEY_GRAVE, KEYMOD_CTRL | KEYMOD_ALT, "Engine.Menu.ImGuiDemo", &Menu_ImGuiDemo);
 
 	RegisterMenuCommandOnly("Engine.Menu.ResourceViewer", &Menu_ResourceViewer);
+	RegisterMenuCommandOnly("Engine.Menu.MemPoolProfiler", &Menu_MemPoolProfilerUI);
 }
 
 void MenuHooks_Register(void)
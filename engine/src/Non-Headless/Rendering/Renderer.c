@@ -3,6 +3,7 @@
 #include "Non-Headless/Rendering/Renderer.h"
 #include "RayGE/External/raymath.h"
 #include "Resources/RenderablePrimitives.h"
+#include "Resources/TextureResources.h"
 #include "Non-Headless/EngineSubsystems/RendererSubsystem.h"
 #include "MemPool/MemPoolManager.h"
 #include "EngineSubsystems/SceneSubsystem.h"
@@ -17,6 +18,8 @@
 
 #define DBG_LOCATION_MARKER_RADIUS 4.0f
 #define MAX_DEV_TEXT_LENGTH 256
+#define FALLBACK_TEXTURE_SIZE 64
+#define FALLBACK_TEXTURE_CHECKS 8
 
 typedef enum DrawMode
 {
@@ -38,6 +41,9 @@ struct RayGE_Renderer
 	// Only used if the "override camera" debug flag is set
 	Camera2D debugCam2D;
 	Camera3D debugCam3D;
+
+	// Drawn in place of textures which are not loaded yet, or failed to load.
+	Texture2D fallbackTexture;
 };
 
 static Camera2D Default2DCamera(void)
@@ -161,53 +167,43 @@ static void DrawRawVertex2D(const Renderer_RawVertex2D* vertex)
 	rlVertex2f(vertex->pos.x, vertex->pos.y);
 }
 
-static void DrawEntityLocation(RayGE_Entity* entity)
+static void DrawEntityLocation(const RayGE_Component_Spatial* spatial)
 {
-	RayGE_ComponentHeader* cmpHeader = Entity_GetFirstComponentOfType(entity, RAYGE_COMPONENTTYPE_SPATIAL);
-
-	if ( !cmpHeader )
-	{
-		// No spatial information.
-		return;
-	}
-
-	RayGE_ComponentImpl_Spatial* component = COMPONENTCAST_SPATIAL(cmpHeader, true);
-
 	Vector3 forward;
 	Vector3 right;
-	EulerAnglesToBasis(component->data.angles, &forward, &right, NULL);
+	EulerAnglesToBasis(spatial->angles, &forward, &right, NULL);
 
 	// World X
 	DrawLine3D(
-		Vector3Add(component->data.position, (Vector3) {-0.2f * DBG_LOCATION_MARKER_RADIUS, 0.0f, 0.0f}),
-		Vector3Add(component->data.position, (Vector3) {1.2f * DBG_LOCATION_MARKER_RADIUS, 0.0f, 0.0f}),
+		Vector3Add(spatial->position, (Vector3) {-0.2f * DBG_LOCATION_MARKER_RADIUS, 0.0f, 0.0f}),
+		Vector3Add(spatial->position, (Vector3) {1.2f * DBG_LOCATION_MARKER_RADIUS, 0.0f, 0.0f}),
 		RED
 	);
 
 	// World Y
 	DrawLine3D(
-		Vector3Add(component->data.position, (Vector3) {0.0f, -0.2f * DBG_LOCATION_MARKER_RADIUS, 0.0f}),
-		Vector3Add(component->data.position, (Vector3) {0.0f, 1.2f * DBG_LOCATION_MARKER_RADIUS, 0.0f}),
+		Vector3Add(spatial->position, (Vector3) {0.0f, -0.2f * DBG_LOCATION_MARKER_RADIUS, 0.0f}),
+		Vector3Add(spatial->position, (Vector3) {0.0f, 1.2f * DBG_LOCATION_MARKER_RADIUS, 0.0f}),
 		GREEN
 	);
 
 	// World Z
 	DrawLine3D(
-		Vector3Add(component->data.position, (Vector3) {0.0f, 0.0f, -0.2f * DBG_LOCATION_MARKER_RADIUS}),
-		Vector3Add(component->data.position, (Vector3) {0.0f, 0.0f, 1.2f * DBG_LOCATION_MARKER_RADIUS}),
+		Vector3Add(spatial->position, (Vector3) {0.0f, 0.0f, -0.2f * DBG_LOCATION_MARKER_RADIUS}),
+		Vector3Add(spatial->position, (Vector3) {0.0f, 0.0f, 1.2f * DBG_LOCATION_MARKER_RADIUS}),
 		BLUE
 	);
 
 	// Yaw circle
-	DrawCircle3D(component->data.position, DBG_LOCATION_MARKER_RADIUS, (Vector3) {0.0f, 0.0f, 1.0f}, 0.0f, GREEN);
+	DrawCircle3D(spatial->position, DBG_LOCATION_MARKER_RADIUS, (Vector3) {0.0f, 0.0f, 1.0f}, 0.0f, GREEN);
 
 	// Rotate pitch circle from being an XY disc to an XZ disc.
 	Quaternion pitchRot =
-		QuaternionFromAxisAngle((Vector3) {1.0f, 0.0f, 0.0}, DEG2RAD * (90.0f + component->data.angles.roll));
+		QuaternionFromAxisAngle((Vector3) {1.0f, 0.0f, 0.0}, DEG2RAD * (90.0f + spatial->angles.roll));
 
 	// Rotate to point in direction of yaw.
 	pitchRot = QuaternionMultiply(
-		QuaternionFromAxisAngle((Vector3) {0.0f, 0.0f, 1.0f}, DEG2RAD * component->data.angles.yaw),
+		QuaternionFromAxisAngle((Vector3) {0.0f, 0.0f, 1.0f}, DEG2RAD * spatial->angles.yaw),
 		pitchRot
 	);
 
@@ -216,26 +212,26 @@ static void DrawEntityLocation(RayGE_Entity* entity)
 	QuaternionToAxisAngle(pitchRot, &rotAxis, &rotAngle);
 
 	// Pitch circle
-	DrawCircle3D(component->data.position, DBG_LOCATION_MARKER_RADIUS, rotAxis, RAD2DEG * rotAngle, RED);
+	DrawCircle3D(spatial->position, DBG_LOCATION_MARKER_RADIUS, rotAxis, RAD2DEG * rotAngle, RED);
 
 	// Rotate roll circle from being an XY disc to an XZ disc.
 	Quaternion rollRot = QuaternionFromAxisAngle((Vector3) {1.0f, 0.0f, 0.0}, DEG2RAD * 90.0f);
 
 	// Rotate to point perpendicular to yaw.
 	rollRot = QuaternionMultiply(
-		QuaternionFromAxisAngle((Vector3) {0.0f, 0.0f, 1.0f}, DEG2RAD * (component->data.angles.yaw - 90.0f)),
+		QuaternionFromAxisAngle((Vector3) {0.0f, 0.0f, 1.0f}, DEG2RAD * (spatial->angles.yaw - 90.0f)),
 		rollRot
 	);
 
 	QuaternionToAxisAngle(rollRot, &rotAxis, &rotAngle);
 
 	// Roll circle
-	DrawCircle3D(component->data.position, DBG_LOCATION_MARKER_RADIUS, rotAxis, RAD2DEG * rotAngle, BLUE);
+	DrawCircle3D(spatial->position, DBG_LOCATION_MARKER_RADIUS, rotAxis, RAD2DEG * rotAngle, BLUE);
 
-	Vector3 endPoint = Vector3Add(component->data.position, Vector3Scale(forward, DBG_LOCATION_MARKER_RADIUS));
+	Vector3 endPoint = Vector3Add(spatial->position, Vector3Scale(forward, DBG_LOCATION_MARKER_RADIUS));
 
 	// Direction
-	DrawLine3D(component->data.position, endPoint, YELLOW);
+	DrawLine3D(spatial->position, endPoint, YELLOW);
 }
 
 static void DrawRenderablePrimitive(
@@ -272,7 +268,27 @@ static void DrawRenderablePrimitive(
 	}
 }
 
-static void DrawRenderable(const RayGE_Component_Renderable* renderable, Vector3 position)
+static void DrawRenderableTexture(
+	const RayGE_Renderer* renderer,
+	const RayGE_Component_Renderable* renderable,
+	Vector3 position
+)
+{
+	Texture2D texture = TextureResources_GetTextureFromHandle(renderable->handle);
+
+	if ( texture.id == 0 )
+	{
+		texture = renderer->fallbackTexture;
+	}
+
+	DrawBillboard(GetCamera3D(renderer), texture, position, renderable->scale, PublicToRaylibColor(renderable->color));
+}
+
+static void DrawRenderable(
+	const RayGE_Renderer* renderer,
+	const RayGE_Component_Renderable* renderable,
+	Vector3 position
+)
 {
 	if ( !renderable )
 	{
@@ -291,6 +307,12 @@ static void DrawRenderable(const RayGE_Component_Renderable* renderable, Vector3
 			break;
 		}
 
+		case RESOURCE_DOMAIN_TEXTURE:
+		{
+			DrawRenderableTexture(renderer, renderable, position);
+			break;
+		}
+
 		default:
 		{
 			break;
@@ -310,6 +332,18 @@ RayGE_Renderer* Renderer_Create(void)
 	renderer->cam3D = Default3DCamera();
 	renderer->debugCam3D = Default3DCamera();
 
+	Image fallbackImage = GenImageChecked(
+		FALLBACK_TEXTURE_SIZE,
+		FALLBACK_TEXTURE_SIZE,
+		FALLBACK_TEXTURE_SIZE / FALLBACK_TEXTURE_CHECKS,
+		FALLBACK_TEXTURE_SIZE / FALLBACK_TEXTURE_CHECKS,
+		MAGENTA,
+		BLACK
+	);
+
+	renderer->fallbackTexture = LoadTextureFromImage(fallbackImage);
+	UnloadImage(fallbackImage);
+
 	return renderer;
 }
 
@@ -322,6 +356,11 @@ void Renderer_Destroy(RayGE_Renderer* renderer)
 		return;
 	}
 
+	if ( renderer->fallbackTexture.id != 0 )
+	{
+		UnloadTexture(renderer->fallbackTexture);
+	}
+
 	MEMPOOL_FREE(renderer);
 }
 
@@ -539,24 +578,27 @@ void Renderer_DrawEntity3D(RayGE_Renderer* renderer, RayGE_Entity* entity)
 		return;
 	}
 
-	if ( renderer->debugFlags & RENDERER_DBG_DRAW_LOCATIONS )
+	const RayGE_Component_Spatial* spatial =
+		COMPONENTDATA_SPATIAL(Entity_GetComponent(entity, RAYGE_COMPONENTTYPE_SPATIAL));
+
+	const RayGE_Component_Renderable* renderable =
+		COMPONENTDATA_RENDERABLE(Entity_GetComponent(entity, RAYGE_COMPONENTTYPE_RENDERABLE));
+
+	if ( spatial && (renderer->debugFlags & RENDERER_DBG_DRAW_LOCATIONS) )
 	{
-		DrawEntityLocation(entity);
+		DrawEntityLocation(spatial);
 	}
 
-	RayGE_ComponentHeader* spatial = Entity_GetFirstComponentOfType(entity, RAYGE_COMPONENTTYPE_SPATIAL);
-	RayGE_ComponentHeader* renderable = Entity_GetFirstComponentOfType(entity, RAYGE_COMPONENTTYPE_RENDERABLE);
-
 	Vector3 position = {0.0f, 0.0f, 0.0f};
 
 	if ( spatial )
 	{
-		position = COMPONENTDATA_SPATIAL(spatial)->position;
+		position = spatial->position;
 	}
 
 	if ( renderable )
 	{
-		DrawRenderable(COMPONENTDATA_RENDERABLE(renderable), position);
+		DrawRenderable(renderer, renderable, position);
 	}
 }
 
@@ -568,18 +610,37 @@ void Renderer_DrawAllActiveEntitiesInScene3D(RayGE_Renderer* renderer)
 	}
 
 	RayGE_Scene* scene = SceneSubsystem_GetScene();
-	const uint32_t maxEntities = Scene_GetMaxEntities(scene);
 
-	for ( uint32_t index = 0; index < maxEntities; ++index )
+	const RayGE_ComponentMask drawableMask =
+		COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL) | COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_RENDERABLE);
+
+	// Only entities that are both spatial and renderable are visited,
+	// and their components are walked chunk by chunk as contiguous arrays.
+	for ( RayGE_EntityChunkIterator iterator = Scene_GetChunkIterator(scene, drawableMask);
+		  Entity_ChunkIteratorIsValid(iterator);
+		  iterator = Entity_IncrementChunkIterator(iterator) )
 	{
-		RayGE_Entity* entity = Scene_GetActiveEntity(scene, index);
+		const RayGE_ArchetypeChunk* chunk = Entity_GetChunkFromIterator(iterator);
+		const RayGE_Component_Spatial* spatials = ARCHETYPECHUNK_SPATIAL(chunk);
+		const RayGE_Component_Renderable* renderables = ARCHETYPECHUNK_RENDERABLE(chunk);
 
-		if ( !entity )
+		for ( uint32_t row = 0; row < chunk->count; ++row )
 		{
-			continue;
+			DrawRenderable(renderer, &renderables[row], spatials[row].position);
 		}
+	}
 
-		Renderer_DrawEntity3D(renderer, entity);
+	if ( renderer->debugFlags & RENDERER_DBG_DRAW_LOCATIONS )
+	{
+		const RayGE_EntityQueryResult spatialEntities =
+			Scene_Query(scene, COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL));
+
+		for ( uint32_t index = 0; index < spatialEntities.count; ++index )
+		{
+			DrawEntityLocation(
+				COMPONENTDATA_SPATIAL(Entity_GetComponent(spatialEntities.entities[index], RAYGE_COMPONENTTYPE_SPATIAL))
+			);
+		}
 	}
 }
 
@@ -654,8 +715,10 @@ void Renderer_DirectDrawImGui(RayGE_Renderer* renderer)
 		batch.indexCount = (size_t)commandList->IdxBuffer.Size;
 		batch.vertexCount = (size_t)commandList->VtxBuffer.Size;
 
+		// Only needed until the batch is drawn, so this
+		// comes from the frame arena and is not freed.
 		Renderer_RawVertex2D* vertices =
-			(Renderer_RawVertex2D*)MEMPOOL_MALLOC(MEMPOOL_RENDERER, batch.vertexCount * sizeof(Renderer_RawVertex2D));
+			(Renderer_RawVertex2D*)MEMPOOL_MALLOC(MEMPOOL_FRAME, batch.vertexCount * sizeof(Renderer_RawVertex2D));
 
 		for ( size_t vIndex = 0; vIndex < batch.vertexCount; ++vIndex )
 		{
@@ -714,8 +777,6 @@ void Renderer_DirectDrawImGui(RayGE_Renderer* renderer)
 
 			rlDrawRenderBatchActive();
 		}
-
-		MEMPOOL_FREE(vertices);
 	}
 
 	rlSetTexture(0);
@@ -0,0 +1,224 @@
+#include "Non-Headless/UI/MemPoolProfilerUI.h"
+#include "MemPool/MemPoolProfiler.h"
+#include "MemPool/MemPoolManager.h"
+#include "cimgui.h"
+
+typedef struct Data
+{
+	bool active;
+
+	// Kept between frames, so that the profiler
+	// does not record the UI churning the heap.
+	MemPoolProfiler_Site* sites;
+	size_t sitesCapacity;
+
+	MemPoolProfiler_SortKey sortKey;
+	bool sortDescending;
+} Data;
+
+static Data g_Data = {
+	.sortKey = MEMPOOL_PROFILER_SORT_LIVE_BYTES,
+	.sortDescending = true,
+};
+
+static size_t FetchSites(Data* data)
+{
+	const size_t numSites = MemPoolProfiler_GetSites(NULL, 0);
+
+	if ( numSites > data->sitesCapacity )
+	{
+		// Leave some headroom, since new sites will keep turning up.
+		const size_t newCapacity = numSites * 2;
+
+		data->sites = (MemPoolProfiler_Site*)
+			MEMPOOL_REALLOC(MEMPOOL_UI, data->sites, newCapacity * sizeof(MemPoolProfiler_Site));
+
+		data->sitesCapacity = newCapacity;
+	}
+
+	if ( !data->sites )
+	{
+		return 0;
+	}
+
+	const size_t numCopied = MemPoolProfiler_GetSites(data->sites, data->sitesCapacity);
+	return numCopied < data->sitesCapacity ? numCopied : data->sitesCapacity;
+}
+
+static void UpdateSortSpecs(Data* data)
+{
+	ImGuiTableSortSpecs* sortSpecs = igTableGetSortSpecs();
+
+	if ( !sortSpecs || !sortSpecs->SpecsDirty )
+	{
+		return;
+	}
+
+	if ( sortSpecs->SpecsCount > 0 )
+	{
+		data->sortKey = (MemPoolProfiler_SortKey)sortSpecs->Specs[0].ColumnUserID;
+		data->sortDescending = sortSpecs->Specs[0].SortDirection == ImGuiSortDirection_Descending;
+	}
+
+	sortSpecs->SpecsDirty = false;
+}
+
+static void DrawControls(void)
+{
+	bool enabled = MemPoolProfiler_IsEnabled();
+
+	if ( igCheckbox("Enabled", &enabled) )
+	{
+		MemPoolProfiler_SetEnabled(enabled);
+	}
+
+	igSameLine(0.0f, -1.0f);
+
+	int sampleRate = (int)MemPoolProfiler_GetSampleRate();
+
+	igSetNextItemWidth(120.0f);
+
+	if ( igInputInt("Sample rate", &sampleRate, 1, 16, 0) )
+	{
+		MemPoolProfiler_SetSampleRate(sampleRate > 0 ? (size_t)sampleRate : 1);
+	}
+
+	igSameLine(0.0f, -1.0f);
+
+	if ( igButton("Reset", (ImVec2) {0.0f, 0.0f}) )
+	{
+		MemPoolProfiler_Reset();
+	}
+}
+
+static void DrawSitesTable(Data* data)
+{
+	const size_t numSites = FetchSites(data);
+	igText("Allocation sites: %zu", numSites);
+
+	const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+		ImGuiTableFlags_BordersOuter | ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable;
+
+	if ( !igBeginTable("Sites", 6, tableFlags, (ImVec2) {0.0f, 0.0f}, 0.0f) )
+	{
+		return;
+	}
+
+	igTableSetupColumn("Location", ImGuiTableColumnFlags_None, 0.0f, MEMPOOL_PROFILER_SORT_LOCATION);
+	igTableSetupColumn(
+		"Live Bytes",
+		ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending,
+		0.0f,
+		MEMPOOL_PROFILER_SORT_LIVE_BYTES
+	);
+	igTableSetupColumn(
+		"Live Count",
+		ImGuiTableColumnFlags_PreferSortDescending,
+		0.0f,
+		MEMPOOL_PROFILER_SORT_LIVE_COUNT
+	);
+	igTableSetupColumn(
+		"Total Allocs",
+		ImGuiTableColumnFlags_PreferSortDescending,
+		0.0f,
+		MEMPOOL_PROFILER_SORT_TOTAL_ALLOCATIONS
+	);
+	igTableSetupColumn(
+		"Allocs/Frame",
+		ImGuiTableColumnFlags_PreferSortDescending,
+		0.0f,
+		MEMPOOL_PROFILER_SORT_ALLOCATIONS_PER_FRAME
+	);
+	igTableSetupColumn(
+		"Peak/Frame",
+		ImGuiTableColumnFlags_PreferSortDescending,
+		0.0f,
+		MEMPOOL_PROFILER_SORT_PEAK_ALLOCATIONS_PER_FRAME
+	);
+	igTableSetupScrollFreeze(0, 1);
+	igTableHeadersRow();
+
+	UpdateSortSpecs(data);
+	MemPoolProfiler_SortSites(data->sites, numSites, data->sortKey, data->sortDescending);
+
+	for ( size_t index = 0; index < numSites; ++index )
+	{
+		const MemPoolProfiler_Site* site = &data->sites[index];
+
+		igTableNextRow(0, 0.0f);
+
+		igTableNextColumn();
+		igText("%s:%d", MemPoolProfiler_ShortFileName(site->file), site->line);
+
+		igTableNextColumn();
+		igText("%zu", site->liveBytes);
+
+		igTableNextColumn();
+		igText("%zu", site->liveCount);
+
+		igTableNextColumn();
+		igText("%zu", site->totalAllocations);
+
+		igTableNextColumn();
+		igText("%zu", site->allocationsPerFrame);
+
+		igTableNextColumn();
+		igText("%zu", site->peakAllocationsPerFrame);
+	}
+
+	igEndTable();
+}
+
+static void Show(void* userData)
+{
+	Data* data = (Data*)userData;
+	data->active = true;
+}
+
+static void Hide(void* userData)
+{
+	Data* data = (Data*)userData;
+	data->active = false;
+}
+
+static void ShutDown(void* userData)
+{
+	Data* data = (Data*)userData;
+
+	if ( data->sites )
+	{
+		MEMPOOL_FREE(data->sites);
+		data->sites = NULL;
+	}
+
+	data->sitesCapacity = 0;
+}
+
+static bool Poll(void* userData)
+{
+	Data* data = (Data*)userData;
+
+	if ( data->active )
+	{
+		if ( igBegin("Mem Pool Profiler", &data->active, ImGuiWindowFlags_None) )
+		{
+			DrawControls();
+			igSeparator();
+			DrawSitesTable(data);
+		}
+
+		igEnd();
+	}
+
+	return data->active;
+}
+
+const RayGE_UIMenu Menu_MemPoolProfilerUI = {
+	&g_Data,
+
+	NULL,  // Init
+	ShutDown,
+	Show,
+	Hide,
+	Poll,
+};
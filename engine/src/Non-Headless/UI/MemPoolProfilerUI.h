@@ -0,0 +1,5 @@
+#pragma once
+
+#include "Non-Headless/EngineSubsystems/UISubsystem.h"
+
+extern const RayGE_UIMenu Menu_MemPoolProfilerUI;
@@ -95,6 +95,16 @@ PixelWorld* PixelWorld_Create(const char* jsonPath)
 	return NULL;
 }
 
+size_t PixelWorld_GetCpuBytes(const PixelWorld* world)
+{
+	if ( !world || !world->baseImage.data )
+	{
+		return 0;
+	}
+
+	return (size_t)GetPixelDataSize(world->baseImage.width, world->baseImage.height, world->baseImage.format);
+}
+
 void PixelWorld_Destroy(PixelWorld* world)
 {
 	RAYGE_ASSERT_VALID(world);
@@ -7,3 +7,6 @@ typedef struct PixelWorld PixelWorld;
 
 WZL_ATTR_NODISCARD PixelWorld* PixelWorld_Create(const char* jsonPath);
 void PixelWorld_Destroy(PixelWorld* world);
+
+// Approximate size of the world's data in system memory.
+size_t PixelWorld_GetCpuBytes(const PixelWorld* world);
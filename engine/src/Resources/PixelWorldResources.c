@@ -1,5 +1,7 @@
+#include <stddef.h>
 #include "Resources/PixelWorldResources.h"
 #include "Resources/ResourceList.h"
+#include "Resources/ResourceResidency.h"
 #include "Resources/ResourceDomains.h"
 #include "PixelWorld/PixelWorld.h"
 #include "Resources/ResourceListUtils.h"
@@ -11,29 +13,54 @@
 
 typedef struct PixelWorldItem
 {
+	ResourceResidency_Item residency;
 	PixelWorld* world;
 } PixelWorldItem;
 
 static ResourceList* g_ResourceList = NULL;
 
-static void DeinitItem(void* item)
+static void UnloadItemWorld(PixelWorldItem* item)
 {
-	PixelWorldItem* pItem = (PixelWorldItem*)item;
+	ResourceResidency_Untrack(&item->residency);
 
-	if ( pItem->world )
+	if ( item->world )
 	{
-		PixelWorld_Destroy(pItem->world);
-		pItem->world = NULL;
+		PixelWorld_Destroy(item->world);
+		item->world = NULL;
 	}
 }
 
-static bool CreateItemCallback(const char* relPath, void* itemData, void* userData)
+static void TrackItemWorld(PixelWorldItem* item, size_t cpuBytes)
 {
-	(void)userData;
+	// Worlds count towards the CPU budget, but are not evicted: nothing dereferences
+	// them through PixelWorldResources_GetPixelWorld() yet, so a world that is in use
+	// every frame would never be touched, and would be evicted and never reloaded.
+	// The world's textures are tracked separately by the texture resources.
+	ResourceResidency_Track(&item->residency, cpuBytes, 0, NULL);
+}
 
-	PixelWorldItem* item = (PixelWorldItem*)itemData;
+static bool LoadItemWorld(PixelWorldItem* item, const char* relPath)
+{
 	item->world = PixelWorld_Create(relPath);
-	return item->world != NULL;
+
+	if ( !item->world )
+	{
+		return false;
+	}
+
+	TrackItemWorld(item, PixelWorld_GetCpuBytes(item->world));
+	return true;
+}
+
+static void DeinitItem(void* item)
+{
+	UnloadItemWorld((PixelWorldItem*)item);
+}
+
+static bool CreateItemCallback(const char* relPath, void* itemData, void* userData)
+{
+	(void)userData;
+	return LoadItemWorld((PixelWorldItem*)itemData, relPath);
 }
 
 void PixelWorldResources_Init(void)
@@ -68,6 +95,16 @@ void PixelWorldResources_ShutDown(void)
 	g_ResourceList = NULL;
 }
 
+void PixelWorldResources_NewFrame(void)
+{
+	if ( !g_ResourceList )
+	{
+		return;
+	}
+
+	ResourceList_DestroyPendingItems(g_ResourceList);
+}
+
 RayGE_ResourceHandle PixelWorldResources_LoadPixelWorld(const char* path)
 {
 	RAYGE_ASSERT_VALID(g_ResourceList);
@@ -89,5 +126,77 @@ void PixelWorldResources_UnloadPixelWorld(RayGE_ResourceHandle handle)
 		return;
 	}
 
-	ResourceList_DestroyItem(g_ResourceList, handle);
+	ResourceList_ReleaseItem(g_ResourceList, handle);
+}
+
+RayGE_ResourceLoadState PixelWorldResources_GetLoadState(RayGE_ResourceHandle handle)
+{
+	RAYGE_ASSERT_VALID(g_ResourceList);
+
+	if ( !g_ResourceList || !ResourceList_GetItemData(g_ResourceList, handle) )
+	{
+		return RAYGE_RESOURCE_LOAD_STATE_INVALID;
+	}
+
+	return RAYGE_RESOURCE_LOAD_STATE_LOADED;
+}
+
+PixelWorld* PixelWorldResources_GetPixelWorld(RayGE_ResourceHandle handle)
+{
+	RAYGE_ASSERT_VALID(g_ResourceList);
+
+	if ( !g_ResourceList )
+	{
+		return NULL;
+	}
+
+	PixelWorldItem* item = (PixelWorldItem*)ResourceList_GetItemData(g_ResourceList, handle);
+
+	if ( !item )
+	{
+		return NULL;
+	}
+
+	ResourceResidency_Touch(&item->residency);
+	return item->world;
+}
+
+#if RAYGE_BUILD_TESTING()
+static void TestWorldUsedEveryFrameIsNotEvicted(void)
+{
+	const ResourceResidency_Stats savedStats = ResourceResidency_GetStats();
+	PixelWorldItem item = {0};
+
+	// Go well over a tiny CPU budget, so that an evictable item would be evicted.
+	ResourceResidency_SetBudgets(1, savedStats.gpuBudget);
+	TrackItemWorld(&item, 1024);
+
+	TEST_EXPECT_TRUE(ResourceResidency_IsTracked(&item.residency));
+
+	for ( size_t frame = 0; frame < 4; ++frame )
+	{
+		ResourceResidency_Touch(&item.residency);
+		ResourceResidency_NewFrame();
+	}
+
+	TEST_EXPECT_TRUE(ResourceResidency_IsTracked(&item.residency));
+
+	// Worlds are currently used through a pointer that is held across frames,
+	// so they are never touched. They must survive this too.
+	for ( size_t frame = 0; frame < 4; ++frame )
+	{
+		ResourceResidency_NewFrame();
+	}
+
+	TEST_EXPECT_TRUE(ResourceResidency_IsTracked(&item.residency));
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().numEvictions, savedStats.numEvictions);
+
+	ResourceResidency_Untrack(&item.residency);
+	ResourceResidency_SetBudgets(savedStats.cpuBudget, savedStats.gpuBudget);
+}
+
+void PixelWorldResources_RunTests(void)
+{
+	TestWorldUsedEveryFrameIsNotEvicted();
 }
+#endif
@@ -2,10 +2,27 @@
 
 #include "PixelWorld/PixelWorld.h"
 #include "RayGE/ResourceHandle.h"
+#include "RayGE/APIs/Resources.h"
+#include "Testing/Testing.h"
 #include "wzl_cutl/attributes.h"
 
 void PixelWorldResources_Init(void);
 void PixelWorldResources_ShutDown(void);
+void PixelWorldResources_NewFrame(void);
 
+// Pixel worlds are reference counted. Loading a path that is already loaded
+// returns the same handle, and each load must be matched by an unload.
+// Worlds that are no longer referenced are destroyed on the next frame.
 WZL_ATTR_NODISCARD RayGE_ResourceHandle PixelWorldResources_LoadPixelWorld(const char* path);
 void PixelWorldResources_UnloadPixelWorld(RayGE_ResourceHandle handle);
+
+// Pixel worlds are always loaded synchronously, so are never pending.
+RayGE_ResourceLoadState PixelWorldResources_GetLoadState(RayGE_ResourceHandle handle);
+
+// Marks the world as used. Worlds are counted towards the resource CPU budget,
+// but are never evicted.
+PixelWorld* PixelWorldResources_GetPixelWorld(RayGE_ResourceHandle handle);
+
+#if RAYGE_BUILD_TESTING()
+void PixelWorldResources_RunTests(void);
+#endif
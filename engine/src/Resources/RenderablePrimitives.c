@@ -8,7 +8,7 @@ RayGE_ResourceHandle RenderablePrimitive_GetHandle(RayGE_RenderablePrimitive pri
 		return RAYGE_NULL_RESOURCE_HANDLE;
 	}
 
-	// Keys don't matter here since these resources aren't specific items,
+	// Generations don't matter here since these resources aren't specific items,
 	// but more just constants representing primitives.
 	return Resource_CreateInternalHandle(RESOURCE_DOMAIN_RENDERABLE_PRIMITIVE, (uint32_t)primitive, 0);
 }
@@ -24,5 +24,5 @@ RayGE_RenderablePrimitive RenderablePrimitive_GetPrimitiveFromHandle(RayGE_Resou
 		return RAYGE_RENDERABLE_PRIM_INVALID;
 	}
 
-	return (RayGE_RenderablePrimitive)handle.index;
+	return (RayGE_RenderablePrimitive)RAYGE_RESOURCE_HANDLE_INDEX(handle);
 }
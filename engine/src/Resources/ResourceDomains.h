@@ -17,5 +17,7 @@ typedef enum InternalResourceDomain
 	RESOURCE_DOMAIN__COUNT
 } InternalResourceDomain;
 
-#define RESOURCEFLAG_INTERNAL_DOMAIN (1 << 31)
-#define RESOURCE_DOMAIN_ID_MASK ((uint32_t)0x7FFFFFFF)
+// The domain occupies RAYGE_RESOURCE_HANDLE_DOMAIN_BITS of a handle,
+// with the top bit reserved for the internal flag.
+#define RESOURCEFLAG_INTERNAL_DOMAIN (1 << 7)
+#define RESOURCE_DOMAIN_ID_MASK ((uint32_t)0x7F)
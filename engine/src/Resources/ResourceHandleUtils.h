@@ -5,8 +5,10 @@
 #include "Resources/ResourceDomains.h"
 #include "Debugging.h"
 
-RayGE_ResourceHandle Resource_CreateInternalHandle(InternalResourceDomain domain, uint32_t index, uint64_t key);
-uint64_t Resource_CreateKey(uint32_t index);
+// The generation is that of the slot at the given index, which changes
+// whenever the slot is released so that old handles are rejected.
+// The index must be no greater than RAYGE_RESOURCE_HANDLE_MAX_INDEX.
+RayGE_ResourceHandle Resource_CreateInternalHandle(InternalResourceDomain domain, uint32_t index, uint32_t generation);
 InternalResourceDomain Resource_GetInternalDomain(RayGE_ResourceHandle handle);
 
 bool Resource_HandleIsValidForInternalDomain(
@@ -1,8 +1,12 @@
 #include <stdbool.h>
 #include "Resources/ResourceList.h"
 #include "MemPool/MemPoolManager.h"
+#include "MemPool/MemPoolObjectPool.h"
 #include "Resources/ResourceHandleUtils.h"
+#include "Utils/Utils.h"
+#include "Utils/BitUtils.h"
 #include "Debugging.h"
+#include "utlist.h"
 
 #define UTHASH_POOLED_MEMPOOL MEMPOOL_RESOURCE_MANAGEMENT
 #include "UTUtils/UTHash_Pooled.h"
@@ -14,20 +18,52 @@ typedef struct PathToResourceHandleHashItem
 	RayGE_ResourceHandle handle;
 } PathToResourceHandleHashItem;
 
+#define NO_FREE_ITEM UINT32_MAX
+#define BITS_PER_OCCUPANCY_WORD 64
+
 typedef struct ResourceItemHeader
 {
 	bool occupied;
-	uint64_t key;
+
+	// Only valid if the item is not occupied.
+	uint32_t nextFreeItem;
+
+	// Incremented each time the item is destroyed, so that
+	// handles to previous occupants of the slot no longer pass.
+	uint32_t generation;
+
+	// Once this reaches zero, the item is queued for destruction.
+	uint32_t refCount;
+
 	PathToResourceHandleHashItem* hashItem;
 } ResourceItemHeader;
 
 typedef struct ResourceBucket
 {
-	void* items;
-	size_t numItems;
+	// For the list of buckets which have free items.
+	struct ResourceBucket* prev;
+	struct ResourceBucket* next;
+	bool isAvailable;
 
-	bool isNotEmpty;
-	bool isFull;
+	void* items;
+	uint32_t index;
+	uint32_t numItems;
+	uint32_t numOccupied;
+
+	// Items that have been released are kept in a list, threaded
+	// through their headers. Items at or beyond firstUnusedItem
+	// have never been used, so are not in the list yet.
+	uint32_t firstFreeItem;
+	uint32_t firstUnusedItem;
+
+	// Generation given to items when they are first used, and the
+	// highest generation any item in this bucket has reached.
+	uint32_t baseGeneration;
+	uint32_t highestGeneration;
+
+	// One bit per item, set if the item is occupied. This lets
+	// iteration skip straight to the next occupied item.
+	uint64_t occupancy[];
 } ResourceBucket;
 
 struct ResourceList
@@ -39,13 +75,86 @@ struct ResourceList
 	ResourceBucket** buckets;
 	size_t numBuckets;
 
+	// Buckets which have at least one free item.
+	ResourceBucket* availableBuckets;
+
+	// Indices of slots in the bucket array which have no bucket
+	// allocated. This is a stack, which starts with index 0 on top.
+	uint32_t* freeBucketIndices;
+	size_t numFreeBucketIndices;
+
+	// When a bucket is freed, the highest generation of its items is
+	// recorded here, so that a replacement bucket in the same slot does
+	// not hand out generations that old handles could still match.
+	uint32_t* bucketGenerations;
+
 	size_t totalResources;
+
+	// Handles to items whose reference count reached zero. These are
+	// only destroyed if their count is still zero when the queue is
+	// processed, and may be stale if the item was destroyed directly.
+	RayGE_ResourceHandle* pendingDestroy;
+	size_t numPendingDestroy;
+	size_t pendingDestroyCapacity;
+
 	PathToResourceHandleHashItem* pathToResourceHandle;
+	MemPool_ObjectPool* hashItemPool;
 };
 
+static size_t GetNumOccupancyWords(uint32_t itemsPerBucket)
+{
+	return ((size_t)itemsPerBucket + BITS_PER_OCCUPANCY_WORD - 1) / BITS_PER_OCCUPANCY_WORD;
+}
+
+static void SetItemOccupied(ResourceBucket* bucket, uint32_t index, bool occupied)
+{
+	const uint64_t mask = (uint64_t)1 << (index % BITS_PER_OCCUPANCY_WORD);
+
+	if ( occupied )
+	{
+		bucket->occupancy[index / BITS_PER_OCCUPANCY_WORD] |= mask;
+	}
+	else
+	{
+		bucket->occupancy[index / BITS_PER_OCCUPANCY_WORD] &= ~mask;
+	}
+}
+
+// Returns the index of the first occupied item at or after the given
+// index in the bucket, or the number of items if there are none.
+static uint32_t FindOccupiedItem(const ResourceBucket* bucket, uint32_t index)
+{
+	if ( index >= bucket->numItems )
+	{
+		return bucket->numItems;
+	}
+
+	const size_t numWords = GetNumOccupancyWords(bucket->numItems);
+	size_t wordIndex = index / BITS_PER_OCCUPANCY_WORD;
+
+	// Mask off the bits for items before the starting index.
+	uint64_t word = bucket->occupancy[wordIndex] & (~(uint64_t)0 << (index % BITS_PER_OCCUPANCY_WORD));
+
+	while ( !word )
+	{
+		if ( ++wordIndex >= numWords )
+		{
+			return bucket->numItems;
+		}
+
+		word = bucket->occupancy[wordIndex];
+	}
+
+	return (uint32_t)(wordIndex * BITS_PER_OCCUPANCY_WORD) + BitUtils_CountTrailingZeros64(word);
+}
+
 static size_t GetFullItemSize(const ResourceList* list)
 {
-	return sizeof(ResourceItemHeader) + list->atts.itemSizeInBytes;
+	// Round up, so that the header of the next item in the bucket is aligned.
+	const size_t alignment = _Alignof(ResourceItemHeader);
+	const size_t size = sizeof(ResourceItemHeader) + list->atts.itemSizeInBytes;
+
+	return (size + alignment - 1) & ~(alignment - 1);
 }
 
 static void* GetItemData(ResourceItemHeader* header)
@@ -58,14 +167,14 @@ static ResourceItemHeader* GetHeader(const ResourceList* list, ResourceBucket* b
 	return (ResourceItemHeader*)((uint8_t*)bucket->items + (index * GetFullItemSize(list)));
 }
 
-static ResourceItemHeader* GetFirstHeader(ResourceBucket* bucket)
+static bool BucketIsEmpty(const ResourceBucket* bucket)
 {
-	return (ResourceItemHeader*)bucket->items;
+	return bucket->numOccupied < 1;
 }
 
-static ResourceItemHeader* GetNextHeader(const ResourceList* list, ResourceItemHeader* header)
+static bool BucketIsFull(const ResourceBucket* bucket)
 {
-	return (ResourceItemHeader*)((uint8_t*)header + GetFullItemSize(list));
+	return bucket->numOccupied >= bucket->numItems;
 }
 
 static void DeleteHashEntry(ResourceList* list, PathToResourceHandleHashItem* item)
@@ -77,7 +186,7 @@ static void DeleteHashEntry(ResourceList* list, PathToResourceHandleHashItem* it
 
 	HASH_DEL(list->pathToResourceHandle, item);
 	MEMPOOL_FREE(item->path);
-	MEMPOOL_FREE(item);
+	MemPoolObjectPool_Free(list->hashItemPool, item);
 }
 
 static void DeleteAllHashEntries(ResourceList* list)
@@ -101,42 +210,64 @@ static void DeinitItemData(ResourceList* list, ResourceItemHeader* header)
 
 static void FreeBucket(ResourceList* list, ResourceBucket* bucket)
 {
-	if ( bucket->isNotEmpty )
+	for ( uint32_t index = FindOccupiedItem(bucket, 0); index < bucket->numItems;
+		  index = FindOccupiedItem(bucket, index + 1) )
 	{
-		ResourceItemHeader* header = (ResourceItemHeader*)bucket->items;
-
-		for ( size_t index = 0; index < bucket->numItems; ++index )
-		{
-			DeinitItemData(list, header);
-			header = GetNextHeader(list, header);
-		}
+		DeinitItemData(list, GetHeader(list, bucket, index));
 	}
 
 	MEMPOOL_FREE(bucket->items);
 	MEMPOOL_FREE(bucket);
 }
 
+static void SetBucketAvailable(ResourceList* list, ResourceBucket* bucket, bool available)
+{
+	if ( bucket->isAvailable == available )
+	{
+		return;
+	}
+
+	if ( available )
+	{
+		// Most recently used buckets are preferred, since they are more likely to be in cache.
+		DL_PREPEND(list->availableBuckets, bucket);
+	}
+	else
+	{
+		DL_DELETE(list->availableBuckets, bucket);
+	}
+
+	bucket->isAvailable = available;
+}
+
 static void DestroyBucketIfEmpty(ResourceList* list, ResourceBucket* bucket)
 {
-	if ( bucket->isNotEmpty )
+	if ( !BucketIsEmpty(bucket) )
 	{
 		return;
 	}
 
-	for ( size_t index = 0; index < list->numBuckets; ++index )
+	// Keep one empty bucket around if there is nowhere else to put new
+	// items, so that repeatedly creating and destroying a single item
+	// does not allocate and free a whole bucket each time.
+	if ( list->availableBuckets == bucket && !bucket->next )
 	{
-		if ( list->buckets[index] == bucket )
-		{
-			FreeBucket(list, bucket);
-			list->buckets[index] = NULL;
-			break;
-		}
+		return;
 	}
+
+	SetBucketAvailable(list, bucket, false);
+	list->buckets[bucket->index] = NULL;
+
+	list->freeBucketIndices[list->numFreeBucketIndices++] = bucket->index;
+	list->bucketGenerations[bucket->index] = bucket->highestGeneration;
+
+	FreeBucket(list, bucket);
 }
 
 static void FreeResourceList(ResourceList* list)
 {
 	DeleteAllHashEntries(list);
+	MemPoolObjectPool_Destroy(list->hashItemPool);
 
 	for ( size_t index = 0; index < list->numBuckets; ++index )
 	{
@@ -146,6 +277,14 @@ static void FreeResourceList(ResourceList* list)
 		}
 	}
 
+	if ( list->pendingDestroy )
+	{
+		MEMPOOL_FREE(list->pendingDestroy);
+	}
+
+	MEMPOOL_FREE(list->bucketGenerations);
+	MEMPOOL_FREE(list->freeBucketIndices);
+	MEMPOOL_FREE(list->buckets);
 	MEMPOOL_FREE(list);
 }
 
@@ -188,64 +327,114 @@ static ResourceList* CreateResourceList(const ResourceListAttributes* attributes
 	list->buckets =
 		(ResourceBucket**)MEMPOOL_CALLOC(MEMPOOL_RESOURCE_MANAGEMENT, list->numBuckets, sizeof(ResourceBucket*));
 
+	list->freeBucketIndices =
+		(uint32_t*)MEMPOOL_MALLOC(MEMPOOL_RESOURCE_MANAGEMENT, list->numBuckets * sizeof(uint32_t));
+	list->numFreeBucketIndices = list->numBuckets;
+
+	list->bucketGenerations =
+		(uint32_t*)MEMPOOL_CALLOC(MEMPOOL_RESOURCE_MANAGEMENT, list->numBuckets, sizeof(uint32_t));
+
+	for ( size_t index = 0; index < list->numBuckets; ++index )
+	{
+		list->freeBucketIndices[index] = (uint32_t)(list->numBuckets - 1 - index);
+	}
+
+	list->hashItemPool = MEMPOOL_OBJECTPOOL_CREATE(
+		MEMPOOL_RESOURCE_MANAGEMENT,
+		PathToResourceHandleHashItem,
+		list->atts.itemsPerBucket
+	);
+
 	return list;
 }
 
-static ResourceBucket* CreateBucket(ResourceList* list)
+static ResourceBucket* CreateBucket(ResourceList* list, uint32_t index)
 {
-	ResourceBucket* bucket = MEMPOOL_CALLOC_STRUCT(MEMPOOL_RESOURCE_MANAGEMENT, ResourceBucket);
+	ResourceBucket* bucket = (ResourceBucket*)MEMPOOL_CALLOC(
+		MEMPOOL_RESOURCE_MANAGEMENT,
+		1,
+		sizeof(ResourceBucket) + (GetNumOccupancyWords(list->atts.itemsPerBucket) * sizeof(uint64_t))
+	);
+
+	bucket->index = index;
 	bucket->numItems = list->atts.itemsPerBucket;
+	bucket->firstFreeItem = NO_FREE_ITEM;
+	bucket->baseGeneration = list->bucketGenerations[index];
+	bucket->highestGeneration = bucket->baseGeneration;
 	bucket->items = MEMPOOL_CALLOC(MEMPOOL_RESOURCE_MANAGEMENT, bucket->numItems, GetFullItemSize(list));
 	return bucket;
 }
 
-static ResourceBucket* GetFirstAvailableBucket(ResourceList* list, size_t* outIndex)
+static ResourceBucket* GetFirstAvailableBucket(ResourceList* list)
 {
-	for ( size_t index = 0; index < list->numBuckets; ++index )
+	if ( list->availableBuckets )
 	{
-		if ( !list->buckets[index] )
-		{
-			list->buckets[index] = CreateBucket(list);
-		}
-
-		if ( !list->buckets[index]->isFull )
-		{
-			if ( outIndex )
-			{
-				*outIndex = index;
-			}
-
-			return list->buckets[index];
-		}
+		return list->availableBuckets;
 	}
 
 	// This function should not have been called if there was no free space.
-	RAYGE_ENSURE(false, "Expected to be able to find a resource bucket with a free item!");
-	return NULL;
+	RAYGE_ENSURE(list->numFreeBucketIndices > 0, "Expected to be able to find a resource bucket with a free item!");
+
+	const uint32_t index = list->freeBucketIndices[--list->numFreeBucketIndices];
+	ResourceBucket* bucket = CreateBucket(list, index);
+
+	list->buckets[index] = bucket;
+	SetBucketAvailable(list, bucket, true);
+
+	return bucket;
 }
 
-static ResourceItemHeader* GetFirstAvailableHeader(ResourceList* list, ResourceBucket* bucket, size_t* outIndex)
+static ResourceItemHeader* AcquireFreeHeader(ResourceList* list, ResourceBucket* bucket, uint32_t* outIndex)
 {
-	ResourceItemHeader* header = (ResourceItemHeader*)bucket->items;
+	uint32_t index = bucket->firstFreeItem;
 
-	for ( size_t index = 0; index < bucket->numItems; ++index )
+	if ( index != NO_FREE_ITEM )
 	{
-		if ( !header->occupied )
-		{
-			if ( outIndex )
-			{
-				*outIndex = index;
-			}
+		bucket->firstFreeItem = GetHeader(list, bucket, index)->nextFreeItem;
+	}
+	else
+	{
+		// This function should not have been called if there was no free space.
+		RAYGE_ENSURE(
+			bucket->firstUnusedItem < bucket->numItems,
+			"Expected to be able to find a free resource item within the bucket!"
+		);
 
-			return header;
-		}
+		index = bucket->firstUnusedItem++;
+		GetHeader(list, bucket, index)->generation = bucket->baseGeneration;
+	}
+
+	++bucket->numOccupied;
+	SetItemOccupied(bucket, index, true);
+
+	if ( BucketIsFull(bucket) )
+	{
+		SetBucketAvailable(list, bucket, false);
+	}
+
+	*outIndex = index;
+	return GetHeader(list, bucket, index);
+}
 
-		header = GetNextHeader(list, header);
+static void ReleaseHeader(ResourceList* list, ResourceBucket* bucket, ResourceItemHeader* header)
+{
+	const size_t index = (size_t)((uint8_t*)header - (uint8_t*)bucket->items) / GetFullItemSize(list);
+
+	// The generation is allowed to wrap, since a stale handle would have
+	// to survive 2^32 re-uses of the same slot before it could match again.
+	++header->generation;
+
+	if ( header->generation - bucket->baseGeneration > bucket->highestGeneration - bucket->baseGeneration )
+	{
+		bucket->highestGeneration = header->generation;
 	}
 
-	// This function should not have been called if there was no free space.
-	RAYGE_ENSURE(false, "Expected to be able to find a free resource item within the bucket!");
-	return NULL;
+	header->nextFreeItem = bucket->firstFreeItem;
+	bucket->firstFreeItem = (uint32_t)index;
+
+	--bucket->numOccupied;
+	SetItemOccupied(bucket, (uint32_t)index, false);
+	SetBucketAvailable(list, bucket, true);
 }
 
 static ResourceItemHeader*
@@ -262,9 +451,9 @@ GetHeaderFromHandle(const ResourceList* list, RayGE_ResourceHandle handle, Resou
 	}
 
 	ResourceBucket* bucket = NULL;
-	ResourceItemHeader* header = GetHeaderFromGlobalIndex(list, handle.index, &bucket);
+	ResourceItemHeader* header = GetHeaderFromGlobalIndex(list, RAYGE_RESOURCE_HANDLE_INDEX(handle), &bucket);
 
-	if ( !header || !header->occupied || header->key != handle.key )
+	if ( !header || !header->occupied || header->generation != RAYGE_RESOURCE_HANDLE_GENERATION(handle) )
 	{
 		return NULL;
 	}
@@ -277,51 +466,21 @@ GetHeaderFromHandle(const ResourceList* list, RayGE_ResourceHandle handle, Resou
 	return header;
 }
 
-static void UpdateBucketFlags(ResourceList* list, ResourceBucket* bucket)
-{
-	bucket->isFull = true;
-	bucket->isNotEmpty = false;
-
-	ResourceItemHeader* header = GetFirstHeader(bucket);
-
-	for ( size_t index = 0; index < bucket->numItems; ++index )
-	{
-		if ( !header->occupied )
-		{
-			bucket->isFull = false;
-		}
-		else
-		{
-			bucket->isNotEmpty = true;
-		}
-
-		if ( !bucket->isFull && bucket->isNotEmpty )
-		{
-			// We can quit now - there will be no more changes to any flags.
-			return;
-		}
-
-		header = GetNextHeader(list, header);
-	}
-}
-
 static RayGE_ResourceHandle CreateItemInFirstFreeListSlot(ResourceList* list, const char* path)
 {
-	size_t bucketIndex = 0;
-	ResourceBucket* bucket = GetFirstAvailableBucket(list, &bucketIndex);
+	ResourceBucket* bucket = GetFirstAvailableBucket(list);
 
-	size_t itemIndex = 0;
-	ResourceItemHeader* header = GetFirstAvailableHeader(list, bucket, &itemIndex);
+	uint32_t itemIndex = 0;
+	ResourceItemHeader* header = AcquireFreeHeader(list, bucket, &itemIndex);
 
 	PathToResourceHandleHashItem* hashItem =
-		path ? MEMPOOL_CALLOC_STRUCT(MEMPOOL_RESOURCE_MANAGEMENT, PathToResourceHandleHashItem) : NULL;
+		path ? (PathToResourceHandleHashItem*)MemPoolObjectPool_Calloc(list->hashItemPool) : NULL;
 
-	const uint32_t globalIndex = ((uint32_t)bucketIndex * list->atts.itemsPerBucket) + (uint32_t)itemIndex;
-	const uint64_t key = Resource_CreateKey(globalIndex);
-	RayGE_ResourceHandle handle = Resource_CreateInternalHandle(list->atts.domain, globalIndex, key);
+	const uint32_t globalIndex = (bucket->index * list->atts.itemsPerBucket) + itemIndex;
+	RayGE_ResourceHandle handle = Resource_CreateInternalHandle(list->atts.domain, globalIndex, header->generation);
 
 	header->occupied = true;
-	header->key = key;
+	header->refCount = 1;
 	header->hashItem = hashItem;
 
 	if ( hashItem )
@@ -335,20 +494,20 @@ static RayGE_ResourceHandle CreateItemInFirstFreeListSlot(ResourceList* list, co
 	void* itemData = GetItemData(header);
 	memset(itemData, 0, list->atts.itemSizeInBytes);
 
-	UpdateBucketFlags(list, bucket);
-
 	++list->totalResources;
 	return handle;
 }
 
-static void DestroyItem(ResourceList* list, ResourceItemHeader* header)
+static void DestroyItem(ResourceList* list, ResourceBucket* bucket, ResourceItemHeader* header)
 {
 	DeleteHashEntry(list, header->hashItem);
 	DeinitItemData(list, header);
 
-	header->key = 0;
 	header->occupied = false;
+	header->refCount = 0;
+	header->hashItem = NULL;
 
+	ReleaseHeader(list, bucket, header);
 	--list->totalResources;
 }
 
@@ -375,103 +534,30 @@ static bool IteratorIsInRangeOfList(const ResourceListIterator* iterator)
 	return iterator && iterator->list && iterator->globalIndex < iterator->list->atts.maxCapacity;
 }
 
-static bool IncrementIteratorToNextValidItem(ResourceListIterator* iterator)
-{
-	ResourceItemHeader* header = GetHeaderFromGlobalIndex(iterator->list, iterator->globalIndex, NULL);
-	RAYGE_ASSERT_VALID(header);
-
-	if ( !header )
-	{
-		return false;
-	}
-
-	uint32_t itemIndex = iterator->globalIndex % iterator->list->atts.itemsPerBucket;
-
-	while ( true )
-	{
-		// For checking overflow later.
-		const uint32_t lastGlobalIndex = iterator->globalIndex;
-
-		// Move on by one item.
-		++iterator->globalIndex;
-		++itemIndex;
-		header = GetNextHeader(iterator->list, header);
-
-		if ( lastGlobalIndex > iterator->globalIndex || itemIndex >= iterator->list->atts.itemsPerBucket )
-		{
-			// Ran out of items.
-			break;
-		}
-
-		if ( header->occupied )
-		{
-			// This item is valid.
-			return true;
-		}
-	}
-
-	return false;
-}
-
-static bool IncrementIteratorToNextValidBucket(ResourceListIterator* iterator, ResourceBucket** outBucket)
+// Returns the global index of the first occupied item at or after
+// the given index, or the list's capacity if there are none.
+static uint32_t FindOccupiedGlobalIndex(const ResourceList* list, uint32_t globalIndex)
 {
-	if ( outBucket )
-	{
-		*outBucket = NULL;
-	}
-
-	ResourceBucket* bucket = NULL;
-	GetHeaderFromGlobalIndex(iterator->list, iterator->globalIndex, &bucket);
-
-	if ( !bucket )
-	{
-		return false;
-	}
-
-	// Reset to the first index in the bucket, since we're about to move on
-	// and want to land at the beginning of the next bucket.
-	const uint32_t itemsPerBucket = iterator->list->atts.itemsPerBucket;
-	iterator->globalIndex = (iterator->globalIndex / itemsPerBucket) * itemsPerBucket;
-
-	// Sanity:
-	RAYGE_ASSERT(
-		iterator->list->buckets[iterator->globalIndex / itemsPerBucket] == bucket,
-		"Unexpected change in bucket after modifying iterator global index!"
-	);
+	const uint32_t itemsPerBucket = list->atts.itemsPerBucket;
 
-	uint32_t bucketIndex = iterator->globalIndex / itemsPerBucket;
-
-	while ( true )
+	for ( size_t bucketIndex = globalIndex / itemsPerBucket; bucketIndex < list->numBuckets; ++bucketIndex )
 	{
-		// For checking overflow later.
-		const uint32_t lastGlobalIndex = iterator->globalIndex;
-
-		// Move on by one bucket.
-		iterator->globalIndex += itemsPerBucket;
-		++bucketIndex;
+		const ResourceBucket* bucket = list->buckets[bucketIndex];
+		const uint32_t bucketStart = (uint32_t)bucketIndex * itemsPerBucket;
 
-		if ( lastGlobalIndex < iterator->globalIndex || bucketIndex >= iterator->list->numBuckets )
+		if ( bucket && !BucketIsEmpty(bucket) )
 		{
-			// Ran out of buckets.
-			break;
-		}
-
-		bucket = iterator->list->buckets[bucketIndex];
-
-		if ( bucket && bucket->isNotEmpty )
-		{
-			// This bucket is valid.
+			const uint32_t startIndex = globalIndex > bucketStart ? globalIndex - bucketStart : 0;
+			const uint32_t itemIndex = FindOccupiedItem(bucket, startIndex);
 
-			if ( outBucket )
+			if ( itemIndex < bucket->numItems )
 			{
-				*outBucket = bucket;
+				return bucketStart + itemIndex;
 			}
-
-			return true;
 		}
 	}
 
-	return false;
+	return list->atts.maxCapacity;
 }
 
 ResourceList* ResourceList_Create(ResourceListAttributes attributes)
@@ -482,6 +568,10 @@ ResourceList* ResourceList_Create(ResourceListAttributes attributes)
 	);
 
 	RAYGE_ASSERT(attributes.maxCapacity > 0, "Capacity must be greater than zero");
+	RAYGE_ASSERT(
+		attributes.maxCapacity - 1 <= RAYGE_RESOURCE_HANDLE_MAX_INDEX,
+		"Capacity must not exceed the number of indices a resource handle can represent"
+	);
 	RAYGE_ASSERT(attributes.itemsPerBucket > 0, "Items per bucket must be greater than zero");
 	RAYGE_ASSERT(
 		attributes.itemsPerBucket <= attributes.maxCapacity,
@@ -490,8 +580,9 @@ ResourceList* ResourceList_Create(ResourceListAttributes attributes)
 	RAYGE_ASSERT(attributes.itemSizeInBytes > 0, "Item size must be greater than zero");
 
 	if ( attributes.domain == RESOURCE_DOMAIN_INVALID || attributes.domain >= RESOURCE_DOMAIN__COUNT ||
-		 attributes.maxCapacity < 1 || attributes.itemsPerBucket < 1 ||
-		 attributes.itemsPerBucket > attributes.maxCapacity || attributes.itemSizeInBytes < 1 )
+		 attributes.maxCapacity < 1 || attributes.maxCapacity - 1 > RAYGE_RESOURCE_HANDLE_MAX_INDEX ||
+		 attributes.itemsPerBucket < 1 || attributes.itemsPerBucket > attributes.maxCapacity ||
+		 attributes.itemSizeInBytes < 1 )
 	{
 		return NULL;
 	}
@@ -564,22 +655,25 @@ ResourceListErrorCode ResourceList_CreateNewItem(ResourceList* list, const char*
 		return RESOURCELIST_ERROR_INVALID_ARGUMENT;
 	}
 
-	if ( list->totalResources >= list->atts.maxCapacity )
-	{
-		return RESOURCELIST_ERROR_NO_FREE_SPACE;
-	}
-
 	if ( path )
 	{
 		RayGE_ResourceHandle handle = FindResourceHandleByPath(list, path);
 
 		if ( !RAYGE_IS_NULL_RESOURCE_HANDLE(handle) )
 		{
+			// This also revives the item if it was waiting to be destroyed.
+			++GetHeaderFromHandle(list, handle, NULL)->refCount;
+
 			*outHandle = handle;
 			return RESOURCELIST_ERROR_PATH_ALREADY_EXISTED;
 		}
 	}
 
+	if ( list->totalResources >= list->atts.maxCapacity )
+	{
+		return RESOURCELIST_ERROR_NO_FREE_SPACE;
+	}
+
 	*outHandle = CreateItemInFirstFreeListSlot(list, path);
 	return RESOURCELIST_ERROR_NONE;
 }
@@ -601,134 +695,256 @@ bool ResourceList_DestroyItem(ResourceList* list, RayGE_ResourceHandle handle)
 		return false;
 	}
 
-	DestroyItem(list, header);
-	UpdateBucketFlags(list, bucket);
+	DestroyItem(list, bucket, header);
 	DestroyBucketIfEmpty(list, bucket);
 	return true;
 }
 
-void* ResourceList_GetItemData(const ResourceList* list, RayGE_ResourceHandle handle)
+bool ResourceList_AddRef(ResourceList* list, RayGE_ResourceHandle handle)
 {
 	RAYGE_ASSERT_VALID(list);
 
 	if ( !list )
 	{
-		return NULL;
+		return false;
 	}
 
 	ResourceItemHeader* header = GetHeaderFromHandle(list, handle, NULL);
-	return header ? GetItemData(header) : NULL;
+
+	if ( !header )
+	{
+		return false;
+	}
+
+	RAYGE_ENSURE(header->refCount < UINT32_MAX, "Resource item reference count overflowed");
+
+	++header->refCount;
+	return true;
 }
 
-const char* ResourceList_GetItemPath(const ResourceList* list, RayGE_ResourceHandle handle)
+bool ResourceList_ReleaseItem(ResourceList* list, RayGE_ResourceHandle handle)
 {
 	RAYGE_ASSERT_VALID(list);
 
 	if ( !list )
 	{
-		return NULL;
+		return false;
 	}
 
 	ResourceItemHeader* header = GetHeaderFromHandle(list, handle, NULL);
-	return header->hashItem ? header->hashItem->path : NULL;
-}
 
-ResourceListIterator ResourceList_GetIteratorToFirstItem(const ResourceList* list)
-{
-	RAYGE_ASSERT_VALID(list);
+	if ( !header )
+	{
+		return false;
+	}
 
-	if ( !list )
+	RAYGE_ASSERT(header->refCount > 0, "Resource item was released more times than it was referenced");
+
+	if ( header->refCount < 1 )
 	{
-		return CreateInvalidIterator(NULL);
+		return false;
 	}
 
-	ResourceListIterator iterator = {
-		.list = list,
-		.globalIndex = 0,
-	};
+	if ( --header->refCount > 0 )
+	{
+		return true;
+	}
 
-	if ( !ResourceList_IteratorIsValid(iterator) )
+	if ( list->numPendingDestroy >= list->pendingDestroyCapacity )
 	{
-		iterator = ResourceList_IncrementIterator(iterator);
+		list->pendingDestroyCapacity = list->pendingDestroyCapacity > 0 ? list->pendingDestroyCapacity * 2 : 16;
+
+		list->pendingDestroy = (RayGE_ResourceHandle*)MEMPOOL_REALLOC(
+			MEMPOOL_RESOURCE_MANAGEMENT,
+			list->pendingDestroy,
+			list->pendingDestroyCapacity * sizeof(RayGE_ResourceHandle)
+		);
 	}
 
-	return iterator;
+	list->pendingDestroy[list->numPendingDestroy++] = handle;
+	return true;
 }
 
-ResourceListIterator ResourceList_GetIteratorFromHandle(const ResourceList* list, RayGE_ResourceHandle handle)
+uint32_t ResourceList_GetRefCount(const ResourceList* list, RayGE_ResourceHandle handle)
 {
-	ResourceItemHeader* header = GetHeaderFromHandle(list, handle, NULL);
+	RAYGE_ASSERT_VALID(list);
 
-	if ( !header )
+	if ( !list )
 	{
-		return CreateInvalidIterator(list);
+		return 0;
 	}
 
-	return (ResourceListIterator)
-	{
-		.list = list,
-		.globalIndex = handle.index,
-	};
+	ResourceItemHeader* header = GetHeaderFromHandle(list, handle, NULL);
+	return header ? header->refCount : 0;
 }
 
-ResourceListIterator ResourceList_IncrementIterator(ResourceListIterator iterator)
+size_t ResourceList_DestroyPendingItems(ResourceList* list)
 {
-	if ( !IteratorIsInRangeOfList(&iterator) )
+	RAYGE_ASSERT_VALID(list);
+
+	if ( !list )
 	{
-		return CreateInvalidIterator(iterator.list);
+		return 0;
 	}
 
-	while ( true )
-	{
-		if ( IncrementIteratorToNextValidItem(&iterator) )
-		{
-			// We found another item in the same bucket, so we're fine.
-			return iterator;
-		}
+	size_t numDestroyed = 0;
 
-		// If we get here, we ran out of items in the bucket, so move to the next bucket.
+	for ( size_t index = 0; index < list->numPendingDestroy; ++index )
+	{
 		ResourceBucket* bucket = NULL;
+		ResourceItemHeader* header = GetHeaderFromHandle(list, list->pendingDestroy[index], &bucket);
 
-		if ( !IncrementIteratorToNextValidBucket(&iterator, &bucket) )
-		{
-			// No more buckets, so we're at the end of the list.
-			break;
-		}
-
-		RAYGE_ASSERT_VALID(bucket);
-
-		// Check that the first items in the bucket is valid.
-		// If it is, we can stop. If not, we go around the loop again,
-		// which will find the next valid item.
-		if ( GetFirstHeader(bucket)->occupied )
+		// The item may have been referenced again since it was queued,
+		// or destroyed directly, in which case the handle is now stale.
+		if ( header && header->refCount < 1 )
 		{
-			return iterator;
+			DestroyItem(list, bucket, header);
+			DestroyBucketIfEmpty(list, bucket);
+			++numDestroyed;
 		}
 	}
 
-	return CreateInvalidIterator(iterator.list);
+	list->numPendingDestroy = 0;
+	return numDestroyed;
 }
 
-bool ResourceList_IteratorIsValid(ResourceListIterator iterator)
+size_t ResourceList_NumPendingItems(const ResourceList* list)
 {
-	if ( !IteratorIsInRangeOfList(&iterator) )
-	{
-		return false;
-	}
-
-	ResourceItemHeader* header = GetHeaderFromGlobalIndex(iterator.list, iterator.globalIndex, NULL);
-	return header && header->occupied;
+	return list ? list->numPendingDestroy : 0;
 }
 
-void* ResourceList_GetItemDataFromIterator(ResourceListIterator iterator)
+void* ResourceList_GetItemData(const ResourceList* list, RayGE_ResourceHandle handle)
 {
-	if ( !IteratorIsInRangeOfList(&iterator) )
+	RAYGE_ASSERT_VALID(list);
+
+	if ( !list )
 	{
 		return NULL;
 	}
 
-	ResourceItemHeader* header = GetHeaderFromGlobalIndex(iterator.list, iterator.globalIndex, NULL);
-	return (header && header->occupied) ? GetItemData(header) : NULL;
+	ResourceItemHeader* header = GetHeaderFromHandle(list, handle, NULL);
+	return header ? GetItemData(header) : NULL;
+}
+
+const char* ResourceList_GetItemPath(const ResourceList* list, RayGE_ResourceHandle handle)
+{
+	RAYGE_ASSERT_VALID(list);
+
+	if ( !list )
+	{
+		return NULL;
+	}
+
+	ResourceItemHeader* header = GetHeaderFromHandle(list, handle, NULL);
+	return (header && header->hashItem) ? header->hashItem->path : NULL;
+}
+
+void ResourceList_ForEach(const ResourceList* list, ResourceList_ForEachFunc callback, void* userData)
+{
+	RAYGE_ASSERT_VALID(list);
+	RAYGE_ASSERT_VALID(callback);
+
+	if ( !list || !callback )
+	{
+		return;
+	}
+
+	for ( size_t bucketIndex = 0; bucketIndex < list->numBuckets; ++bucketIndex )
+	{
+		ResourceBucket* bucket = list->buckets[bucketIndex];
+
+		if ( !bucket || BucketIsEmpty(bucket) )
+		{
+			continue;
+		}
+
+		const uint32_t bucketStart = (uint32_t)bucketIndex * list->atts.itemsPerBucket;
+		const size_t numWords = GetNumOccupancyWords(bucket->numItems);
+
+		for ( size_t wordIndex = 0; wordIndex < numWords; ++wordIndex )
+		{
+			uint64_t word = bucket->occupancy[wordIndex];
+
+			while ( word )
+			{
+				const uint32_t itemIndex =
+					(uint32_t)(wordIndex * BITS_PER_OCCUPANCY_WORD) + BitUtils_CountTrailingZeros64(word);
+
+				// Clear the lowest set bit.
+				word &= word - 1;
+
+				ResourceItemHeader* header = GetHeader(list, bucket, itemIndex);
+				RayGE_ResourceHandle handle =
+					Resource_CreateInternalHandle(list->atts.domain, bucketStart + itemIndex, header->generation);
+
+				callback(handle, GetItemData(header), userData);
+			}
+		}
+	}
+}
+
+ResourceListIterator ResourceList_GetIteratorToFirstItem(const ResourceList* list)
+{
+	RAYGE_ASSERT_VALID(list);
+
+	if ( !list )
+	{
+		return CreateInvalidIterator(NULL);
+	}
+
+	return (ResourceListIterator) {
+		.list = list,
+		.globalIndex = FindOccupiedGlobalIndex(list, 0),
+	};
+}
+
+ResourceListIterator ResourceList_GetIteratorFromHandle(const ResourceList* list, RayGE_ResourceHandle handle)
+{
+	ResourceItemHeader* header = GetHeaderFromHandle(list, handle, NULL);
+
+	if ( !header )
+	{
+		return CreateInvalidIterator(list);
+	}
+
+	return (ResourceListIterator)
+	{
+		.list = list,
+		.globalIndex = RAYGE_RESOURCE_HANDLE_INDEX(handle),
+	};
+}
+
+ResourceListIterator ResourceList_IncrementIterator(ResourceListIterator iterator)
+{
+	if ( !IteratorIsInRangeOfList(&iterator) )
+	{
+		return CreateInvalidIterator(iterator.list);
+	}
+
+	iterator.globalIndex = FindOccupiedGlobalIndex(iterator.list, iterator.globalIndex + 1);
+	return iterator;
+}
+
+bool ResourceList_IteratorIsValid(ResourceListIterator iterator)
+{
+	if ( !IteratorIsInRangeOfList(&iterator) )
+	{
+		return false;
+	}
+
+	ResourceItemHeader* header = GetHeaderFromGlobalIndex(iterator.list, iterator.globalIndex, NULL);
+	return header && header->occupied;
+}
+
+void* ResourceList_GetItemDataFromIterator(ResourceListIterator iterator)
+{
+	if ( !IteratorIsInRangeOfList(&iterator) )
+	{
+		return NULL;
+	}
+
+	ResourceItemHeader* header = GetHeaderFromGlobalIndex(iterator.list, iterator.globalIndex, NULL);
+	return (header && header->occupied) ? GetItemData(header) : NULL;
 }
 
 const char* ResourceList_GetItemPathFromIterator(ResourceListIterator iterator)
@@ -775,6 +991,16 @@ static void TestInvalidArguments(void)
 
 	TEST_EXPECT_TRUE(!ResourceList_Create(atts));
 
+	// Capacity too large to be represented by handles
+	atts = (ResourceListAttributes) {
+		.domain = RESOURCE_DOMAIN_ENTITY,
+		.itemSizeInBytes = 4,
+		.itemsPerBucket = 4,
+		.maxCapacity = RAYGE_RESOURCE_HANDLE_MAX_INDEX + 5,
+	};
+
+	TEST_EXPECT_TRUE(!ResourceList_Create(atts));
+
 	// Zero items per bucket
 	atts = (ResourceListAttributes) {
 		.domain = RESOURCE_DOMAIN_ENTITY,
@@ -873,9 +1099,543 @@ void TestAddingAndRemovingElements(void)
 	ResourceList_Destroy(list);
 }
 
+static size_t CountItemsByIterating(const ResourceList* list)
+{
+	size_t count = 0;
+
+	for ( ResourceListIterator iterator = ResourceList_GetIteratorToFirstItem(list);
+		  ResourceList_IteratorIsValid(iterator);
+		  iterator = ResourceList_IncrementIterator(iterator) )
+	{
+		++count;
+	}
+
+	return count;
+}
+
+static size_t CountAllocatedBuckets(const ResourceList* list)
+{
+	size_t count = 0;
+
+	for ( size_t index = 0; index < list->numBuckets; ++index )
+	{
+		if ( list->buckets[index] )
+		{
+			++count;
+		}
+	}
+
+	return count;
+}
+
+static void TestFillingAndRefilling(void)
+{
+	enum
+	{
+		CAPACITY = 64,
+		ITEMS_PER_BUCKET = 8
+	};
+
+	ResourceListAttributes atts = (ResourceListAttributes) {
+		.domain = RESOURCE_DOMAIN_ENTITY,
+		.itemSizeInBytes = sizeof(uint32_t),
+		.itemsPerBucket = ITEMS_PER_BUCKET,
+		.maxCapacity = CAPACITY,
+	};
+
+	ResourceList* list = ResourceList_Create(atts);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	RayGE_ResourceHandle handles[CAPACITY];
+
+	for ( uint32_t index = 0; index < CAPACITY; ++index )
+	{
+		TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &handles[index]), RESOURCELIST_ERROR_NONE);
+		*((uint32_t*)ResourceList_GetItemData(list, handles[index])) = index;
+	}
+
+	RayGE_ResourceHandle extra = RAYGE_NULL_RESOURCE_HANDLE;
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &extra), RESOURCELIST_ERROR_NO_FREE_SPACE);
+	TEST_EXPECT_EQL_INT(CountItemsByIterating(list), CAPACITY);
+
+	// Punch holes in every bucket.
+	for ( uint32_t index = 0; index < CAPACITY; index += 2 )
+	{
+		TEST_EXPECT_TRUE(ResourceList_DestroyItem(list, handles[index]));
+		TEST_EXPECT_FALSE(ResourceList_DestroyItem(list, handles[index]));
+	}
+
+	TEST_EXPECT_EQL_INT(ResourceList_ItemCount(list), CAPACITY / 2);
+	TEST_EXPECT_EQL_INT(CountItemsByIterating(list), CAPACITY / 2);
+	TEST_EXPECT_EQL_INT(CountAllocatedBuckets(list), CAPACITY / ITEMS_PER_BUCKET);
+
+	// Refilling should use up exactly the holes.
+	for ( uint32_t index = 0; index < CAPACITY; index += 2 )
+	{
+		TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &handles[index]), RESOURCELIST_ERROR_NONE);
+		*((uint32_t*)ResourceList_GetItemData(list, handles[index])) = index;
+	}
+
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &extra), RESOURCELIST_ERROR_NO_FREE_SPACE);
+
+	for ( uint32_t index = 0; index < CAPACITY; ++index )
+	{
+		const uint32_t* data = (const uint32_t*)ResourceList_GetItemData(list, handles[index]);
+		TEST_EXPECT_TRUE(data && *data == index);
+	}
+
+	// Emptying whole buckets should release them, apart from one spare.
+	for ( uint32_t index = 0; index < CAPACITY; ++index )
+	{
+		TEST_EXPECT_TRUE(ResourceList_DestroyItem(list, handles[index]));
+	}
+
+	TEST_EXPECT_EQL_INT(ResourceList_ItemCount(list), 0);
+	TEST_EXPECT_EQL_INT(CountItemsByIterating(list), 0);
+	TEST_EXPECT_EQL_INT(CountAllocatedBuckets(list), 1);
+
+	ResourceList_Destroy(list);
+}
+
+static void TestSingleItemChurn(void)
+{
+	ResourceListAttributes atts = (ResourceListAttributes) {
+		.domain = RESOURCE_DOMAIN_ENTITY,
+		.itemSizeInBytes = sizeof(uint32_t),
+		.itemsPerBucket = 4,
+		.maxCapacity = 16,
+	};
+
+	ResourceList* list = ResourceList_Create(atts);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	RayGE_ResourceHandle handle = RAYGE_NULL_RESOURCE_HANDLE;
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &handle), RESOURCELIST_ERROR_NONE);
+
+	ResourceBucket* bucket = list->buckets[0];
+	TEST_EXPECT_TRUE(bucket);
+
+	// The same slot in the same bucket should be handed out each time,
+	// without the bucket being freed and reallocated.
+	const uint32_t firstIndex = RAYGE_RESOURCE_HANDLE_INDEX(handle);
+	size_t failures = 0;
+
+	for ( size_t iteration = 0; iteration < 1000; ++iteration )
+	{
+		if ( !ResourceList_DestroyItem(list, handle) ||
+			 ResourceList_CreateNewItem(list, NULL, &handle) != RESOURCELIST_ERROR_NONE ||
+			 RAYGE_RESOURCE_HANDLE_INDEX(handle) != firstIndex )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+	TEST_EXPECT_TRUE(list->buckets[0] == bucket);
+	TEST_EXPECT_EQL_INT(CountAllocatedBuckets(list), 1);
+	TEST_EXPECT_EQL_INT(ResourceList_ItemCount(list), 1);
+
+	ResourceList_Destroy(list);
+}
+
+static void TestRandomChurn(void)
+{
+	enum
+	{
+		CAPACITY = 96,
+		ITEMS_PER_BUCKET = 8,
+		NUM_OPERATIONS = 20000
+	};
+
+	ResourceListAttributes atts = (ResourceListAttributes) {
+		.domain = RESOURCE_DOMAIN_ENTITY,
+		.itemSizeInBytes = sizeof(uint32_t),
+		.itemsPerBucket = ITEMS_PER_BUCKET,
+		.maxCapacity = CAPACITY,
+	};
+
+	ResourceList* list = ResourceList_Create(atts);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	RayGE_ResourceHandle handles[CAPACITY];
+	uint32_t values[CAPACITY];
+	size_t numLive = 0;
+	uint32_t nextValue = 1;
+	uint32_t random = 0x9E3779B9u;
+	size_t failures = 0;
+
+	for ( size_t operation = 0; operation < NUM_OPERATIONS; ++operation )
+	{
+		// Xorshift, so that the sequence is the same on every platform.
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+
+		// Alternate between phases that mostly create and phases that mostly
+		// destroy, so that the list swings between nearly empty and full.
+		const bool filling = ((operation / 500) % 2) == 0;
+		const bool createMore = filling ? (random % 4) != 0 : (random % 4) == 0;
+		const bool create = numLive < 1 || (numLive < CAPACITY && createMore);
+
+		if ( create )
+		{
+			if ( ResourceList_CreateNewItem(list, NULL, &handles[numLive]) != RESOURCELIST_ERROR_NONE )
+			{
+				++failures;
+				continue;
+			}
+
+			values[numLive] = nextValue++;
+			*((uint32_t*)ResourceList_GetItemData(list, handles[numLive])) = values[numLive];
+			++numLive;
+		}
+		else
+		{
+			const size_t victim = (random >> 8) % numLive;
+			RayGE_ResourceHandle handle = handles[victim];
+
+			if ( !ResourceList_DestroyItem(list, handle) )
+			{
+				++failures;
+			}
+
+			// Stale handles must not resolve.
+			if ( ResourceList_GetItemData(list, handle) )
+			{
+				++failures;
+			}
+
+			--numLive;
+			handles[victim] = handles[numLive];
+			values[victim] = values[numLive];
+		}
+
+		if ( ResourceList_ItemCount(list) != numLive )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+	TEST_EXPECT_EQL_INT(CountItemsByIterating(list), numLive);
+
+	for ( size_t index = 0; index < numLive; ++index )
+	{
+		const uint32_t* data = (const uint32_t*)ResourceList_GetItemData(list, handles[index]);
+		TEST_EXPECT_TRUE(data && *data == values[index]);
+	}
+
+	ResourceList_Destroy(list);
+}
+
+static void TestStaleHandles(void)
+{
+	ResourceListAttributes atts = (ResourceListAttributes) {
+		.domain = RESOURCE_DOMAIN_ENTITY,
+		.itemSizeInBytes = sizeof(uint32_t),
+		.itemsPerBucket = 4,
+		.maxCapacity = 16,
+	};
+
+	ResourceList* list = ResourceList_Create(atts);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	// Re-using a slot should invalidate handles to its previous occupant.
+	RayGE_ResourceHandle oldHandle = RAYGE_NULL_RESOURCE_HANDLE;
+	RayGE_ResourceHandle newHandle = RAYGE_NULL_RESOURCE_HANDLE;
+
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &oldHandle), RESOURCELIST_ERROR_NONE);
+	TEST_EXPECT_TRUE(ResourceList_DestroyItem(list, oldHandle));
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &newHandle), RESOURCELIST_ERROR_NONE);
+
+	TEST_EXPECT_EQL_INT(RAYGE_RESOURCE_HANDLE_INDEX(newHandle), RAYGE_RESOURCE_HANDLE_INDEX(oldHandle));
+	TEST_EXPECT_FALSE(ResourceList_GetItemData(list, oldHandle));
+	TEST_EXPECT_FALSE(ResourceList_DestroyItem(list, oldHandle));
+	TEST_EXPECT_TRUE(ResourceList_GetItemData(list, newHandle));
+	TEST_EXPECT_TRUE(ResourceList_DestroyItem(list, newHandle));
+
+	// Handles should also be rejected if the bucket their item lived in
+	// is freed, and a new bucket is later allocated in the same place.
+	RayGE_ResourceHandle handles[8];
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(handles); ++index )
+	{
+		TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &handles[index]), RESOURCELIST_ERROR_NONE);
+	}
+
+	ResourceBucket* secondBucket = list->buckets[1];
+	TEST_EXPECT_TRUE(secondBucket);
+
+	// Leave space in the first bucket, so that the second is not kept as a spare.
+	TEST_EXPECT_TRUE(ResourceList_DestroyItem(list, handles[0]));
+
+	for ( size_t index = 4; index < RAYGE_ARRAY_SIZE(handles); ++index )
+	{
+		TEST_EXPECT_TRUE(ResourceList_DestroyItem(list, handles[index]));
+	}
+
+	TEST_EXPECT_FALSE(list->buckets[1]);
+
+	RayGE_ResourceHandle newHandles[5];
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(newHandles); ++index )
+	{
+		TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &newHandles[index]), RESOURCELIST_ERROR_NONE);
+	}
+
+	TEST_EXPECT_TRUE(list->buckets[1]);
+	TEST_EXPECT_EQL_INT(RAYGE_RESOURCE_HANDLE_INDEX(newHandles[0]), RAYGE_RESOURCE_HANDLE_INDEX(handles[0]));
+
+	size_t failures = 0;
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(newHandles); ++index )
+	{
+		const size_t oldIndex = index == 0 ? 0 : index + 3;
+
+		if ( RAYGE_RESOURCE_HANDLE_INDEX(newHandles[index]) != RAYGE_RESOURCE_HANDLE_INDEX(handles[oldIndex]) ||
+			 ResourceList_GetItemData(list, handles[oldIndex]) ||
+			 !ResourceList_GetItemData(list, newHandles[index]) )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+	TEST_EXPECT_EQL_INT(ResourceList_ItemCount(list), 8);
+
+	ResourceList_Destroy(list);
+}
+
+typedef struct ForEachState
+{
+	const ResourceList* list;
+	uint32_t lastIndex;
+	size_t count;
+	size_t failures;
+} ForEachState;
+
+static void CheckForEachItem(RayGE_ResourceHandle handle, void* item, void* userData)
+{
+	ForEachState* state = (ForEachState*)userData;
+	const uint32_t index = RAYGE_RESOURCE_HANDLE_INDEX(handle);
+
+	// Items should be visited in order, and the handle should refer to the item.
+	if ( (state->count > 0 && index <= state->lastIndex) || ResourceList_GetItemData(state->list, handle) != item ||
+		 *(const uint32_t*)item != index )
+	{
+		++state->failures;
+	}
+
+	state->lastIndex = index;
+	++state->count;
+}
+
+static size_t CountOccupancyBitMismatches(const ResourceList* list)
+{
+	size_t mismatches = 0;
+
+	for ( size_t bucketIndex = 0; bucketIndex < list->numBuckets; ++bucketIndex )
+	{
+		const ResourceBucket* bucket = list->buckets[bucketIndex];
+
+		if ( !bucket )
+		{
+			continue;
+		}
+
+		size_t setBits = 0;
+
+		for ( size_t wordIndex = 0; wordIndex < GetNumOccupancyWords(bucket->numItems); ++wordIndex )
+		{
+			setBits += BitUtils_PopCount64(bucket->occupancy[wordIndex]);
+		}
+
+		if ( setBits != bucket->numOccupied )
+		{
+			++mismatches;
+		}
+	}
+
+	return mismatches;
+}
+
+static void TestSparseIteration(void)
+{
+	// Items per bucket is deliberately not a multiple of 64, so that
+	// the last occupancy word in each bucket is only partially used.
+	ResourceListAttributes atts = (ResourceListAttributes) {
+		.domain = RESOURCE_DOMAIN_ENTITY,
+		.itemSizeInBytes = sizeof(uint32_t),
+		.itemsPerBucket = 100,
+		.maxCapacity = 1000,
+	};
+
+	ResourceList* list = ResourceList_Create(atts);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	RayGE_ResourceHandle handles[1000];
+	size_t setupFailures = 0;
+
+	for ( uint32_t index = 0; index < RAYGE_ARRAY_SIZE(handles); ++index )
+	{
+		if ( ResourceList_CreateNewItem(list, NULL, &handles[index]) != RESOURCELIST_ERROR_NONE )
+		{
+			++setupFailures;
+			continue;
+		}
+
+		*(uint32_t*)ResourceList_GetItemData(list, handles[index]) = RAYGE_RESOURCE_HANDLE_INDEX(handles[index]);
+	}
+
+	// Keep a sparse set of items, which includes both ends of
+	// some buckets, and leaves other buckets entirely empty.
+	size_t numKept = 0;
+
+	for ( uint32_t index = 0; index < RAYGE_ARRAY_SIZE(handles); ++index )
+	{
+		const bool keep = index < 500 && (index % 37 == 0 || index % 100 == 99 || index == 63 || index == 64);
+
+		if ( keep )
+		{
+			++numKept;
+		}
+		else if ( !ResourceList_DestroyItem(list, handles[index]) )
+		{
+			++setupFailures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(setupFailures, 0);
+	TEST_EXPECT_EQL_INT(ResourceList_ItemCount(list), numKept);
+	TEST_EXPECT_EQL_INT(CountOccupancyBitMismatches(list), 0);
+
+	// The iterator should visit the same items in the same order.
+	size_t iteratorFailures = 0;
+	size_t iteratorCount = 0;
+	uint32_t lastIndex = 0;
+
+	for ( ResourceListIterator it = ResourceList_GetIteratorToFirstItem(list); ResourceList_IteratorIsValid(it);
+		  it = ResourceList_IncrementIterator(it) )
+	{
+		const uint32_t* data = (const uint32_t*)ResourceList_GetItemDataFromIterator(it);
+
+		if ( !data || *data != it.globalIndex || (iteratorCount > 0 && it.globalIndex <= lastIndex) )
+		{
+			++iteratorFailures;
+		}
+
+		lastIndex = it.globalIndex;
+		++iteratorCount;
+	}
+
+	TEST_EXPECT_EQL_INT(iteratorFailures, 0);
+	TEST_EXPECT_EQL_INT(iteratorCount, numKept);
+
+	ForEachState state = {
+		.list = list,
+	};
+
+	ResourceList_ForEach(list, &CheckForEachItem, &state);
+
+	TEST_EXPECT_EQL_INT(state.failures, 0);
+	TEST_EXPECT_EQL_INT(state.count, numKept);
+	TEST_EXPECT_EQL_INT(state.lastIndex, 499);
+
+	ResourceList_Destroy(list);
+}
+
+static void TestReferenceCounting(void)
+{
+	ResourceListAttributes atts = (ResourceListAttributes) {
+		.domain = RESOURCE_DOMAIN_TEXTURE,
+		.itemSizeInBytes = sizeof(uint32_t),
+		.itemsPerBucket = 2,
+		.maxCapacity = 2,
+	};
+
+	ResourceList* list = ResourceList_Create(atts);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	RayGE_ResourceHandle handle = RAYGE_NULL_RESOURCE_HANDLE;
+	RayGE_ResourceHandle other = RAYGE_NULL_RESOURCE_HANDLE;
+
+	// Creating the same path twice should reference the same item twice.
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, "item", &handle), RESOURCELIST_ERROR_NONE);
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, "item", &other), RESOURCELIST_ERROR_PATH_ALREADY_EXISTED);
+	TEST_EXPECT_TRUE(RAYGE_RESOURCE_HANDLES_EQUAL(handle, other));
+	TEST_EXPECT_EQL_INT(ResourceList_GetRefCount(list, handle), 2);
+
+	// Existing paths should still be found when the list is full.
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, NULL, &other), RESOURCELIST_ERROR_NONE);
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, "item", &other), RESOURCELIST_ERROR_PATH_ALREADY_EXISTED);
+	TEST_EXPECT_EQL_INT(ResourceList_GetRefCount(list, handle), 3);
+	TEST_EXPECT_TRUE(ResourceList_ReleaseItem(list, handle));
+
+	// Releasing the last reference should only queue the item.
+	TEST_EXPECT_TRUE(ResourceList_ReleaseItem(list, handle));
+	TEST_EXPECT_EQL_INT(ResourceList_NumPendingItems(list), 0);
+	TEST_EXPECT_TRUE(ResourceList_ReleaseItem(list, handle));
+	TEST_EXPECT_EQL_INT(ResourceList_NumPendingItems(list), 1);
+	TEST_EXPECT_EQL_INT(ResourceList_GetRefCount(list, handle), 0);
+	TEST_EXPECT_TRUE(ResourceList_GetItemData(list, handle));
+
+	// Referencing the item again before the queue is processed should keep it alive.
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, "item", &other), RESOURCELIST_ERROR_PATH_ALREADY_EXISTED);
+	TEST_EXPECT_EQL_INT(ResourceList_DestroyPendingItems(list), 0);
+	TEST_EXPECT_EQL_INT(ResourceList_NumPendingItems(list), 0);
+	TEST_EXPECT_TRUE(ResourceList_GetItemData(list, handle));
+
+	TEST_EXPECT_TRUE(ResourceList_ReleaseItem(list, handle));
+	TEST_EXPECT_EQL_INT(ResourceList_DestroyPendingItems(list), 1);
+	TEST_EXPECT_FALSE(ResourceList_GetItemData(list, handle));
+	TEST_EXPECT_FALSE(ResourceList_ReleaseItem(list, handle));
+	TEST_EXPECT_FALSE(ResourceList_AddRef(list, handle));
+	TEST_EXPECT_EQL_INT(ResourceList_ItemCount(list), 1);
+
+	// Items destroyed directly after being queued should be skipped.
+	TEST_EXPECT_EQL_INT(ResourceList_CreateNewItem(list, "item", &handle), RESOURCELIST_ERROR_NONE);
+	TEST_EXPECT_TRUE(ResourceList_ReleaseItem(list, handle));
+	TEST_EXPECT_TRUE(ResourceList_DestroyItem(list, handle));
+	TEST_EXPECT_EQL_INT(ResourceList_NumPendingItems(list), 1);
+	TEST_EXPECT_EQL_INT(ResourceList_DestroyPendingItems(list), 0);
+	TEST_EXPECT_EQL_INT(ResourceList_ItemCount(list), 1);
+
+	ResourceList_Destroy(list);
+}
+
 void ResourceList_RunTests(void)
 {
 	TestInvalidArguments();
 	TestAddingAndRemovingElements();
+	TestFillingAndRefilling();
+	TestSingleItemChurn();
+	TestRandomChurn();
+	TestStaleHandles();
+	TestSparseIteration();
+	TestReferenceCounting();
 }
 #endif
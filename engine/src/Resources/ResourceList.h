@@ -36,6 +36,9 @@ typedef struct ResourceListIterator
 	uint32_t globalIndex;
 } ResourceListIterator;
 
+// Called by ResourceList_ForEach() for each item in the list.
+typedef void (*ResourceList_ForEachFunc)(RayGE_ResourceHandle handle, void* item, void* userData);
+
 typedef enum ResourceListErrorCode
 {
 	RESOURCELIST_ERROR_NONE = 0,
@@ -49,17 +52,38 @@ void ResourceList_Destroy(ResourceList* list);
 size_t ResourceList_ItemCount(const ResourceList* list);
 size_t ResourceList_Capacity(const ResourceList* list);
 
+// Items are reference counted, and a newly created item has a count of one.
 // If a path is provided, and a resource with this path has already been
-// added, the existing resource will be returned.
+// added, the existing resource will be returned and its count incremented.
 // When an item is successfully created, its data starts out zeroed,
 // so there is no need for the caller to do this.
 ResourceListErrorCode
 ResourceList_CreateNewItem(ResourceList* list, const char* path, RayGE_ResourceHandle* outHandle);
 
+// Destroys the item immediately, regardless of its reference count.
 bool ResourceList_DestroyItem(ResourceList* list, RayGE_ResourceHandle handle);
+
+bool ResourceList_AddRef(ResourceList* list, RayGE_ResourceHandle handle);
+
+// When an item's reference count reaches zero, it is queued for destruction,
+// but remains valid until ResourceList_DestroyPendingItems() is called.
+// If the item is referenced again before then, it is not destroyed.
+bool ResourceList_ReleaseItem(ResourceList* list, RayGE_ResourceHandle handle);
+
+uint32_t ResourceList_GetRefCount(const ResourceList* list, RayGE_ResourceHandle handle);
+
+// Intended to be called once per frame. Returns the number of items destroyed.
+size_t ResourceList_DestroyPendingItems(ResourceList* list);
+size_t ResourceList_NumPendingItems(const ResourceList* list);
 void* ResourceList_GetItemData(const ResourceList* list, RayGE_ResourceHandle handle);
 const char* ResourceList_GetItemPath(const ResourceList* list, RayGE_ResourceHandle handle);
 
+// Calls the callback for each item in the list, in order of index.
+// This is cheaper than using an iterator, since empty slots are
+// skipped in bulk. Items must not be created or destroyed in the
+// list until iteration has finished.
+void ResourceList_ForEach(const ResourceList* list, ResourceList_ForEachFunc callback, void* userData);
+
 ResourceListIterator ResourceList_GetIteratorToFirstItem(const ResourceList* list);
 ResourceListIterator ResourceList_GetIteratorFromHandle(const ResourceList* list, RayGE_ResourceHandle handle);
 ResourceListIterator ResourceList_IncrementIterator(ResourceListIterator iterator);
@@ -21,7 +21,8 @@ RayGE_ResourceHandle ResourceListUtils_CreateNewItem(
 		return RAYGE_NULL_RESOURCE_HANDLE;
 	}
 
-	char* trimmedPath = StringUtils_TrimString(MEMPOOL_RESOURCE_MANAGEMENT, relPath);
+	// The list makes its own copy of the path, so this is only temporary.
+	char* trimmedPath = StringUtils_TrimString(MEMPOOL_FRAME, relPath);
 	RayGE_ResourceHandle outHandle = RAYGE_NULL_RESOURCE_HANDLE;
 
 	do
@@ -74,10 +75,5 @@ RayGE_ResourceHandle ResourceListUtils_CreateNewItem(
 	}
 	while ( false );
 
-	if ( trimmedPath )
-	{
-		MEMPOOL_FREE(trimmedPath);
-	}
-
 	return outHandle;
 }
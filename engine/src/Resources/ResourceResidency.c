@@ -0,0 +1,362 @@
+#include <string.h>
+#include "Resources/ResourceResidency.h"
+#include "Launcher/LaunchParams.h"
+#include "Logging/Logging.h"
+#include "MemPool/MemPoolBudgets.h"
+#include "Debugging.h"
+#include "utlist.h"
+
+typedef struct Data
+{
+	// Evictable items, with the most recently used at the head.
+	ResourceResidency_Item* lruHead;
+
+	uint64_t frame;
+	size_t cpuBytes;
+	size_t gpuBytes;
+	size_t cpuBudget;
+	size_t gpuBudget;
+	size_t numTracked;
+	size_t numEvictions;
+
+	// So that we only complain once each time the budget can't be met.
+	bool warnedOverBudget;
+} Data;
+
+static Data g_Data;
+static bool g_Initialised = false;
+
+static size_t ParseBudget(const char* optionName, const char* value)
+{
+	size_t bytes = 0;
+
+	if ( value && !MemPoolBudgets_ParseSize(value, value + strlen(value), &bytes) )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Ignoring invalid value \"%s\" for --%s", value, optionName);
+		bytes = 0;
+	}
+
+	return bytes;
+}
+
+static bool IsOverBudget(void)
+{
+	return (g_Data.cpuBudget > 0 && g_Data.cpuBytes > g_Data.cpuBudget) ||
+		(g_Data.gpuBudget > 0 && g_Data.gpuBytes > g_Data.gpuBudget);
+}
+
+// Returns whether evicting the item would reduce usage of a budget that has been exceeded.
+static bool EvictionWouldHelp(const ResourceResidency_Item* item)
+{
+	return (g_Data.cpuBudget > 0 && g_Data.cpuBytes > g_Data.cpuBudget && item->cpuBytes > 0) ||
+		(g_Data.gpuBudget > 0 && g_Data.gpuBytes > g_Data.gpuBudget && item->gpuBytes > 0);
+}
+
+static void EnforceBudgets(void)
+{
+	if ( !IsOverBudget() )
+	{
+		g_Data.warnedOverBudget = false;
+		return;
+	}
+
+	// Walk from least to most recently used. The head's prev pointer is the tail.
+	ResourceResidency_Item* item = g_Data.lruHead ? g_Data.lruHead->prev : NULL;
+
+	while ( item && IsOverBudget() )
+	{
+		// Everything from here onwards was used too recently to evict.
+		if ( item->lastUsedFrame + 1 >= g_Data.frame )
+		{
+			break;
+		}
+
+		ResourceResidency_Item* prev = item == g_Data.lruHead ? NULL : item->prev;
+
+		if ( EvictionWouldHelp(item) )
+		{
+			item->Evict(item);
+
+			RAYGE_ENSURE(!item->isTracked, "Resource was not untracked when it was evicted");
+			++g_Data.numEvictions;
+		}
+
+		item = prev;
+	}
+
+	if ( IsOverBudget() && !g_Data.warnedOverBudget )
+	{
+		Logging_PrintLine(
+			RAYGE_LOG_WARNING,
+			"Resources in use exceed budget (CPU: %zu of %zu bytes, GPU: %zu of %zu bytes)",
+			g_Data.cpuBytes,
+			g_Data.cpuBudget,
+			g_Data.gpuBytes,
+			g_Data.gpuBudget
+		);
+
+		g_Data.warnedOverBudget = true;
+	}
+}
+
+void ResourceResidency_Init(void)
+{
+	if ( g_Initialised )
+	{
+		return;
+	}
+
+	memset(&g_Data, 0, sizeof(g_Data));
+
+	const RayGE_LaunchState* launchState = LaunchParams_GetLaunchState();
+	g_Data.cpuBudget = ParseBudget("resource-cpu-budget", launchState->resourceCpuBudget);
+	g_Data.gpuBudget = ParseBudget("resource-gpu-budget", launchState->resourceGpuBudget);
+
+	g_Initialised = true;
+}
+
+void ResourceResidency_ShutDown(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	RAYGE_ASSERT(g_Data.numTracked == 0, "Expected all resources to be untracked before shutdown");
+
+	memset(&g_Data, 0, sizeof(g_Data));
+	g_Initialised = false;
+}
+
+void ResourceResidency_NewFrame(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	++g_Data.frame;
+	EnforceBudgets();
+}
+
+void ResourceResidency_SetBudgets(size_t cpuBytes, size_t gpuBytes)
+{
+	RAYGE_ENSURE(g_Initialised, "Resource residency manager was not initialised");
+
+	g_Data.cpuBudget = cpuBytes;
+	g_Data.gpuBudget = gpuBytes;
+	g_Data.warnedOverBudget = false;
+}
+
+void ResourceResidency_Track(
+	ResourceResidency_Item* item,
+	size_t cpuBytes,
+	size_t gpuBytes,
+	ResourceResidency_EvictFunc evictFunc
+)
+{
+	RAYGE_ASSERT_VALID(item);
+
+	if ( !g_Initialised || !item )
+	{
+		return;
+	}
+
+	RAYGE_ASSERT(!item->isTracked, "Resource was already tracked");
+
+	if ( item->isTracked )
+	{
+		return;
+	}
+
+	item->prev = NULL;
+	item->next = NULL;
+	item->Evict = evictFunc;
+	item->cpuBytes = cpuBytes;
+	item->gpuBytes = gpuBytes;
+	item->lastUsedFrame = g_Data.frame;
+	item->isTracked = true;
+
+	if ( item->Evict )
+	{
+		DL_PREPEND(g_Data.lruHead, item);
+	}
+
+	g_Data.cpuBytes += cpuBytes;
+	g_Data.gpuBytes += gpuBytes;
+	++g_Data.numTracked;
+}
+
+void ResourceResidency_Untrack(ResourceResidency_Item* item)
+{
+	if ( !g_Initialised || !item || !item->isTracked )
+	{
+		return;
+	}
+
+	if ( item->Evict )
+	{
+		DL_DELETE(g_Data.lruHead, item);
+	}
+
+	g_Data.cpuBytes -= item->cpuBytes;
+	g_Data.gpuBytes -= item->gpuBytes;
+	--g_Data.numTracked;
+
+	memset(item, 0, sizeof(*item));
+}
+
+bool ResourceResidency_IsTracked(const ResourceResidency_Item* item)
+{
+	return item && item->isTracked;
+}
+
+void ResourceResidency_Touch(ResourceResidency_Item* item)
+{
+	if ( !g_Initialised || !item || !item->isTracked )
+	{
+		return;
+	}
+
+	item->lastUsedFrame = g_Data.frame;
+
+	if ( item->Evict && g_Data.lruHead != item )
+	{
+		DL_DELETE(g_Data.lruHead, item);
+		DL_PREPEND(g_Data.lruHead, item);
+	}
+}
+
+ResourceResidency_Stats ResourceResidency_GetStats(void)
+{
+	return (ResourceResidency_Stats) {
+		.cpuBytes = g_Data.cpuBytes,
+		.gpuBytes = g_Data.gpuBytes,
+		.cpuBudget = g_Data.cpuBudget,
+		.gpuBudget = g_Data.gpuBudget,
+		.numTracked = g_Data.numTracked,
+		.numEvictions = g_Data.numEvictions,
+	};
+}
+
+#if RAYGE_BUILD_TESTING()
+typedef struct TestResource
+{
+	ResourceResidency_Item residency;
+	bool loaded;
+} TestResource;
+
+static void EvictTestResource(ResourceResidency_Item* item)
+{
+	// The residency item is the first member.
+	TestResource* resource = (TestResource*)item;
+
+	resource->loaded = false;
+	ResourceResidency_Untrack(item);
+}
+
+static void LoadTestResource(TestResource* resource, size_t cpuBytes, size_t gpuBytes, bool evictable)
+{
+	resource->loaded = true;
+	ResourceResidency_Track(&resource->residency, cpuBytes, gpuBytes, evictable ? &EvictTestResource : NULL);
+}
+
+static void TestEvictionOrder(void)
+{
+	TestResource resources[4];
+	memset(resources, 0, sizeof(resources));
+
+	ResourceResidency_SetBudgets(0, 300);
+
+	for ( size_t index = 0; index < 4; ++index )
+	{
+		LoadTestResource(&resources[index], 10, 100, true);
+	}
+
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().gpuBytes, 400);
+
+	// Nothing should be evicted while it has been used within the last frame.
+	ResourceResidency_NewFrame();
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().numTracked, 4);
+
+	// Using the first resource should make the second the least recently used.
+	ResourceResidency_Touch(&resources[0].residency);
+	ResourceResidency_NewFrame();
+
+	TEST_EXPECT_TRUE(resources[0].loaded);
+	TEST_EXPECT_FALSE(resources[1].loaded);
+	TEST_EXPECT_TRUE(resources[2].loaded);
+	TEST_EXPECT_TRUE(resources[3].loaded);
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().gpuBytes, 300);
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().cpuBytes, 30);
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().numEvictions, 1);
+
+	// Reloading should push the least recently used one out again.
+	LoadTestResource(&resources[1], 10, 100, true);
+	ResourceResidency_NewFrame();
+	ResourceResidency_NewFrame();
+
+	TEST_EXPECT_TRUE(resources[0].loaded);
+	TEST_EXPECT_TRUE(resources[1].loaded);
+	TEST_EXPECT_FALSE(resources[2].loaded);
+	TEST_EXPECT_TRUE(resources[3].loaded);
+
+	for ( size_t index = 0; index < 4; ++index )
+	{
+		ResourceResidency_Untrack(&resources[index].residency);
+	}
+
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().numTracked, 0);
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().gpuBytes, 0);
+}
+
+static void TestUnevictableResources(void)
+{
+	TestResource pinned;
+	TestResource cpuOnly;
+	TestResource gpuOnly;
+
+	memset(&pinned, 0, sizeof(pinned));
+	memset(&cpuOnly, 0, sizeof(cpuOnly));
+	memset(&gpuOnly, 0, sizeof(gpuOnly));
+
+	ResourceResidency_SetBudgets(0, 100);
+
+	LoadTestResource(&pinned, 0, 200, false);
+	LoadTestResource(&cpuOnly, 50, 0, true);
+	LoadTestResource(&gpuOnly, 0, 50, true);
+
+	ResourceResidency_NewFrame();
+	ResourceResidency_NewFrame();
+
+	// Evicting the CPU-only resource would not help the GPU budget, and
+	// the pinned resource cannot be evicted, so the budget can't be met.
+	TEST_EXPECT_TRUE(pinned.loaded);
+	TEST_EXPECT_TRUE(cpuOnly.loaded);
+	TEST_EXPECT_FALSE(gpuOnly.loaded);
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().gpuBytes, 200);
+
+	ResourceResidency_Untrack(&pinned.residency);
+	ResourceResidency_Untrack(&cpuOnly.residency);
+
+	TEST_EXPECT_EQL_INT(ResourceResidency_GetStats().numTracked, 0);
+}
+
+void ResourceResidency_RunTests(void)
+{
+	// Run against a fresh manager, and restore the engine's one afterwards.
+	const bool wasInitialised = g_Initialised;
+	const Data savedData = g_Data;
+
+	g_Initialised = false;
+	ResourceResidency_Init();
+
+	TestEvictionOrder();
+	TestUnevictableResources();
+
+	ResourceResidency_ShutDown();
+
+	g_Data = savedData;
+	g_Initialised = wasInitialised;
+}
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "Testing/Testing.h"
+
+// The residency manager keeps track of how much CPU and GPU memory
+// loaded resources are using, and when each resource was last used.
+// If a budget is exceeded, resources which have not been used recently
+// are evicted: their data is unloaded, but their handles remain valid,
+// and they are reloaded the next time they are dereferenced.
+//
+// Budgets are configured on the command line with --resource-cpu-budget
+// and --resource-gpu-budget, and are unlimited by default.
+
+typedef struct ResourceResidency_Item ResourceResidency_Item;
+
+// Must unload the resource's data and call ResourceResidency_Untrack().
+typedef void (*ResourceResidency_EvictFunc)(ResourceResidency_Item* item);
+
+// This is embedded in each resource's item data, and must not
+// move while it is tracked. Its members are private to the
+// residency manager, and a zeroed item is untracked.
+struct ResourceResidency_Item
+{
+	ResourceResidency_Item* prev;
+	ResourceResidency_Item* next;
+	ResourceResidency_EvictFunc Evict;
+	size_t cpuBytes;
+	size_t gpuBytes;
+	uint64_t lastUsedFrame;
+	bool isTracked;
+};
+
+typedef struct ResourceResidency_Stats
+{
+	size_t cpuBytes;
+	size_t gpuBytes;
+	size_t cpuBudget;
+	size_t gpuBudget;
+	size_t numTracked;
+	size_t numEvictions;
+} ResourceResidency_Stats;
+
+void ResourceResidency_Init(void);
+void ResourceResidency_ShutDown(void);
+
+// Evicts any resources required to get back within budget. Resources
+// used during the frame that has just finished are never evicted.
+void ResourceResidency_NewFrame(void);
+
+// A budget of zero means unlimited.
+void ResourceResidency_SetBudgets(size_t cpuBytes, size_t gpuBytes);
+
+// The item is treated as having just been used. If no eviction
+// function is provided, the item counts towards the totals
+// but is never evicted.
+void ResourceResidency_Track(
+	ResourceResidency_Item* item,
+	size_t cpuBytes,
+	size_t gpuBytes,
+	ResourceResidency_EvictFunc evictFunc
+);
+
+void ResourceResidency_Untrack(ResourceResidency_Item* item);
+bool ResourceResidency_IsTracked(const ResourceResidency_Item* item);
+
+// Should be called whenever the resource is dereferenced.
+void ResourceResidency_Touch(ResourceResidency_Item* item);
+
+ResourceResidency_Stats ResourceResidency_GetStats(void);
+
+#if RAYGE_BUILD_TESTING()
+void ResourceResidency_RunTests(void);
+#endif
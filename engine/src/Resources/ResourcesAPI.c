@@ -2,6 +2,7 @@
 #include "Resources/RenderablePrimitives.h"
 #include "Resources/TextureResources.h"
 #include "Resources/PixelWorldResources.h"
+#include "Resources/ResourceHandleUtils.h"
 
 RayGE_ResourceHandle ResourcesAPI_GetPrimitiveHandle(RayGE_RenderablePrimitive primitive)
 {
@@ -27,3 +28,36 @@ void ResourcesAPI_UnloadPixelWorld(RayGE_ResourceHandle handle)
 {
 	PixelWorldResources_UnloadPixelWorld(handle);
 }
+
+RayGE_ResourceHandle ResourcesAPI_LoadTextureAsync(const char* path)
+{
+	return TextureResources_LoadTextureAsync(path);
+}
+
+RayGE_ResourceLoadState ResourcesAPI_GetLoadState(RayGE_ResourceHandle handle)
+{
+	switch ( Resource_GetInternalDomain(handle) )
+	{
+		case RESOURCE_DOMAIN_RENDERABLE_PRIMITIVE:
+		{
+			return RenderablePrimitive_GetPrimitiveFromHandle(handle) != RAYGE_RENDERABLE_PRIM_INVALID
+				? RAYGE_RESOURCE_LOAD_STATE_LOADED
+				: RAYGE_RESOURCE_LOAD_STATE_INVALID;
+		}
+
+		case RESOURCE_DOMAIN_TEXTURE:
+		{
+			return TextureResources_GetLoadState(handle);
+		}
+
+		case RESOURCE_DOMAIN_PIXEL_WORLD:
+		{
+			return PixelWorldResources_GetLoadState(handle);
+		}
+
+		default:
+		{
+			return RAYGE_RESOURCE_LOAD_STATE_INVALID;
+		}
+	}
+}
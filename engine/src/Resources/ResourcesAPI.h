@@ -8,3 +8,5 @@ WZL_ATTR_NODISCARD RayGE_ResourceHandle ResourcesAPI_LoadTexture(const char* pat
 void ResourcesAPI_UnloadTexture(RayGE_ResourceHandle handle);
 WZL_ATTR_NODISCARD RayGE_ResourceHandle ResourcesAPI_LoadPixelWorld(const char* path);
 void ResourcesAPI_UnloadPixelWorld(RayGE_ResourceHandle handle);
+WZL_ATTR_NODISCARD RayGE_ResourceHandle ResourcesAPI_LoadTextureAsync(const char* path);
+RayGE_ResourceLoadState ResourcesAPI_GetLoadState(RayGE_ResourceHandle handle);
@@ -0,0 +1,583 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "Resources/TextureCache.h"
+#include "Filesystem/NativeFilesystem.h"
+#include "EngineSubsystems/FilesystemSubsystem.h"
+#include "Launcher/LaunchParams.h"
+#include "Logging/Logging.h"
+#include "MemPool/MemPoolManager.h"
+#include "Threading/Threading.h"
+#include "Utils/HashUtils.h"
+#include "Utils/Utils.h"
+#include "Debugging.h"
+#include "wzl_cutl/string.h"
+
+// Increment this whenever the layout of cache files changes,
+// or the way images are decoded changes. Existing entries
+// are then ignored, and replaced when next loaded.
+#define CACHE_FORMAT_VERSION 1
+
+#define DEFAULT_CACHE_DIR_NAME "texturecache"
+#define ENTRY_FILE_EXTENSION ".img"
+#define STAMP_FILE_EXTENSION ".stamp"
+#define ENTRY_MAGIC 0x43544752u // "RGTC"
+#define STAMP_MAGIC 0x53544752u // "RGTS"
+
+// Keeps pixel data aligned when the entry is mapped.
+#define ENTRY_HEADER_SIZE 64
+
+typedef struct EntryHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t contentKey;
+	int32_t width;
+	int32_t height;
+	int32_t mipmaps;
+	int32_t format;
+	uint64_t dataSize;
+	uint8_t reserved[ENTRY_HEADER_SIZE - 40];
+} EntryHeader;
+
+static_assert(sizeof(EntryHeader) == ENTRY_HEADER_SIZE, "Unexpected texture cache entry header size");
+
+typedef struct StampRecord
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceSize;
+	int64_t sourceModTimeNs;
+	uint64_t contentKey;
+} StampRecord;
+
+typedef struct Data
+{
+	FilesystemSubsystem_LongPath directory;
+	bool enabled;
+
+	// These are updated from loader threads.
+	volatile size_t numHits;
+	volatile size_t numMisses;
+	volatile size_t numTempFiles;
+} Data;
+
+static Data g_Data;
+static bool g_Initialised = false;
+
+static bool MakeCachePath(char* outBuffer, size_t outBufferSize, uint64_t key, const char* extension)
+{
+	const int charsWritten = wzl_sprintf(
+		outBuffer,
+		outBufferSize,
+		"%s/%016llx%s",
+		g_Data.directory,
+		(unsigned long long)key,
+		extension
+	);
+
+	return charsWritten > 0 && (size_t)charsWritten < outBufferSize;
+}
+
+static uint64_t GetContentKey(const uint8_t* data, size_t size, bool generateMipmaps)
+{
+	// The same source decoded with different options must produce a different entry.
+	const uint64_t options = ((uint64_t)CACHE_FORMAT_VERSION << 1) | (generateMipmaps ? 1 : 0);
+	return HashUtils_Hash64(data, size, options);
+}
+
+static uint64_t GetStampKey(const char* sourceName, bool generateMipmaps)
+{
+	return HashUtils_Hash64(sourceName, strlen(sourceName), generateMipmaps ? 1 : 0);
+}
+
+// Writes to a temporary file first, so that other threads or processes
+// reading the cache never see a partially written file.
+static bool WriteCacheFile(const char* path, const void* header, size_t headerSize, const void* data, size_t dataSize)
+{
+	FilesystemSubsystem_LongPath tempPath;
+	const size_t tempIndex = Threading_AtomicAddSize(&g_Data.numTempFiles, 1);
+	const int charsWritten = wzl_sprintf(tempPath, sizeof(tempPath), "%s.%zu.tmp", path, tempIndex);
+
+	if ( charsWritten < 1 || (size_t)charsWritten >= sizeof(tempPath) )
+	{
+		return false;
+	}
+
+	FILE* file = fopen(tempPath, "wb");
+
+	if ( !file )
+	{
+		return false;
+	}
+
+	bool success = fwrite(header, 1, headerSize, file) == headerSize;
+
+	if ( success && dataSize > 0 )
+	{
+		success = fwrite(data, 1, dataSize, file) == dataSize;
+	}
+
+	success = fclose(file) == 0 && success;
+
+	if ( success )
+	{
+		success = NativeFilesystem_ReplaceFile(tempPath, path);
+	}
+
+	if ( !success )
+	{
+		NativeFilesystem_DeleteFile(tempPath);
+	}
+
+	return success;
+}
+
+static bool ReadStamp(uint64_t stampKey, StampRecord* outStamp)
+{
+	FilesystemSubsystem_LongPath path;
+
+	if ( !MakeCachePath(path, sizeof(path), stampKey, STAMP_FILE_EXTENSION) )
+	{
+		return false;
+	}
+
+	FILE* file = fopen(path, "rb");
+
+	if ( !file )
+	{
+		return false;
+	}
+
+	const bool success = fread(outStamp, sizeof(*outStamp), 1, file) == 1;
+	fclose(file);
+
+	return success && outStamp->magic == STAMP_MAGIC && outStamp->version == CACHE_FORMAT_VERSION;
+}
+
+static void WriteStamp(uint64_t stampKey, const StampRecord* stamp)
+{
+	FilesystemSubsystem_LongPath path;
+
+	if ( MakeCachePath(path, sizeof(path), stampKey, STAMP_FILE_EXTENSION) )
+	{
+		WriteCacheFile(path, stamp, sizeof(*stamp), NULL, 0);
+	}
+}
+
+static bool ReadEntry(uint64_t contentKey, Image* outImage)
+{
+	FilesystemSubsystem_LongPath path;
+
+	if ( !MakeCachePath(path, sizeof(path), contentKey, ENTRY_FILE_EXTENSION) )
+	{
+		return false;
+	}
+
+	NativeFilesystem_MappedFile file;
+
+	if ( !NativeFilesystem_MapFile(path, &file) )
+	{
+		return false;
+	}
+
+	bool success = false;
+
+	do
+	{
+		if ( file.size < sizeof(EntryHeader) )
+		{
+			break;
+		}
+
+		EntryHeader header;
+		memcpy(&header, file.data, sizeof(header));
+
+		if ( header.magic != ENTRY_MAGIC || header.version != CACHE_FORMAT_VERSION || header.contentKey != contentKey )
+		{
+			break;
+		}
+
+		const size_t expectedSize =
+			TextureCache_GetPixelDataSize(header.width, header.height, header.mipmaps, header.format);
+
+		if ( expectedSize < 1 || header.dataSize != expectedSize || file.size - sizeof(header) < expectedSize )
+		{
+			break;
+		}
+
+		// This is allocated in the same way as raylib allocates
+		// image data, so that it can be freed with UnloadImage().
+		void* data = MEMPOOL_MALLOC(MEMPOOL_RAYLIB, expectedSize);
+		memcpy(data, file.data + sizeof(header), expectedSize);
+
+		outImage->data = data;
+		outImage->width = header.width;
+		outImage->height = header.height;
+		outImage->mipmaps = header.mipmaps;
+		outImage->format = header.format;
+
+		success = true;
+	}
+	while ( false );
+
+	NativeFilesystem_UnmapFile(&file);
+	return success;
+}
+
+static void WriteEntry(uint64_t contentKey, Image image)
+{
+	FilesystemSubsystem_LongPath path;
+
+	if ( !MakeCachePath(path, sizeof(path), contentKey, ENTRY_FILE_EXTENSION) )
+	{
+		return;
+	}
+
+	EntryHeader header;
+	memset(&header, 0, sizeof(header));
+
+	header.magic = ENTRY_MAGIC;
+	header.version = CACHE_FORMAT_VERSION;
+	header.contentKey = contentKey;
+	header.width = image.width;
+	header.height = image.height;
+	header.mipmaps = image.mipmaps;
+	header.format = image.format;
+	header.dataSize = TextureCache_GetPixelDataSize(image.width, image.height, image.mipmaps, image.format);
+
+	if ( !WriteCacheFile(path, &header, sizeof(header), image.data, (size_t)header.dataSize) )
+	{
+		Logging_PrintLine(RAYGE_LOG_DEBUG, "Could not write texture cache entry %s", path);
+	}
+}
+
+static void GenerateMipmaps(Image* image, bool generateMipmaps)
+{
+	if ( generateMipmaps && image->data && image->mipmaps <= 1 )
+	{
+		ImageMipmaps(image);
+	}
+}
+
+static Image DecodeImage(const char* sourceName, const uint8_t* data, size_t size, bool generateMipmaps)
+{
+	// raylib uses the extension to decide how to decode the image.
+	const char* extension = GetFileExtension(sourceName);
+
+	if ( !extension || !data || size > INT_MAX )
+	{
+		return (Image) {0};
+	}
+
+	Image image = LoadImageFromMemory(extension, data, (int)size);
+	GenerateMipmaps(&image, generateMipmaps);
+	return image;
+}
+
+void TextureCache_Init(void)
+{
+	if ( g_Initialised )
+	{
+		return;
+	}
+
+	memset(&g_Data, 0, sizeof(g_Data));
+	g_Initialised = true;
+
+	const RayGE_LaunchState* launchState = LaunchParams_GetLaunchState();
+
+	if ( launchState->disableTextureCache )
+	{
+		Logging_PrintLine(RAYGE_LOG_DEBUG, "Texture cache is disabled");
+		return;
+	}
+
+	if ( launchState->textureCacheDir && *launchState->textureCacheDir )
+	{
+		wzl_strcpy(g_Data.directory, sizeof(g_Data.directory), launchState->textureCacheDir);
+	}
+	else
+	{
+		// The application directory always ends in a separator.
+		wzl_sprintf(
+			g_Data.directory,
+			sizeof(g_Data.directory),
+			"%s%s",
+			GetApplicationDirectory(),
+			DEFAULT_CACHE_DIR_NAME
+		);
+	}
+
+	g_Data.enabled = NativeFilesystem_CreateDirectories(g_Data.directory);
+
+	if ( g_Data.enabled )
+	{
+		Logging_PrintLine(RAYGE_LOG_DEBUG, "Using texture cache directory: %s", g_Data.directory);
+	}
+	else
+	{
+		Logging_PrintLine(
+			RAYGE_LOG_WARNING,
+			"Could not create texture cache directory %s, so decoded textures will not be cached",
+			g_Data.directory
+		);
+	}
+}
+
+void TextureCache_ShutDown(void)
+{
+	if ( !g_Initialised )
+	{
+		return;
+	}
+
+	if ( g_Data.enabled )
+	{
+		Logging_PrintLine(
+			RAYGE_LOG_DEBUG,
+			"Texture cache: %zu hits, %zu misses",
+			Threading_AtomicLoadSize(&g_Data.numHits),
+			Threading_AtomicLoadSize(&g_Data.numMisses)
+		);
+	}
+
+	memset(&g_Data, 0, sizeof(g_Data));
+	g_Initialised = false;
+}
+
+Image TextureCache_LoadImage(
+	const char* sourceName,
+	const FilesystemSubsystem_MappedFile* source,
+	bool generateMipmaps
+)
+{
+	RAYGE_ASSERT_VALID(sourceName);
+	RAYGE_ASSERT_VALID(source);
+
+	if ( !sourceName || !(*sourceName) || !source || !source->data )
+	{
+		return (Image) {0};
+	}
+
+	if ( !g_Data.enabled )
+	{
+		return DecodeImage(sourceName, source->data, source->size, generateMipmaps);
+	}
+
+	const uint64_t stampKey = GetStampKey(sourceName, generateMipmaps);
+	StampRecord stamp;
+	Image image = {0};
+
+	// If the source is unchanged since it was last decoded, its data does not need
+	// to be touched at all, so none of its mapping is ever actually read from disk.
+	if ( ReadStamp(stampKey, &stamp) && stamp.sourceSize == source->size &&
+		 stamp.sourceModTimeNs == source->modTimeNs && ReadEntry(stamp.contentKey, &image) )
+	{
+		Threading_AtomicAddSize(&g_Data.numHits, 1);
+		return image;
+	}
+
+	memset(&stamp, 0, sizeof(stamp));
+	stamp.magic = STAMP_MAGIC;
+	stamp.version = CACHE_FORMAT_VERSION;
+	stamp.sourceSize = source->size;
+	stamp.sourceModTimeNs = source->modTimeNs;
+	stamp.contentKey = GetContentKey(source->data, source->size, generateMipmaps);
+
+	// The source may have been touched or copied without its contents changing.
+	if ( ReadEntry(stamp.contentKey, &image) )
+	{
+		Threading_AtomicAddSize(&g_Data.numHits, 1);
+	}
+	else
+	{
+		Threading_AtomicAddSize(&g_Data.numMisses, 1);
+		image = DecodeImage(sourceName, source->data, source->size, generateMipmaps);
+
+		if ( image.data )
+		{
+			WriteEntry(stamp.contentKey, image);
+		}
+	}
+
+	if ( image.data )
+	{
+		WriteStamp(stampKey, &stamp);
+	}
+
+	return image;
+}
+
+size_t TextureCache_GetPixelDataSize(int width, int height, int mipmaps, int format)
+{
+	if ( width < 1 || height < 1 )
+	{
+		return 0;
+	}
+
+	size_t total = 0;
+
+	for ( int level = 0; level < RAYGE_MAX(mipmaps, 1); ++level )
+	{
+		total += (size_t)GetPixelDataSize(width, height, format);
+		width = RAYGE_MAX(width / 2, 1);
+		height = RAYGE_MAX(height / 2, 1);
+	}
+
+	return total;
+}
+
+#if RAYGE_BUILD_TESTING()
+#define TEST_DIRECTORY "rayge_texture_cache_test"
+#define TEST_IMAGE_SIZE 4
+
+static Image CreateTestImage(uint8_t seed)
+{
+	const size_t size = TextureCache_GetPixelDataSize(
+		TEST_IMAGE_SIZE,
+		TEST_IMAGE_SIZE,
+		1,
+		PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+	);
+
+	uint8_t* data = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_RAYLIB, size);
+
+	for ( size_t index = 0; index < size; ++index )
+	{
+		data[index] = (uint8_t)(seed + index);
+	}
+
+	return (Image) {
+		.data = data,
+		.width = TEST_IMAGE_SIZE,
+		.height = TEST_IMAGE_SIZE,
+		.mipmaps = 1,
+		.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+	};
+}
+
+static void DeleteCacheFile(uint64_t key, const char* extension)
+{
+	FilesystemSubsystem_LongPath path;
+
+	if ( MakeCachePath(path, sizeof(path), key, extension) )
+	{
+		NativeFilesystem_DeleteFile(path);
+	}
+}
+
+static void TestEntryRoundTrip(void)
+{
+	const uint64_t key = 0x0123456789ABCDEFull;
+	Image source = CreateTestImage(7);
+	Image loaded = {0};
+
+	WriteEntry(key, source);
+
+	TEST_EXPECT_TRUE(ReadEntry(key, &loaded));
+	TEST_EXPECT_EQL_INT(loaded.width, source.width);
+	TEST_EXPECT_EQL_INT(loaded.height, source.height);
+	TEST_EXPECT_EQL_INT(loaded.mipmaps, source.mipmaps);
+	TEST_EXPECT_EQL_INT(loaded.format, source.format);
+	TEST_EXPECT_TRUE(loaded.data && memcmp(loaded.data, source.data, TEST_IMAGE_SIZE * TEST_IMAGE_SIZE * 4) == 0);
+
+	if ( loaded.data )
+	{
+		MEMPOOL_FREE(loaded.data);
+	}
+
+	MEMPOOL_FREE(source.data);
+	DeleteCacheFile(key, ENTRY_FILE_EXTENSION);
+}
+
+static void TestInvalidEntriesAreRejected(void)
+{
+	const uint64_t key = 0xFEDCBA9876543210ull;
+	Image source = CreateTestImage(3);
+	Image loaded = {0};
+
+	// An entry whose header does not match its name is not used.
+	WriteEntry(key, source);
+
+	FilesystemSubsystem_LongPath wrongPath;
+	FilesystemSubsystem_LongPath rightPath;
+	MakeCachePath(rightPath, sizeof(rightPath), key, ENTRY_FILE_EXTENSION);
+	MakeCachePath(wrongPath, sizeof(wrongPath), key + 1, ENTRY_FILE_EXTENSION);
+	NativeFilesystem_ReplaceFile(rightPath, wrongPath);
+
+	TEST_EXPECT_FALSE(ReadEntry(key + 1, &loaded));
+	TEST_EXPECT_TRUE(loaded.data == NULL);
+	DeleteCacheFile(key + 1, ENTRY_FILE_EXTENSION);
+
+	// Neither is a truncated entry.
+	EntryHeader header;
+	memset(&header, 0, sizeof(header));
+
+	header.magic = ENTRY_MAGIC;
+	header.version = CACHE_FORMAT_VERSION;
+	header.contentKey = key;
+	header.width = source.width;
+	header.height = source.height;
+	header.mipmaps = source.mipmaps;
+	header.format = source.format;
+	header.dataSize = TextureCache_GetPixelDataSize(source.width, source.height, source.mipmaps, source.format);
+
+	WriteCacheFile(rightPath, &header, sizeof(header), source.data, (size_t)header.dataSize / 2);
+
+	TEST_EXPECT_FALSE(ReadEntry(key, &loaded));
+	TEST_EXPECT_TRUE(loaded.data == NULL);
+
+	MEMPOOL_FREE(source.data);
+	DeleteCacheFile(key, ENTRY_FILE_EXTENSION);
+}
+
+static void TestStampRoundTrip(void)
+{
+	const uint64_t stampKey = GetStampKey("some/texture.png", false);
+	StampRecord stamp;
+	StampRecord loaded;
+
+	memset(&stamp, 0, sizeof(stamp));
+	stamp.magic = STAMP_MAGIC;
+	stamp.version = CACHE_FORMAT_VERSION;
+	stamp.sourceSize = 1234;
+	stamp.sourceModTimeNs = 5678;
+	stamp.contentKey = 91011;
+
+	// The same path with different options should use a different stamp.
+	TEST_EXPECT_TRUE(stampKey != GetStampKey("some/texture.png", true));
+
+	TEST_EXPECT_FALSE(ReadStamp(stampKey, &loaded));
+	WriteStamp(stampKey, &stamp);
+
+	TEST_EXPECT_TRUE(ReadStamp(stampKey, &loaded));
+	TEST_EXPECT_TRUE(memcmp(&stamp, &loaded, sizeof(stamp)) == 0);
+
+	DeleteCacheFile(stampKey, STAMP_FILE_EXTENSION);
+}
+
+void TextureCache_RunTests(void)
+{
+	// Run against a temporary directory, and restore the engine's cache afterwards.
+	const Data savedData = g_Data;
+
+	memset(&g_Data, 0, sizeof(g_Data));
+	wzl_strcpy(g_Data.directory, sizeof(g_Data.directory), TEST_DIRECTORY);
+	g_Data.enabled = NativeFilesystem_CreateDirectories(g_Data.directory);
+
+	TEST_EXPECT_TRUE(g_Data.enabled);
+
+	if ( g_Data.enabled )
+	{
+		TestEntryRoundTrip();
+		TestInvalidEntriesAreRejected();
+		TestStampRoundTrip();
+
+		NativeFilesystem_DeleteFile(TEST_DIRECTORY);
+	}
+
+	g_Data = savedData;
+}
+#endif
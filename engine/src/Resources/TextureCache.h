@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "Testing/Testing.h"
+#include "raylib.h"
+#include "EngineSubsystems/FilesystemSubsystem.h"
+
+// The texture cache keeps decoded copies of source images on disk, so that
+// they do not need to be decoded again the next time they are loaded.
+//
+// Each cache entry is named after a hash of the source file's contents and the
+// options it was decoded with, and holds pixel data that is ready to upload.
+// A small stamp file per source name records the source's size and modification
+// time along with the entry it was decoded to. If these still match, the entry
+// is used without reading the source at all. If not, the source is hashed,
+// and is only decoded again if its contents have actually changed.
+//
+// Entries use the host's byte order, so are not portable between machines.
+// The cache is stored in the "texturecache" directory next to the executable,
+// unless --texture-cache-dir is given, and can be disabled with
+// --disable-texture-cache.
+
+void TextureCache_Init(void);
+void TextureCache_ShutDown(void);
+
+// Decodes the image from the source file's data, unless it is already cached.
+// The source name identifies the file between runs, and its extension decides
+// how the data is decoded. May be called from any thread. If generateMipmaps
+// is true, the image includes a full mip chain. The image should be freed
+// with UnloadImage().
+Image TextureCache_LoadImage(
+	const char* sourceName,
+	const FilesystemSubsystem_MappedFile* source,
+	bool generateMipmaps
+);
+
+// Returns the size of an image's pixel data, including all mip levels.
+size_t TextureCache_GetPixelDataSize(int width, int height, int mipmaps, int format);
+
+#if RAYGE_BUILD_TESTING()
+void TextureCache_RunTests(void);
+#endif
@@ -1,41 +1,139 @@
+#include <assert.h>
+#include <stddef.h>
 #include "Resources/TextureResources.h"
+#include "Resources/ResourceResidency.h"
+#include "Resources/TextureCache.h"
+#include "Launcher/LaunchParams.h"
 #include "Logging/Logging.h"
 #include "Resources/ResourceHandleUtils.h"
 #include "EngineSubsystems/FilesystemSubsystem.h"
 #include "MemPool/MemPoolManager.h"
 #include "Resources/ResourceListUtils.h"
+#include "Threading/WorkerPool.h"
 #include "Utils/Utils.h"
 #include "Utils/StringUtils.h"
 #include "wzl_cutl/string.h"
 #include "raylib.h"
 
-// These must be powers of two to divide nicely
-#define MAX_TEXTURES 2048
+// These must be powers of two to divide nicely.
+// Buckets are only allocated as they are needed, and the memory
+// used by textures is governed by the residency manager's budget.
+#define MAX_TEXTURES 65536
 #define TEXTURE_BATCH_SIZE 32
 
+// Images for asynchronously loaded textures are decoded on these threads.
+#define TEXTURE_LOADER_THREADS 2
+
+// Maximum time per frame spent uploading decoded images to the GPU.
+// At least one image is always uploaded, so that loading makes progress.
+#define TEXTURE_UPLOAD_BUDGET_NS (2ull * 1000000ull)
+
 typedef struct TextureItem
 {
+	ResourceResidency_Item residency;
 	Texture2D texture;
+	RayGE_ResourceLoadState loadState;
 } TextureItem;
 
+typedef struct TextureLoadJob
+{
+	RayGE_ResourceHandle handle;
+	char* fullPath;
+	FilesystemSubsystem_MappedFile source;
+	Image image;
+} TextureLoadJob;
+
+// Eviction is given the residency item, and needs to find the texture item from it.
+static_assert(offsetof(TextureItem, residency) == 0, "Residency item must be the first member of TextureItem");
+
 static ResourceList* g_ResourceList = NULL;
+static WorkerPool* g_LoaderPool = NULL;
 
-static void DeinitItem(void* item)
+static size_t GetTextureGpuBytes(Texture2D texture)
+{
+	return TextureCache_GetPixelDataSize(texture.width, texture.height, texture.mipmaps, texture.format);
+}
+
+static bool ShouldGenerateMipmaps(void)
+{
+	return LaunchParams_GetLaunchState()->generateTextureMipmaps;
+}
+
+static Texture2D UploadImage(Image image)
+{
+	Texture2D texture = LoadTextureFromImage(image);
+
+	if ( texture.id != 0 && texture.mipmaps > 1 )
+	{
+		SetTextureFilter(texture, TEXTURE_FILTER_TRILINEAR);
+	}
+
+	return texture;
+}
+
+// The image is decoded straight from the mapped file, which is only
+// read at all if the texture cache does not already hold the image.
+static Image LoadImageFromFile(const char* relPath, bool generateMipmaps)
+{
+	FilesystemSubsystem_MappedFile file;
+	Image image = {0};
+
+	if ( FilesystemSubsystem_MapFile(relPath, &file) )
+	{
+		// If the file was mapped, its path must have been resolvable.
+		image = TextureCache_LoadImage(FilesystemSubsystem_ResolvePath(relPath), &file, generateMipmaps);
+	}
+
+	FilesystemSubsystem_UnmapFile(&file);
+	return image;
+}
+
+static Texture2D LoadTextureFromFile(const char* relPath)
+{
+	Image image = LoadImageFromFile(relPath, ShouldGenerateMipmaps());
+
+	if ( !image.data )
+	{
+		return (Texture2D) {0, 0, 0, 0, 0};
+	}
+
+	Texture2D texture = UploadImage(image);
+	UnloadImage(image);
+	return texture;
+}
+
+static void UnloadItemTexture(TextureItem* item)
 {
-	TextureItem* texItem = (TextureItem*)item;
+	ResourceResidency_Untrack(&item->residency);
 
-	if ( texItem->texture.id != 0 )
+	if ( item->texture.id != 0 )
 	{
-		UnloadTexture(texItem->texture);
-		texItem->texture.id = 0;
+		UnloadTexture(item->texture);
+		memset(&item->texture, 0, sizeof(item->texture));
 	}
 }
 
+static void EvictItem(ResourceResidency_Item* residency)
+{
+	UnloadItemTexture((TextureItem*)residency);
+}
+
+static void TrackItem(TextureItem* item, bool isInternal)
+{
+	// Internal textures are created from image data rather than loaded
+	// from disk, so there is no way to reload them if they are evicted.
+	ResourceResidency_Track(&item->residency, 0, GetTextureGpuBytes(item->texture), isInternal ? NULL : &EvictItem);
+}
+
+static void DeinitItem(void* item)
+{
+	UnloadItemTexture((TextureItem*)item);
+}
+
 static bool CreateItemCallback(const char* relPath, void* itemData, void* userData)
 {
 	TextureItem* item = (TextureItem*)itemData;
 	Image* sourceImage = (Image*)userData;
-	char* fullPath = NULL;
 
 	do
 	{
@@ -46,12 +144,12 @@ static bool CreateItemCallback(const char* relPath, void* itemData, void* userDa
 		}
 		else
 		{
-			fullPath = FilesystemSubsystem_MakeAbsoluteAlloc(relPath);
-
 			if ( sourceImage )
 			{
-				Logging_PrintLine(RAYGE_LOG_TRACE, "Loading texture %s from file and retaining source image", fullPath);
-				*sourceImage = LoadImage(fullPath);
+				Logging_PrintLine(RAYGE_LOG_TRACE, "Loading texture %s from file and retaining source image", relPath);
+
+				// Retained images are read back on the CPU, so they never have mipmaps.
+				*sourceImage = LoadImageFromFile(relPath, false);
 
 				if ( !sourceImage->data )
 				{
@@ -62,19 +160,106 @@ static bool CreateItemCallback(const char* relPath, void* itemData, void* userDa
 			}
 			else
 			{
-				Logging_PrintLine(RAYGE_LOG_TRACE, "Loading texture %s from file", fullPath);
-				item->texture = LoadTexture(fullPath);
+				Logging_PrintLine(RAYGE_LOG_TRACE, "Loading texture %s from file", relPath);
+				item->texture = LoadTextureFromFile(relPath);
 			}
 		}
 	}
 	while ( false );
 
-	if ( fullPath )
+	if ( item->texture.id == 0 )
 	{
-		MEMPOOL_FREE(fullPath);
+		return false;
 	}
 
-	return item->texture.id != 0;
+	item->loadState = RAYGE_RESOURCE_LOAD_STATE_LOADED;
+	TrackItem(item, relPath[0] == ':');
+	return true;
+}
+
+static bool CreatePendingItemCallback(const char* relPath, void* itemData, void* userData)
+{
+	(void)relPath;
+
+	TextureItem* item = (TextureItem*)itemData;
+	item->loadState = RAYGE_RESOURCE_LOAD_STATE_PENDING;
+
+	*((bool*)userData) = true;
+	return true;
+}
+
+// Called on a worker thread.
+static void RunLoadJob(void* userData)
+{
+	TextureLoadJob* job = (TextureLoadJob*)userData;
+
+	// raylib decodes straight into the pixel format that
+	// will be uploaded, so no further conversion is needed.
+	job->image = TextureCache_LoadImage(job->fullPath, &job->source, ShouldGenerateMipmaps());
+}
+
+static void CompleteLoadJob(void* userData, bool wasCancelled)
+{
+	TextureLoadJob* job = (TextureLoadJob*)userData;
+
+	// The loader pool is cleared before it is destroyed, so if it is not
+	// set then we are shutting down, and there is no point uploading.
+	TextureItem* item = (!wasCancelled && g_LoaderPool)
+		? (TextureItem*)ResourceList_GetItemData(g_ResourceList, job->handle)
+		: NULL;
+
+	// If the item is not found, it was destroyed while the image was being decoded.
+	if ( item && item->loadState == RAYGE_RESOURCE_LOAD_STATE_PENDING )
+	{
+		if ( job->image.data )
+		{
+			item->texture = UploadImage(job->image);
+		}
+
+		if ( item->texture.id != 0 )
+		{
+			item->loadState = RAYGE_RESOURCE_LOAD_STATE_LOADED;
+			TrackItem(item, false);
+		}
+		else
+		{
+			Logging_PrintLine(RAYGE_LOG_ERROR, "Failed to load texture %s", job->fullPath);
+			item->loadState = RAYGE_RESOURCE_LOAD_STATE_FAILED;
+		}
+	}
+
+	if ( job->image.data )
+	{
+		UnloadImage(job->image);
+	}
+
+	FilesystemSubsystem_UnmapFile(&job->source);
+	MEMPOOL_FREE(job->fullPath);
+	MEMPOOL_FREE(job);
+}
+
+static void SubmitLoadJob(RayGE_ResourceHandle handle)
+{
+	TextureLoadJob* job = MEMPOOL_CALLOC_STRUCT(MEMPOOL_RESOURCE_MANAGEMENT, TextureLoadJob);
+	job->handle = handle;
+
+	// The filesystem is only used from the main thread, so the path is resolved
+	// before the job is queued. The resolved path only lasts until the base path
+	// changes, which may happen while the image is decoding, so the job keeps a copy.
+	const char* relPath = ResourceList_GetItemPath(g_ResourceList, handle);
+	const char* fullPath = FilesystemSubsystem_ResolvePath(relPath);
+	job->fullPath = StringUtils_Duplicate(MEMPOOL_RESOURCE_MANAGEMENT, fullPath ? fullPath : relPath);
+
+	// Mapping is cheap, since nothing is read until the worker touches the data.
+	// If this fails, the job still runs, and reports the failure when it completes.
+	FilesystemSubsystem_MapFile(relPath, &job->source);
+
+	Logging_PrintLine(RAYGE_LOG_TRACE, "Queueing texture %s for asynchronous load", job->fullPath);
+
+	if ( !WorkerPool_Submit(g_LoaderPool, &RunLoadJob, &CompleteLoadJob, job) )
+	{
+		CompleteLoadJob(job, true);
+	}
 }
 
 // If source image is provided and data is valid, it is used as the image for the texture.
@@ -82,14 +267,14 @@ static bool CreateItemCallback(const char* relPath, void* itemData, void* userDa
 // is updated to hold the data.
 // If source image is not provided, the texture is loaded off disk and the image data
 // is not kept on the CPU afterwards.
-static RayGE_ResourceHandle LoadTextureFromPath(const char* path, Image* sourceImage, bool isInternal)
+static bool ValidateLoadPath(const char* path, bool isInternal)
 {
 	RAYGE_ASSERT_VALID(g_ResourceList);
 	RAYGE_ASSERT(path && *path, "Expected a valid path");
 
 	if ( !g_ResourceList || !path || !(*path) )
 	{
-		return RAYGE_NULL_RESOURCE_HANDLE;
+		return false;
 	}
 
 	StringBounds bounds = StringUtils_GetStringTrimBounds(path);
@@ -102,11 +287,20 @@ static RayGE_ResourceHandle LoadTextureFromPath(const char* path, Image* sourceI
 			path
 		);
 
+		return false;
+	}
+
+	return true;
+}
+
+static RayGE_ResourceHandle LoadTextureFromPath(const char* path, Image* sourceImage, bool isInternal)
+{
+	if ( !ValidateLoadPath(path, isInternal) )
+	{
 		return RAYGE_NULL_RESOURCE_HANDLE;
 	}
 
 	return ResourceListUtils_CreateNewItem("texture", g_ResourceList, path, CreateItemCallback, sourceImage);
-
 }
 
 static void UnloadTextureFromHandle(RayGE_ResourceHandle handle, bool requestIsInternal)
@@ -144,12 +338,19 @@ static void UnloadTextureFromHandle(RayGE_ResourceHandle handle, bool requestIsI
 		return;
 	}
 
-	if ( !ResourceList_DestroyItem(g_ResourceList, handle) )
+	if ( !ResourceList_ReleaseItem(g_ResourceList, handle) )
 	{
 		Logging_PrintLine(
 			RAYGE_LOG_WARNING,
 			"Could not unload texture: provided handle did not refer to a loaded texture"
 		);
+
+		return;
+	}
+
+	if ( requestIsInternal && ResourceList_GetRefCount(g_ResourceList, handle) < 1 )
+	{
+		ResourceList_DestroyItem(g_ResourceList, handle);
 	}
 }
 
@@ -172,6 +373,12 @@ void TextureResources_Init(void)
 	g_ResourceList = ResourceList_Create(atts);
 
 	RAYGE_ENSURE(g_ResourceList, "Failed to create texture resource list!");
+
+	// The cache must be ready before any loader threads start using it.
+	TextureCache_Init();
+	g_LoaderPool = WorkerPool_Create(MEMPOOL_RESOURCE_MANAGEMENT, TEXTURE_LOADER_THREADS);
+
+	RAYGE_ENSURE(g_LoaderPool, "Failed to create texture loader threads!");
 }
 
 void TextureResources_ShutDown(void)
@@ -181,8 +388,36 @@ void TextureResources_ShutDown(void)
 		return;
 	}
 
+	// Any images that are still being decoded are thrown away.
+	WorkerPool* loaderPool = g_LoaderPool;
+	g_LoaderPool = NULL;
+	WorkerPool_Destroy(loaderPool);
+
 	ResourceList_Destroy(g_ResourceList);
 	g_ResourceList = NULL;
+
+	TextureCache_ShutDown();
+}
+
+void TextureResources_NewFrame(void)
+{
+	if ( !g_ResourceList )
+	{
+		return;
+	}
+
+	ResourceList_DestroyPendingItems(g_ResourceList);
+	WorkerPool_ProcessCompleted(g_LoaderPool, TEXTURE_UPLOAD_BUDGET_NS);
+}
+
+void TextureResources_FinishPendingLoads(void)
+{
+	if ( !g_LoaderPool )
+	{
+		return;
+	}
+
+	WorkerPool_WaitForAll(g_LoaderPool);
 }
 
 RayGE_ResourceHandle TextureResources_LoadTexture(const char* path)
@@ -190,6 +425,38 @@ RayGE_ResourceHandle TextureResources_LoadTexture(const char* path)
 	return LoadTextureFromPath(path, NULL, false);
 }
 
+RayGE_ResourceHandle TextureResources_LoadTextureAsync(const char* path)
+{
+	if ( !ValidateLoadPath(path, false) )
+	{
+		return RAYGE_NULL_RESOURCE_HANDLE;
+	}
+
+	bool needsLoad = false;
+
+	RayGE_ResourceHandle handle =
+		ResourceListUtils_CreateNewItem("texture", g_ResourceList, path, CreatePendingItemCallback, &needsLoad);
+
+	if ( !needsLoad && !RAYGE_IS_NULL_RESOURCE_HANDLE(handle) )
+	{
+		// If a previous attempt to load the texture failed, try again.
+		TextureItem* item = (TextureItem*)ResourceList_GetItemData(g_ResourceList, handle);
+
+		if ( item->loadState == RAYGE_RESOURCE_LOAD_STATE_FAILED )
+		{
+			item->loadState = RAYGE_RESOURCE_LOAD_STATE_PENDING;
+			needsLoad = true;
+		}
+	}
+
+	if ( needsLoad )
+	{
+		SubmitLoadJob(handle);
+	}
+
+	return handle;
+}
+
 RayGE_ResourceHandle TextureResources_LoadTextureAndRetainImage(const char* path, Image* outImage)
 {
 	RAYGE_ASSERT(outImage && !outImage->data, "Output image is not valid");
@@ -200,7 +467,25 @@ RayGE_ResourceHandle TextureResources_LoadTextureAndRetainImage(const char* path
 	}
 
 	memset(outImage, 0, sizeof(*outImage));
-	return LoadTextureFromPath(path, outImage, false);
+	RayGE_ResourceHandle handle = LoadTextureFromPath(path, outImage, false);
+
+	// If the texture was already loaded, the image was not
+	// populated, so it needs to be loaded separately.
+	if ( !RAYGE_IS_NULL_RESOURCE_HANDLE(handle) && !outImage->data )
+	{
+		const char* relPath = ResourceList_GetItemPath(g_ResourceList, handle);
+		Logging_PrintLine(RAYGE_LOG_TRACE, "Loading source image for existing texture %s", relPath);
+
+		*outImage = LoadImageFromFile(relPath, false);
+
+		if ( !outImage->data )
+		{
+			TextureResources_UnloadTexture(handle);
+			handle = RAYGE_NULL_RESOURCE_HANDLE;
+		}
+	}
+
+	return handle;
 }
 
 RayGE_ResourceHandle TextureResources_LoadInternalTexture(const char* name, Image sourceImage)
@@ -255,6 +540,57 @@ const ResourceList* TestureResources_GetResourceList(void)
 	return g_ResourceList;
 }
 
+Texture2D TextureResources_GetTextureFromHandle(RayGE_ResourceHandle handle)
+{
+	RAYGE_ASSERT_VALID(g_ResourceList);
+
+	if ( !g_ResourceList )
+	{
+		return (Texture2D) {0, 0, 0, 0, 0};
+	}
+
+	TextureItem* item = (TextureItem*)ResourceList_GetItemData(g_ResourceList, handle);
+
+	if ( !item || item->loadState != RAYGE_RESOURCE_LOAD_STATE_LOADED )
+	{
+		return (Texture2D) {0, 0, 0, 0, 0};
+	}
+
+	if ( ResourceResidency_IsTracked(&item->residency) )
+	{
+		ResourceResidency_Touch(&item->residency);
+		return item->texture;
+	}
+
+	// The texture was evicted, so load it again.
+	const char* path = ResourceList_GetItemPath(g_ResourceList, handle);
+	Logging_PrintLine(RAYGE_LOG_TRACE, "Reloading evicted texture %s", path);
+	item->texture = LoadTextureFromFile(path);
+
+	if ( item->texture.id == 0 )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "Failed to reload evicted texture %s", path);
+		item->loadState = RAYGE_RESOURCE_LOAD_STATE_FAILED;
+		return item->texture;
+	}
+
+	TrackItem(item, false);
+	return item->texture;
+}
+
+RayGE_ResourceLoadState TextureResources_GetLoadState(RayGE_ResourceHandle handle)
+{
+	RAYGE_ASSERT_VALID(g_ResourceList);
+
+	if ( !g_ResourceList )
+	{
+		return RAYGE_RESOURCE_LOAD_STATE_INVALID;
+	}
+
+	const TextureItem* item = (const TextureItem*)ResourceList_GetItemData(g_ResourceList, handle);
+	return item ? item->loadState : RAYGE_RESOURCE_LOAD_STATE_INVALID;
+}
+
 Texture2D TextureResources_GetTexture(ResourceListIterator iterator)
 {
 	RAYGE_ASSERT_VALID(g_ResourceList);
@@ -2,25 +2,51 @@
 
 #include <stddef.h>
 #include "RayGE/ResourceHandle.h"
+#include "RayGE/APIs/Resources.h"
 #include "Resources/ResourceList.h"
 #include "raylib.h"
 #include "wzl_cutl/attributes.h"
 
 void TextureResources_Init(void);
 void TextureResources_ShutDown(void);
+void TextureResources_NewFrame(void);
 
+// Blocks until every asynchronous load has finished and been uploaded.
+// Load jobs read from views into mounted pack archives, so the filesystem
+// calls this before unmounting them.
+void TextureResources_FinishPendingLoads(void);
+
+// Textures are reference counted. Loading a path that is already loaded
+// returns the same handle, and each load must be matched by an unload.
+// Textures that are no longer referenced are destroyed on the next frame.
 WZL_ATTR_NODISCARD RayGE_ResourceHandle TextureResources_LoadTexture(const char* path);
+// Returns immediately with a handle to a texture in the pending state. The image is
+// decoded on a worker thread, and uploaded during a later call to NewFrame().
+// If the path is already loaded or being loaded, the existing handle is returned.
+WZL_ATTR_NODISCARD RayGE_ResourceHandle TextureResources_LoadTextureAsync(const char* path);
+
 WZL_ATTR_NODISCARD RayGE_ResourceHandle TextureResources_LoadTextureAndRetainImage(const char* path, Image* outImage);
 WZL_ATTR_NODISCARD RayGE_ResourceHandle TextureResources_LoadInternalTexture(const char* name, Image sourceImage);
 
 // These two functions essentially do the same thing, but one of them is designed
 // only to be called externally, and the other only to be called internally.
 // This stops game clients from unloading internal resources.
+// Internal textures are destroyed as soon as they are no longer referenced,
+// since they may be recreated from different image data under the same name.
 void TextureResources_UnloadTexture(RayGE_ResourceHandle handle);
 void TextureResources_UnloadInternalTexture(RayGE_ResourceHandle handle);
 
 size_t TextureResources_NumTextures(void);
 
+RayGE_ResourceLoadState TextureResources_GetLoadState(RayGE_ResourceHandle handle);
+
+// Marks the texture as used, and reloads it if it was evicted.
+// If the texture is not loaded, its ID will be zero.
+Texture2D TextureResources_GetTextureFromHandle(RayGE_ResourceHandle handle);
+
 const ResourceList* TestureResources_GetResourceList(void);
+
+// This is intended for inspecting the resource list, so does not count as
+// using the texture. If the texture was evicted, its ID will be zero.
 Texture2D TextureResources_GetTexture(ResourceListIterator iterator);
 const char* TextureResources_GetPath(ResourceListIterator iterator);
@@ -0,0 +1,579 @@
+#include <string.h>
+#include "Scene/Archetype.h"
+#include "MemPool/MemPoolManager.h"
+#include "Resources/ResourceHandleUtils.h"
+#include "Utils/Utils.h"
+#include "Debugging.h"
+
+#define ALIGN_SIZE(size) ((((size) + ARCHETYPE_ALIGNMENT - 1) / ARCHETYPE_ALIGNMENT) * ARCHETYPE_ALIGNMENT)
+#define CHUNK_HEADER_SIZE ALIGN_SIZE(sizeof(RayGE_ArchetypeChunk))
+
+struct RayGE_Archetype
+{
+	RayGE_ComponentMask mask;
+	uint32_t numRows;
+
+	// Each chunk is a single allocation, laid out as the chunk header,
+	// followed by the entity handle array, followed by one array for each
+	// component type in the mask. Offsets are from the start of the chunk.
+	size_t chunkSizeInBytes;
+	size_t entityHandlesOffset;
+	size_t componentOffsets[RAYGE_COMPONENTTYPE__COUNT];
+
+	RayGE_ArchetypeChunk** chunks;
+	size_t numAllocatedChunks;
+	size_t chunkListCapacity;
+};
+
+static RayGE_ArchetypeChunk* AllocateChunk(RayGE_Archetype* archetype)
+{
+	if ( archetype->numAllocatedChunks >= archetype->chunkListCapacity )
+	{
+		const size_t newCapacity = archetype->chunkListCapacity > 0 ? archetype->chunkListCapacity * 2 : 4;
+
+		archetype->chunks = (RayGE_ArchetypeChunk**)MEMPOOL_REALLOC(
+			MEMPOOL_ENTITY,
+			archetype->chunks,
+			newCapacity * sizeof(RayGE_ArchetypeChunk*)
+		);
+
+		archetype->chunkListCapacity = newCapacity;
+	}
+
+	uint8_t* base = (uint8_t*)MEMPOOL_MALLOC(MEMPOOL_ENTITY, archetype->chunkSizeInBytes);
+	RAYGE_ENSURE(base, "Failed to allocate archetype chunk of %zu bytes", archetype->chunkSizeInBytes);
+
+	RayGE_ArchetypeChunk* chunk = (RayGE_ArchetypeChunk*)base;
+	memset(chunk, 0, sizeof(*chunk));
+
+	chunk->entityHandles = (RayGE_ResourceHandle*)(base + archetype->entityHandlesOffset);
+
+	for ( size_t type = 0; type < RAYGE_COMPONENTTYPE__COUNT; ++type )
+	{
+		if ( COMPONENT_MASK_HAS(archetype->mask, type) )
+		{
+			chunk->components[type] = base + archetype->componentOffsets[type];
+		}
+	}
+
+	archetype->chunks[archetype->numAllocatedChunks++] = chunk;
+	return chunk;
+}
+
+static RayGE_ArchetypeChunk* GetChunkForRow(const RayGE_Archetype* archetype, uint32_t row, uint32_t* outLocalRow)
+{
+	*outLocalRow = row % ARCHETYPE_ENTITIES_PER_CHUNK;
+	return archetype->chunks[row / ARCHETYPE_ENTITIES_PER_CHUNK];
+}
+
+static void* GetComponentInChunk(RayGE_ArchetypeChunk* chunk, uint32_t localRow, RayGE_ComponentType type)
+{
+	return (uint8_t*)chunk->components[type] + ((size_t)localRow * Component_GetSize(type));
+}
+
+// Sets the first component to the given value, or to the defaults if there is
+// no value, and then copies it to the rest in as few copies as possible.
+static void FillComponents(RayGE_ComponentType type, void* components, uint32_t count, const void* value)
+{
+	if ( count < 1 )
+	{
+		return;
+	}
+
+	const size_t size = Component_GetSize(type);
+	uint8_t* base = (uint8_t*)components;
+
+	if ( value )
+	{
+		memcpy(base, value, size);
+	}
+	else
+	{
+		Component_InitDefaults(type, base);
+	}
+
+	for ( uint32_t filled = 1; filled < count; )
+	{
+		const uint32_t toCopy = RAYGE_MIN(filled, count - filled);
+
+		memcpy(base + ((size_t)filled * size), base, (size_t)toCopy * size);
+		filled += toCopy;
+	}
+}
+
+RayGE_Archetype* Archetype_Create(RayGE_ComponentMask mask)
+{
+	RAYGE_ASSERT(
+		(mask >> RAYGE_COMPONENTTYPE__COUNT) == 0,
+		"Component mask 0x%x contained unrecognised component types",
+		mask
+	);
+
+	RayGE_Archetype* archetype = MEMPOOL_CALLOC_STRUCT(MEMPOOL_ENTITY, RayGE_Archetype);
+	archetype->mask = mask & (RayGE_ComponentMask)(COMPONENT_MASK_COUNT - 1);
+
+	size_t offset = CHUNK_HEADER_SIZE;
+
+	archetype->entityHandlesOffset = offset;
+	offset += ALIGN_SIZE(ARCHETYPE_ENTITIES_PER_CHUNK * sizeof(RayGE_ResourceHandle));
+
+	for ( size_t type = 0; type < RAYGE_COMPONENTTYPE__COUNT; ++type )
+	{
+		if ( COMPONENT_MASK_HAS(archetype->mask, type) )
+		{
+			archetype->componentOffsets[type] = offset;
+			offset += ALIGN_SIZE(ARCHETYPE_ENTITIES_PER_CHUNK * Component_GetSize((RayGE_ComponentType)type));
+		}
+	}
+
+	archetype->chunkSizeInBytes = offset;
+	return archetype;
+}
+
+void Archetype_Destroy(RayGE_Archetype* archetype)
+{
+	if ( !archetype )
+	{
+		return;
+	}
+
+	for ( size_t index = 0; index < archetype->numAllocatedChunks; ++index )
+	{
+		MEMPOOL_FREE(archetype->chunks[index]);
+	}
+
+	if ( archetype->chunks )
+	{
+		MEMPOOL_FREE(archetype->chunks);
+	}
+
+	MEMPOOL_FREE(archetype);
+}
+
+RayGE_ComponentMask Archetype_GetMask(const RayGE_Archetype* archetype)
+{
+	RAYGE_ASSERT_VALID(archetype);
+	return archetype ? archetype->mask : 0;
+}
+
+uint32_t Archetype_GetNumRows(const RayGE_Archetype* archetype)
+{
+	return archetype ? archetype->numRows : 0;
+}
+
+size_t Archetype_GetNumChunks(const RayGE_Archetype* archetype)
+{
+	if ( !archetype )
+	{
+		return 0;
+	}
+
+	return ((size_t)archetype->numRows + ARCHETYPE_ENTITIES_PER_CHUNK - 1) / ARCHETYPE_ENTITIES_PER_CHUNK;
+}
+
+const RayGE_ArchetypeChunk* Archetype_GetChunk(const RayGE_Archetype* archetype, size_t index)
+{
+	return index < Archetype_GetNumChunks(archetype) ? archetype->chunks[index] : NULL;
+}
+
+uint32_t Archetype_AddRow(RayGE_Archetype* archetype, RayGE_ResourceHandle entityHandle)
+{
+	return Archetype_AddRows(archetype, &entityHandle, 1, NULL);
+}
+
+uint32_t Archetype_AddRows(
+	RayGE_Archetype* archetype,
+	const RayGE_ResourceHandle* entityHandles,
+	uint32_t count,
+	const void* const initialData[RAYGE_COMPONENTTYPE__COUNT]
+)
+{
+	RAYGE_ENSURE(archetype, "Cannot add rows to null archetype");
+	RAYGE_ENSURE(count < 1 || entityHandles, "Expected entity handles for new archetype rows");
+	RAYGE_ENSURE(
+		count <= UINT32_MAX - archetype->numRows,
+		"Archetype 0x%x cannot hold %u more rows",
+		archetype->mask,
+		count
+	);
+
+	const uint32_t firstRow = archetype->numRows;
+	uint32_t rowsAdded = 0;
+
+	// Rows are added in runs, each of which fills up to the end of a chunk.
+	while ( rowsAdded < count )
+	{
+		const uint32_t row = firstRow + rowsAdded;
+
+		if ( row / ARCHETYPE_ENTITIES_PER_CHUNK >= archetype->numAllocatedChunks )
+		{
+			AllocateChunk(archetype);
+		}
+
+		uint32_t localRow = 0;
+		RayGE_ArchetypeChunk* chunk = GetChunkForRow(archetype, row, &localRow);
+
+		RAYGE_ASSERT(chunk->count == localRow, "Expected new rows to be at the end of their chunk");
+
+		const uint32_t runLength = RAYGE_MIN(count - rowsAdded, ARCHETYPE_ENTITIES_PER_CHUNK - localRow);
+
+		memcpy(&chunk->entityHandles[localRow], &entityHandles[rowsAdded], runLength * sizeof(RayGE_ResourceHandle));
+
+		for ( size_t type = 0; type < RAYGE_COMPONENTTYPE__COUNT; ++type )
+		{
+			if ( COMPONENT_MASK_HAS(archetype->mask, type) )
+			{
+				FillComponents(
+					(RayGE_ComponentType)type,
+					GetComponentInChunk(chunk, localRow, type),
+					runLength,
+					initialData ? initialData[type] : NULL
+				);
+			}
+		}
+
+		chunk->count += runLength;
+		archetype->numRows += runLength;
+		rowsAdded += runLength;
+	}
+
+	return firstRow;
+}
+
+uint32_t Archetype_RemoveRow(RayGE_Archetype* archetype, uint32_t row)
+{
+	RAYGE_ASSERT_VALID(archetype);
+	RAYGE_ASSERT(archetype && row < archetype->numRows, "Archetype row %u was out of range", row);
+
+	if ( !archetype || row >= archetype->numRows )
+	{
+		return UINT32_MAX;
+	}
+
+	const uint32_t lastRow = archetype->numRows - 1;
+
+	uint32_t lastLocalRow = 0;
+	RayGE_ArchetypeChunk* lastChunk = GetChunkForRow(archetype, lastRow, &lastLocalRow);
+
+	uint32_t movedEntityIndex = UINT32_MAX;
+
+	if ( row != lastRow )
+	{
+		uint32_t localRow = 0;
+		RayGE_ArchetypeChunk* chunk = GetChunkForRow(archetype, row, &localRow);
+
+		chunk->entityHandles[localRow] = lastChunk->entityHandles[lastLocalRow];
+		movedEntityIndex = RAYGE_RESOURCE_HANDLE_INDEX(chunk->entityHandles[localRow]);
+
+		for ( size_t type = 0; type < RAYGE_COMPONENTTYPE__COUNT; ++type )
+		{
+			if ( COMPONENT_MASK_HAS(archetype->mask, type) )
+			{
+				memcpy(
+					GetComponentInChunk(chunk, localRow, type),
+					GetComponentInChunk(lastChunk, lastLocalRow, type),
+					Component_GetSize(type)
+				);
+			}
+		}
+	}
+
+	--lastChunk->count;
+	--archetype->numRows;
+
+	return movedEntityIndex;
+}
+
+void Archetype_CopyRow(
+	RayGE_Archetype* dest,
+	uint32_t destRow,
+	const RayGE_Archetype* source,
+	uint32_t sourceRow
+)
+{
+	RAYGE_ASSERT_VALID(dest);
+	RAYGE_ASSERT_VALID(source);
+
+	if ( !dest || !source || destRow >= dest->numRows || sourceRow >= source->numRows )
+	{
+		return;
+	}
+
+	const RayGE_ComponentMask sharedMask = dest->mask & source->mask;
+
+	uint32_t destLocalRow = 0;
+	RayGE_ArchetypeChunk* destChunk = GetChunkForRow(dest, destRow, &destLocalRow);
+
+	uint32_t sourceLocalRow = 0;
+	RayGE_ArchetypeChunk* sourceChunk = GetChunkForRow(source, sourceRow, &sourceLocalRow);
+
+	for ( size_t type = 0; type < RAYGE_COMPONENTTYPE__COUNT; ++type )
+	{
+		if ( COMPONENT_MASK_HAS(sharedMask, type) )
+		{
+			memcpy(
+				GetComponentInChunk(destChunk, destLocalRow, type),
+				GetComponentInChunk(sourceChunk, sourceLocalRow, type),
+				Component_GetSize(type)
+			);
+		}
+	}
+}
+
+RayGE_ResourceHandle Archetype_GetEntityHandle(const RayGE_Archetype* archetype, uint32_t row)
+{
+	RAYGE_ASSERT_VALID(archetype);
+
+	if ( !archetype || row >= archetype->numRows )
+	{
+		return RAYGE_NULL_RESOURCE_HANDLE;
+	}
+
+	uint32_t localRow = 0;
+	const RayGE_ArchetypeChunk* chunk = GetChunkForRow(archetype, row, &localRow);
+
+	return chunk->entityHandles[localRow];
+}
+
+void* Archetype_GetComponent(const RayGE_Archetype* archetype, uint32_t row, RayGE_ComponentType type)
+{
+	RAYGE_ASSERT_VALID(archetype);
+
+	if ( !archetype || row >= archetype->numRows || !Component_TypeIsValid(type) ||
+		 !COMPONENT_MASK_HAS(archetype->mask, type) )
+	{
+		return NULL;
+	}
+
+	uint32_t localRow = 0;
+	RayGE_ArchetypeChunk* chunk = GetChunkForRow(archetype, row, &localRow);
+
+	return GetComponentInChunk(chunk, localRow, type);
+}
+
+#if RAYGE_BUILD_TESTING()
+static RayGE_ResourceHandle TestHandle(uint32_t index)
+{
+	return Resource_CreateInternalHandle(RESOURCE_DOMAIN_ENTITY, index, 0);
+}
+
+static uint32_t EntityIndexAtRow(const RayGE_Archetype* archetype, uint32_t row)
+{
+	return RAYGE_RESOURCE_HANDLE_INDEX(Archetype_GetEntityHandle(archetype, row));
+}
+
+static void TestChunkLayout(void)
+{
+	const RayGE_ComponentMask mask =
+		COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL) | COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_RENDERABLE);
+
+	RayGE_Archetype* archetype = Archetype_Create(mask);
+
+	if ( !TEST_EXPECT_TRUE(archetype) )
+	{
+		return;
+	}
+
+	const uint32_t numRows = ARCHETYPE_ENTITIES_PER_CHUNK + 10;
+
+	for ( uint32_t index = 0; index < numRows; ++index )
+	{
+		TEST_EXPECT_EQL_INT(Archetype_AddRow(archetype, TestHandle(1000 + index)), index);
+	}
+
+	TEST_EXPECT_EQL_INT(Archetype_GetNumRows(archetype), numRows);
+	TEST_EXPECT_EQL_INT(Archetype_GetNumChunks(archetype), 2);
+
+	const RayGE_ArchetypeChunk* first = Archetype_GetChunk(archetype, 0);
+	const RayGE_ArchetypeChunk* second = Archetype_GetChunk(archetype, 1);
+
+	if ( !TEST_EXPECT_TRUE(first && second) )
+	{
+		Archetype_Destroy(archetype);
+		return;
+	}
+
+	TEST_EXPECT_FALSE(Archetype_GetChunk(archetype, 2));
+	TEST_EXPECT_EQL_INT(first->count, ARCHETYPE_ENTITIES_PER_CHUNK);
+	TEST_EXPECT_EQL_INT(second->count, 10);
+	TEST_EXPECT_EQL_INT(RAYGE_RESOURCE_HANDLE_INDEX(second->entityHandles[0]), 1000 + ARCHETYPE_ENTITIES_PER_CHUNK);
+
+	// Arrays for component types that are not in the archetype should not exist.
+	TEST_EXPECT_TRUE(ARCHETYPECHUNK_SPATIAL(first));
+	TEST_EXPECT_TRUE(ARCHETYPECHUNK_RENDERABLE(first));
+	TEST_EXPECT_FALSE(ARCHETYPECHUNK_CAMERA(first));
+
+	TEST_EXPECT_EQL_INT((size_t)ARCHETYPECHUNK_SPATIAL(first) % ARCHETYPE_ALIGNMENT, 0);
+	TEST_EXPECT_EQL_INT((size_t)ARCHETYPECHUNK_RENDERABLE(first) % ARCHETYPE_ALIGNMENT, 0);
+
+	// Rows should be contiguous within each component array.
+	TEST_EXPECT_TRUE(
+		Archetype_GetComponent(archetype, 3, RAYGE_COMPONENTTYPE_RENDERABLE) == &ARCHETYPECHUNK_RENDERABLE(first)[3]
+	);
+
+	TEST_EXPECT_FALSE(Archetype_GetComponent(archetype, 3, RAYGE_COMPONENTTYPE_CAMERA));
+	TEST_EXPECT_FALSE(Archetype_GetComponent(archetype, numRows, RAYGE_COMPONENTTYPE_SPATIAL));
+
+	// New rows should have default component values.
+	TEST_EXPECT_TRUE(ARCHETYPECHUNK_RENDERABLE(second)[9].scale == 1.0f);
+	TEST_EXPECT_TRUE(RAYGE_IS_NULL_RESOURCE_HANDLE(ARCHETYPECHUNK_RENDERABLE(second)[9].handle));
+
+	Archetype_Destroy(archetype);
+}
+
+static void TestRemoveRowMovesLastRow(void)
+{
+	RayGE_Archetype* archetype = Archetype_Create(COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL));
+
+	if ( !TEST_EXPECT_TRUE(archetype) )
+	{
+		return;
+	}
+
+	for ( uint32_t index = 0; index < 3; ++index )
+	{
+		const uint32_t row = Archetype_AddRow(archetype, TestHandle(10 + index));
+		RayGE_Component_Spatial* spatial =
+			COMPONENTDATA_SPATIAL(Archetype_GetComponent(archetype, row, RAYGE_COMPONENTTYPE_SPATIAL));
+
+		spatial->position.x = (float)(10 + index);
+	}
+
+	// The last row should be moved into the gap.
+	TEST_EXPECT_EQL_INT(Archetype_RemoveRow(archetype, 0), 12);
+	TEST_EXPECT_EQL_INT(Archetype_GetNumRows(archetype), 2);
+	TEST_EXPECT_EQL_INT(EntityIndexAtRow(archetype, 0), 12);
+	TEST_EXPECT_EQL_INT(EntityIndexAtRow(archetype, 1), 11);
+
+	TEST_EXPECT_TRUE(
+		COMPONENTDATA_SPATIAL(Archetype_GetComponent(archetype, 0, RAYGE_COMPONENTTYPE_SPATIAL))->position.x == 12.0f
+	);
+
+	// Nothing needs to move if the last row is removed.
+	TEST_EXPECT_EQL_INT(Archetype_RemoveRow(archetype, 1), UINT32_MAX);
+	TEST_EXPECT_EQL_INT(Archetype_GetNumRows(archetype), 1);
+	TEST_EXPECT_EQL_INT(Archetype_RemoveRow(archetype, 0), UINT32_MAX);
+	TEST_EXPECT_EQL_INT(Archetype_GetNumChunks(archetype), 0);
+
+	Archetype_Destroy(archetype);
+}
+
+static void TestChunksAreReused(void)
+{
+	RayGE_Archetype* archetype = Archetype_Create(COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_CAMERA));
+
+	if ( !TEST_EXPECT_TRUE(archetype) )
+	{
+		return;
+	}
+
+	for ( uint32_t index = 0; index <= ARCHETYPE_ENTITIES_PER_CHUNK; ++index )
+	{
+		(void)Archetype_AddRow(archetype, TestHandle(index));
+	}
+
+	const RayGE_ArchetypeChunk* chunk = Archetype_GetChunk(archetype, 1);
+
+	(void)Archetype_RemoveRow(archetype, ARCHETYPE_ENTITIES_PER_CHUNK);
+	TEST_EXPECT_EQL_INT(Archetype_GetNumChunks(archetype), 1);
+
+	(void)Archetype_AddRow(archetype, TestHandle(0));
+	TEST_EXPECT_TRUE(Archetype_GetChunk(archetype, 1) == chunk);
+
+	Archetype_Destroy(archetype);
+}
+
+static void TestCopyRow(void)
+{
+	const RayGE_ComponentMask sourceMask =
+		COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL) | COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_RENDERABLE);
+
+	const RayGE_ComponentMask destMask =
+		COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL) | COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_CAMERA);
+
+	RayGE_Archetype* source = Archetype_Create(sourceMask);
+	RayGE_Archetype* dest = Archetype_Create(destMask);
+
+	const uint32_t sourceRow = Archetype_AddRow(source, TestHandle(1));
+	const uint32_t destRow = Archetype_AddRow(dest, TestHandle(1));
+
+	COMPONENTDATA_SPATIAL(Archetype_GetComponent(source, sourceRow, RAYGE_COMPONENTTYPE_SPATIAL))->position.y = 5.0f;
+	Archetype_CopyRow(dest, destRow, source, sourceRow);
+
+	TEST_EXPECT_TRUE(
+		COMPONENTDATA_SPATIAL(Archetype_GetComponent(dest, destRow, RAYGE_COMPONENTTYPE_SPATIAL))->position.y == 5.0f
+	);
+
+	// Components that the source does not have should keep their defaults.
+	TEST_EXPECT_TRUE(
+		COMPONENTDATA_CAMERA(Archetype_GetComponent(dest, destRow, RAYGE_COMPONENTTYPE_CAMERA))->fieldOfView == 90.0f
+	);
+
+	Archetype_Destroy(dest);
+	Archetype_Destroy(source);
+}
+
+static void TestAddRowsCopiesInitialData(void)
+{
+	const RayGE_ComponentMask mask =
+		COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL) | COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_CAMERA);
+
+	RayGE_Archetype* archetype = Archetype_Create(mask);
+
+	// Start part-way through a chunk, so that the new rows span three chunks.
+	(void)Archetype_AddRow(archetype, TestHandle(0));
+
+	RayGE_ResourceHandle handles[(2 * ARCHETYPE_ENTITIES_PER_CHUNK) + 10];
+	const uint32_t numHandles = (uint32_t)(sizeof(handles) / sizeof(handles[0]));
+
+	for ( uint32_t index = 0; index < numHandles; ++index )
+	{
+		handles[index] = TestHandle(1 + index);
+	}
+
+	RayGE_Component_Spatial spatial = {0};
+	spatial.position.x = 3.0f;
+	spatial.angles.yaw = 45.0f;
+
+	const void* initialData[RAYGE_COMPONENTTYPE__COUNT] = {0};
+	initialData[RAYGE_COMPONENTTYPE_SPATIAL] = &spatial;
+
+	TEST_EXPECT_EQL_INT(Archetype_AddRows(archetype, handles, numHandles, initialData), 1);
+	TEST_EXPECT_EQL_INT(Archetype_GetNumRows(archetype), numHandles + 1);
+	TEST_EXPECT_EQL_INT(Archetype_GetNumChunks(archetype), 3);
+
+	uint32_t numMatching = 0;
+
+	for ( uint32_t row = 1; row <= numHandles; ++row )
+	{
+		const RayGE_Component_Spatial* rowSpatial =
+			COMPONENTDATA_SPATIAL(Archetype_GetComponent(archetype, row, RAYGE_COMPONENTTYPE_SPATIAL));
+		const RayGE_Component_Camera* rowCamera =
+			COMPONENTDATA_CAMERA(Archetype_GetComponent(archetype, row, RAYGE_COMPONENTTYPE_CAMERA));
+
+		if ( RAYGE_RESOURCE_HANDLE_INDEX(Archetype_GetEntityHandle(archetype, row)) == row &&
+			 memcmp(rowSpatial, &spatial, sizeof(spatial)) == 0 && rowCamera->fieldOfView == 90.0f )
+		{
+			++numMatching;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(numMatching, numHandles);
+
+	// The row that was already present should not have been touched.
+	TEST_EXPECT_TRUE(
+		COMPONENTDATA_SPATIAL(Archetype_GetComponent(archetype, 0, RAYGE_COMPONENTTYPE_SPATIAL))->position.x == 0.0f
+	);
+
+	Archetype_Destroy(archetype);
+}
+
+void Archetype_RunTests(void)
+{
+	TestChunkLayout();
+	TestRemoveRowMovesLastRow();
+	TestChunksAreReused();
+	TestCopyRow();
+	TestAddRowsCopiesInitialData();
+}
+#endif
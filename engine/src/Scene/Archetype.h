@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "RayGE/SceneTypes.h"
+#include "Scene/Component.h"
+#include "Testing/Testing.h"
+#include "wzl_cutl/attributes.h"
+
+// An archetype holds the components for every entity which has exactly the
+// same set of component types. Components are stored in structure-of-arrays
+// form: each chunk holds up to ARCHETYPE_ENTITIES_PER_CHUNK entities, with one
+// contiguous array per component type, so that systems can walk the data for
+// a component type without following any pointers.
+//
+// Rows are densely packed. Removing a row moves the archetype's last row into
+// the gap, so component pointers into an archetype are only valid until a row
+// is next removed from it. Adding a row never moves existing rows, since chunks
+// are never reallocated. Chunks are kept for re-use once they have been
+// allocated, and are only released when the archetype is destroyed.
+
+#define ARCHETYPE_ENTITIES_PER_CHUNK 256
+
+// Component arrays are aligned to this many bytes.
+#define ARCHETYPE_ALIGNMENT ((size_t)16)
+
+typedef struct RayGE_Archetype RayGE_Archetype;
+
+typedef struct RayGE_ArchetypeChunk
+{
+	// Number of rows in use in this chunk.
+	uint32_t count;
+
+	// Handle to the entity that each row belongs to.
+	RayGE_ResourceHandle* entityHandles;
+
+	// One array per component type, indexed by RayGE_ComponentType.
+	// Arrays for types which are not in the archetype are null.
+	void* components[RAYGE_COMPONENTTYPE__COUNT];
+} RayGE_ArchetypeChunk;
+
+WZL_ATTR_NODISCARD RayGE_Archetype* Archetype_Create(RayGE_ComponentMask mask);
+void Archetype_Destroy(RayGE_Archetype* archetype);
+
+RayGE_ComponentMask Archetype_GetMask(const RayGE_Archetype* archetype);
+uint32_t Archetype_GetNumRows(const RayGE_Archetype* archetype);
+
+// Only chunks which hold at least one row are counted.
+size_t Archetype_GetNumChunks(const RayGE_Archetype* archetype);
+const RayGE_ArchetypeChunk* Archetype_GetChunk(const RayGE_Archetype* archetype, size_t index);
+
+// Appends a row for the given entity, with each component set to its
+// defaults, and returns the index of the new row.
+uint32_t Archetype_AddRow(RayGE_Archetype* archetype, RayGE_ResourceHandle entityHandle);
+
+// Appends one row for each of the given entities, and returns the index of the
+// first new row. For each component type, if initialData holds a value for the
+// type then every new row is given a copy of it, and otherwise the components
+// are set to their defaults. initialData may be null if all should be defaults.
+uint32_t Archetype_AddRows(
+	RayGE_Archetype* archetype,
+	const RayGE_ResourceHandle* entityHandles,
+	uint32_t count,
+	const void* const initialData[RAYGE_COMPONENTTYPE__COUNT]
+);
+
+// Removes the row by moving the archetype's last row into its place. Returns
+// the index (within its entity list) of the entity whose row was moved, or
+// UINT32_MAX if the removed row was the last one and nothing needed to move.
+uint32_t Archetype_RemoveRow(RayGE_Archetype* archetype, uint32_t row);
+
+// Copies the components that both archetypes have in common
+// from the source row to the destination row.
+void Archetype_CopyRow(
+	RayGE_Archetype* dest,
+	uint32_t destRow,
+	const RayGE_Archetype* source,
+	uint32_t sourceRow
+);
+
+RayGE_ResourceHandle Archetype_GetEntityHandle(const RayGE_Archetype* archetype, uint32_t row);
+
+// Returns null if the archetype does not contain the component type.
+void* Archetype_GetComponent(const RayGE_Archetype* archetype, uint32_t row, RayGE_ComponentType type);
+
+// The macros below return a chunk's array of components of the given type:
+
+#define ARCHETYPECHUNK_SPATIAL(chunk) COMPONENTDATA_SPATIAL((chunk)->components[RAYGE_COMPONENTTYPE_SPATIAL])
+#define ARCHETYPECHUNK_CAMERA(chunk) COMPONENTDATA_CAMERA((chunk)->components[RAYGE_COMPONENTTYPE_CAMERA])
+#define ARCHETYPECHUNK_RENDERABLE(chunk) COMPONENTDATA_RENDERABLE((chunk)->components[RAYGE_COMPONENTTYPE_RENDERABLE])
+
+#if RAYGE_BUILD_TESTING()
+void Archetype_RunTests(void);
+#endif
@@ -1,87 +1,57 @@
-#include <stdbool.h>
+#include <string.h>
 #include "Scene/Component.h"
-#include "MemPool/MemPoolManager.h"
 #include "Debugging.h"
 
-static void* CallocComponent(RayGE_ComponentType type, size_t size)
+static const size_t g_ComponentSizes[RAYGE_COMPONENTTYPE__COUNT] =
 {
-	RayGE_ComponentHeader* component = MEMPOOL_CALLOC(MEMPOOL_ENTITY, 1, size);
-	component->type = type;
-	return component;
-}
-
-#define CALLOC_COMPONENT(structType, componentType) ((structType*)CallocComponent((componentType), sizeof(structType)))
+	sizeof(RayGE_Component_Spatial),
+	sizeof(RayGE_Component_Camera),
+	sizeof(RayGE_Component_Renderable),
+};
 
-void Component_FreeList(RayGE_ComponentHeader* head)
+bool Component_TypeIsValid(RayGE_ComponentType type)
 {
-	while ( head )
-	{
-		RayGE_ComponentHeader* next = head->next;
-		MEMPOOL_FREE(head);
-		head = next;
-	}
+	return (size_t)type < RAYGE_COMPONENTTYPE__COUNT;
 }
 
-RayGE_ComponentImpl_Spatial* Component_CreateSpatial(void)
+size_t Component_GetSize(RayGE_ComponentType type)
 {
-	return CALLOC_COMPONENT(RayGE_ComponentImpl_Spatial, RAYGE_COMPONENTTYPE_SPATIAL);
+	RAYGE_ENSURE(Component_TypeIsValid(type), "Invalid component type %d", type);
+	return g_ComponentSizes[type];
 }
 
-RayGE_ComponentImpl_Camera* Component_CreateCamera(void)
+void Component_InitDefaults(RayGE_ComponentType type, void* data)
 {
-	RayGE_ComponentImpl_Camera* component = CALLOC_COMPONENT(RayGE_ComponentImpl_Camera, RAYGE_COMPONENTTYPE_CAMERA);
-
-	component->data.fieldOfView = 90.0f;
+	RAYGE_ASSERT_VALID(data);
 
-	return component;
-}
-
-RayGE_ComponentImpl_Renderable* Component_CreateRenderable(void)
-{
-	RayGE_ComponentImpl_Renderable* component =
-		CALLOC_COMPONENT(RayGE_ComponentImpl_Renderable, RAYGE_COMPONENTTYPE_RENDERABLE);
+	if ( !data )
+	{
+		return;
+	}
 
-	component->data.handle = RAYGE_NULL_RESOURCE_HANDLE;
-	component->data.color = (RayGE_Color){ 255, 255, 255, 255 };
-	component->data.scale = 1.0f;
+	memset(data, 0, Component_GetSize(type));
 
-	return component;
-}
-
-void* Component_CastImpl(
-	RayGE_ComponentHeader* header,
-	RayGE_ComponentType toType,
-	bool ensureTypeMatches,
-	const char* file,
-	int line
-)
-{
-	if ( !header )
+	switch ( type )
 	{
-		if ( ensureTypeMatches )
+		case RAYGE_COMPONENTTYPE_CAMERA:
 		{
-			RAYGE_ENSURE(
-				header,
-				"Component cast @ %s:%d: Provided component pointer was null.",
-				file,
-				line
-			);
+			COMPONENTDATA_CAMERA(data)->fieldOfView = 90.0f;
+			break;
 		}
 
-		return NULL;
-	}
+		case RAYGE_COMPONENTTYPE_RENDERABLE:
+		{
+			RayGE_Component_Renderable* renderable = COMPONENTDATA_RENDERABLE(data);
 
-	if ( ensureTypeMatches )
-	{
-		RAYGE_ENSURE(
-			header->type == toType,
-			"Component cast @ %s:%d: Component type %d did not match expected type %d",
-			file,
-			line,
-			header->type,
-			toType
-		);
-	}
+			renderable->handle = RAYGE_NULL_RESOURCE_HANDLE;
+			renderable->color = (RayGE_Color){ 255, 255, 255, 255 };
+			renderable->scale = 1.0f;
+			break;
+		}
 
-	return header->type == toType ? (void*)header : NULL;
+		default:
+		{
+			break;
+		}
+	}
 }
@@ -3,76 +3,32 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "RayGE/SceneTypes.h"
-#include "wzl_cutl/attributes.h"
 
-typedef struct RayGE_ComponentHeader
-{
-	RayGE_ComponentType type;
-	struct RayGE_ComponentHeader* next;
-} RayGE_ComponentHeader;
+// Components are plain data structs, which are stored by value
+// in archetype chunks (see Scene/Archetype.h) rather than being
+// allocated individually.
 
-#define CHECK_COMPONENT_STRUCTURE(type) \
-	static_assert(offsetof(type, header) == 0, "Header must be the first member in the component struct")
+#define COMPONENT_MASK_BIT(type) RAYGE_COMPONENT_MASK_BIT(type)
+#define COMPONENT_MASK_HAS(mask, type) (((mask) & COMPONENT_MASK_BIT(type)) != 0)
 
-typedef struct RayGE_ComponentImpl_Spatial
-{
-	RayGE_ComponentHeader header;
-	RayGE_Component_Spatial data;
-} RayGE_ComponentImpl_Spatial;
+// Number of distinct component masks that can exist.
+#define COMPONENT_MASK_COUNT ((size_t)1 << RAYGE_COMPONENTTYPE__COUNT)
 
-CHECK_COMPONENT_STRUCTURE(RayGE_ComponentImpl_Spatial);
-
-typedef struct RayGE_ComponentImpl_Camera
-{
-	RayGE_ComponentHeader header;
-	RayGE_Component_Camera data;
-} RayGE_ComponentImpl_Camera;
-
-CHECK_COMPONENT_STRUCTURE(RayGE_ComponentImpl_Camera);
-
-typedef struct RayGE_ComponentImpl_Renderable
-{
-	RayGE_ComponentHeader header;
-	RayGE_Component_Renderable data;
-} RayGE_ComponentImpl_Renderable;
-
-CHECK_COMPONENT_STRUCTURE(RayGE_ComponentImpl_Renderable);
-
-void Component_FreeList(RayGE_ComponentHeader* head);
-
-WZL_ATTR_NODISCARD RayGE_ComponentImpl_Spatial* Component_CreateSpatial(void);
-WZL_ATTR_NODISCARD RayGE_ComponentImpl_Camera* Component_CreateCamera(void);
-WZL_ATTR_NODISCARD RayGE_ComponentImpl_Renderable* Component_CreateRenderable(void);
-
-// Do not use this function directly - use the macros below instead.
-// If ensureTypeMatches is set, emits a fatal log error if the type does not match.
-void* Component_CastImpl(
-	RayGE_ComponentHeader* header,
-	RayGE_ComponentType toType,
-	bool ensureTypeMatches,
-	const char* file,
-	int line
+static_assert(
+	RAYGE_COMPONENTTYPE__COUNT <= sizeof(RayGE_ComponentMask) * 8,
+	"Component mask is too small to hold all component types"
 );
 
-// The macros below cast from a component header to an implementation struct:
-
-#define COMPONENTCAST_SPATIAL(header, mustSucceed) \
-	((RayGE_ComponentImpl_Spatial*) \
-		 Component_CastImpl((header), RAYGE_COMPONENTTYPE_SPATIAL, (mustSucceed), __FILE__, __LINE__))
-
-#define COMPONENTCAST_CAMERA(header, mustSucceed) \
-	((RayGE_ComponentImpl_Camera*) \
-		 Component_CastImpl((header), RAYGE_COMPONENTTYPE_CAMERA, (mustSucceed), __FILE__, __LINE__))
-
-#define COMPONENTCAST_RENDERABLE(header, mustSucceed) \
-	((RayGE_ComponentImpl_Renderable*) \
-		 Component_CastImpl((header), RAYGE_COMPONENTTYPE_RENDERABLE, (mustSucceed), __FILE__, __LINE__))
+bool Component_TypeIsValid(RayGE_ComponentType type);
+size_t Component_GetSize(RayGE_ComponentType type);
 
-// The macros below cast from a component header to a data struct:
+// Writes the default values for a new component of the given type.
+void Component_InitDefaults(RayGE_ComponentType type, void* data);
 
-#define GET_COMPONENT_DATA_PTR(header, castMacro) (&castMacro(header, true)->data)
+// The macros below cast from a pointer to component data to the data struct:
 
-#define COMPONENTDATA_SPATIAL(header) GET_COMPONENT_DATA_PTR(header, COMPONENTCAST_SPATIAL)
-#define COMPONENTDATA_CAMERA(header) GET_COMPONENT_DATA_PTR(header, COMPONENTCAST_CAMERA)
-#define COMPONENTDATA_RENDERABLE(header) GET_COMPONENT_DATA_PTR(header, COMPONENTCAST_RENDERABLE)
+#define COMPONENTDATA_SPATIAL(ptr) ((RayGE_Component_Spatial*)(ptr))
+#define COMPONENTDATA_CAMERA(ptr) ((RayGE_Component_Camera*)(ptr))
+#define COMPONENTDATA_RENDERABLE(ptr) ((RayGE_Component_Renderable*)(ptr))
@@ -1,34 +1,314 @@
 #include <string.h>
 #include "Scene/Entity.h"
+#include "Scene/Archetype.h"
 #include "Scene/Component.h"
 #include "MemPool/MemPoolManager.h"
 #include "Resources/ResourceHandleUtils.h"
+#include "Utils/Utils.h"
 #include "Debugging.h"
-#include "Resources/ResourceHandleUtils.h"
 
+#define INVALID_ENTITY_INDEX UINT32_MAX
+
+// Entities are set up when they are first acquired. Until then,
+// their parent list and index are not set, and they are not in
+// the list's free list.
 struct RayGE_Entity
 {
 	RayGE_EntityList* parentList;
 	uint32_t indexInParent;
 	bool isInUse;
-	RayGE_ComponentHeader* componentsHead;
-	RayGE_ComponentHeader* componentsTail;
-	size_t componentCount;
-	uint64_t key;
+	bool isPendingRelease;
+
+	// Links to neighbouring entities in the free list.
+	// These are only meaningful while the entity is free.
+	uint32_t prevFreeIndex;
+	uint32_t nextFreeIndex;
+
+	// One bit per component type that the entity has.
+	RayGE_ComponentMask componentMask;
+
+	// Null if the entity has no components.
+	RayGE_Archetype* archetype;
+	uint32_t rowInArchetype;
+
+	// Incremented each time the entity is released, so that
+	// handles to any previous occupant of this slot no longer pass.
+	uint32_t generation;
 };
 
+// Dense list of the in-use entities whose component masks include all of the
+// query's components. This is kept up to date as entities change, rather than
+// being rebuilt each time it is requested.
+typedef struct EntityQuery
+{
+	RayGE_ComponentMask mask;
+	RayGE_Entity** members;
+	uint32_t count;
+
+	// Indexed by entity index. Holds the entity's position
+	// in the member list, or INVALID_ENTITY_INDEX if absent.
+	uint32_t* memberSlots;
+} EntityQuery;
+
 struct RayGE_EntityList
 {
 	RayGE_Entity* entities;
 	uint32_t capacity;
 	uint32_t numInUse;
+
+	// Most recently released entity, which is handed out first.
+	uint32_t firstFreeIndex;
+
+	// Entities at or above this index have never been acquired. They are
+	// implicitly free, and are handed out in order once the free list is empty.
+	uint32_t highWaterIndex;
+
+	// Handles to entities waiting for Entity_ReleaseAllDeferred(). These are
+	// handles rather than indices, so that if an entity is released directly
+	// in the meantime, its stale entry no longer refers to the slot.
+	RayGE_ResourceHandle* pendingRelease;
+	size_t numPendingRelease;
+	size_t pendingReleaseCapacity;
+
+	// Both indexed by component mask, and created when first needed.
+	RayGE_Archetype* archetypes[COMPONENT_MASK_COUNT];
+	EntityQuery* queries[COMPONENT_MASK_COUNT];
 };
 
+static bool EntityMatchesQuery(const RayGE_Entity* entity, const EntityQuery* query)
+{
+	return entity->isInUse && (entity->componentMask & query->mask) == query->mask;
+}
+
+static void AddToQuery(EntityQuery* query, RayGE_Entity* entity)
+{
+	query->memberSlots[entity->indexInParent] = query->count;
+	query->members[query->count++] = entity;
+}
+
+static void RemoveFromQuery(EntityQuery* query, RayGE_Entity* entity)
+{
+	const uint32_t slot = query->memberSlots[entity->indexInParent];
+	RayGE_Entity* last = query->members[--query->count];
+
+	query->members[slot] = last;
+	query->memberSlots[last->indexInParent] = slot;
+	query->memberSlots[entity->indexInParent] = INVALID_ENTITY_INDEX;
+}
+
+// Must be called whenever an entity is acquired, is
+// released, or has its set of components changed.
+static void UpdateQueryMembership(RayGE_EntityList* list, RayGE_Entity* entity)
+{
+	for ( size_t index = 0; index < COMPONENT_MASK_COUNT; ++index )
+	{
+		EntityQuery* query = list->queries[index];
+
+		if ( !query )
+		{
+			continue;
+		}
+
+		const bool isMember = query->memberSlots[entity->indexInParent] != INVALID_ENTITY_INDEX;
+		const bool shouldBeMember = EntityMatchesQuery(entity, query);
+
+		if ( shouldBeMember && !isMember )
+		{
+			AddToQuery(query, entity);
+		}
+		else if ( !shouldBeMember && isMember )
+		{
+			RemoveFromQuery(query, entity);
+		}
+	}
+}
+
+static EntityQuery* CreateQuery(RayGE_EntityList* list, RayGE_ComponentMask mask)
+{
+	EntityQuery* query = MEMPOOL_CALLOC_STRUCT(MEMPOOL_ENTITY, EntityQuery);
+
+	query->mask = mask;
+	query->members = (RayGE_Entity**)MEMPOOL_CALLOC(MEMPOOL_ENTITY, list->capacity, sizeof(RayGE_Entity*));
+	query->memberSlots = (uint32_t*)MEMPOOL_MALLOC(MEMPOOL_ENTITY, list->capacity * sizeof(uint32_t));
+
+	for ( uint32_t index = 0; index < list->capacity; ++index )
+	{
+		RayGE_Entity* entity = &list->entities[index];
+		query->memberSlots[index] = INVALID_ENTITY_INDEX;
+
+		if ( EntityMatchesQuery(entity, query) )
+		{
+			AddToQuery(query, entity);
+		}
+	}
+
+	return query;
+}
+
+static void DestroyQuery(EntityQuery* query)
+{
+	if ( !query )
+	{
+		return;
+	}
+
+	MEMPOOL_FREE(query->members);
+	MEMPOOL_FREE(query->memberSlots);
+	MEMPOOL_FREE(query);
+}
+
+static void UnlinkFromFreeList(RayGE_EntityList* list, RayGE_Entity* entity)
+{
+	if ( entity->prevFreeIndex != INVALID_ENTITY_INDEX )
+	{
+		list->entities[entity->prevFreeIndex].nextFreeIndex = entity->nextFreeIndex;
+	}
+	else
+	{
+		list->firstFreeIndex = entity->nextFreeIndex;
+	}
+
+	if ( entity->nextFreeIndex != INVALID_ENTITY_INDEX )
+	{
+		list->entities[entity->nextFreeIndex].prevFreeIndex = entity->prevFreeIndex;
+	}
+
+	entity->prevFreeIndex = INVALID_ENTITY_INDEX;
+	entity->nextFreeIndex = INVALID_ENTITY_INDEX;
+}
+
+static void PushOntoFreeList(RayGE_EntityList* list, RayGE_Entity* entity)
+{
+	entity->prevFreeIndex = INVALID_ENTITY_INDEX;
+	entity->nextFreeIndex = list->firstFreeIndex;
+
+	if ( list->firstFreeIndex != INVALID_ENTITY_INDEX )
+	{
+		list->entities[list->firstFreeIndex].prevFreeIndex = entity->indexInParent;
+	}
+
+	list->firstFreeIndex = entity->indexInParent;
+}
+
+static void SetUpEntity(RayGE_EntityList* list, uint32_t index)
+{
+	RayGE_Entity* entity = &list->entities[index];
+
+	entity->parentList = list;
+	entity->indexInParent = index;
+	entity->prevFreeIndex = INVALID_ENTITY_INDEX;
+	entity->nextFreeIndex = INVALID_ENTITY_INDEX;
+}
+
+// Takes the entity out of the set of free entities, setting it up if this is
+// the first time that it has been acquired.
+static void TakeFreeEntity(RayGE_EntityList* list, RayGE_Entity* entity)
+{
+	const uint32_t index = (uint32_t)(entity - list->entities);
+
+	if ( index < list->highWaterIndex )
+	{
+		UnlinkFromFreeList(list, entity);
+		return;
+	}
+
+	// Any never-acquired entities that are skipped over are put in the free
+	// list, so that they are not lost. The lowest index is pushed last, so
+	// that it is handed out first.
+	for ( uint32_t skippedIndex = index; skippedIndex > list->highWaterIndex; --skippedIndex )
+	{
+		SetUpEntity(list, skippedIndex - 1);
+		PushOntoFreeList(list, &list->entities[skippedIndex - 1]);
+	}
+
+	SetUpEntity(list, index);
+	list->highWaterIndex = index + 1;
+}
+
+static RayGE_Archetype* GetOrCreateArchetype(RayGE_EntityList* list, RayGE_ComponentMask mask)
+{
+	if ( !list->archetypes[mask] )
+	{
+		list->archetypes[mask] = Archetype_Create(mask);
+	}
+
+	return list->archetypes[mask];
+}
+
+static void RemoveFromArchetype(RayGE_Entity* entity)
+{
+	if ( !entity->archetype )
+	{
+		return;
+	}
+
+	const uint32_t movedIndex = Archetype_RemoveRow(entity->archetype, entity->rowInArchetype);
+
+	if ( movedIndex != UINT32_MAX )
+	{
+		// Another entity's components were moved into this entity's old row.
+		entity->parentList->entities[movedIndex].rowInArchetype = entity->rowInArchetype;
+	}
+
+	entity->archetype = NULL;
+	entity->rowInArchetype = 0;
+}
+
+// Moves the entity to the archetype for its new set of components,
+// keeping the values of any components that it already had.
+static void SetComponentMask(RayGE_Entity* entity, RayGE_ComponentMask mask)
+{
+	RayGE_Archetype* newArchetype = mask ? GetOrCreateArchetype(entity->parentList, mask) : NULL;
+	uint32_t newRow = 0;
+
+	if ( newArchetype )
+	{
+		newRow = Archetype_AddRow(newArchetype, Entity_CreateHandle(entity));
+
+		if ( entity->archetype )
+		{
+			Archetype_CopyRow(newArchetype, newRow, entity->archetype, entity->rowInArchetype);
+		}
+	}
+
+	RemoveFromArchetype(entity);
+
+	entity->archetype = newArchetype;
+	entity->rowInArchetype = newRow;
+	entity->componentMask = mask;
+
+	UpdateQueryMembership(entity->parentList, entity);
+}
+
+// Returns the first position at or after the given one which refers
+// to a chunk in an archetype that has all of the required components.
+static RayGE_EntityChunkIterator FindMatchingChunk(RayGE_EntityChunkIterator iterator)
+{
+	for ( ; iterator.archetypeIndex < COMPONENT_MASK_COUNT; ++iterator.archetypeIndex )
+	{
+		const RayGE_Archetype* archetype = iterator.list->archetypes[iterator.archetypeIndex];
+
+		if ( (iterator.archetypeIndex & iterator.requiredMask) == iterator.requiredMask &&
+			 iterator.chunkIndex < Archetype_GetNumChunks(archetype) )
+		{
+			break;
+		}
+
+		iterator.chunkIndex = 0;
+	}
+
+	return iterator;
+}
+
 RayGE_EntityList* Entity_AllocateList(uint32_t capacity)
 {
 	RAYGE_ASSERT(capacity > 0, "Expected the entity list capacity to be greater than zero.");
+	RAYGE_ASSERT(
+		capacity - 1 <= RAYGE_RESOURCE_HANDLE_MAX_INDEX,
+		"Expected the entity list capacity to be representable by entity handles."
+	);
 
-	if ( capacity < 1 )
+	if ( capacity < 1 || capacity - 1 > RAYGE_RESOURCE_HANDLE_MAX_INDEX )
 	{
 		return NULL;
 	}
@@ -38,14 +318,10 @@ RayGE_EntityList* Entity_AllocateList(uint32_t capacity)
 	list->capacity = capacity;
 	list->entities = (RayGE_Entity*)MEMPOOL_CALLOC(MEMPOOL_ENTITY, list->capacity, sizeof(RayGE_Entity));
 
-	for ( uint32_t index = 0; index < list->capacity; ++index )
-	{
-		RayGE_Entity* entity = &list->entities[index];
-
-		entity->parentList = list;
-		entity->indexInParent = index;
-		entity->key = Resource_CreateKey(index);
-	}
+	// Entities are only set up when they are first acquired, so
+	// that creating a large list does not touch every entity.
+	list->firstFreeIndex = INVALID_ENTITY_INDEX;
+	list->highWaterIndex = 0;
 
 	return list;
 }
@@ -57,19 +333,24 @@ void Entity_FreeList(RayGE_EntityList* list)
 		return;
 	}
 
-	if ( list->entities )
+	// The components of any entities still in use are
+	// owned by the archetypes, so are freed along with them.
+	for ( size_t index = 0; index < COMPONENT_MASK_COUNT; ++index )
 	{
-		for ( RayGE_Entity* entity = list->entities; list->capacity > 0; ++entity, --list->capacity )
-		{
-			if ( Entity_IsInUse(entity) )
-			{
-				Entity_Release(entity);
-			}
-		}
+		Archetype_Destroy(list->archetypes[index]);
+		DestroyQuery(list->queries[index]);
+	}
 
+	if ( list->entities )
+	{
 		MEMPOOL_FREE(list->entities);
 	}
 
+	if ( list->pendingRelease )
+	{
+		MEMPOOL_FREE(list->pendingRelease);
+	}
+
 	MEMPOOL_FREE(list);
 }
 
@@ -105,24 +386,19 @@ RayGE_Entity* Entity_Get(const RayGE_EntityList* list, uint32_t index)
 	return &list->entities[index];
 }
 
-RayGE_Entity* Entity_FindFirstFree(const RayGE_EntityList* list)
+RayGE_Entity* Entity_GetNextFree(const RayGE_EntityList* list)
 {
-	if ( !list || !list->entities || list->capacity < 1 )
+	if ( !list || !list->entities )
 	{
 		return NULL;
 	}
 
-	for ( uint32_t index = 0; index < list->capacity; ++index )
+	if ( list->firstFreeIndex != INVALID_ENTITY_INDEX )
 	{
-		RayGE_Entity* entity = &list->entities[index];
-
-		if ( !Entity_IsInUse(entity) )
-		{
-			return entity;
-		}
+		return &list->entities[list->firstFreeIndex];
 	}
 
-	return NULL;
+	return list->highWaterIndex < list->capacity ? &list->entities[list->highWaterIndex] : NULL;
 }
 
 RayGE_ResourceHandle Entity_CreateHandle(const RayGE_Entity* entity)
@@ -132,7 +408,8 @@ RayGE_ResourceHandle Entity_CreateHandle(const RayGE_Entity* entity)
 		return RAYGE_NULL_RESOURCE_HANDLE;
 	}
 
-	return Resource_CreateInternalHandle(RESOURCE_DOMAIN_ENTITY, entity->indexInParent, entity->key);
+	RAYGE_ASSERT(entity->isInUse, "Expected entity to be in use.");
+	return Resource_CreateInternalHandle(RESOURCE_DOMAIN_ENTITY, entity->indexInParent, entity->generation);
 }
 
 RayGE_Entity* Entity_GetFromHandle(const RayGE_EntityList* list, RayGE_ResourceHandle handle)
@@ -149,28 +426,97 @@ RayGE_Entity* Entity_GetFromHandle(const RayGE_EntityList* list, RayGE_ResourceH
 		return NULL;
 	}
 
-	RayGE_Entity* entity = Entity_Get(list, handle.index);
-	return (entity && entity->isInUse && entity->key == handle.key) ? entity : NULL;
+	RayGE_Entity* entity = Entity_Get(list, RAYGE_RESOURCE_HANDLE_INDEX(handle));
+	const bool generationMatches = entity && entity->generation == RAYGE_RESOURCE_HANDLE_GENERATION(handle);
+
+	return (generationMatches && entity->isInUse) ? entity : NULL;
 }
 
-void Entity_Acquire(RayGE_Entity* entity)
+void Entity_Acquire(RayGE_EntityList* list, RayGE_Entity* entity)
 {
-	if ( !entity )
+	RAYGE_ASSERT_VALID(list);
+
+	if ( !list || !entity )
 	{
 		return;
 	}
 
 	RAYGE_ASSERT(!entity->isInUse, "Entity was already in use");
-	RAYGE_ASSERT(entity->parentList, "Expected valid parent list for entity");
+	RAYGE_ASSERT(
+		entity >= list->entities && entity < list->entities + list->capacity,
+		"Expected entity to belong to the provided list"
+	);
 
-	if ( entity->isInUse || !entity->parentList )
+	if ( entity->isInUse || entity < list->entities || entity >= list->entities + list->capacity )
 	{
 		return;
 	}
 
+	TakeFreeEntity(list, entity);
 	entity->isInUse = true;
 
-	++entity->parentList->numInUse;
+	++list->numInUse;
+	UpdateQueryMembership(list, entity);
+}
+
+uint32_t Entity_AcquireMany(
+	RayGE_EntityList* list,
+	RayGE_ComponentMask mask,
+	const void* const componentData[RAYGE_COMPONENTTYPE__COUNT],
+	uint32_t count,
+	RayGE_ResourceHandle* outHandles
+)
+{
+	RAYGE_ASSERT_VALID(list);
+	RAYGE_ASSERT((size_t)mask < COMPONENT_MASK_COUNT, "Component mask 0x%x was not valid", mask);
+
+	if ( !list || (size_t)mask >= COMPONENT_MASK_COUNT || count < 1 || count > Entity_GetNumFreeSlots(list) )
+	{
+		return 0;
+	}
+
+	RayGE_Archetype* archetype = mask ? GetOrCreateArchetype(list, mask) : NULL;
+
+	// Entities are acquired in batches, so that each batch's
+	// rows can be added to the archetype in one go.
+	RayGE_ResourceHandle batchHandles[ARCHETYPE_ENTITIES_PER_CHUNK];
+
+	for ( uint32_t numAcquired = 0; numAcquired < count; )
+	{
+		const uint32_t batchSize = RAYGE_MIN(count - numAcquired, ARCHETYPE_ENTITIES_PER_CHUNK);
+
+		for ( uint32_t index = 0; index < batchSize; ++index )
+		{
+			RayGE_Entity* entity = Entity_GetNextFree(list);
+
+			TakeFreeEntity(list, entity);
+			entity->isInUse = true;
+			entity->componentMask = mask;
+			entity->archetype = archetype;
+
+			batchHandles[index] = Entity_CreateHandle(entity);
+		}
+
+		const uint32_t firstRow = archetype ? Archetype_AddRows(archetype, batchHandles, batchSize, componentData) : 0;
+
+		for ( uint32_t index = 0; index < batchSize; ++index )
+		{
+			RayGE_Entity* entity = &list->entities[RAYGE_RESOURCE_HANDLE_INDEX(batchHandles[index])];
+
+			entity->rowInArchetype = archetype ? firstRow + index : 0;
+			UpdateQueryMembership(list, entity);
+		}
+
+		if ( outHandles )
+		{
+			memcpy(&outHandles[numAcquired], batchHandles, batchSize * sizeof(RayGE_ResourceHandle));
+		}
+
+		list->numInUse += batchSize;
+		numAcquired += batchSize;
+	}
+
+	return count;
 }
 
 void Entity_Release(RayGE_Entity* entity)
@@ -191,18 +537,21 @@ void Entity_Release(RayGE_Entity* entity)
 	// Something's gone very wrong if this is not true:
 	RAYGE_ENSURE(entity->parentList->numInUse > 0, "Tried to release in-use entity that was not correctly recorded");
 
-	Component_FreeList(entity->componentsHead);
-	entity->componentsHead = NULL;
-	entity->componentsTail = NULL;
-	entity->componentCount = 0;
+	RemoveFromArchetype(entity);
 
+	entity->componentMask = 0;
 	entity->isInUse = false;
+	entity->isPendingRelease = false;
 
-	// Reset the key to make sure that entity handles referring to
-	// this index will no longer pass.
-	entity->key = Resource_CreateKey(entity->indexInParent);
+	// Make sure that entity handles referring to this index
+	// will no longer pass. The generation is allowed to wrap,
+	// since a stale handle would have to survive 2^32 re-uses
+	// of the same slot before it could match again.
+	++entity->generation;
 
 	--entity->parentList->numInUse;
+	PushOntoFreeList(entity->parentList, entity);
+	UpdateQueryMembership(entity->parentList, entity);
 }
 
 bool Entity_IsInUse(const RayGE_Entity* entity)
@@ -210,56 +559,673 @@ bool Entity_IsInUse(const RayGE_Entity* entity)
 	return entity && entity->isInUse;
 }
 
+void Entity_ReleaseDeferred(RayGE_Entity* entity)
+{
+	if ( !entity )
+	{
+		return;
+	}
+
+	RAYGE_ASSERT(entity->isInUse, "Entity was not in use");
+
+	if ( !entity->isInUse || entity->isPendingRelease )
+	{
+		return;
+	}
+
+	RayGE_EntityList* list = entity->parentList;
+
+	if ( list->numPendingRelease >= list->pendingReleaseCapacity )
+	{
+		const size_t newCapacity = list->pendingReleaseCapacity > 0 ? list->pendingReleaseCapacity * 2 : 32;
+
+		list->pendingRelease = (RayGE_ResourceHandle*)MEMPOOL_REALLOC(
+			MEMPOOL_ENTITY,
+			list->pendingRelease,
+			newCapacity * sizeof(RayGE_ResourceHandle)
+		);
+
+		list->pendingReleaseCapacity = newCapacity;
+	}
+
+	list->pendingRelease[list->numPendingRelease++] = Entity_CreateHandle(entity);
+	entity->isPendingRelease = true;
+}
+
+bool Entity_IsPendingRelease(const RayGE_Entity* entity)
+{
+	return entity && entity->isInUse && entity->isPendingRelease;
+}
+
+void Entity_ReleaseAllDeferred(RayGE_EntityList* list)
+{
+	RAYGE_ASSERT_VALID(list);
+
+	if ( !list )
+	{
+		return;
+	}
+
+	for ( size_t index = 0; index < list->numPendingRelease; ++index )
+	{
+		RayGE_Entity* entity = Entity_GetFromHandle(list, list->pendingRelease[index]);
+
+		if ( entity && entity->isPendingRelease )
+		{
+			Entity_Release(entity);
+		}
+	}
+
+	list->numPendingRelease = 0;
+}
+
 uint32_t Entity_GetIndex(const RayGE_Entity* entity)
 {
 	RAYGE_ASSERT(entity, "Cannot get index of null entity.");
-	return entity ? entity->indexInParent : UINT32_MAX;
+	// Entities that have never been acquired are not set up yet.
+	return (entity && entity->parentList) ? entity->indexInParent : UINT32_MAX;
+}
+
+RayGE_ComponentMask Entity_GetComponentMask(const RayGE_Entity* entity)
+{
+	return entity ? entity->componentMask : 0;
 }
 
-bool Entity_AddComponent(RayGE_Entity* entity, RayGE_ComponentHeader* component)
+void* Entity_AddComponent(RayGE_Entity* entity, RayGE_ComponentType type)
 {
-	if ( !entity || !component )
+	if ( !entity || !Component_TypeIsValid(type) )
 	{
-		return false;
+		return NULL;
 	}
 
 	RAYGE_ASSERT(Entity_IsInUse(entity), "Expected entity to be in use.");
 
 	if ( !Entity_IsInUse(entity) )
 	{
-		return false;
+		return NULL;
+	}
+
+	if ( !COMPONENT_MASK_HAS(entity->componentMask, type) )
+	{
+		SetComponentMask(entity, entity->componentMask | COMPONENT_MASK_BIT(type));
 	}
 
-	if ( entity->componentsTail )
+	return Archetype_GetComponent(entity->archetype, entity->rowInArchetype, type);
+}
+
+bool Entity_RemoveComponent(RayGE_Entity* entity, RayGE_ComponentType type)
+{
+	if ( !entity || !Component_TypeIsValid(type) )
 	{
-		entity->componentsTail->next = component;
+		return false;
 	}
 
-	entity->componentsTail = component;
+	RAYGE_ASSERT(Entity_IsInUse(entity), "Expected entity to be in use.");
 
-	if ( !entity->componentsHead )
+	if ( !Entity_IsInUse(entity) || !COMPONENT_MASK_HAS(entity->componentMask, type) )
 	{
-		entity->componentsHead = component;
+		return false;
 	}
 
-	++entity->componentCount;
+	SetComponentMask(entity, entity->componentMask & ~COMPONENT_MASK_BIT(type));
 	return true;
 }
 
-RayGE_ComponentHeader* Entity_GetFirstComponentOfType(const RayGE_Entity* entity, RayGE_ComponentType type)
+void* Entity_GetComponent(const RayGE_Entity* entity, RayGE_ComponentType type)
 {
-	if ( !entity )
+	if ( !entity || !entity->archetype )
 	{
 		return NULL;
 	}
 
-	for ( RayGE_ComponentHeader* component = entity->componentsHead; component; component = component->next )
+	return Archetype_GetComponent(entity->archetype, entity->rowInArchetype, type);
+}
+
+RayGE_EntityQueryResult Entity_Query(RayGE_EntityList* list, RayGE_ComponentMask mask)
+{
+	RAYGE_ASSERT_VALID(list);
+	RAYGE_ASSERT(
+		(mask >> RAYGE_COMPONENTTYPE__COUNT) == 0,
+		"Component mask 0x%x contained unrecognised component types",
+		mask
+	);
+
+	if ( !list || (mask >> RAYGE_COMPONENTTYPE__COUNT) != 0 )
+	{
+		return (RayGE_EntityQueryResult) {NULL, 0};
+	}
+
+	if ( !list->queries[mask] )
+	{
+		list->queries[mask] = CreateQuery(list, mask);
+	}
+
+	const EntityQuery* query = list->queries[mask];
+	return (RayGE_EntityQueryResult) {query->members, query->count};
+}
+
+RayGE_EntityChunkIterator Entity_GetChunkIterator(const RayGE_EntityList* list, RayGE_ComponentMask requiredMask)
+{
+	RAYGE_ASSERT_VALID(list);
+
+	RayGE_EntityChunkIterator iterator =
+	{
+		.list = list,
+		.requiredMask = requiredMask,
+		.archetypeIndex = list ? 0 : (uint32_t)COMPONENT_MASK_COUNT,
+		.chunkIndex = 0,
+	};
+
+	return list ? FindMatchingChunk(iterator) : iterator;
+}
+
+RayGE_EntityChunkIterator Entity_IncrementChunkIterator(RayGE_EntityChunkIterator iterator)
+{
+	if ( !Entity_ChunkIteratorIsValid(iterator) )
+	{
+		return iterator;
+	}
+
+	++iterator.chunkIndex;
+	return FindMatchingChunk(iterator);
+}
+
+bool Entity_ChunkIteratorIsValid(RayGE_EntityChunkIterator iterator)
+{
+	return iterator.list && iterator.archetypeIndex < COMPONENT_MASK_COUNT;
+}
+
+const RayGE_ArchetypeChunk* Entity_GetChunkFromIterator(RayGE_EntityChunkIterator iterator)
+{
+	if ( !Entity_ChunkIteratorIsValid(iterator) )
+	{
+		return NULL;
+	}
+
+	return Archetype_GetChunk(iterator.list->archetypes[iterator.archetypeIndex], iterator.chunkIndex);
+}
+
+#if RAYGE_BUILD_TESTING()
+static void TestHandlesForNewList(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(4);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	// No entities have been acquired yet,
+	// so none of these should be valid.
+	size_t failures = 0;
+
+	for ( uint32_t index = 0; index < Entity_GetListCapacity(list); ++index )
+	{
+		RayGE_ResourceHandle handle = Resource_CreateInternalHandle(RESOURCE_DOMAIN_ENTITY, index, 0);
+
+		if ( Entity_GetFromHandle(list, handle) )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+	TEST_EXPECT_FALSE(Entity_GetFromHandle(list, RAYGE_NULL_RESOURCE_HANDLE));
+
+	RayGE_Entity* entity = Entity_Get(list, 2);
+	Entity_Acquire(list, entity);
+
+	TEST_EXPECT_EQL_INT(Entity_GetIndex(entity), 2);
+	TEST_EXPECT_EQL_INT(Entity_GetNumUsedSlots(list), 1);
+	TEST_EXPECT_TRUE(Entity_GetFromHandle(list, Entity_CreateHandle(entity)) == entity);
+
+	Entity_FreeList(list);
+}
+
+static void TestStaleHandles(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(2);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	RayGE_Entity* entity = Entity_GetNextFree(list);
+	Entity_Acquire(list, entity);
+
+	const RayGE_ResourceHandle oldHandle = Entity_CreateHandle(entity);
+	Entity_Release(entity);
+
+	TEST_EXPECT_FALSE(Entity_GetFromHandle(list, oldHandle));
+
+	// The same slot should be handed out again, but the
+	// handle to its previous occupant should not pass.
+	TEST_EXPECT_TRUE(Entity_GetNextFree(list) == entity);
+	Entity_Acquire(list, entity);
+
+	const RayGE_ResourceHandle newHandle = Entity_CreateHandle(entity);
+
+	TEST_EXPECT_EQL_INT(RAYGE_RESOURCE_HANDLE_INDEX(newHandle), RAYGE_RESOURCE_HANDLE_INDEX(oldHandle));
+	TEST_EXPECT_FALSE(Entity_GetFromHandle(list, oldHandle));
+	TEST_EXPECT_TRUE(Entity_GetFromHandle(list, newHandle) == entity);
+
+	Entity_FreeList(list);
+}
+
+static void TestFreeListOrder(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(4);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	// Acquiring a slot out of order should take it out of the free list.
+	Entity_Acquire(list, Entity_Get(list, 1));
+	TEST_EXPECT_TRUE(Entity_GetNextFree(list) == Entity_Get(list, 0));
+
+	Entity_Acquire(list, Entity_GetNextFree(list));
+	TEST_EXPECT_TRUE(Entity_GetNextFree(list) == Entity_Get(list, 2));
+
+	Entity_Acquire(list, Entity_GetNextFree(list));
+	Entity_Acquire(list, Entity_GetNextFree(list));
+	TEST_EXPECT_FALSE(Entity_GetNextFree(list));
+	TEST_EXPECT_EQL_INT(Entity_GetNumFreeSlots(list), 0);
+
+	// The most recently released slot should be handed out first.
+	Entity_Release(Entity_Get(list, 3));
+	Entity_Release(Entity_Get(list, 0));
+	TEST_EXPECT_TRUE(Entity_GetNextFree(list) == Entity_Get(list, 0));
+
+	Entity_Acquire(list, Entity_GetNextFree(list));
+	TEST_EXPECT_TRUE(Entity_GetNextFree(list) == Entity_Get(list, 3));
+
+	Entity_FreeList(list);
+}
+
+static void TestEntitiesAreSetUpWhenFirstAcquired(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(5);
+
+	if ( !TEST_EXPECT_TRUE(list) )
 	{
-		if ( component->type == type )
+		return;
+	}
+
+	TEST_EXPECT_EQL_INT(Entity_GetIndex(Entity_Get(list, 3)), UINT32_MAX);
+	TEST_EXPECT_EQL_INT(Entity_GetNumFreeSlots(list), 5);
+
+	// Skipping over never-acquired entities should not lose them,
+	// and they should still be handed out lowest index first.
+	Entity_Acquire(list, Entity_Get(list, 3));
+	TEST_EXPECT_EQL_INT(Entity_GetIndex(Entity_Get(list, 3)), 3);
+
+	const uint32_t expectedOrder[] = {0, 1, 2, 4};
+	size_t failures = 0;
+
+	for ( size_t index = 0; index < sizeof(expectedOrder) / sizeof(expectedOrder[0]); ++index )
+	{
+		RayGE_Entity* entity = Entity_GetNextFree(list);
+		Entity_Acquire(list, entity);
+
+		if ( Entity_GetIndex(entity) != expectedOrder[index] )
 		{
-			return component;
+			++failures;
 		}
 	}
 
-	return NULL;
+	TEST_EXPECT_EQL_INT(failures, 0);
+	TEST_EXPECT_FALSE(Entity_GetNextFree(list));
+	TEST_EXPECT_EQL_INT(Entity_GetNumUsedSlots(list), 5);
+
+	Entity_FreeList(list);
+}
+
+static void TestDeferredRelease(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(4);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	RayGE_Entity* first = Entity_GetNextFree(list);
+	Entity_Acquire(list, first);
+
+	RayGE_Entity* second = Entity_GetNextFree(list);
+	Entity_Acquire(list, second);
+
+	const RayGE_ResourceHandle firstHandle = Entity_CreateHandle(first);
+	(void)Entity_AddComponent(first, RAYGE_COMPONENTTYPE_SPATIAL);
+
+	Entity_ReleaseDeferred(first);
+	Entity_ReleaseDeferred(first);
+
+	// The entity should stay usable until the deferred release happens.
+	TEST_EXPECT_TRUE(Entity_IsPendingRelease(first));
+	TEST_EXPECT_TRUE(Entity_GetFromHandle(list, firstHandle) == first);
+	TEST_EXPECT_TRUE(Entity_GetComponent(first, RAYGE_COMPONENTTYPE_SPATIAL));
+	TEST_EXPECT_EQL_INT(Entity_GetNumUsedSlots(list), 2);
+
+	Entity_ReleaseAllDeferred(list);
+
+	TEST_EXPECT_FALSE(Entity_IsInUse(first));
+	TEST_EXPECT_FALSE(Entity_GetFromHandle(list, firstHandle));
+	TEST_EXPECT_TRUE(Entity_IsInUse(second));
+	TEST_EXPECT_EQL_INT(Entity_GetNumUsedSlots(list), 1);
+
+	// If a pending entity is released directly and its slot is re-used,
+	// the new occupant should not be released by the stale entry.
+	Entity_ReleaseDeferred(second);
+	Entity_Release(second);
+	Entity_Acquire(list, second);
+	Entity_ReleaseAllDeferred(list);
+
+	TEST_EXPECT_TRUE(Entity_IsInUse(second));
+	TEST_EXPECT_FALSE(Entity_IsPendingRelease(second));
+
+	Entity_FreeList(list);
+}
+
+static float GetSpatialX(const RayGE_Entity* entity)
+{
+	const RayGE_Component_Spatial* spatial =
+		COMPONENTDATA_SPATIAL(Entity_GetComponent(entity, RAYGE_COMPONENTTYPE_SPATIAL));
+
+	return spatial ? spatial->position.x : -1.0f;
+}
+
+static void TestAddingComponentsKeepsData(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(4);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	RayGE_Entity* first = Entity_Get(list, 0);
+	RayGE_Entity* second = Entity_Get(list, 1);
+	Entity_Acquire(list, first);
+	Entity_Acquire(list, second);
+
+	TEST_EXPECT_EQL_INT(Entity_GetComponentMask(first), 0);
+	TEST_EXPECT_FALSE(Entity_GetComponent(first, RAYGE_COMPONENTTYPE_SPATIAL));
+
+	COMPONENTDATA_SPATIAL(Entity_AddComponent(first, RAYGE_COMPONENTTYPE_SPATIAL))->position.x = 1.0f;
+	COMPONENTDATA_SPATIAL(Entity_AddComponent(second, RAYGE_COMPONENTTYPE_SPATIAL))->position.x = 2.0f;
+
+	// Adding the same type again should return the existing component.
+	TEST_EXPECT_TRUE(
+		Entity_AddComponent(first, RAYGE_COMPONENTTYPE_SPATIAL) ==
+		Entity_GetComponent(first, RAYGE_COMPONENTTYPE_SPATIAL)
+	);
+
+	// This moves the first entity to a new archetype, and the
+	// second entity into the first entity's old row.
+	RayGE_Component_Renderable* renderable =
+		COMPONENTDATA_RENDERABLE(Entity_AddComponent(first, RAYGE_COMPONENTTYPE_RENDERABLE));
+
+	TEST_EXPECT_TRUE(renderable && renderable->scale == 1.0f);
+	TEST_EXPECT_EQL_INT(
+		Entity_GetComponentMask(first),
+		COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL) | COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_RENDERABLE)
+	);
+
+	TEST_EXPECT_TRUE(GetSpatialX(first) == 1.0f);
+	TEST_EXPECT_TRUE(GetSpatialX(second) == 2.0f);
+
+	Entity_Release(first);
+	TEST_EXPECT_TRUE(GetSpatialX(second) == 2.0f);
+
+	// Re-using the slot should not bring back the previous occupant's components.
+	Entity_Acquire(list, first);
+	TEST_EXPECT_EQL_INT(Entity_GetComponentMask(first), 0);
+
+	Entity_FreeList(list);
+}
+
+static void TestChunkIteration(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(8);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	for ( uint32_t index = 0; index < 8; ++index )
+	{
+		RayGE_Entity* entity = Entity_Get(list, index);
+		Entity_Acquire(list, entity);
+
+		// Every entity is spatial, but only odd ones are renderable, and only some of those are cameras.
+		COMPONENTDATA_SPATIAL(Entity_AddComponent(entity, RAYGE_COMPONENTTYPE_SPATIAL))->position.x = (float)index;
+
+		if ( index % 2 == 1 )
+		{
+			(void)Entity_AddComponent(entity, RAYGE_COMPONENTTYPE_RENDERABLE);
+		}
+
+		if ( index % 4 == 1 )
+		{
+			(void)Entity_AddComponent(entity, RAYGE_COMPONENTTYPE_CAMERA);
+		}
+	}
+
+	const RayGE_ComponentMask mask =
+		COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL) | COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_RENDERABLE);
+
+	size_t numChunks = 0;
+	size_t numEntities = 0;
+	size_t mismatches = 0;
+
+	for ( RayGE_EntityChunkIterator iterator = Entity_GetChunkIterator(list, mask);
+		  Entity_ChunkIteratorIsValid(iterator);
+		  iterator = Entity_IncrementChunkIterator(iterator) )
+	{
+		const RayGE_ArchetypeChunk* chunk = Entity_GetChunkFromIterator(iterator);
+
+		if ( !TEST_EXPECT_TRUE(chunk && ARCHETYPECHUNK_SPATIAL(chunk) && ARCHETYPECHUNK_RENDERABLE(chunk)) )
+		{
+			break;
+		}
+
+		++numChunks;
+
+		for ( uint32_t row = 0; row < chunk->count; ++row )
+		{
+			const uint32_t entityIndex = RAYGE_RESOURCE_HANDLE_INDEX(chunk->entityHandles[row]);
+
+			if ( entityIndex % 2 != 1 || ARCHETYPECHUNK_SPATIAL(chunk)[row].position.x != (float)entityIndex )
+			{
+				++mismatches;
+			}
+
+			++numEntities;
+		}
+	}
+
+	// Renderable entities are split between two archetypes, depending on whether they are cameras.
+	TEST_EXPECT_EQL_INT(numChunks, 2);
+	TEST_EXPECT_EQL_INT(numEntities, 4);
+	TEST_EXPECT_EQL_INT(mismatches, 0);
+
+	Entity_FreeList(list);
+}
+
+static bool QueryContains(RayGE_EntityQueryResult result, const RayGE_Entity* entity)
+{
+	for ( uint32_t index = 0; index < result.count; ++index )
+	{
+		if ( result.entities[index] == entity )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void TestRemovingComponents(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(2);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	RayGE_Entity* entity = Entity_GetNextFree(list);
+	Entity_Acquire(list, entity);
+
+	COMPONENTDATA_SPATIAL(Entity_AddComponent(entity, RAYGE_COMPONENTTYPE_SPATIAL))->position.x = 4.0f;
+	(void)Entity_AddComponent(entity, RAYGE_COMPONENTTYPE_CAMERA);
+
+	TEST_EXPECT_TRUE(Entity_RemoveComponent(entity, RAYGE_COMPONENTTYPE_CAMERA));
+	TEST_EXPECT_FALSE(Entity_RemoveComponent(entity, RAYGE_COMPONENTTYPE_CAMERA));
+	TEST_EXPECT_FALSE(Entity_GetComponent(entity, RAYGE_COMPONENTTYPE_CAMERA));
+	TEST_EXPECT_EQL_INT(Entity_GetComponentMask(entity), COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL));
+	TEST_EXPECT_TRUE(GetSpatialX(entity) == 4.0f);
+
+	TEST_EXPECT_TRUE(Entity_RemoveComponent(entity, RAYGE_COMPONENTTYPE_SPATIAL));
+	TEST_EXPECT_EQL_INT(Entity_GetComponentMask(entity), 0);
+	TEST_EXPECT_FALSE(Entity_GetComponent(entity, RAYGE_COMPONENTTYPE_SPATIAL));
+
+	Entity_FreeList(list);
+}
+
+static void TestQueriesAreUpdated(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(8);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	const RayGE_ComponentMask mask =
+		COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL) | COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_RENDERABLE);
+
+	RayGE_Entity* first = Entity_GetNextFree(list);
+	Entity_Acquire(list, first);
+	(void)Entity_AddComponent(first, RAYGE_COMPONENTTYPE_SPATIAL);
+	(void)Entity_AddComponent(first, RAYGE_COMPONENTTYPE_RENDERABLE);
+
+	RayGE_Entity* second = Entity_GetNextFree(list);
+	Entity_Acquire(list, second);
+	(void)Entity_AddComponent(second, RAYGE_COMPONENTTYPE_SPATIAL);
+
+	// Entities which existed before the first query should be found.
+	RayGE_EntityQueryResult result = Entity_Query(list, mask);
+	TEST_EXPECT_EQL_INT(result.count, 1);
+	TEST_EXPECT_TRUE(QueryContains(result, first));
+
+	TEST_EXPECT_EQL_INT(Entity_Query(list, 0).count, 2);
+
+	// Later changes should be reflected without the list being rebuilt.
+	(void)Entity_AddComponent(second, RAYGE_COMPONENTTYPE_RENDERABLE);
+	result = Entity_Query(list, mask);
+	TEST_EXPECT_EQL_INT(result.count, 2);
+	TEST_EXPECT_TRUE(QueryContains(result, second));
+
+	(void)Entity_RemoveComponent(first, RAYGE_COMPONENTTYPE_RENDERABLE);
+	result = Entity_Query(list, mask);
+	TEST_EXPECT_EQL_INT(result.count, 1);
+	TEST_EXPECT_FALSE(QueryContains(result, first));
+	TEST_EXPECT_TRUE(QueryContains(result, second));
+
+	Entity_Release(second);
+	TEST_EXPECT_EQL_INT(Entity_Query(list, mask).count, 0);
+	TEST_EXPECT_EQL_INT(Entity_Query(list, 0).count, 1);
+
+	RayGE_Entity* third = Entity_GetNextFree(list);
+	Entity_Acquire(list, third);
+	TEST_EXPECT_EQL_INT(Entity_Query(list, 0).count, 2);
+	TEST_EXPECT_EQL_INT(Entity_Query(list, COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL)).count, 1);
+
+	Entity_FreeList(list);
+}
+
+static void TestAcquireMany(void)
+{
+	RayGE_EntityList* list = Entity_AllocateList(600);
+
+	if ( !TEST_EXPECT_TRUE(list) )
+	{
+		return;
+	}
+
+	const RayGE_ComponentMask mask =
+		COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL) | COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_RENDERABLE);
+
+	RayGE_Component_Spatial spatial = {0};
+	spatial.position.x = 7.0f;
+
+	const void* componentData[RAYGE_COMPONENTTYPE__COUNT] = {0};
+	componentData[RAYGE_COMPONENTTYPE_SPATIAL] = &spatial;
+
+	// Make sure an existing query is kept up to date.
+	TEST_EXPECT_EQL_INT(Entity_Query(list, mask).count, 0);
+
+	RayGE_ResourceHandle handles[300];
+	TEST_EXPECT_EQL_INT(Entity_AcquireMany(list, mask, componentData, 300, handles), 300);
+	TEST_EXPECT_EQL_INT(Entity_GetNumUsedSlots(list), 300);
+	TEST_EXPECT_EQL_INT(Entity_Query(list, mask).count, 300);
+
+	uint32_t numMatching = 0;
+
+	for ( uint32_t index = 0; index < 300; ++index )
+	{
+		RayGE_Entity* entity = Entity_GetFromHandle(list, handles[index]);
+
+		if ( entity && Entity_GetIndex(entity) == index && Entity_GetComponentMask(entity) == mask &&
+			 GetSpatialX(entity) == 7.0f )
+		{
+			++numMatching;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(numMatching, 300);
+
+	// Components not in the data should be set to their defaults.
+	const RayGE_Component_Renderable* renderable = COMPONENTDATA_RENDERABLE(
+		Entity_GetComponent(Entity_GetFromHandle(list, handles[299]), RAYGE_COMPONENTTYPE_RENDERABLE)
+	);
+
+	TEST_EXPECT_TRUE(renderable && renderable->scale == 1.0f);
+
+	// Nothing should be created if there is not enough space for all of the entities.
+	TEST_EXPECT_EQL_INT(Entity_AcquireMany(list, mask, componentData, 301, NULL), 0);
+	TEST_EXPECT_EQL_INT(Entity_GetNumUsedSlots(list), 300);
+
+	TEST_EXPECT_EQL_INT(Entity_AcquireMany(list, 0, NULL, 300, NULL), 300);
+	TEST_EXPECT_EQL_INT(Entity_GetNumFreeSlots(list), 0);
+	TEST_EXPECT_EQL_INT(Entity_Query(list, 0).count, 600);
+	TEST_EXPECT_EQL_INT(Entity_Query(list, mask).count, 300);
+
+	// Entities made in bulk should be released like any other.
+	Entity_Release(Entity_GetFromHandle(list, handles[0]));
+	TEST_EXPECT_EQL_INT(Entity_Query(list, mask).count, 299);
+	TEST_EXPECT_TRUE(GetSpatialX(Entity_GetFromHandle(list, handles[299])) == 7.0f);
+
+	Entity_FreeList(list);
+}
+
+void Entity_RunTests(void)
+{
+	TestHandlesForNewList();
+	TestStaleHandles();
+	TestFreeListOrder();
+	TestEntitiesAreSetUpWhenFirstAcquired();
+	TestDeferredRelease();
+	TestAddingComponentsKeepsData();
+	TestRemovingComponents();
+	TestChunkIteration();
+	TestQueriesAreUpdated();
+	TestAcquireMany();
 }
+#endif
@@ -3,29 +3,105 @@
 #include <stdbool.h>
 #include "RayGE/SceneTypes.h"
 #include "RayGE/ResourceHandle.h"
+#include "Scene/Archetype.h"
 #include "Scene/Component.h"
+#include "Testing/Testing.h"
 #include "wzl_cutl/attributes.h"
 
 typedef struct RayGE_Entity RayGE_Entity;
 typedef struct RayGE_EntityList RayGE_EntityList;
 
+// Iterates over the archetype chunks (see Scene/Archetype.h) of all entities
+// in a list which have at least the required set of components. Entities must
+// not be released, and must not have components added, while iterating.
+typedef struct RayGE_EntityChunkIterator
+{
+	const RayGE_EntityList* list;
+	RayGE_ComponentMask requiredMask;
+	uint32_t archetypeIndex;
+	uint32_t chunkIndex;
+} RayGE_EntityChunkIterator;
+
+// Dense list of the in-use entities which have at least a given set of
+// components, in no particular order. The list is owned by the entity list.
+typedef struct RayGE_EntityQueryResult
+{
+	RayGE_Entity* const* entities;
+	uint32_t count;
+} RayGE_EntityQueryResult;
+
 WZL_ATTR_NODISCARD RayGE_EntityList* Entity_AllocateList(uint32_t capacity);
 void Entity_FreeList(RayGE_EntityList* list);
 uint32_t Entity_GetListCapacity(const RayGE_EntityList* list);
 uint32_t Entity_GetNumFreeSlots(const RayGE_EntityList* list);
 uint32_t Entity_GetNumUsedSlots(const RayGE_EntityList* list);
 RayGE_Entity* Entity_Get(const RayGE_EntityList* list, uint32_t index);
-RayGE_Entity* Entity_FindFirstFree(const RayGE_EntityList* list);
+
+// Returns the free entity that will be handed out next, or null if
+// the list is full. Released entities are tracked in a list, and
+// the rest are handed out in index order, so this does not need
+// to search.
+RayGE_Entity* Entity_GetNextFree(const RayGE_EntityList* list);
 
 RayGE_ResourceHandle Entity_CreateHandle(const RayGE_Entity* entity);
 
-// Entity must be in use, and the key must match.
+// Entity must be in use, and the handle's generation must match.
 RayGE_Entity* Entity_GetFromHandle(const RayGE_EntityList* list, RayGE_ResourceHandle handle);
 
-void Entity_Acquire(RayGE_Entity* entity);
+// The entity must belong to the list.
+void Entity_Acquire(RayGE_EntityList* list, RayGE_Entity* entity);
+
+// Acquires the given number of entities, each with the given set of components,
+// and returns how many were acquired. This is either all of them or, if there
+// are not enough free slots, none of them. The components are initialised as
+// described for Archetype_AddRows(). Handles to the new entities are written to
+// outHandles, if it is not null.
+uint32_t Entity_AcquireMany(
+	RayGE_EntityList* list,
+	RayGE_ComponentMask mask,
+	const void* const componentData[RAYGE_COMPONENTTYPE__COUNT],
+	uint32_t count,
+	RayGE_ResourceHandle* outHandles
+);
 void Entity_Release(RayGE_Entity* entity);
 bool Entity_IsInUse(const RayGE_Entity* entity);
+
+// Marks the entity to be released the next time Entity_ReleaseAllDeferred() is
+// called. Until then the entity stays in use, and handles to it remain valid.
+// Marking an entity more than once has no further effect.
+void Entity_ReleaseDeferred(RayGE_Entity* entity);
+bool Entity_IsPendingRelease(const RayGE_Entity* entity);
+void Entity_ReleaseAllDeferred(RayGE_EntityList* list);
+
+// Returns UINT32_MAX for entities that have never been acquired.
 uint32_t Entity_GetIndex(const RayGE_Entity* entity);
 
-bool Entity_AddComponent(RayGE_Entity* entity, RayGE_ComponentHeader* component);
-RayGE_ComponentHeader* Entity_GetFirstComponentOfType(const RayGE_Entity* entity, RayGE_ComponentType type);
+// Components are stored in the archetype for the entity's set of component
+// types. Adding a component moves the entity to a different archetype, and
+// releasing an entity moves another entity within its archetype, so pointers
+// to components are only valid until the next time either of these happens.
+RayGE_ComponentMask Entity_GetComponentMask(const RayGE_Entity* entity);
+
+// If the entity already has a component of this type, the existing one is returned.
+void* Entity_AddComponent(RayGE_Entity* entity, RayGE_ComponentType type);
+
+// Returns false if the entity did not have a component of this type.
+bool Entity_RemoveComponent(RayGE_Entity* entity, RayGE_ComponentType type);
+
+// Returns null if the entity does not have a component of this type.
+void* Entity_GetComponent(const RayGE_Entity* entity, RayGE_ComponentType type);
+
+RayGE_EntityChunkIterator Entity_GetChunkIterator(const RayGE_EntityList* list, RayGE_ComponentMask requiredMask);
+RayGE_EntityChunkIterator Entity_IncrementChunkIterator(RayGE_EntityChunkIterator iterator);
+bool Entity_ChunkIteratorIsValid(RayGE_EntityChunkIterator iterator);
+const RayGE_ArchetypeChunk* Entity_GetChunkFromIterator(RayGE_EntityChunkIterator iterator);
+
+// The first query for a given mask builds a list of matching entities, which is
+// then updated as entities are acquired, released, or have components added or
+// removed, so later queries for the same mask do not need to search. The result
+// is only valid until the next time any of these things happens.
+RayGE_EntityQueryResult Entity_Query(RayGE_EntityList* list, RayGE_ComponentMask mask);
+
+#if RAYGE_BUILD_TESTING()
+void Entity_RunTests(void);
+#endif
@@ -66,7 +66,7 @@ RayGE_Entity* Scene_CreateEntity(RayGE_Scene* scene)
 		return NULL;
 	}
 
-	RayGE_Entity* ent = Entity_FindFirstFree(scene->entities);
+	RayGE_Entity* ent = Entity_GetNextFree(scene->entities);
 
 	RAYGE_ENSURE(
 		ent,
@@ -75,11 +75,42 @@ RayGE_Entity* Scene_CreateEntity(RayGE_Scene* scene)
 		Entity_GetListCapacity(scene->entities)
 	);
 
-	Entity_Acquire(ent);
+	Entity_Acquire(scene->entities, ent);
 
 	return ent;
 }
 
+uint32_t Scene_CreateEntities(
+	RayGE_Scene* scene,
+	RayGE_ComponentMask mask,
+	const void* const componentData[RAYGE_COMPONENTTYPE__COUNT],
+	uint32_t count,
+	RayGE_ResourceHandle* outHandles
+)
+{
+	RAYGE_ASSERT_VALID(scene);
+
+	if ( !scene || count < 1 )
+	{
+		return 0;
+	}
+
+	if ( Entity_GetNumFreeSlots(scene->entities) < count )
+	{
+		Logging_PrintLine(
+			RAYGE_LOG_ERROR,
+			"Cannot create %u scene entities: only %u of %u slots are free.",
+			count,
+			Entity_GetNumFreeSlots(scene->entities),
+			Entity_GetListCapacity(scene->entities)
+		);
+
+		return 0;
+	}
+
+	return Entity_AcquireMany(scene->entities, mask, componentData, count, outHandles);
+}
+
 RayGE_Entity* Scene_GetActiveEntity(RayGE_Scene* scene, uint32_t index)
 {
 	RAYGE_ASSERT_VALID(scene);
@@ -98,3 +129,40 @@ RayGE_Entity* Scene_GetEntityFromHandle(RayGE_Scene* scene, RayGE_ResourceHandle
 	RAYGE_ASSERT_VALID(scene);
 	return scene ? Entity_GetFromHandle(scene->entities, handle) : NULL;
 }
+
+void Scene_DestroyEntity(RayGE_Scene* scene, RayGE_Entity* entity)
+{
+	RAYGE_ASSERT_VALID(scene);
+	RAYGE_ASSERT_VALID(entity);
+
+	if ( !scene || !entity )
+	{
+		return;
+	}
+
+	Entity_ReleaseDeferred(entity);
+}
+
+void Scene_ReleaseDestroyedEntities(RayGE_Scene* scene)
+{
+	RAYGE_ASSERT_VALID(scene);
+
+	if ( !scene )
+	{
+		return;
+	}
+
+	Entity_ReleaseAllDeferred(scene->entities);
+}
+
+RayGE_EntityQueryResult Scene_Query(RayGE_Scene* scene, RayGE_ComponentMask mask)
+{
+	RAYGE_ASSERT_VALID(scene);
+	return Entity_Query(scene ? scene->entities : NULL, mask);
+}
+
+RayGE_EntityChunkIterator Scene_GetChunkIterator(const RayGE_Scene* scene, RayGE_ComponentMask requiredMask)
+{
+	RAYGE_ASSERT_VALID(scene);
+	return Entity_GetChunkIterator(scene ? scene->entities : NULL, requiredMask);
+}
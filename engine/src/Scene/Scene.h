@@ -15,5 +15,31 @@ void Scene_Destroy(RayGE_Scene* scene);
 uint32_t Scene_GetMaxEntities(const RayGE_Scene* scene);
 uint32_t Scene_GetActiveEntities(const RayGE_Scene* scene);
 RayGE_Entity* Scene_CreateEntity(RayGE_Scene* scene);
+
+// Creates many entities with the same set of components at once. Either all of
+// the entities are created, or none are if there is not enough space for them.
+// Returns the number of entities created. See Entity_AcquireMany().
+uint32_t Scene_CreateEntities(
+	RayGE_Scene* scene,
+	RayGE_ComponentMask mask,
+	const void* const componentData[RAYGE_COMPONENTTYPE__COUNT],
+	uint32_t count,
+	RayGE_ResourceHandle* outHandles
+);
+
 RayGE_Entity* Scene_GetActiveEntity(RayGE_Scene* scene, uint32_t index);
 RayGE_Entity* Scene_GetEntityFromHandle(RayGE_Scene* scene, RayGE_ResourceHandle handle);
+
+// Destruction is deferred until Scene_ReleaseDestroyedEntities() is called at
+// the end of the frame, so that systems which are part-way through iterating
+// over the scene never see entities or components move underneath them.
+void Scene_DestroyEntity(RayGE_Scene* scene, RayGE_Entity* entity);
+void Scene_ReleaseDestroyedEntities(RayGE_Scene* scene);
+
+// Returns the cached list of active entities which have at least the given set
+// of components. See Entity_Query().
+RayGE_EntityQueryResult Scene_Query(RayGE_Scene* scene, RayGE_ComponentMask mask);
+
+// Iterates over the components of all active entities which have at least the
+// required set of components, as contiguous arrays. See Entity_GetChunkIterator().
+RayGE_EntityChunkIterator Scene_GetChunkIterator(const RayGE_Scene* scene, RayGE_ComponentMask requiredMask);
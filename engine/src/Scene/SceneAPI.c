@@ -18,130 +18,169 @@ static RayGE_Entity* GetEntityFromHandle(RayGE_ResourceHandle handle, const char
 	return entity;
 }
 
-RayGE_ResourceHandle SceneAPI_CreateEntity(void)
-{
-	return Entity_CreateHandle(Scene_CreateEntity(SceneSubsystem_GetScene()));
-}
-
-RayGE_Component_Spatial* SceneAPI_AddSpatialComponent(RayGE_ResourceHandle entity)
+static void* AddComponent(RayGE_ResourceHandle handle, RayGE_ComponentType type, const char* operation)
 {
-	RayGE_Entity* entPtr = GetEntityFromHandle(entity, "AddSpatialComponent");
+	RayGE_Entity* entity = GetEntityFromHandle(handle, operation);
 
-	if ( !entPtr )
+	if ( !entity )
 	{
 		return NULL;
 	}
 
-	RayGE_ComponentHeader* existing = Entity_GetFirstComponentOfType(entPtr, RAYGE_COMPONENTTYPE_SPATIAL);
-
-	if ( existing )
-	{
-		return COMPONENTDATA_SPATIAL(existing);
-	}
-
-	RayGE_ComponentImpl_Spatial* component = Component_CreateSpatial();
+	void* component = Entity_AddComponent(entity, type);
 
-	if ( !Entity_AddComponent(entPtr, &component->header) )
+	if ( !component )
 	{
-		Logging_PrintLine(RAYGE_LOG_ERROR, "AddSpatialComponent: failed to add component to entity.");
-		Component_FreeList(&component->header);
-		component = NULL;
+		Logging_PrintLine(RAYGE_LOG_ERROR, "%s: failed to add component to entity.", operation);
 	}
 
-	return &component->data;
+	return component;
 }
 
-RayGE_Component_Spatial* SceneAPI_GetSpatialComponent(RayGE_ResourceHandle entity)
+static void* GetComponent(RayGE_ResourceHandle handle, RayGE_ComponentType type, const char* operation)
 {
-	RayGE_Entity* entPtr = GetEntityFromHandle(entity, "GetSpatialComponent");
-
-	if ( !entPtr )
-	{
-		return NULL;
-	}
-
-	RayGE_ComponentHeader* component = Entity_GetFirstComponentOfType(entPtr, RAYGE_COMPONENTTYPE_SPATIAL);
-	return component ? COMPONENTDATA_SPATIAL(component) : NULL;
+	RayGE_Entity* entity = GetEntityFromHandle(handle, operation);
+	return entity ? Entity_GetComponent(entity, type) : NULL;
 }
 
-RayGE_Component_Camera* SceneAPI_AddCameraComponent(RayGE_ResourceHandle entity)
+RayGE_ResourceHandle SceneAPI_CreateEntity(void)
 {
-	RayGE_Entity* entPtr = GetEntityFromHandle(entity, "AddCameraComponent");
-
-	if ( !entPtr )
-	{
-		return NULL;
-	}
+	return Entity_CreateHandle(Scene_CreateEntity(SceneSubsystem_GetScene()));
+}
 
-	RayGE_ComponentHeader* existing = Entity_GetFirstComponentOfType(entPtr, RAYGE_COMPONENTTYPE_CAMERA);
+void SceneAPI_DestroyEntity(RayGE_ResourceHandle entity)
+{
+	RayGE_Entity* entPtr = GetEntityFromHandle(entity, "DestroyEntity");
 
-	if ( existing )
+	if ( entPtr )
 	{
-		return COMPONENTDATA_CAMERA(existing);
+		Scene_DestroyEntity(SceneSubsystem_GetScene(), entPtr);
 	}
+}
 
-	RayGE_ComponentImpl_Camera* component = Component_CreateCamera();
+RayGE_Component_Spatial* SceneAPI_AddSpatialComponent(RayGE_ResourceHandle entity)
+{
+	return COMPONENTDATA_SPATIAL(AddComponent(entity, RAYGE_COMPONENTTYPE_SPATIAL, "AddSpatialComponent"));
+}
 
-	if ( !Entity_AddComponent(entPtr, &component->header) )
-	{
-		Logging_PrintLine(RAYGE_LOG_ERROR, "AddCameraComponent: failed to add component to entity.");
-		Component_FreeList(&component->header);
-		component = NULL;
-	}
+RayGE_Component_Spatial* SceneAPI_GetSpatialComponent(RayGE_ResourceHandle entity)
+{
+	return COMPONENTDATA_SPATIAL(GetComponent(entity, RAYGE_COMPONENTTYPE_SPATIAL, "GetSpatialComponent"));
+}
 
-	return &component->data;
+RayGE_Component_Camera* SceneAPI_AddCameraComponent(RayGE_ResourceHandle entity)
+{
+	return COMPONENTDATA_CAMERA(AddComponent(entity, RAYGE_COMPONENTTYPE_CAMERA, "AddCameraComponent"));
 }
 
 RayGE_Component_Camera* SceneAPI_GetCameraComponent(RayGE_ResourceHandle entity)
 {
-	RayGE_Entity* entPtr = GetEntityFromHandle(entity, "GetCameraComponent");
+	return COMPONENTDATA_CAMERA(GetComponent(entity, RAYGE_COMPONENTTYPE_CAMERA, "GetCameraComponent"));
+}
 
-	if ( !entPtr )
-	{
-		return NULL;
-	}
+RayGE_Component_Renderable* SceneAPI_AddRenderableComponent(RayGE_ResourceHandle entity)
+{
+	return COMPONENTDATA_RENDERABLE(AddComponent(entity, RAYGE_COMPONENTTYPE_RENDERABLE, "AddRenderableComponent"));
+}
 
-	RayGE_ComponentHeader* component = Entity_GetFirstComponentOfType(entPtr, RAYGE_COMPONENTTYPE_CAMERA);
-	return component ? COMPONENTDATA_CAMERA(component) : NULL;
+RayGE_Component_Renderable* SceneAPI_GetRenderableComponent(RayGE_ResourceHandle entity)
+{
+	return COMPONENTDATA_RENDERABLE(GetComponent(entity, RAYGE_COMPONENTTYPE_RENDERABLE, "GetRenderableComponent"));
 }
 
-RayGE_Component_Renderable* SceneAPI_AddRenderableComponent(RayGE_ResourceHandle entity)
+static void* GetRequestedArray(const RayGE_ArchetypeChunk* chunk, RayGE_ComponentMask mask, RayGE_ComponentType type)
 {
-	RayGE_Entity* entPtr = GetEntityFromHandle(entity, "AddRenderableComponent");
+	return COMPONENT_MASK_HAS(mask, type) ? chunk->components[type] : NULL;
+}
 
-	if ( !entPtr )
+size_t SceneAPI_GetComponentSpans(
+	RayGE_ComponentMask requiredComponents,
+	RayGE_ComponentSpan* outSpans,
+	size_t maxSpans
+)
+{
+	if ( (requiredComponents >> RAYGE_COMPONENTTYPE__COUNT) != 0 )
 	{
-		return NULL;
-	}
+		Logging_PrintLine(
+			RAYGE_LOG_ERROR,
+			"GetComponentSpans: component mask 0x%x contained unrecognised component types.",
+			requiredComponents
+		);
 
-	RayGE_ComponentHeader* existing = Entity_GetFirstComponentOfType(entPtr, RAYGE_COMPONENTTYPE_RENDERABLE);
+		return 0;
+	}
 
-	if ( existing )
+	if ( !outSpans )
 	{
-		return COMPONENTDATA_RENDERABLE(existing);
+		maxSpans = 0;
 	}
 
-	RayGE_ComponentImpl_Renderable* component = Component_CreateRenderable();
+	RayGE_Scene* scene = SceneSubsystem_GetScene();
+	size_t numSpans = 0;
 
-	if ( !Entity_AddComponent(entPtr, &component->header) )
+	// Each span is one archetype chunk, so no component data needs to be copied.
+	for ( RayGE_EntityChunkIterator iterator = Scene_GetChunkIterator(scene, requiredComponents);
+		  Entity_ChunkIteratorIsValid(iterator);
+		  iterator = Entity_IncrementChunkIterator(iterator) )
 	{
-		Logging_PrintLine(RAYGE_LOG_ERROR, "AddRenderableComponent: failed to add component to entity.");
-		Component_FreeList(&component->header);
-		component = NULL;
+		if ( numSpans < maxSpans )
+		{
+			const RayGE_ArchetypeChunk* chunk = Entity_GetChunkFromIterator(iterator);
+			RayGE_ComponentSpan* span = &outSpans[numSpans];
+
+			span->count = chunk->count;
+			span->entities = chunk->entityHandles;
+			span->spatial = GetRequestedArray(chunk, requiredComponents, RAYGE_COMPONENTTYPE_SPATIAL);
+			span->camera = GetRequestedArray(chunk, requiredComponents, RAYGE_COMPONENTTYPE_CAMERA);
+			span->renderable = GetRequestedArray(chunk, requiredComponents, RAYGE_COMPONENTTYPE_RENDERABLE);
+		}
+
+		++numSpans;
 	}
 
-	return &component->data;
+	return numSpans;
 }
 
-RayGE_Component_Renderable* SceneAPI_GetRenderableComponent(RayGE_ResourceHandle entity)
+size_t SceneAPI_CreateEntitiesFromTemplate(
+	const RayGE_EntityTemplate* entityTemplate,
+	size_t count,
+	RayGE_ResourceHandle* outHandles
+)
 {
-	RayGE_Entity* entPtr = GetEntityFromHandle(entity, "GetRenderableComponent");
+	if ( !entityTemplate )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "CreateEntitiesFromTemplate: template was null.");
+		return 0;
+	}
 
-	if ( !entPtr )
+	if ( (entityTemplate->components >> RAYGE_COMPONENTTYPE__COUNT) != 0 )
 	{
-		return NULL;
+		Logging_PrintLine(
+			RAYGE_LOG_ERROR,
+			"CreateEntitiesFromTemplate: component mask 0x%x contained unrecognised component types.",
+			entityTemplate->components
+		);
+
+		return 0;
 	}
 
-	RayGE_ComponentHeader* component = Entity_GetFirstComponentOfType(entPtr, RAYGE_COMPONENTTYPE_RENDERABLE);
-	return component ? COMPONENTDATA_RENDERABLE(component) : NULL;
+	if ( count > UINT32_MAX )
+	{
+		Logging_PrintLine(RAYGE_LOG_ERROR, "CreateEntitiesFromTemplate: cannot create %zu entities.", count);
+		return 0;
+	}
+
+	const void* componentData[RAYGE_COMPONENTTYPE__COUNT] = {0};
+
+	componentData[RAYGE_COMPONENTTYPE_SPATIAL] = &entityTemplate->spatial;
+	componentData[RAYGE_COMPONENTTYPE_CAMERA] = &entityTemplate->camera;
+	componentData[RAYGE_COMPONENTTYPE_RENDERABLE] = &entityTemplate->renderable;
+
+	return Scene_CreateEntities(
+		SceneSubsystem_GetScene(),
+		entityTemplate->components,
+		componentData,
+		(uint32_t)count,
+		outHandles
+	);
 }
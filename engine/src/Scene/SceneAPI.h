@@ -3,9 +3,22 @@
 #include "RayGE/APIs/Scene.h"
 
 RayGE_ResourceHandle SceneAPI_CreateEntity(void);
+void SceneAPI_DestroyEntity(RayGE_ResourceHandle entity);
 RayGE_Component_Spatial* SceneAPI_AddSpatialComponent(RayGE_ResourceHandle entity);
 RayGE_Component_Spatial* SceneAPI_GetSpatialComponent(RayGE_ResourceHandle entity);
 RayGE_Component_Camera* SceneAPI_AddCameraComponent(RayGE_ResourceHandle entity);
 RayGE_Component_Camera* SceneAPI_GetCameraComponent(RayGE_ResourceHandle entity);
 RayGE_Component_Renderable* SceneAPI_AddRenderableComponent(RayGE_ResourceHandle entity);
 RayGE_Component_Renderable* SceneAPI_GetRenderableComponent(RayGE_ResourceHandle entity);
+
+size_t SceneAPI_GetComponentSpans(
+	RayGE_ComponentMask requiredComponents,
+	RayGE_ComponentSpan* outSpans,
+	size_t maxSpans
+);
+
+size_t SceneAPI_CreateEntitiesFromTemplate(
+	const RayGE_EntityTemplate* entityTemplate,
+	size_t count,
+	RayGE_ResourceHandle* outHandles
+);
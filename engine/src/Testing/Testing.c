@@ -1,8 +1,22 @@
 #include <stdbool.h>
 #include <math.h>
 #include "Testing/Testing.h"
+#include "Filesystem/AsyncReadQueue.h"
+#include "Filesystem/NativeFilesystem.h"
+#include "Filesystem/PackArchive.h"
 #include "MemPool/MemPoolManager.h"
+#include "MemPool/MemPoolBudgets.h"
+#include "MemPool/MemPoolObjectPool.h"
+#include "MemPool/MemPoolProfiler.h"
+#include "MemPool/MemPoolTrace.h"
+#include "Resources/PixelWorldResources.h"
 #include "Resources/ResourceList.h"
+#include "Resources/ResourceResidency.h"
+#include "Resources/TextureCache.h"
+#include "Scene/Archetype.h"
+#include "Scene/Entity.h"
+#include "Threading/WorkerPool.h"
+#include "Utils/LZ4Utils.h"
 #include "Testing/AngleTests.h"
 #include "Launcher/LaunchParams.h"
 #include "Debugging.h"
@@ -127,7 +141,26 @@ bool Testing_RunAllTests(void)
 	}
 
 	RunTestsInCategory("MemPool Realloc", &MemPoolManager_TestRealloc);
+	RunTestsInCategory("MemPool Slab Allocations", &MemPoolManager_TestSlabAllocations);
+	RunTestsInCategory("MemPool Compact Layout", &MemPoolManager_TestCompactLayout);
+	RunTestsInCategory("MemPool Frame Arena", &MemPoolManager_TestFrameArena);
+	RunTestsInCategory("MemPool Thread Caches", &MemPoolManager_TestThreadCaches);
+	RunTestsInCategory("MemPool Budgets", &MemPoolManager_TestBudgets);
+	RunTestsInCategory("MemPool Budget Parsing", &MemPoolBudgets_RunTests);
+	RunTestsInCategory("MemPool Object Pool", &MemPoolObjectPool_RunTests);
+	RunTestsInCategory("MemPool Profiler", &MemPoolProfiler_RunTests);
+	RunTestsInCategory("MemPool Trace", &MemPoolTrace_RunTests);
 	RunTestsInCategory("Resource List", &ResourceList_RunTests);
+	RunTestsInCategory("Resource Residency", &ResourceResidency_RunTests);
+	RunTestsInCategory("Pixel World Resources", &PixelWorldResources_RunTests);
+	RunTestsInCategory("Texture Cache", &TextureCache_RunTests);
+	RunTestsInCategory("Native Filesystem", &NativeFilesystem_RunTests);
+	RunTestsInCategory("Pack Archive", &PackArchive_RunTests);
+	RunTestsInCategory("LZ4", &LZ4Utils_RunTests);
+	RunTestsInCategory("Scene Archetypes", &Archetype_RunTests);
+	RunTestsInCategory("Scene Entities", &Entity_RunTests);
+	RunTestsInCategory("Worker Pool", &WorkerPool_RunTests);
+	RunTestsInCategory("Async Read Queue", &AsyncReadQueue_RunTests);
 	RunTestsInCategory("Angle Normalisation", &Testing_RunAngleNormalisationTests);
 	RunTestsInCategory("Angle To Direction Vector", &Testing_RunAngleToDirectionVectorTests);
 	RunTestsInCategory("Direction Vector To Angle", &Testing_RunDirectionVectorToAngleTests);
@@ -193,7 +226,7 @@ bool Testing_ExpectTrue(bool result, const char* expression, const char* file, i
 	return RecordTestResult(result, expression, file, line);
 }
 
-bool Testing_RecordTestResult_ExpectFalse(bool result, const char* expression, const char* file, int line)
+bool Testing_ExpectFalse(bool result, const char* expression, const char* file, int line)
 {
 	return RecordTestResult(!result, expression, file, line);
 }
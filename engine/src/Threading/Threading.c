@@ -0,0 +1,258 @@
+// For clock_gettime().
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Threading/Threading.h"
+#include "Debugging.h"
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <process.h>
+
+static_assert(sizeof(SRWLOCK) <= sizeof(void*), "SRWLOCK does not fit in Threading_Mutex");
+static_assert(sizeof(CONDITION_VARIABLE) <= sizeof(void*), "CONDITION_VARIABLE does not fit in Threading_CondVar");
+#else
+#include <time.h>
+#endif
+
+typedef struct ThreadStartArgs
+{
+	Threading_ThreadFunc func;
+	void* userData;
+} ThreadStartArgs;
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+static unsigned __stdcall ThreadEntryPoint(void* arg)
+#else
+static void* ThreadEntryPoint(void* arg)
+#endif
+{
+	// Copy the args and free them before calling the function,
+	// in case the thread runs for the lifetime of the engine.
+	ThreadStartArgs args = *(ThreadStartArgs*)arg;
+	free(arg);
+
+	args.func(args.userData);
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	return 0;
+#else
+	return NULL;
+#endif
+}
+
+void Threading_Mutex_Init(Threading_Mutex* mutex)
+{
+	RAYGE_ASSERT_VALID(mutex);
+
+	if ( !mutex )
+	{
+		return;
+	}
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	InitializeSRWLock((PSRWLOCK)&mutex->srwLock);
+#else
+	const int result = pthread_mutex_init(&mutex->mutex, NULL);
+	RAYGE_ENSURE(result == 0, "Failed to initialise mutex (error %d)", result);
+#endif
+}
+
+void Threading_Mutex_Destroy(Threading_Mutex* mutex)
+{
+	RAYGE_ASSERT_VALID(mutex);
+
+	if ( !mutex )
+	{
+		return;
+	}
+
+#if RAYGE_PLATFORM() != RAYGE_PLATFORM_WINDOWS
+	pthread_mutex_destroy(&mutex->mutex);
+#endif
+
+	memset(mutex, 0, sizeof(*mutex));
+}
+
+void Threading_Mutex_Lock(Threading_Mutex* mutex)
+{
+	RAYGE_ASSERT_VALID(mutex);
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	AcquireSRWLockExclusive((PSRWLOCK)&mutex->srwLock);
+#else
+	pthread_mutex_lock(&mutex->mutex);
+#endif
+}
+
+void Threading_Mutex_Unlock(Threading_Mutex* mutex)
+{
+	RAYGE_ASSERT_VALID(mutex);
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	ReleaseSRWLockExclusive((PSRWLOCK)&mutex->srwLock);
+#else
+	pthread_mutex_unlock(&mutex->mutex);
+#endif
+}
+
+void Threading_CondVar_Init(Threading_CondVar* condVar)
+{
+	RAYGE_ASSERT_VALID(condVar);
+
+	if ( !condVar )
+	{
+		return;
+	}
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	InitializeConditionVariable((PCONDITION_VARIABLE)&condVar->conditionVariable);
+#else
+	const int result = pthread_cond_init(&condVar->cond, NULL);
+	RAYGE_ENSURE(result == 0, "Failed to initialise condition variable (error %d)", result);
+#endif
+}
+
+void Threading_CondVar_Destroy(Threading_CondVar* condVar)
+{
+	RAYGE_ASSERT_VALID(condVar);
+
+	if ( !condVar )
+	{
+		return;
+	}
+
+#if RAYGE_PLATFORM() != RAYGE_PLATFORM_WINDOWS
+	pthread_cond_destroy(&condVar->cond);
+#endif
+
+	memset(condVar, 0, sizeof(*condVar));
+}
+
+void Threading_CondVar_Wait(Threading_CondVar* condVar, Threading_Mutex* mutex)
+{
+	RAYGE_ASSERT_VALID(condVar);
+	RAYGE_ASSERT_VALID(mutex);
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	SleepConditionVariableSRW(
+		(PCONDITION_VARIABLE)&condVar->conditionVariable,
+		(PSRWLOCK)&mutex->srwLock,
+		INFINITE,
+		0
+	);
+#else
+	pthread_cond_wait(&condVar->cond, &mutex->mutex);
+#endif
+}
+
+void Threading_CondVar_Signal(Threading_CondVar* condVar)
+{
+	RAYGE_ASSERT_VALID(condVar);
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	WakeConditionVariable((PCONDITION_VARIABLE)&condVar->conditionVariable);
+#else
+	pthread_cond_signal(&condVar->cond);
+#endif
+}
+
+void Threading_CondVar_Broadcast(Threading_CondVar* condVar)
+{
+	RAYGE_ASSERT_VALID(condVar);
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	WakeAllConditionVariable((PCONDITION_VARIABLE)&condVar->conditionVariable);
+#else
+	pthread_cond_broadcast(&condVar->cond);
+#endif
+}
+
+bool Threading_Thread_Create(Threading_Thread* thread, Threading_ThreadFunc func, void* userData)
+{
+	RAYGE_ASSERT_VALID(thread);
+	RAYGE_ASSERT_VALID(func);
+
+	if ( !thread || !func )
+	{
+		return false;
+	}
+
+	memset(thread, 0, sizeof(*thread));
+
+	// This uses the system allocator, since the mem pool
+	// manager relies on threads for some of its tests.
+	ThreadStartArgs* args = (ThreadStartArgs*)malloc(sizeof(ThreadStartArgs));
+
+	if ( !args )
+	{
+		return false;
+	}
+
+	args->func = func;
+	args->userData = userData;
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	thread->handle = (void*)_beginthreadex(NULL, 0, &ThreadEntryPoint, args, 0, NULL);
+	thread->valid = thread->handle != NULL;
+#else
+	thread->valid = pthread_create(&thread->thread, NULL, &ThreadEntryPoint, args) == 0;
+#endif
+
+	if ( !thread->valid )
+	{
+		free(args);
+	}
+
+	return thread->valid;
+}
+
+void Threading_Thread_Join(Threading_Thread* thread)
+{
+	RAYGE_ASSERT_VALID(thread);
+
+	if ( !thread || !thread->valid )
+	{
+		return;
+	}
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	WaitForSingleObject((HANDLE)thread->handle, INFINITE);
+	CloseHandle((HANDLE)thread->handle);
+#else
+	pthread_join(thread->thread, NULL);
+#endif
+
+	memset(thread, 0, sizeof(*thread));
+}
+
+uint64_t Threading_GetTimeNs(void)
+{
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	static LARGE_INTEGER frequency;
+
+	if ( frequency.QuadPart == 0 )
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+
+	// Split to avoid overflowing when multiplying up to nanoseconds.
+	const uint64_t seconds = (uint64_t)(counter.QuadPart / frequency.QuadPart);
+	const uint64_t remainder = (uint64_t)(counter.QuadPart % frequency.QuadPart);
+
+	return (seconds * 1000000000ull) + ((remainder * 1000000000ull) / (uint64_t)frequency.QuadPart);
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t)now.tv_sec * 1000000000ull) + (uint64_t)now.tv_nsec;
+#endif
+}
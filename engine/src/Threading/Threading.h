@@ -0,0 +1,152 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "RayGE/Platform.h"
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+#include <intrin.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef _MSC_VER
+#define RAYGE_THREAD_LOCAL __declspec(thread)
+#else
+#define RAYGE_THREAD_LOCAL _Thread_local
+#endif
+
+// Windows headers are kept out of this file, since they clash with raylib.
+// The mutex just needs to be large enough to hold an SRWLOCK.
+typedef struct Threading_Mutex
+{
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	void* srwLock;
+#else
+	pthread_mutex_t mutex;
+#endif
+} Threading_Mutex;
+
+// As with the mutex, this just needs to be large enough to hold a CONDITION_VARIABLE.
+typedef struct Threading_CondVar
+{
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	void* conditionVariable;
+#else
+	pthread_cond_t cond;
+#endif
+} Threading_CondVar;
+
+typedef struct Threading_Thread
+{
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	void* handle;
+#else
+	pthread_t thread;
+#endif
+	bool valid;
+} Threading_Thread;
+
+typedef void (*Threading_ThreadFunc)(void* userData);
+
+void Threading_Mutex_Init(Threading_Mutex* mutex);
+void Threading_Mutex_Destroy(Threading_Mutex* mutex);
+void Threading_Mutex_Lock(Threading_Mutex* mutex);
+void Threading_Mutex_Unlock(Threading_Mutex* mutex);
+
+void Threading_CondVar_Init(Threading_CondVar* condVar);
+void Threading_CondVar_Destroy(Threading_CondVar* condVar);
+
+// The mutex must be locked by the caller. It is released while waiting,
+// and locked again before returning. Wakeups may be spurious, so the
+// caller should always re-check the condition it is waiting on.
+void Threading_CondVar_Wait(Threading_CondVar* condVar, Threading_Mutex* mutex);
+void Threading_CondVar_Signal(Threading_CondVar* condVar);
+void Threading_CondVar_Broadcast(Threading_CondVar* condVar);
+
+// Returns false if the thread could not be created.
+bool Threading_Thread_Create(Threading_Thread* thread, Threading_ThreadFunc func, void* userData);
+void Threading_Thread_Join(Threading_Thread* thread);
+
+// Returns a monotonic timestamp in nanoseconds, for measuring elapsed time.
+uint64_t Threading_GetTimeNs(void);
+
+// Atomic operations on size_t values. These are sequentially consistent.
+static inline size_t Threading_AtomicAddSize(volatile size_t* target, size_t value)
+{
+#ifdef _MSC_VER
+#if defined(_WIN64)
+	return (size_t)_InterlockedExchangeAdd64((volatile __int64*)target, (__int64)value) + value;
+#else
+	return (size_t)_InterlockedExchangeAdd((volatile long*)target, (long)value) + value;
+#endif
+#else
+	return __atomic_add_fetch(target, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline size_t Threading_AtomicSubSize(volatile size_t* target, size_t value)
+{
+	return Threading_AtomicAddSize(target, (size_t)0 - value);
+}
+
+static inline size_t Threading_AtomicLoadSize(const volatile size_t* target)
+{
+#ifdef _MSC_VER
+	// Aligned loads of pointer-sized values are atomic on all supported
+	// platforms, and volatile accesses are not reordered by MSVC.
+	return *target;
+#else
+	return __atomic_load_n(target, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void Threading_AtomicStoreSize(volatile size_t* target, size_t value)
+{
+#ifdef _MSC_VER
+	*target = value;
+#else
+	__atomic_store_n(target, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Returns the previous value.
+static inline size_t Threading_AtomicExchangeSize(volatile size_t* target, size_t value)
+{
+#ifdef _MSC_VER
+#if defined(_WIN64)
+	return (size_t)_InterlockedExchange64((volatile __int64*)target, (__int64)value);
+#else
+	return (size_t)_InterlockedExchange((volatile long*)target, (long)value);
+#endif
+#else
+	return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Returns true if the target held the expected value and was replaced.
+static inline bool Threading_AtomicCompareExchangeSize(volatile size_t* target, size_t expected, size_t value)
+{
+#ifdef _MSC_VER
+#if defined(_WIN64)
+	return (size_t)_InterlockedCompareExchange64((volatile __int64*)target, (__int64)value, (__int64)expected) ==
+		expected;
+#else
+	return (size_t)_InterlockedCompareExchange((volatile long*)target, (long)value, (long)expected) == expected;
+#endif
+#else
+	return __atomic_compare_exchange_n(target, &expected, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Raises the target to the given value if it is currently lower.
+static inline void Threading_AtomicMaxSize(volatile size_t* target, size_t value)
+{
+	size_t current = Threading_AtomicLoadSize(target);
+
+	while ( current < value && !Threading_AtomicCompareExchangeSize(target, current, value) )
+	{
+		current = Threading_AtomicLoadSize(target);
+	}
+}
@@ -0,0 +1,494 @@
+#include <string.h>
+#include "Threading/WorkerPool.h"
+#include "Threading/Threading.h"
+#include "Utils/Utils.h"
+#include "Debugging.h"
+
+#define MAX_WORKER_THREADS 16
+
+typedef struct Job
+{
+	struct Job* next;
+	WorkerPool_JobFunc jobFunc;
+	WorkerPool_CompleteFunc completeFunc;
+	void* userData;
+} Job;
+
+// Jobs are appended at the tail and taken from the head.
+typedef struct JobQueue
+{
+	Job* head;
+	Job* tail;
+} JobQueue;
+
+struct WorkerPool
+{
+	MemPool_Category category;
+
+	// Guards the queues, the running count and the shutdown flag.
+	Threading_Mutex lock;
+	Threading_CondVar jobAvailable;
+	Threading_CondVar allJobsFinished;
+	JobQueue pending;
+	JobQueue completed;
+	size_t numRunning;
+	bool shuttingDown;
+
+	// Only accessed by the thread that owns the pool.
+	size_t numOutstanding;
+
+	size_t numThreads;
+	Threading_Thread threads[];
+};
+
+static void PushJob(JobQueue* queue, Job* job)
+{
+	job->next = NULL;
+
+	if ( queue->tail )
+	{
+		queue->tail->next = job;
+	}
+	else
+	{
+		queue->head = job;
+	}
+
+	queue->tail = job;
+}
+
+static Job* PopJob(JobQueue* queue)
+{
+	Job* job = queue->head;
+
+	if ( job )
+	{
+		queue->head = job->next;
+
+		if ( !queue->head )
+		{
+			queue->tail = NULL;
+		}
+
+		job->next = NULL;
+	}
+
+	return job;
+}
+
+static void CompleteJob(WorkerPool* pool, Job* job, bool wasCancelled)
+{
+	if ( job->completeFunc )
+	{
+		job->completeFunc(job->userData, wasCancelled);
+	}
+
+	MEMPOOL_FREE(job);
+	--pool->numOutstanding;
+}
+
+static void WorkerThreadFunc(void* userData)
+{
+	WorkerPool* pool = (WorkerPool*)userData;
+
+	Threading_Mutex_Lock(&pool->lock);
+
+	while ( true )
+	{
+		while ( !pool->pending.head && !pool->shuttingDown )
+		{
+			Threading_CondVar_Wait(&pool->jobAvailable, &pool->lock);
+		}
+
+		// Any jobs that have not started yet are cancelled by the pool's owner.
+		if ( pool->shuttingDown )
+		{
+			break;
+		}
+
+		Job* job = PopJob(&pool->pending);
+		++pool->numRunning;
+		Threading_Mutex_Unlock(&pool->lock);
+
+		job->jobFunc(job->userData);
+
+		Threading_Mutex_Lock(&pool->lock);
+		PushJob(&pool->completed, job);
+		--pool->numRunning;
+
+		if ( !pool->pending.head && pool->numRunning < 1 )
+		{
+			Threading_CondVar_Broadcast(&pool->allJobsFinished);
+		}
+	}
+
+	Threading_Mutex_Unlock(&pool->lock);
+}
+
+WorkerPool* WorkerPool_Create(MemPool_Category category, size_t numThreads)
+{
+	RAYGE_ASSERT(numThreads > 0, "Expected at least one worker thread");
+
+	if ( numThreads < 1 )
+	{
+		return NULL;
+	}
+
+	if ( numThreads > MAX_WORKER_THREADS )
+	{
+		numThreads = MAX_WORKER_THREADS;
+	}
+
+	WorkerPool* pool =
+		(WorkerPool*)MEMPOOL_CALLOC(category, 1, sizeof(WorkerPool) + (numThreads * sizeof(Threading_Thread)));
+
+	pool->category = category;
+	Threading_Mutex_Init(&pool->lock);
+	Threading_CondVar_Init(&pool->jobAvailable);
+	Threading_CondVar_Init(&pool->allJobsFinished);
+
+	for ( size_t index = 0; index < numThreads; ++index )
+	{
+		if ( !Threading_Thread_Create(&pool->threads[index], &WorkerThreadFunc, pool) )
+		{
+			break;
+		}
+
+		++pool->numThreads;
+	}
+
+	if ( pool->numThreads < 1 )
+	{
+		WorkerPool_Destroy(pool);
+		return NULL;
+	}
+
+	return pool;
+}
+
+void WorkerPool_Destroy(WorkerPool* pool)
+{
+	RAYGE_ASSERT_VALID(pool);
+
+	if ( !pool )
+	{
+		return;
+	}
+
+	Threading_Mutex_Lock(&pool->lock);
+	pool->shuttingDown = true;
+	Threading_CondVar_Broadcast(&pool->jobAvailable);
+	Threading_Mutex_Unlock(&pool->lock);
+
+	for ( size_t index = 0; index < pool->numThreads; ++index )
+	{
+		Threading_Thread_Join(&pool->threads[index]);
+	}
+
+	// All threads have exited, so the queues no longer need to be locked.
+	Job* job = NULL;
+
+	while ( (job = PopJob(&pool->completed)) != NULL )
+	{
+		CompleteJob(pool, job, false);
+	}
+
+	while ( (job = PopJob(&pool->pending)) != NULL )
+	{
+		CompleteJob(pool, job, true);
+	}
+
+	RAYGE_ASSERT(pool->numOutstanding == 0, "Worker pool still had outstanding jobs after being destroyed");
+
+	Threading_CondVar_Destroy(&pool->allJobsFinished);
+	Threading_CondVar_Destroy(&pool->jobAvailable);
+	Threading_Mutex_Destroy(&pool->lock);
+	MEMPOOL_FREE(pool);
+}
+
+bool WorkerPool_Submit(
+	WorkerPool* pool,
+	WorkerPool_JobFunc jobFunc,
+	WorkerPool_CompleteFunc completeFunc,
+	void* userData
+)
+{
+	RAYGE_ASSERT_VALID(pool);
+	RAYGE_ASSERT_VALID(jobFunc);
+
+	if ( !pool || !jobFunc )
+	{
+		return false;
+	}
+
+	Job* job = MEMPOOL_CALLOC_STRUCT(pool->category, Job);
+	job->jobFunc = jobFunc;
+	job->completeFunc = completeFunc;
+	job->userData = userData;
+
+	++pool->numOutstanding;
+
+	Threading_Mutex_Lock(&pool->lock);
+	PushJob(&pool->pending, job);
+	Threading_CondVar_Signal(&pool->jobAvailable);
+	Threading_Mutex_Unlock(&pool->lock);
+
+	return true;
+}
+
+size_t WorkerPool_ProcessCompleted(WorkerPool* pool, uint64_t budgetNs)
+{
+	RAYGE_ASSERT_VALID(pool);
+
+	if ( !pool )
+	{
+		return 0;
+	}
+
+	const uint64_t startNs = Threading_GetTimeNs();
+	size_t numProcessed = 0;
+
+	do
+	{
+		Threading_Mutex_Lock(&pool->lock);
+		Job* job = PopJob(&pool->completed);
+		Threading_Mutex_Unlock(&pool->lock);
+
+		if ( !job )
+		{
+			break;
+		}
+
+		CompleteJob(pool, job, false);
+		++numProcessed;
+	}
+	while ( budgetNs == 0 || Threading_GetTimeNs() - startNs < budgetNs );
+
+	return numProcessed;
+}
+
+size_t WorkerPool_WaitForAll(WorkerPool* pool)
+{
+	RAYGE_ASSERT_VALID(pool);
+
+	if ( !pool )
+	{
+		return 0;
+	}
+
+	Threading_Mutex_Lock(&pool->lock);
+
+	while ( pool->pending.head || pool->numRunning > 0 )
+	{
+		Threading_CondVar_Wait(&pool->allJobsFinished, &pool->lock);
+	}
+
+	Threading_Mutex_Unlock(&pool->lock);
+
+	return WorkerPool_ProcessCompleted(pool, 0);
+}
+
+size_t WorkerPool_NumOutstandingJobs(const WorkerPool* pool)
+{
+	RAYGE_ASSERT_VALID(pool);
+	return pool ? pool->numOutstanding : 0;
+}
+
+#if RAYGE_BUILD_TESTING()
+#define TEST_NUM_JOBS 64
+#define TEST_TIMEOUT_NS (10ull * 1000000000ull)
+
+typedef struct TestJob
+{
+	size_t input;
+	size_t output;
+	size_t* numCompleted;
+	bool wasCancelled;
+} TestJob;
+
+typedef struct BlockingJob
+{
+	WorkerPool* pool;
+	volatile size_t started;
+} BlockingJob;
+
+static void RunTestJob(void* userData)
+{
+	TestJob* job = (TestJob*)userData;
+	job->output = job->input * job->input;
+}
+
+static void CompleteTestJob(void* userData, bool wasCancelled)
+{
+	TestJob* job = (TestJob*)userData;
+	job->wasCancelled = wasCancelled;
+
+	// Completion functions are only called on the processing thread,
+	// so this does not need to be atomic. Tests are run on a single thread.
+	++(*job->numCompleted);
+}
+
+static void RunBlockingJob(void* userData)
+{
+	BlockingJob* job = (BlockingJob*)userData;
+	Threading_AtomicStoreSize(&job->started, 1);
+
+	// Hold up the only worker until the pool is being destroyed.
+	bool shuttingDown = false;
+
+	while ( !shuttingDown )
+	{
+		Threading_Mutex_Lock(&job->pool->lock);
+		shuttingDown = job->pool->shuttingDown;
+		Threading_Mutex_Unlock(&job->pool->lock);
+	}
+}
+
+static void TestJobsAreCompleted(void)
+{
+	WorkerPool* pool = WorkerPool_Create(MEMPOOL_TEST_MANAGER, 4);
+
+	if ( !TEST_EXPECT_TRUE(pool) )
+	{
+		return;
+	}
+
+	TestJob jobs[TEST_NUM_JOBS];
+	size_t numCompleted = 0;
+
+	memset(jobs, 0, sizeof(jobs));
+
+	for ( size_t index = 0; index < TEST_NUM_JOBS; ++index )
+	{
+		jobs[index].input = index;
+		jobs[index].numCompleted = &numCompleted;
+
+		WorkerPool_Submit(pool, &RunTestJob, &CompleteTestJob, &jobs[index]);
+	}
+
+	TEST_EXPECT_EQL_INT(WorkerPool_NumOutstandingJobs(pool), TEST_NUM_JOBS);
+
+	const uint64_t startNs = Threading_GetTimeNs();
+
+	while ( WorkerPool_NumOutstandingJobs(pool) > 0 && Threading_GetTimeNs() - startNs < TEST_TIMEOUT_NS )
+	{
+		WorkerPool_ProcessCompleted(pool, 0);
+	}
+
+	TEST_EXPECT_EQL_INT(numCompleted, TEST_NUM_JOBS);
+	TEST_EXPECT_EQL_INT(WorkerPool_NumOutstandingJobs(pool), 0);
+
+	size_t failures = 0;
+
+	for ( size_t index = 0; index < TEST_NUM_JOBS; ++index )
+	{
+		if ( jobs[index].output != index * index || jobs[index].wasCancelled )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+
+	WorkerPool_Destroy(pool);
+}
+
+static void TestWaitForAll(void)
+{
+	WorkerPool* pool = WorkerPool_Create(MEMPOOL_TEST_MANAGER, 2);
+
+	if ( !TEST_EXPECT_TRUE(pool) )
+	{
+		return;
+	}
+
+	TestJob jobs[TEST_NUM_JOBS];
+	size_t numCompleted = 0;
+
+	memset(jobs, 0, sizeof(jobs));
+
+	for ( size_t index = 0; index < TEST_NUM_JOBS; ++index )
+	{
+		jobs[index].input = index;
+		jobs[index].numCompleted = &numCompleted;
+
+		WorkerPool_Submit(pool, &RunTestJob, &CompleteTestJob, &jobs[index]);
+	}
+
+	TEST_EXPECT_EQL_INT(WorkerPool_WaitForAll(pool), TEST_NUM_JOBS);
+	TEST_EXPECT_EQL_INT(numCompleted, TEST_NUM_JOBS);
+	TEST_EXPECT_EQL_INT(WorkerPool_NumOutstandingJobs(pool), 0);
+
+	size_t failures = 0;
+
+	for ( size_t index = 0; index < TEST_NUM_JOBS; ++index )
+	{
+		if ( jobs[index].output != index * index || jobs[index].wasCancelled )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+
+	// With nothing submitted, this should return straight away.
+	TEST_EXPECT_EQL_INT(WorkerPool_WaitForAll(pool), 0);
+
+	WorkerPool_Destroy(pool);
+}
+
+static void TestDestroyCancelsPendingJobs(void)
+{
+	WorkerPool* pool = WorkerPool_Create(MEMPOOL_TEST_MANAGER, 1);
+
+	if ( !TEST_EXPECT_TRUE(pool) )
+	{
+		return;
+	}
+
+	BlockingJob blocker;
+	memset(&blocker, 0, sizeof(blocker));
+	blocker.pool = pool;
+
+	TestJob jobs[4];
+	size_t numCompleted = 0;
+
+	memset(jobs, 0, sizeof(jobs));
+
+	WorkerPool_Submit(pool, &RunBlockingJob, NULL, &blocker);
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(jobs); ++index )
+	{
+		jobs[index].numCompleted = &numCompleted;
+		WorkerPool_Submit(pool, &RunTestJob, &CompleteTestJob, &jobs[index]);
+	}
+
+	// Make sure the blocker is running, so that the other jobs are stuck behind it.
+	while ( !Threading_AtomicLoadSize(&blocker.started) )
+	{
+	}
+
+	WorkerPool_Destroy(pool);
+
+	TEST_EXPECT_EQL_INT(numCompleted, RAYGE_ARRAY_SIZE(jobs));
+
+	size_t failures = 0;
+
+	for ( size_t index = 0; index < RAYGE_ARRAY_SIZE(jobs); ++index )
+	{
+		if ( !jobs[index].wasCancelled )
+		{
+			++failures;
+		}
+	}
+
+	TEST_EXPECT_EQL_INT(failures, 0);
+}
+
+void WorkerPool_RunTests(void)
+{
+	TestJobsAreCompleted();
+	TestWaitForAll();
+	TestDestroyCancelsPendingJobs();
+}
+#endif
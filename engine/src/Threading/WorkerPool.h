@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "MemPool/MemPoolManager.h"
+#include "Testing/Testing.h"
+#include "wzl_cutl/attributes.h"
+
+// A fixed set of threads which run jobs in the order they were submitted.
+// Once a job has run, its completion function is called on whichever thread
+// processes completed jobs (normally the main thread), so that any results
+// can be handed over to systems which are not thread-safe.
+typedef struct WorkerPool WorkerPool;
+
+// Called on a worker thread.
+typedef void (*WorkerPool_JobFunc)(void* userData);
+
+// Called on the thread that processes completed jobs. If the pool was
+// destroyed before the job got a chance to run, wasCancelled is true.
+// This is always called exactly once per submitted job, so it is the
+// place to free any data associated with the job.
+typedef void (*WorkerPool_CompleteFunc)(void* userData, bool wasCancelled);
+
+// Job bookkeeping is allocated from the given category.
+WZL_ATTR_NODISCARD WorkerPool* WorkerPool_Create(MemPool_Category category, size_t numThreads);
+
+// Waits for any running jobs to finish, and calls the completion function
+// for all outstanding jobs before returning.
+void WorkerPool_Destroy(WorkerPool* pool);
+
+// Returns false if the job could not be queued.
+bool WorkerPool_Submit(
+	WorkerPool* pool,
+	WorkerPool_JobFunc jobFunc,
+	WorkerPool_CompleteFunc completeFunc,
+	void* userData
+);
+
+// Calls completion functions for finished jobs until none are left, or until the
+// given time budget is used up. At least one job is always processed if any are
+// ready, so that progress is made. A budget of zero means unlimited.
+// Returns the number of jobs that were processed.
+size_t WorkerPool_ProcessCompleted(WorkerPool* pool, uint64_t budgetNs);
+
+// Blocks until every job that has been submitted so far has run, and then
+// calls all outstanding completion functions. Must be called on the thread
+// that processes completed jobs. Returns the number of jobs that were processed.
+size_t WorkerPool_WaitForAll(WorkerPool* pool);
+
+// Returns the number of jobs which have been submitted
+// but whose completion functions have not yet been called.
+size_t WorkerPool_NumOutstandingJobs(const WorkerPool* pool);
+
+#if RAYGE_BUILD_TESTING()
+void WorkerPool_RunTests(void);
+#endif
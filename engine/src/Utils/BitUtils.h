@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Returns the index of the lowest set bit. The value must not be zero.
+static inline uint32_t BitUtils_CountTrailingZeros64(uint64_t value)
+{
+#ifdef _MSC_VER
+	unsigned long index = 0;
+
+#if defined(_WIN64)
+	_BitScanForward64(&index, value);
+#else
+	if ( !_BitScanForward(&index, (unsigned long)value) )
+	{
+		_BitScanForward(&index, (unsigned long)(value >> 32));
+		index += 32;
+	}
+#endif
+
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+// Returns the number of set bits.
+static inline uint32_t BitUtils_PopCount64(uint64_t value)
+{
+#ifdef _MSC_VER
+	value = value - ((value >> 1) & 0x5555555555555555ULL);
+	value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (uint32_t)((value * 0x0101010101010101ULL) >> 56);
+#else
+	return (uint32_t)__builtin_popcountll(value);
+#endif
+}
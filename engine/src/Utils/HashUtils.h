@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Fast non-cryptographic hashing, for identifying data rather than protecting it.
+// Input is consumed eight bytes at a time, in the style of xxHash64's single lane.
+
+#define HASHUTILS_PRIME_1 0x9E3779B185EBCA87ull
+#define HASHUTILS_PRIME_2 0xC2B2AE3D27D4EB4Full
+
+static inline uint64_t HashUtils_RotateLeft64(uint64_t value, uint32_t bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+// Spreads the bits of the value so that small differences in input
+// produce large differences in output.
+static inline uint64_t HashUtils_Mix64(uint64_t value)
+{
+	value ^= value >> 33;
+	value *= 0xFF51AFD7ED558CCDull;
+	value ^= value >> 33;
+	value *= 0xC4CEB9FE1A85EC53ull;
+	value ^= value >> 33;
+	return value;
+}
+
+static inline uint64_t HashUtils_Hash64(const void* data, size_t length, uint64_t seed)
+{
+	const uint8_t* bytes = (const uint8_t*)data;
+	uint64_t hash = seed ^ ((uint64_t)length * HASHUTILS_PRIME_1);
+
+	while ( length >= sizeof(uint64_t) )
+	{
+		uint64_t word;
+		memcpy(&word, bytes, sizeof(word));
+
+		hash ^= HashUtils_RotateLeft64(word * HASHUTILS_PRIME_2, 31) * HASHUTILS_PRIME_1;
+		hash = (HashUtils_RotateLeft64(hash, 27) * HASHUTILS_PRIME_1) + HASHUTILS_PRIME_2;
+
+		bytes += sizeof(word);
+		length -= sizeof(word);
+	}
+
+	if ( length > 0 )
+	{
+		uint64_t word = 0;
+		memcpy(&word, bytes, length);
+
+		hash ^= HashUtils_RotateLeft64(word * HASHUTILS_PRIME_2, 31) * HASHUTILS_PRIME_1;
+	}
+
+	return HashUtils_Mix64(hash);
+}
@@ -0,0 +1,340 @@
+#include <stdint.h>
+#include <string.h>
+#include "Utils/LZ4Utils.h"
+
+// Each sequence in a block is a token byte, whose high nibble is the number of
+// literals and whose low nibble is the match length minus LZ4_MIN_MATCH. A nibble
+// of 15 is followed by extra length bytes, which are summed until one is not 255.
+// The literals are followed by a two byte little-endian offset back into the
+// output, and then any extra match length bytes. The final sequence only has
+// literals.
+#define LZ4_MIN_MATCH 4
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_TOKEN_MAX 15
+#define LZ4_EXTRA_LENGTH_MAX 255
+
+// The specification requires the last five bytes of a block to be literals,
+// and the last match to begin at least twelve bytes before the end.
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_FIND_LIMIT 12
+
+#define LZ4_HASH_BITS 12
+
+static uint32_t Read32(const uint8_t* data)
+{
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static uint32_t HashSequence(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+static uint8_t* WriteExtraLength(uint8_t* output, size_t length)
+{
+	while ( length >= LZ4_EXTRA_LENGTH_MAX )
+	{
+		*(output++) = LZ4_EXTRA_LENGTH_MAX;
+		length -= LZ4_EXTRA_LENGTH_MAX;
+	}
+
+	*(output++) = (uint8_t)length;
+	return output;
+}
+
+// If matchLength is 0, this is the last sequence, which has no match.
+static uint8_t* WriteSequence(
+	uint8_t* output,
+	const uint8_t* literals,
+	size_t numLiterals,
+	size_t offset,
+	size_t matchLength
+)
+{
+	uint8_t* token = output++;
+	*token = (uint8_t)((numLiterals < LZ4_TOKEN_MAX ? numLiterals : LZ4_TOKEN_MAX) << 4);
+
+	if ( numLiterals >= LZ4_TOKEN_MAX )
+	{
+		output = WriteExtraLength(output, numLiterals - LZ4_TOKEN_MAX);
+	}
+
+	memcpy(output, literals, numLiterals);
+	output += numLiterals;
+
+	if ( matchLength == 0 )
+	{
+		return output;
+	}
+
+	output[0] = (uint8_t)(offset & 0xFF);
+	output[1] = (uint8_t)(offset >> 8);
+	output += 2;
+
+	const size_t lengthCode = matchLength - LZ4_MIN_MATCH;
+	*token |= (uint8_t)(lengthCode < LZ4_TOKEN_MAX ? lengthCode : LZ4_TOKEN_MAX);
+
+	if ( lengthCode >= LZ4_TOKEN_MAX )
+	{
+		output = WriteExtraLength(output, lengthCode - LZ4_TOKEN_MAX);
+	}
+
+	return output;
+}
+
+// Advances the cursor past the extra length bytes, adding them to the length.
+static bool ReadExtraLength(const uint8_t** cursor, const uint8_t* end, size_t* length)
+{
+	uint8_t byte;
+
+	do
+	{
+		if ( *cursor >= end )
+		{
+			return false;
+		}
+
+		byte = *((*cursor)++);
+
+		if ( *length > SIZE_MAX - byte )
+		{
+			return false;
+		}
+
+		*length += byte;
+	}
+	while ( byte == LZ4_EXTRA_LENGTH_MAX );
+
+	return true;
+}
+
+size_t LZ4Utils_CompressBound(size_t inputSize)
+{
+	return inputSize + (inputSize / LZ4_EXTRA_LENGTH_MAX) + 16;
+}
+
+size_t LZ4Utils_Compress(const void* input, size_t inputSize, void* output, size_t outputCapacity)
+{
+	if ( (!input && inputSize > 0) || !output || inputSize > UINT32_MAX ||
+		 outputCapacity < LZ4Utils_CompressBound(inputSize) )
+	{
+		return 0;
+	}
+
+	const uint8_t* in = (const uint8_t*)input;
+	uint8_t* out = (uint8_t*)output;
+
+	// Most recent position at which each hashed sequence of four bytes was seen.
+	// Positions are always checked against the input, so stale entries are harmless.
+	uint32_t table[1 << LZ4_HASH_BITS];
+	memset(table, 0, sizeof(table));
+
+	size_t anchor = 0;
+	size_t position = 0;
+
+	if ( inputSize > LZ4_MATCH_FIND_LIMIT )
+	{
+		const size_t searchEnd = inputSize - LZ4_MATCH_FIND_LIMIT;
+		const size_t matchEnd = inputSize - LZ4_LAST_LITERALS;
+
+		while ( position <= searchEnd )
+		{
+			const uint32_t sequence = Read32(in + position);
+			const uint32_t hash = HashSequence(sequence);
+			const size_t candidate = table[hash];
+
+			table[hash] = (uint32_t)position;
+
+			if ( candidate >= position || position - candidate > LZ4_MAX_OFFSET || Read32(in + candidate) != sequence )
+			{
+				++position;
+				continue;
+			}
+
+			size_t matchLength = LZ4_MIN_MATCH;
+
+			while ( position + matchLength < matchEnd && in[candidate + matchLength] == in[position + matchLength] )
+			{
+				++matchLength;
+			}
+
+			out = WriteSequence(out, in + anchor, position - anchor, position - candidate, matchLength);
+			position += matchLength;
+			anchor = position;
+		}
+	}
+
+	out = WriteSequence(out, in + anchor, inputSize - anchor, 0, 0);
+	return (size_t)(out - (uint8_t*)output);
+}
+
+bool LZ4Utils_Decompress(const void* input, size_t inputSize, void* output, size_t outputSize)
+{
+	if ( (!input && inputSize > 0) || (!output && outputSize > 0) )
+	{
+		return false;
+	}
+
+	const uint8_t* in = (const uint8_t*)input;
+	const uint8_t* const inEnd = in + inputSize;
+	uint8_t* const outBegin = (uint8_t*)output;
+	uint8_t* const outEnd = outBegin + outputSize;
+	uint8_t* out = outBegin;
+
+	while ( in < inEnd )
+	{
+		const uint8_t token = *(in++);
+		size_t numLiterals = token >> 4;
+
+		if ( numLiterals == LZ4_TOKEN_MAX && !ReadExtraLength(&in, inEnd, &numLiterals) )
+		{
+			return false;
+		}
+
+		if ( numLiterals > (size_t)(inEnd - in) || numLiterals > (size_t)(outEnd - out) )
+		{
+			return false;
+		}
+
+		memcpy(out, in, numLiterals);
+		in += numLiterals;
+		out += numLiterals;
+
+		if ( in == inEnd )
+		{
+			// This was the last sequence.
+			break;
+		}
+
+		if ( inEnd - in < 2 )
+		{
+			return false;
+		}
+
+		const size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+		in += 2;
+
+		if ( offset == 0 || offset > (size_t)(out - outBegin) )
+		{
+			return false;
+		}
+
+		size_t matchLength = token & LZ4_TOKEN_MAX;
+
+		if ( matchLength == LZ4_TOKEN_MAX && !ReadExtraLength(&in, inEnd, &matchLength) )
+		{
+			return false;
+		}
+
+		matchLength += LZ4_MIN_MATCH;
+
+		if ( matchLength > (size_t)(outEnd - out) )
+		{
+			return false;
+		}
+
+		const uint8_t* match = out - offset;
+
+		if ( offset >= matchLength )
+		{
+			memcpy(out, match, matchLength);
+			out += matchLength;
+		}
+		else
+		{
+			// The match overlaps the bytes being written, which repeats them.
+			for ( size_t index = 0; index < matchLength; ++index )
+			{
+				*(out++) = *(match++);
+			}
+		}
+	}
+
+	return out == outEnd;
+}
+
+#if RAYGE_BUILD_TESTING()
+#define TEST_BUFFER_SIZE 4096
+
+static bool RoundTrip(const uint8_t* input, size_t inputSize)
+{
+	uint8_t compressed[TEST_BUFFER_SIZE + (TEST_BUFFER_SIZE / 255) + 16];
+	uint8_t decompressed[TEST_BUFFER_SIZE];
+
+	const size_t compressedSize = LZ4Utils_Compress(input, inputSize, compressed, sizeof(compressed));
+
+	return compressedSize > 0 && LZ4Utils_Decompress(compressed, compressedSize, decompressed, inputSize) &&
+		memcmp(input, decompressed, inputSize) == 0;
+}
+
+static void TestRoundTrip(void)
+{
+	static uint8_t input[TEST_BUFFER_SIZE];
+	uint32_t state = 12345;
+
+	// Pseudo-random data will not compress, and should be stored as literals.
+	for ( size_t index = 0; index < sizeof(input); ++index )
+	{
+		state = (state * 1103515245u) + 12345u;
+		input[index] = (uint8_t)(state >> 16);
+	}
+
+	TEST_EXPECT_TRUE(RoundTrip(input, sizeof(input)));
+	TEST_EXPECT_TRUE(RoundTrip(input, 0));
+	TEST_EXPECT_TRUE(RoundTrip(input, 1));
+	TEST_EXPECT_TRUE(RoundTrip(input, LZ4_MATCH_FIND_LIMIT + 1));
+
+	// Repeated runs produce overlapping matches, and long lengths.
+	memset(input, 'a', sizeof(input));
+	TEST_EXPECT_TRUE(RoundTrip(input, sizeof(input)));
+
+	for ( size_t index = 0; index < sizeof(input); ++index )
+	{
+		input[index] = (uint8_t)("RayGE texture "[index % 14]);
+	}
+
+	TEST_EXPECT_TRUE(RoundTrip(input, sizeof(input)));
+
+	uint8_t compressed[TEST_BUFFER_SIZE + (TEST_BUFFER_SIZE / 255) + 16];
+	const size_t compressedSize = LZ4Utils_Compress(input, sizeof(input), compressed, sizeof(compressed));
+	TEST_EXPECT_TRUE(compressedSize > 0 && compressedSize < sizeof(input) / 10);
+
+	// Too small an output buffer is refused up front.
+	TEST_EXPECT_EQL_INT(LZ4Utils_Compress(input, sizeof(input), compressed, sizeof(input)), 0);
+}
+
+static void TestMalformedInputIsRejected(void)
+{
+	uint8_t output[32];
+
+	// Match offset pointing before the start of the output.
+	const uint8_t badOffset[] = {0x14, 'a', 0x02, 0x00, 0x50, 'a', 'b', 'c', 'd', 'e'};
+	TEST_EXPECT_FALSE(LZ4Utils_Decompress(badOffset, sizeof(badOffset), output, 10));
+
+	// Zero offset.
+	const uint8_t zeroOffset[] = {0x10, 'a', 0x00, 0x00};
+	TEST_EXPECT_FALSE(LZ4Utils_Decompress(zeroOffset, sizeof(zeroOffset), output, 5));
+
+	// Literals running past the end of the input.
+	const uint8_t truncatedLiterals[] = {0x50, 'a', 'b'};
+	TEST_EXPECT_FALSE(LZ4Utils_Decompress(truncatedLiterals, sizeof(truncatedLiterals), output, 5));
+
+	// Extra length bytes running past the end of the input.
+	const uint8_t truncatedLength[] = {0xF0, 0xFF};
+	TEST_EXPECT_FALSE(LZ4Utils_Decompress(truncatedLength, sizeof(truncatedLength), output, sizeof(output)));
+
+	// Valid block, but decompressing to the wrong size.
+	const uint8_t valid[] = {0x50, 'a', 'b', 'c', 'd', 'e'};
+	TEST_EXPECT_TRUE(LZ4Utils_Decompress(valid, sizeof(valid), output, 5));
+	TEST_EXPECT_FALSE(LZ4Utils_Decompress(valid, sizeof(valid), output, 4));
+	TEST_EXPECT_FALSE(LZ4Utils_Decompress(valid, sizeof(valid), output, 6));
+}
+
+void LZ4Utils_RunTests(void)
+{
+	TestRoundTrip();
+	TestMalformedInputIsRejected();
+}
+#endif
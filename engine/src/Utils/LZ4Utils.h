@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "Testing/Testing.h"
+
+// Compression and decompression of raw LZ4 blocks, as described by the LZ4 block
+// format specification. Frames, checksums and dictionaries are not supported,
+// since the size of the original data is always stored alongside the block.
+//
+// Neither function allocates memory, so both may be called from any thread.
+// This file is also built into tools which do not link against the engine.
+
+// Returns the size of output buffer that compression may require in the worst case.
+size_t LZ4Utils_CompressBound(size_t inputSize);
+
+// Returns the size of the compressed block, or 0 if the output buffer is smaller
+// than LZ4Utils_CompressBound(inputSize), or the input is larger than 4GB.
+// Compression is greedy, favouring speed over ratio.
+size_t LZ4Utils_Compress(const void* input, size_t inputSize, void* output, size_t outputCapacity);
+
+// Returns true only if the block was valid and decompressed to exactly outputSize bytes.
+// Malformed input never causes reads or writes outside of the buffers.
+bool LZ4Utils_Decompress(const void* input, size_t inputSize, void* output, size_t outputSize);
+
+#if RAYGE_BUILD_TESTING()
+void LZ4Utils_RunTests(void);
+#endif
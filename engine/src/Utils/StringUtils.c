@@ -36,3 +36,17 @@ char* StringUtils_TrimString(MemPool_Category memPool, const char* str)
 	out[size - 1] = '\0';
 	return out;
 }
+
+char* StringUtils_Duplicate(MemPool_Category memPool, const char* str)
+{
+	if ( !str )
+	{
+		return NULL;
+	}
+
+	const size_t size = strlen(str) + 1;
+	char* out = MEMPOOL_MALLOC(memPool, size);
+
+	memcpy(out, str, size);
+	return out;
+}
@@ -13,3 +13,6 @@ StringBounds StringUtils_GetStringTrimBounds(const char* str);
 
 // Caller is responsible for freeing
 WZL_ATTR_NODISCARD char* StringUtils_TrimString(MemPool_Category memPool, const char* str);
+
+// Caller is responsible for freeing
+WZL_ATTR_NODISCARD char* StringUtils_Duplicate(MemPool_Category memPool, const char* str);
@@ -7,8 +7,8 @@ static void Game_ShutDown(void);
 static void Scene_Begin(void);
 static void Scene_End(void);
 
-static const RayGE_Engine_API_V1* g_EngineAPI = NULL;
-static const RayGE_GameLib_Callbacks_V1 g_Callbacks = {
+static const RayGE_Engine_API_V3* g_EngineAPI = NULL;
+static const RayGE_GameLib_Callbacks_V3 g_Callbacks = {
 	// Game
 	{
 		Game_StartUp,
@@ -36,6 +36,51 @@ static void Game_ShutDown(void)
 	g_EngineAPI->log.PrintLine(RAYGE_LOG_INFO, "Sanity test: Game_ShutDown()");
 }
 
+static void LogSpatialEntities(void)
+{
+	RayGE_ComponentSpan spans[8];
+	const size_t numSpans = g_EngineAPI->sceneBulk.GetComponentSpans(
+		RAYGE_COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL),
+		spans,
+		sizeof(spans) / sizeof(spans[0])
+	);
+
+	size_t numEntities = 0;
+
+	for ( size_t index = 0; index < numSpans && index < sizeof(spans) / sizeof(spans[0]); ++index )
+	{
+		numEntities += spans[index].count;
+	}
+
+	g_EngineAPI->log.PrintLine(
+		RAYGE_LOG_INFO,
+		"Sanity test: Scene has %zu spatial entities in %zu spans",
+		numEntities,
+		numSpans
+	);
+}
+
+static void SpawnMarkerEntities(void)
+{
+	RayGE_EntityTemplate markerTemplate = {0};
+	markerTemplate.components = RAYGE_COMPONENT_MASK_BIT(RAYGE_COMPONENTTYPE_SPATIAL);
+	markerTemplate.spatial.position.z = 5.0f;
+
+	RayGE_ResourceHandle markers[8];
+	const size_t numMarkers = g_EngineAPI->sceneBulk.CreateEntitiesFromTemplate(
+		&markerTemplate,
+		sizeof(markers) / sizeof(markers[0]),
+		markers
+	);
+
+	g_EngineAPI->log.PrintLine(RAYGE_LOG_INFO, "Sanity test: Spawned %zu marker entities", numMarkers);
+
+	for ( size_t index = 0; index < numMarkers; ++index )
+	{
+		g_EngineAPI->scene.GetSpatialComponent(markers[index])->position.x = 2.0f * (float)index;
+	}
+}
+
 static void Scene_Begin(void)
 {
 	g_EngineAPI->log.PrintLine(RAYGE_LOG_INFO, "Sanity test: Scene_Begin()");
@@ -65,6 +110,9 @@ static void Scene_Begin(void)
 	camera->fieldOfView = 80.0f;
 
 	g_PixelWorld = g_EngineAPI->resources.LoadPixelWorld("pixelworld.json");
+
+	SpawnMarkerEntities();
+	LogSpatialEntities();
 }
 
 static void Scene_End(void)
@@ -81,14 +129,14 @@ GAMELIB_SANITYTEST_PUBLIC(void) RayGE_GameLibrary_ExchangeAPIs(RayGE_Engine_GetA
 	}
 
 	uint16_t actualVersion = 0;
-	g_EngineAPI = getEngineAPIFunc(RAYGE_ENGINEAPI_VERSION_1, &g_Callbacks, &actualVersion);
+	g_EngineAPI = getEngineAPIFunc(RAYGE_ENGINEAPI_VERSION_3, &g_Callbacks, &actualVersion);
 
 	if ( !g_EngineAPI )
 	{
 		fprintf(
 			stderr,
 			"Could not get RayGE engine API version %u (got version %u)\n",
-			RAYGE_ENGINEAPI_VERSION_1,
+			RAYGE_ENGINEAPI_VERSION_3,
 			actualVersion
 		);
 
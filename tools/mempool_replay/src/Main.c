@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cargs.h"
+#include "Launcher/LaunchParams.h"
+#include "Logging/Logging.h"
+#include "ReplayTrace.h"
+#include "ReplayAllocators.h"
+#include "Replay.h"
+
+#define DEFAULT_ALLOCATORS "mempool,system"
+#define DEFAULT_ITERATIONS 5
+#define MAX_ALLOCATORS 16
+
+typedef enum OptionIdentifier
+{
+	ID_HELP = (int)'A',
+	ID_ALLOCATORS,
+	ID_ITERATIONS,
+	ID_DEBUG_MEMPOOL,
+} OptionIdentifier;
+
+typedef struct Options
+{
+	const char* tracePath;
+	const char* allocators;
+	size_t iterations;
+} Options;
+
+static RayGE_LaunchState g_LaunchState;
+static const struct cag_option OptionDefs[] = {
+	{
+		.identifier = (char)ID_HELP,
+		.access_letters = "h",
+		.access_name = "help",
+		.description = "Displays a help message and exits.",
+	},
+	{
+		.identifier = (char)ID_ALLOCATORS,
+		.access_letters = "a",
+		.access_name = "allocators",
+		.value_name = "NAMES",
+		.description = "Comma-separated list of allocators to replay the trace against (defaults to " DEFAULT_ALLOCATORS
+					   ").",
+	},
+	{
+		.identifier = (char)ID_ITERATIONS,
+		.access_letters = "n",
+		.access_name = "iterations",
+		.value_name = "COUNT",
+		.description = "Number of timed replays per allocator. The fastest is reported.",
+	},
+	{
+		.identifier = (char)ID_DEBUG_MEMPOOL,
+		.access_letters = NULL,
+		.access_name = "debug-mempool",
+		.description = "Enables mem pool debugging, as with the engine's launch option of the same name.",
+	},
+};
+
+// The mem pool sources are built directly into this tool,
+// so the launch state they depend on is provided here.
+const RayGE_LaunchState* LaunchParams_GetLaunchState(void)
+{
+	return &g_LaunchState;
+}
+
+static void PrintUsage(void)
+{
+	printf("Usage: mempool-replay [OPTIONS] TRACE_FILE\n\n");
+	printf("Replays a mem pool trace recorded with the engine's --trace-mempool option\n");
+	printf("against one or more allocators, and reports throughput and peak memory usage.\n\n");
+
+	cag_option_print(OptionDefs, CAG_ARRAY_SIZE(OptionDefs), stdout);
+
+	printf("\nAvailable allocators:\n");
+
+	for ( size_t index = 0; index < ReplayAllocators_Count(); ++index )
+	{
+		const ReplayAllocator* allocator = ReplayAllocators_Get(index);
+		printf("  %-10s %s\n", allocator->name, allocator->description);
+	}
+}
+
+static bool ParseOptions(int argc, char** argv, Options* options)
+{
+	options->tracePath = NULL;
+	options->allocators = DEFAULT_ALLOCATORS;
+	options->iterations = DEFAULT_ITERATIONS;
+
+	cag_option_context context;
+	cag_option_prepare(&context, OptionDefs, CAG_ARRAY_SIZE(OptionDefs), argc, argv);
+
+	while ( cag_option_fetch(&context) )
+	{
+		switch ( cag_option_get(&context) )
+		{
+			case ID_HELP:
+			{
+				PrintUsage();
+				return false;
+			}
+
+			case ID_ALLOCATORS:
+			{
+				const char* value = cag_option_get_value(&context);
+				options->allocators = value ? value : DEFAULT_ALLOCATORS;
+				break;
+			}
+
+			case ID_ITERATIONS:
+			{
+				const char* value = cag_option_get_value(&context);
+				const int iterations = value ? atoi(value) : 0;
+				options->iterations = iterations > 0 ? (size_t)iterations : DEFAULT_ITERATIONS;
+				break;
+			}
+
+			case ID_DEBUG_MEMPOOL:
+			{
+				g_LaunchState.enableMemPoolDebugging = true;
+				break;
+			}
+
+			case '?':
+			default:
+			{
+				cag_option_print_error(&context, stderr);
+				return false;
+			}
+		}
+	}
+
+	const int pathIndex = cag_option_get_index(&context);
+
+	if ( pathIndex < 0 || pathIndex >= argc )
+	{
+		fprintf(stderr, "No trace file was specified. Run with --help for usage.\n");
+		return false;
+	}
+
+	options->tracePath = argv[pathIndex];
+	return true;
+}
+
+static size_t ParseAllocators(const char* list, const ReplayAllocator** outAllocators, size_t maxAllocators)
+{
+	size_t count = 0;
+
+	while ( *list )
+	{
+		const char* end = strchr(list, ',');
+		const size_t length = end ? (size_t)(end - list) : strlen(list);
+
+		if ( length > 0 )
+		{
+			const ReplayAllocator* allocator = ReplayAllocators_Find(list, length);
+
+			if ( !allocator )
+			{
+				fprintf(stderr, "Unknown allocator \"%.*s\". Run with --help for a list.\n", (int)length, list);
+				return 0;
+			}
+
+			if ( count >= maxAllocators )
+			{
+				fprintf(stderr, "Too many allocators specified\n");
+				return 0;
+			}
+
+			outAllocators[count++] = allocator;
+		}
+
+		list += length;
+
+		if ( *list == ',' )
+		{
+			++list;
+		}
+	}
+
+	return count;
+}
+
+static void PrintTraceSummary(const char* path, const ReplayTrace* trace)
+{
+	printf("Trace: %s\n", path);
+	printf(
+		"  Recorded over %.2f ms and %zu frames\n",
+		(double)trace->recordedDurationNs / 1000000.0,
+		trace->numFrames
+	);
+	printf(
+		"  %zu events: %zu allocs, %zu reallocs, %zu frees, %zu frame arena releases\n",
+		trace->numEvents,
+		trace->numAllocs,
+		trace->numReallocs,
+		trace->numFrees,
+		trace->numSyntheticFrees
+	);
+	printf("  %zu allocation sites, peak of %zu live allocations\n", trace->numSites, trace->numSlots);
+
+	if ( trace->numSkippedRecords > 0 )
+	{
+		printf("  %zu records referenced allocations made before recording began\n", trace->numSkippedRecords);
+	}
+
+	if ( trace->categoriesMismatched )
+	{
+		printf("  Warning: Trace was recorded with different mem pool categories, which may be misattributed\n");
+	}
+
+	printf("\n");
+}
+
+static bool ReplayWithAllocator(const ReplayTrace* trace, const ReplayAllocator* allocator, size_t iterations)
+{
+	uint64_t bestNs = UINT64_MAX;
+
+	for ( size_t iteration = 0; iteration < iterations; ++iteration )
+	{
+		ReplayResult result;
+
+		if ( !Replay_Run(trace, allocator, false, &result) )
+		{
+			return false;
+		}
+
+		if ( result.elapsedNs < bestNs )
+		{
+			bestNs = result.elapsedNs;
+		}
+	}
+
+	// Memory is measured separately, since sampling it skews the timings.
+	ReplayResult memoryResult;
+
+	if ( !Replay_Run(trace, allocator, true, &memoryResult) )
+	{
+		return false;
+	}
+
+	const size_t operations = trace->numEvents - trace->numFrames;
+	const double seconds = (double)bestNs / 1000000000.0;
+
+	printf(
+		"%-10s %12.3f %14.2f %10.1f %16.2f\n",
+		allocator->name,
+		(double)bestNs / 1000000.0,
+		seconds > 0.0 ? ((double)operations / seconds) / 1000000.0 : 0.0,
+		operations > 0 ? (double)bestNs / (double)operations : 0.0,
+		(double)(memoryResult.peakResidentBytes - memoryResult.baselineResidentBytes) / (1024.0 * 1024.0)
+	);
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	memset(&g_LaunchState, 0, sizeof(g_LaunchState));
+	g_LaunchState.defaultLogLevel = RAYGE_LOG_WARNING;
+	g_LaunchState.memPoolProfilerSampleRate = 1;
+
+	Options options;
+
+	if ( !ParseOptions(argc, argv, &options) )
+	{
+		return 1;
+	}
+
+	const ReplayAllocator* allocators[MAX_ALLOCATORS];
+	const size_t numAllocators = ParseAllocators(options.allocators, allocators, MAX_ALLOCATORS);
+
+	if ( numAllocators < 1 )
+	{
+		return 1;
+	}
+
+	ReplayTrace trace;
+
+	if ( !ReplayTrace_Load(options.tracePath, &trace) )
+	{
+		return 1;
+	}
+
+	PrintTraceSummary(options.tracePath, &trace);
+
+	Logging_Init();
+
+	printf(
+		"Best of %zu replays%s:\n\n",
+		options.iterations,
+		g_LaunchState.enableMemPoolDebugging ? " (mem pool debugging enabled)" : ""
+	);
+
+	printf("%-10s %12s %14s %10s %16s\n", "Allocator", "Time (ms)", "Mops/s", "ns/op", "Peak RSS (MiB)");
+
+	int exitCode = 0;
+
+	for ( size_t index = 0; index < numAllocators; ++index )
+	{
+		if ( !ReplayWithAllocator(&trace, allocators[index], options.iterations) )
+		{
+			exitCode = 1;
+		}
+	}
+
+	Logging_ShutDown();
+	ReplayTrace_Free(&trace);
+
+	return exitCode;
+}
@@ -0,0 +1,52 @@
+// For sysconf().
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdio.h>
+#include "ProcessMemory.h"
+#include "RayGE/Platform.h"
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+size_t ProcessMemory_GetResidentBytes(void)
+{
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+
+	// K32GetProcessMemoryInfo lives in kernel32, so no need to link psapi.
+	if ( !K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) )
+	{
+		return 0;
+	}
+
+	return (size_t)counters.WorkingSetSize;
+#else
+	FILE* file = fopen("/proc/self/statm", "r");
+
+	if ( !file )
+	{
+		return 0;
+	}
+
+	unsigned long totalPages = 0;
+	unsigned long residentPages = 0;
+	const int numRead = fscanf(file, "%lu %lu", &totalPages, &residentPages);
+
+	fclose(file);
+
+	if ( numRead != 2 )
+	{
+		return 0;
+	}
+
+	const long pageSize = sysconf(_SC_PAGESIZE);
+	return pageSize > 0 ? (size_t)residentPages * (size_t)pageSize : 0;
+#endif
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stddef.h>
+
+// Returns the current resident set size of this process in bytes,
+// or 0 if this could not be determined on the current platform.
+size_t ProcessMemory_GetResidentBytes(void);
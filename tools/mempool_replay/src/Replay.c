@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Replay.h"
+#include "ProcessMemory.h"
+#include "MemPool/MemPoolTrace.h"
+
+// How often to sample memory usage, in addition to at each frame boundary.
+#define SAMPLE_INTERVAL_EVENTS 4096
+
+#define FILL_BYTE 0xA5
+
+static void SampleMemory(ReplayResult* result)
+{
+	const size_t resident = ProcessMemory_GetResidentBytes();
+
+	if ( resident > result->peakResidentBytes )
+	{
+		result->peakResidentBytes = resident;
+	}
+}
+
+static bool RunEvents(
+	const ReplayTrace* trace,
+	const ReplayAllocator* allocator,
+	void** slots,
+	bool sampleMemory,
+	ReplayResult* result
+)
+{
+	for ( size_t index = 0; index < trace->numEvents; ++index )
+	{
+		const ReplayEvent* event = &trace->events[index];
+		const ReplaySite* site = &trace->sites[event->site];
+
+		switch ( event->type )
+		{
+			case REPLAY_EVENT_ALLOC:
+			case REPLAY_EVENT_REALLOC:
+			{
+				void* memory = event->type == REPLAY_EVENT_ALLOC
+					? allocator->malloc((MemPool_Category)event->category, event->size, site->file, site->line)
+					: allocator->realloc(
+						  (MemPool_Category)event->category,
+						  slots[event->slot],
+						  event->size,
+						  site->file,
+						  site->line
+					  );
+
+				if ( !memory && event->size > 0 )
+				{
+					fprintf(stderr, "Allocator \"%s\" failed to provide %zu bytes\n", allocator->name, event->size);
+					return false;
+				}
+
+				memset(memory, FILL_BYTE, event->size);
+				slots[event->slot] = memory;
+				break;
+			}
+
+			case REPLAY_EVENT_FREE:
+			{
+				if ( slots[event->slot] )
+				{
+					allocator->free(slots[event->slot], site->file, site->line);
+					slots[event->slot] = NULL;
+				}
+
+				break;
+			}
+
+			case REPLAY_EVENT_FRAME:
+			{
+				allocator->newFrame();
+
+				if ( sampleMemory )
+				{
+					SampleMemory(result);
+				}
+
+				break;
+			}
+
+			default:
+			{
+				break;
+			}
+		}
+
+		if ( sampleMemory && (index % SAMPLE_INTERVAL_EVENTS) == 0 )
+		{
+			SampleMemory(result);
+		}
+	}
+
+	return true;
+}
+
+bool Replay_Run(const ReplayTrace* trace, const ReplayAllocator* allocator, bool sampleMemory, ReplayResult* outResult)
+{
+	memset(outResult, 0, sizeof(*outResult));
+
+	void** slots = (void**)calloc(trace->numSlots > 0 ? trace->numSlots : 1, sizeof(void*));
+
+	if ( !slots )
+	{
+		fprintf(stderr, "Out of memory when preparing replay\n");
+		return false;
+	}
+
+	allocator->init();
+
+	if ( sampleMemory )
+	{
+		outResult->baselineResidentBytes = ProcessMemory_GetResidentBytes();
+		outResult->peakResidentBytes = outResult->baselineResidentBytes;
+	}
+
+	const uint64_t startNs = MemPoolTrace_GetTimeNs();
+	const bool success = RunEvents(trace, allocator, slots, sampleMemory, outResult);
+	outResult->elapsedNs = MemPoolTrace_GetTimeNs() - startNs;
+
+	// Anything still live at the end of the trace is not part of the timing.
+	for ( size_t index = 0; index < trace->numSlots; ++index )
+	{
+		if ( slots[index] )
+		{
+			allocator->free(slots[index], __FILE__, __LINE__);
+		}
+	}
+
+	allocator->shutDown();
+	free(slots);
+
+	return success;
+}
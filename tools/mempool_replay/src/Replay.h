@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ReplayTrace.h"
+#include "ReplayAllocators.h"
+
+typedef struct ReplayResult
+{
+	uint64_t elapsedNs;
+
+	// Only filled in if memory usage was sampled.
+	size_t baselineResidentBytes;
+	size_t peakResidentBytes;
+} ReplayResult;
+
+// Replays every event in the trace against the allocator. Each allocation
+// is written to, so that its memory is actually committed. If sampleMemory
+// is set, the process's resident memory is sampled regularly during the
+// replay, which adds overhead, so timings from such runs are not reliable.
+// Returns false if the allocator failed to provide memory.
+bool Replay_Run(const ReplayTrace* trace, const ReplayAllocator* allocator, bool sampleMemory, ReplayResult* outResult);
@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ReplayAllocators.h"
+
+static void MemPoolInit(void)
+{
+	MemPoolManager_Init();
+}
+
+static void MemPoolShutDown(void)
+{
+	MemPoolManager_ShutDown();
+}
+
+static void* MemPoolMalloc(MemPool_Category category, size_t size, const char* file, int line)
+{
+	return MemPoolManager_Malloc(file, line, category, size);
+}
+
+static void* MemPoolRealloc(MemPool_Category category, void* memory, size_t size, const char* file, int line)
+{
+	return MemPoolManager_Realloc(file, line, category, memory, size);
+}
+
+static void MemPoolFree(void* memory, const char* file, int line)
+{
+	MemPoolManager_Free(file, line, memory);
+}
+
+static void MemPoolNewFrame(void)
+{
+	MemPoolManager_NewFrame();
+}
+
+static void SystemInit(void)
+{
+}
+
+static void SystemShutDown(void)
+{
+}
+
+static void* SystemMalloc(MemPool_Category category, size_t size, const char* file, int line)
+{
+	(void)category;
+	(void)file;
+	(void)line;
+
+	// Never return null for valid zero-sized requests.
+	return malloc(size > 0 ? size : 1);
+}
+
+static void* SystemRealloc(MemPool_Category category, void* memory, size_t size, const char* file, int line)
+{
+	(void)category;
+	(void)file;
+	(void)line;
+
+	return realloc(memory, size > 0 ? size : 1);
+}
+
+static void SystemFree(void* memory, const char* file, int line)
+{
+	(void)file;
+	(void)line;
+
+	free(memory);
+}
+
+static void SystemNewFrame(void)
+{
+}
+
+static const ReplayAllocator g_Allocators[] = {
+	{
+		.name = "mempool",
+		.description = "The engine's mem pool manager, as configured by --debug-mempool",
+		.init = MemPoolInit,
+		.shutDown = MemPoolShutDown,
+		.malloc = MemPoolMalloc,
+		.realloc = MemPoolRealloc,
+		.free = MemPoolFree,
+		.newFrame = MemPoolNewFrame,
+	},
+	{
+		.name = "system",
+		.description = "The C runtime's malloc, realloc and free",
+		.init = SystemInit,
+		.shutDown = SystemShutDown,
+		.malloc = SystemMalloc,
+		.realloc = SystemRealloc,
+		.free = SystemFree,
+		.newFrame = SystemNewFrame,
+	},
+};
+
+size_t ReplayAllocators_Count(void)
+{
+	return sizeof(g_Allocators) / sizeof(g_Allocators[0]);
+}
+
+const ReplayAllocator* ReplayAllocators_Get(size_t index)
+{
+	return index < ReplayAllocators_Count() ? &g_Allocators[index] : NULL;
+}
+
+const ReplayAllocator* ReplayAllocators_Find(const char* name, size_t nameLength)
+{
+	for ( size_t index = 0; index < ReplayAllocators_Count(); ++index )
+	{
+		if ( strlen(g_Allocators[index].name) == nameLength &&
+			 strncmp(g_Allocators[index].name, name, nameLength) == 0 )
+		{
+			return &g_Allocators[index];
+		}
+	}
+
+	return NULL;
+}
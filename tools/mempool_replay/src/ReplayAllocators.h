@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include "MemPool/MemPoolManager.h"
+
+// An allocator which a trace can be replayed against. To compare a new
+// candidate allocator with the existing ones, add an entry to the table
+// in ReplayAllocators.c.
+typedef struct ReplayAllocator
+{
+	const char* name;
+	const char* description;
+
+	// Called before and after each replay of the trace.
+	// The allocator should start and end each replay empty.
+	void (*init)(void);
+	void (*shutDown)(void);
+
+	void* (*malloc)(MemPool_Category category, size_t size, const char* file, int line);
+	void* (*realloc)(MemPool_Category category, void* memory, size_t size, const char* file, int line);
+	void (*free)(void* memory, const char* file, int line);
+
+	// Called at each frame boundary in the trace.
+	void (*newFrame)(void);
+} ReplayAllocator;
+
+size_t ReplayAllocators_Count(void);
+const ReplayAllocator* ReplayAllocators_Get(size_t index);
+
+// Returns null if there is no allocator with this name.
+const ReplayAllocator* ReplayAllocators_Find(const char* name, size_t nameLength);
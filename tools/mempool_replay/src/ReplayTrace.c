@@ -0,0 +1,698 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ReplayTrace.h"
+#include "MemPool/MemPoolManager.h"
+#include "MemPool/MemPoolTraceFormat.h"
+
+#define READ_CHUNK_SIZE (1024 * 1024)
+#define INVALID_SLOT UINT32_MAX
+
+static const char UNKNOWN_SITE_FILE[] = "<unknown>";
+
+typedef struct AddressEntry
+{
+	uint64_t address;
+	uint32_t slot;
+	bool used;
+} AddressEntry;
+
+typedef struct SlotInfo
+{
+	uint64_t address;
+
+	// False if the address was reused while the slot was still live.
+	bool mapped;
+	bool frame;
+} SlotInfo;
+
+typedef struct SlotList
+{
+	uint32_t* items;
+	size_t count;
+	size_t capacity;
+} SlotList;
+
+typedef struct Decoder
+{
+	ReplayTrace* trace;
+	size_t eventsCapacity;
+	size_t sitesCapacity;
+
+	// Open-addressed with linear probing, mapping live addresses to slots.
+	AddressEntry* addresses;
+	size_t addressesCapacity;
+	size_t numAddresses;
+
+	SlotInfo* slots;
+	size_t slotsCapacity;
+	SlotList freeSlots;
+
+	// Frame arena allocations made in the current and previous frames.
+	SlotList frameSlots[2];
+	size_t frameIndex;
+} Decoder;
+
+static bool GrowArray(void** array, size_t* capacity, size_t required, size_t elementSize)
+{
+	if ( required <= *capacity )
+	{
+		return true;
+	}
+
+	size_t newCapacity = *capacity > 0 ? *capacity : 64;
+
+	while ( newCapacity < required )
+	{
+		newCapacity *= 2;
+	}
+
+	void* newArray = realloc(*array, newCapacity * elementSize);
+
+	if ( !newArray )
+	{
+		fprintf(stderr, "Out of memory when decoding trace\n");
+		return false;
+	}
+
+	*array = newArray;
+	*capacity = newCapacity;
+	return true;
+}
+
+static bool PushSlot(SlotList* list, uint32_t slot)
+{
+	if ( !GrowArray((void**)&list->items, &list->capacity, list->count + 1, sizeof(uint32_t)) )
+	{
+		return false;
+	}
+
+	list->items[list->count++] = slot;
+	return true;
+}
+
+static size_t HashAddress(uint64_t address)
+{
+	address ^= address >> 33;
+	address *= 0xFF51AFD7ED558CCDull;
+	address ^= address >> 33;
+	return (size_t)address;
+}
+
+static AddressEntry* FindAddress(Decoder* decoder, uint64_t address)
+{
+	if ( decoder->addressesCapacity < 1 )
+	{
+		return NULL;
+	}
+
+	const size_t mask = decoder->addressesCapacity - 1;
+
+	for ( size_t index = HashAddress(address) & mask; decoder->addresses[index].used; index = (index + 1) & mask )
+	{
+		if ( decoder->addresses[index].address == address )
+		{
+			return &decoder->addresses[index];
+		}
+	}
+
+	return NULL;
+}
+
+static void InsertAddressUnchecked(AddressEntry* table, size_t capacity, uint64_t address, uint32_t slot)
+{
+	const size_t mask = capacity - 1;
+	size_t index = HashAddress(address) & mask;
+
+	while ( table[index].used )
+	{
+		index = (index + 1) & mask;
+	}
+
+	table[index].address = address;
+	table[index].slot = slot;
+	table[index].used = true;
+}
+
+static bool InsertAddress(Decoder* decoder, uint64_t address, uint32_t slot)
+{
+	if ( (decoder->numAddresses + 1) * 2 > decoder->addressesCapacity )
+	{
+		const size_t newCapacity = decoder->addressesCapacity > 0 ? decoder->addressesCapacity * 2 : 1024;
+		AddressEntry* newTable = (AddressEntry*)calloc(newCapacity, sizeof(AddressEntry));
+
+		if ( !newTable )
+		{
+			fprintf(stderr, "Out of memory when decoding trace\n");
+			return false;
+		}
+
+		for ( size_t index = 0; index < decoder->addressesCapacity; ++index )
+		{
+			const AddressEntry* entry = &decoder->addresses[index];
+
+			if ( entry->used )
+			{
+				InsertAddressUnchecked(newTable, newCapacity, entry->address, entry->slot);
+			}
+		}
+
+		free(decoder->addresses);
+		decoder->addresses = newTable;
+		decoder->addressesCapacity = newCapacity;
+	}
+
+	InsertAddressUnchecked(decoder->addresses, decoder->addressesCapacity, address, slot);
+	++decoder->numAddresses;
+	return true;
+}
+
+static void RemoveAddress(Decoder* decoder, AddressEntry* entry)
+{
+	// Backward-shift deletion, so that no tombstones are needed.
+	const size_t mask = decoder->addressesCapacity - 1;
+	size_t hole = (size_t)(entry - decoder->addresses);
+	size_t index = hole;
+
+	decoder->addresses[hole].used = false;
+	--decoder->numAddresses;
+
+	while ( true )
+	{
+		index = (index + 1) & mask;
+
+		if ( !decoder->addresses[index].used )
+		{
+			break;
+		}
+
+		const size_t home = HashAddress(decoder->addresses[index].address) & mask;
+
+		// Move the entry into the hole if its home
+		// position does not lie between the two.
+		const bool homeBetween = hole <= index ? (home > hole && home <= index) : (home > hole || home <= index);
+
+		if ( !homeBetween )
+		{
+			decoder->addresses[hole] = decoder->addresses[index];
+			decoder->addresses[index].used = false;
+			hole = index;
+		}
+	}
+}
+
+static ReplayEvent* AddEvent(Decoder* decoder, ReplayEventType type)
+{
+	ReplayTrace* trace = decoder->trace;
+
+	if ( !GrowArray((void**)&trace->events, &decoder->eventsCapacity, trace->numEvents + 1, sizeof(ReplayEvent)) )
+	{
+		return NULL;
+	}
+
+	ReplayEvent* event = &trace->events[trace->numEvents++];
+	memset(event, 0, sizeof(*event));
+	event->type = (uint8_t)type;
+
+	return event;
+}
+
+static bool AddFreeEvent(Decoder* decoder, uint32_t slot, uint32_t site)
+{
+	ReplayEvent* event = AddEvent(decoder, REPLAY_EVENT_FREE);
+
+	if ( !event )
+	{
+		return false;
+	}
+
+	event->slot = slot;
+	event->site = site;
+
+	SlotInfo* info = &decoder->slots[slot];
+
+	if ( info->mapped )
+	{
+		AddressEntry* entry = FindAddress(decoder, info->address);
+
+		if ( entry && entry->slot == slot )
+		{
+			RemoveAddress(decoder, entry);
+		}
+	}
+
+	info->mapped = false;
+	return PushSlot(&decoder->freeSlots, slot);
+}
+
+static uint32_t AcquireSlot(Decoder* decoder)
+{
+	if ( decoder->freeSlots.count > 0 )
+	{
+		return decoder->freeSlots.items[--decoder->freeSlots.count];
+	}
+
+	const size_t slot = decoder->trace->numSlots;
+
+	if ( slot >= INVALID_SLOT ||
+		 !GrowArray((void**)&decoder->slots, &decoder->slotsCapacity, slot + 1, sizeof(SlotInfo)) )
+	{
+		return INVALID_SLOT;
+	}
+
+	++decoder->trace->numSlots;
+	return (uint32_t)slot;
+}
+
+static bool MapAddress(Decoder* decoder, uint32_t slot, uint64_t address, bool frame)
+{
+	AddressEntry* existing = FindAddress(decoder, address);
+
+	if ( existing )
+	{
+		// The address was reused without the previous allocation being
+		// freed. This happens when frame arena memory is recycled earlier
+		// than the decoder expected. The old slot keeps its memory until
+		// it is released, but can no longer be referenced by address.
+		decoder->slots[existing->slot].mapped = false;
+		existing->slot = slot;
+	}
+	else if ( !InsertAddress(decoder, address, slot) )
+	{
+		return false;
+	}
+
+	SlotInfo* info = &decoder->slots[slot];
+	info->address = address;
+	info->mapped = true;
+	info->frame = frame;
+
+	return true;
+}
+
+static bool ReleaseFrameSlots(Decoder* decoder, SlotList* list)
+{
+	for ( size_t index = 0; index < list->count; ++index )
+	{
+		if ( !AddFreeEvent(decoder, list->items[index], 0) )
+		{
+			return false;
+		}
+
+		++decoder->trace->numSyntheticFrees;
+	}
+
+	list->count = 0;
+	return true;
+}
+
+static MemPool_Category ClampCategory(uint64_t category)
+{
+	// Test categories only exist in testing builds.
+	return category < MEMPOOL__COUNT ? (MemPool_Category)category : MEMPOOL_UNCATEGORISED;
+}
+
+static bool DecodeSite(Decoder* decoder, const uint8_t** cursor, const uint8_t* end)
+{
+	uint64_t siteId = 0;
+	uint64_t line = 0;
+	uint64_t nameLength = 0;
+
+	if ( !MemPoolTrace_DecodeVarint(cursor, end, &siteId) || !MemPoolTrace_DecodeVarint(cursor, end, &line) ||
+		 !MemPoolTrace_DecodeVarint(cursor, end, &nameLength) || nameLength > (uint64_t)(end - *cursor) ||
+		 siteId >= UINT32_MAX )
+	{
+		return false;
+	}
+
+	ReplayTrace* trace = decoder->trace;
+
+	if ( !GrowArray((void**)&trace->sites, &decoder->sitesCapacity, (size_t)siteId + 1, sizeof(ReplaySite)) )
+	{
+		return false;
+	}
+
+	while ( trace->numSites <= siteId )
+	{
+		trace->sites[trace->numSites].file = NULL;
+		trace->sites[trace->numSites].line = 0;
+		++trace->numSites;
+	}
+
+	char* name = (char*)malloc((size_t)nameLength + 1);
+
+	if ( !name )
+	{
+		return false;
+	}
+
+	memcpy(name, *cursor, (size_t)nameLength);
+	name[nameLength] = '\0';
+	*cursor += nameLength;
+
+	ReplaySite* site = &trace->sites[siteId];
+	free((char*)site->file);
+	site->file = name;
+	site->line = (int)line;
+
+	return true;
+}
+
+static bool DecodeRecords(Decoder* decoder, const uint8_t* cursor, const uint8_t* end)
+{
+	ReplayTrace* trace = decoder->trace;
+
+	while ( cursor < end )
+	{
+		const uint8_t type = *cursor++;
+		uint64_t fields[6] = {0};
+		size_t numFields = 0;
+
+		switch ( type )
+		{
+			case MEMPOOL_TRACE_RECORD_SITE:
+			{
+				if ( !DecodeSite(decoder, &cursor, end) )
+				{
+					fprintf(stderr, "Trace contained a malformed site record\n");
+					return false;
+				}
+
+				continue;
+			}
+
+			case MEMPOOL_TRACE_RECORD_ALLOC:
+			{
+				numFields = 5;
+				break;
+			}
+
+			case MEMPOOL_TRACE_RECORD_REALLOC:
+			{
+				numFields = 6;
+				break;
+			}
+
+			case MEMPOOL_TRACE_RECORD_FREE:
+			{
+				numFields = 3;
+				break;
+			}
+
+			case MEMPOOL_TRACE_RECORD_FRAME:
+			{
+				numFields = 1;
+				break;
+			}
+
+			default:
+			{
+				fprintf(stderr, "Trace contained unknown record type %u\n", (unsigned int)type);
+				return false;
+			}
+		}
+
+		for ( size_t index = 0; index < numFields; ++index )
+		{
+			if ( !MemPoolTrace_DecodeVarint(&cursor, end, &fields[index]) )
+			{
+				// The engine may have been killed while writing.
+				fprintf(stderr, "Warning: Trace was truncated, ignoring final record\n");
+				return true;
+			}
+		}
+
+		trace->recordedDurationNs += fields[0];
+
+		switch ( type )
+		{
+			case MEMPOOL_TRACE_RECORD_ALLOC:
+			{
+				const MemPool_Category category = ClampCategory(fields[1]);
+				const uint32_t slot = AcquireSlot(decoder);
+				ReplayEvent* event = slot != INVALID_SLOT ? AddEvent(decoder, REPLAY_EVENT_ALLOC) : NULL;
+
+				if ( !event || !MapAddress(decoder, slot, fields[3], category == MEMPOOL_FRAME) ||
+					 (category == MEMPOOL_FRAME && !PushSlot(&decoder->frameSlots[decoder->frameIndex % 2], slot)) )
+				{
+					return false;
+				}
+
+				event->category = (uint8_t)category;
+				event->size = (size_t)fields[2];
+				event->slot = slot;
+				event->site = (uint32_t)fields[4];
+
+				++trace->numAllocs;
+				break;
+			}
+
+			case MEMPOOL_TRACE_RECORD_REALLOC:
+			{
+				const MemPool_Category category = ClampCategory(fields[1]);
+				AddressEntry* entry = FindAddress(decoder, fields[3]);
+				uint32_t slot = INVALID_SLOT;
+				ReplayEventType eventType = REPLAY_EVENT_REALLOC;
+
+				if ( entry )
+				{
+					slot = entry->slot;
+					RemoveAddress(decoder, entry);
+					decoder->slots[slot].mapped = false;
+				}
+				else
+				{
+					// Allocated before the trace began, so
+					// the best we can do is a fresh allocation.
+					slot = AcquireSlot(decoder);
+					eventType = REPLAY_EVENT_ALLOC;
+					++trace->numSkippedRecords;
+
+					if ( slot == INVALID_SLOT ||
+						 (category == MEMPOOL_FRAME &&
+						  !PushSlot(&decoder->frameSlots[decoder->frameIndex % 2], slot)) )
+					{
+						return false;
+					}
+				}
+
+				ReplayEvent* event = AddEvent(decoder, eventType);
+
+				if ( !event || !MapAddress(decoder, slot, fields[4], decoder->slots[slot].frame) )
+				{
+					return false;
+				}
+
+				event->category = (uint8_t)category;
+				event->size = (size_t)fields[2];
+				event->slot = slot;
+				event->site = (uint32_t)fields[5];
+
+				++trace->numReallocs;
+				break;
+			}
+
+			case MEMPOOL_TRACE_RECORD_FREE:
+			{
+				AddressEntry* entry = FindAddress(decoder, fields[1]);
+
+				// Frame arena allocations are only released at frame boundaries.
+				if ( !entry || decoder->slots[entry->slot].frame )
+				{
+					++trace->numSkippedRecords;
+					break;
+				}
+
+				if ( !AddFreeEvent(decoder, entry->slot, (uint32_t)fields[2]) )
+				{
+					return false;
+				}
+
+				++trace->numFrees;
+				break;
+			}
+
+			case MEMPOOL_TRACE_RECORD_FRAME:
+			{
+				// The frame arena that was used two frames ago is reset
+				// here, so release the allocations that were made in it
+				// before replaying the reset.
+				if ( !ReleaseFrameSlots(decoder, &decoder->frameSlots[(decoder->frameIndex + 1) % 2]) ||
+					 !AddEvent(decoder, REPLAY_EVENT_FRAME) )
+				{
+					return false;
+				}
+
+				++decoder->frameIndex;
+				++trace->numFrames;
+				break;
+			}
+
+			default:
+			{
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+static uint8_t* ReadWholeFile(const char* path, size_t* outLength)
+{
+	FILE* file = fopen(path, "rb");
+
+	if ( !file )
+	{
+		fprintf(stderr, "Could not open trace file %s\n", path);
+		return NULL;
+	}
+
+	uint8_t* data = NULL;
+	size_t capacity = 0;
+	size_t length = 0;
+
+	while ( true )
+	{
+		if ( !GrowArray((void**)&data, &capacity, length + READ_CHUNK_SIZE, 1) )
+		{
+			free(data);
+			fclose(file);
+			return NULL;
+		}
+
+		const size_t numRead = fread(data + length, 1, READ_CHUNK_SIZE, file);
+		length += numRead;
+
+		if ( numRead < READ_CHUNK_SIZE )
+		{
+			break;
+		}
+	}
+
+	const bool failed = ferror(file) != 0;
+	fclose(file);
+
+	if ( failed )
+	{
+		fprintf(stderr, "Could not read trace file %s\n", path);
+		free(data);
+		return NULL;
+	}
+
+	*outLength = length;
+	return data;
+}
+
+static uint32_t ReadUint32(const uint8_t* buffer)
+{
+	return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2] << 16) |
+		((uint32_t)buffer[3] << 24);
+}
+
+bool ReplayTrace_Load(const char* path, ReplayTrace* outTrace)
+{
+	memset(outTrace, 0, sizeof(*outTrace));
+
+	size_t length = 0;
+	uint8_t* data = ReadWholeFile(path, &length);
+
+	if ( !data )
+	{
+		return false;
+	}
+
+	if ( length < sizeof(MemPoolTrace_FileHeader) || memcmp(data, MEMPOOL_TRACE_MAGIC, 4) != 0 )
+	{
+		fprintf(stderr, "%s is not a mem pool trace file\n", path);
+		free(data);
+		return false;
+	}
+
+	const uint32_t version = ReadUint32(data + 4);
+
+	if ( version != MEMPOOL_TRACE_VERSION )
+	{
+		fprintf(stderr, "%s has unsupported trace version %u\n", path, version);
+		free(data);
+		return false;
+	}
+
+	outTrace->categoriesMismatched = ReadUint32(data + 8) != (uint32_t)MEMPOOL__COUNT;
+
+	Decoder decoder;
+	memset(&decoder, 0, sizeof(decoder));
+	decoder.trace = outTrace;
+
+	bool success = DecodeRecords(&decoder, data + sizeof(MemPoolTrace_FileHeader), data + length);
+
+	// Sites referenced by events must always exist,
+	// even if the trace never described them.
+	for ( size_t index = 0; success && index < outTrace->numEvents; ++index )
+	{
+		const uint32_t site = outTrace->events[index].site;
+
+		if ( outTrace->events[index].type != REPLAY_EVENT_FRAME && site >= outTrace->numSites )
+		{
+			const size_t oldCount = outTrace->numSites;
+
+			if ( !GrowArray((void**)&outTrace->sites, &decoder.sitesCapacity, (size_t)site + 1, sizeof(ReplaySite)) )
+			{
+				success = false;
+				break;
+			}
+
+			for ( size_t siteIndex = oldCount; siteIndex <= site; ++siteIndex )
+			{
+				outTrace->sites[siteIndex].file = NULL;
+				outTrace->sites[siteIndex].line = 0;
+			}
+
+			outTrace->numSites = (size_t)site + 1;
+		}
+	}
+
+	for ( size_t index = 0; index < outTrace->numSites; ++index )
+	{
+		if ( !outTrace->sites[index].file )
+		{
+			outTrace->sites[index].file = UNKNOWN_SITE_FILE;
+		}
+	}
+
+	free(decoder.addresses);
+	free(decoder.slots);
+	free(decoder.freeSlots.items);
+	free(decoder.frameSlots[0].items);
+	free(decoder.frameSlots[1].items);
+	free(data);
+
+	if ( !success )
+	{
+		ReplayTrace_Free(outTrace);
+	}
+
+	return success;
+}
+
+void ReplayTrace_Free(ReplayTrace* trace)
+{
+	if ( !trace )
+	{
+		return;
+	}
+
+	for ( size_t index = 0; index < trace->numSites; ++index )
+	{
+		const char* file = trace->sites[index].file;
+
+		if ( file && file != UNKNOWN_SITE_FILE )
+		{
+			free((char*)file);
+		}
+	}
+
+	free(trace->sites);
+	free(trace->events);
+	memset(trace, 0, sizeof(*trace));
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// A trace recorded by the engine (see MemPool/MemPoolTraceFormat.h),
+// decoded up front into a flat list of events so that none of the
+// decoding cost is included in replay timings.
+//
+// Addresses in the trace are replaced by slot indices. A slot holds one
+// live allocation at a time, and slots are reused once freed, so the
+// number of slots is the peak number of live allocations in the trace.
+
+typedef enum ReplayEventType
+{
+	REPLAY_EVENT_ALLOC = 0,
+	REPLAY_EVENT_REALLOC,
+	REPLAY_EVENT_FREE,
+	REPLAY_EVENT_FRAME
+} ReplayEventType;
+
+typedef struct ReplayEvent
+{
+	uint8_t type;
+	uint8_t category;
+	uint32_t slot;
+	uint32_t site;
+	size_t size;
+} ReplayEvent;
+
+typedef struct ReplaySite
+{
+	// Owned by the trace. Never null.
+	const char* file;
+	int line;
+} ReplaySite;
+
+typedef struct ReplayTrace
+{
+	ReplayEvent* events;
+	size_t numEvents;
+
+	// Indexed by ReplayEvent.site.
+	ReplaySite* sites;
+	size_t numSites;
+
+	size_t numSlots;
+	size_t numAllocs;
+	size_t numReallocs;
+	size_t numFrees;
+	size_t numFrames;
+
+	// Frees of frame arena allocations, which are not
+	// present in the trace and are generated when decoding.
+	size_t numSyntheticFrees;
+
+	// References to addresses which were allocated before the
+	// trace began recording. These cannot be replayed.
+	size_t numSkippedRecords;
+
+	uint64_t recordedDurationNs;
+
+	// Whether the trace was recorded with a different set of mem
+	// pool categories to the ones that this tool was built with.
+	bool categoriesMismatched;
+} ReplayTrace;
+
+// On failure, an error is printed and false is returned.
+bool ReplayTrace_Load(const char* path, ReplayTrace* outTrace);
+void ReplayTrace_Free(ReplayTrace* trace);
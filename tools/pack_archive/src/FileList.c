@@ -0,0 +1,198 @@
+// For opendir() and stat().
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FileList.h"
+#include "RayGE/Platform.h"
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#define MAX_PATH_LENGTH 4096
+
+static bool AddPath(FileList* list, const char* path)
+{
+	if ( list->count >= list->capacity )
+	{
+		const size_t newCapacity = list->capacity > 0 ? list->capacity * 2 : 256;
+		char** newPaths = (char**)realloc(list->paths, newCapacity * sizeof(char*));
+
+		if ( !newPaths )
+		{
+			fprintf(stderr, "Out of memory when listing files\n");
+			return false;
+		}
+
+		list->paths = newPaths;
+		list->capacity = newCapacity;
+	}
+
+	const size_t length = strlen(path);
+	char* copy = (char*)malloc(length + 1);
+
+	if ( !copy )
+	{
+		fprintf(stderr, "Out of memory when listing files\n");
+		return false;
+	}
+
+	memcpy(copy, path, length + 1);
+	list->paths[list->count++] = copy;
+	return true;
+}
+
+static bool JoinPath(char* outBuffer, const char* lhs, const char* rhs)
+{
+	const int charsWritten = (lhs[0] && rhs[0])
+		? snprintf(outBuffer, MAX_PATH_LENGTH, "%s/%s", lhs, rhs)
+		: snprintf(outBuffer, MAX_PATH_LENGTH, "%s", lhs[0] ? lhs : rhs);
+
+	if ( charsWritten < 0 || charsWritten >= MAX_PATH_LENGTH )
+	{
+		fprintf(stderr, "Path was too long: %s/%s\n", lhs, rhs);
+		return false;
+	}
+
+	return true;
+}
+
+// relDir is relative to rootDir, and is empty for the root directory itself.
+static bool ScanDirectory(FileList* list, const char* rootDir, const char* relDir)
+{
+	char nativeDir[MAX_PATH_LENGTH];
+
+	if ( !JoinPath(nativeDir, rootDir, relDir) )
+	{
+		return false;
+	}
+
+	bool success = true;
+
+#if RAYGE_PLATFORM() == RAYGE_PLATFORM_WINDOWS
+	char pattern[MAX_PATH_LENGTH];
+
+	if ( !JoinPath(pattern, nativeDir, "*") )
+	{
+		return false;
+	}
+
+	WIN32_FIND_DATAA findData;
+	HANDLE find = FindFirstFileA(pattern, &findData);
+
+	if ( find == INVALID_HANDLE_VALUE )
+	{
+		fprintf(stderr, "Could not open directory %s\n", nativeDir);
+		return false;
+	}
+
+	do
+	{
+		const char* name = findData.cFileName;
+
+		if ( strcmp(name, ".") == 0 || strcmp(name, "..") == 0 )
+		{
+			continue;
+		}
+
+		char relPath[MAX_PATH_LENGTH];
+
+		if ( !JoinPath(relPath, relDir, name) )
+		{
+			success = false;
+			break;
+		}
+
+		success = (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? ScanDirectory(list, rootDir, relPath)
+																		  : AddPath(list, relPath);
+	}
+	while ( success && FindNextFileA(find, &findData) );
+
+	FindClose(find);
+#else
+	DIR* dir = opendir(nativeDir);
+
+	if ( !dir )
+	{
+		fprintf(stderr, "Could not open directory %s\n", nativeDir);
+		return false;
+	}
+
+	for ( struct dirent* entry = readdir(dir); entry && success; entry = readdir(dir) )
+	{
+		const char* name = entry->d_name;
+
+		if ( strcmp(name, ".") == 0 || strcmp(name, "..") == 0 )
+		{
+			continue;
+		}
+
+		char relPath[MAX_PATH_LENGTH];
+		char nativePath[MAX_PATH_LENGTH];
+		struct stat info;
+
+		if ( !JoinPath(relPath, relDir, name) || !JoinPath(nativePath, nativeDir, name) )
+		{
+			success = false;
+			break;
+		}
+
+		if ( stat(nativePath, &info) != 0 )
+		{
+			fprintf(stderr, "Could not get information about %s\n", nativePath);
+			success = false;
+			break;
+		}
+
+		if ( S_ISDIR(info.st_mode) )
+		{
+			success = ScanDirectory(list, rootDir, relPath);
+		}
+		else if ( S_ISREG(info.st_mode) )
+		{
+			success = AddPath(list, relPath);
+		}
+	}
+
+	closedir(dir);
+#endif
+
+	return success;
+}
+
+bool FileList_Scan(const char* rootDir, FileList* outList)
+{
+	memset(outList, 0, sizeof(*outList));
+
+	if ( !ScanDirectory(outList, rootDir, "") )
+	{
+		FileList_Free(outList);
+		return false;
+	}
+
+	return true;
+}
+
+void FileList_Free(FileList* list)
+{
+	if ( !list )
+	{
+		return;
+	}
+
+	for ( size_t index = 0; index < list->count; ++index )
+	{
+		free(list->paths[index]);
+	}
+
+	free(list->paths);
+	memset(list, 0, sizeof(*list));
+}
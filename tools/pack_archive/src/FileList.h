@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// A list of every file under a directory, including those in subdirectories.
+// Paths are relative to the directory that was scanned, and use forward
+// slashes, which is the form in which they are stored in pack archives.
+typedef struct FileList
+{
+	char** paths;
+	size_t count;
+	size_t capacity;
+} FileList;
+
+// On failure, an error is printed and false is returned.
+bool FileList_Scan(const char* rootDir, FileList* outList);
+void FileList_Free(FileList* list);
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cargs.h"
+#include "FileList.h"
+#include "PackWriter.h"
+#include "Filesystem/PackArchiveFormat.h"
+
+typedef enum OptionIdentifier
+{
+	ID_HELP = (int)'A',
+	ID_COMPRESS,
+	ID_VERBOSE,
+} OptionIdentifier;
+
+typedef struct Options
+{
+	const char* outputPath;
+	const char* inputDir;
+	PackWriterOptions writerOptions;
+} Options;
+
+static const struct cag_option OptionDefs[] = {
+	{
+		.identifier = (char)ID_HELP,
+		.access_letters = "h",
+		.access_name = "help",
+		.description = "Displays a help message and exits.",
+	},
+	{
+		.identifier = (char)ID_COMPRESS,
+		.access_letters = "c",
+		.access_name = "compress",
+		.description = "Compresses files with LZ4 where this makes them smaller. Compressed files cannot be read "
+					   "by the engine without a copy, so this is best used for large files that compress well.",
+	},
+	{
+		.identifier = (char)ID_VERBOSE,
+		.access_letters = "v",
+		.access_name = "verbose",
+		.description = "Prints each file as it is packed.",
+	},
+};
+
+static void PrintUsage(void)
+{
+	printf("Usage: pack-archive [OPTIONS] OUTPUT_FILE INPUT_DIR\n\n");
+	printf("Packs every file under INPUT_DIR into a pack archive, which the engine mounts\n");
+	printf("automatically if it is placed in the root of a game's directory. Archive files\n");
+	printf("should be given the " PACK_ARCHIVE_FILE_EXTENSION " extension.\n\n");
+
+	cag_option_print(OptionDefs, CAG_ARRAY_SIZE(OptionDefs), stdout);
+}
+
+static bool ParseOptions(int argc, char** argv, Options* options)
+{
+	memset(options, 0, sizeof(*options));
+
+	cag_option_context context;
+	cag_option_prepare(&context, OptionDefs, CAG_ARRAY_SIZE(OptionDefs), argc, argv);
+
+	while ( cag_option_fetch(&context) )
+	{
+		switch ( cag_option_get(&context) )
+		{
+			case ID_HELP:
+			{
+				PrintUsage();
+				return false;
+			}
+
+			case ID_COMPRESS:
+			{
+				options->writerOptions.compress = true;
+				break;
+			}
+
+			case ID_VERBOSE:
+			{
+				options->writerOptions.verbose = true;
+				break;
+			}
+
+			case '?':
+			default:
+			{
+				cag_option_print_error(&context, stderr);
+				return false;
+			}
+		}
+	}
+
+	const int pathIndex = cag_option_get_index(&context);
+
+	if ( pathIndex < 0 || pathIndex + 1 >= argc )
+	{
+		fprintf(stderr, "An output file and input directory must be specified. Run with --help for usage.\n");
+		return false;
+	}
+
+	options->outputPath = argv[pathIndex];
+	options->inputDir = argv[pathIndex + 1];
+	return true;
+}
+
+// Archives are never packed into other archives. This also stops
+// the output from being packed into itself, if it is being written
+// inside the input directory.
+static void RemoveArchives(FileList* files)
+{
+	const size_t extensionLength = strlen(PACK_ARCHIVE_FILE_EXTENSION);
+	size_t count = 0;
+
+	for ( size_t index = 0; index < files->count; ++index )
+	{
+		char* path = files->paths[index];
+		const size_t length = strlen(path);
+
+		if ( length >= extensionLength && strcmp(path + length - extensionLength, PACK_ARCHIVE_FILE_EXTENSION) == 0 )
+		{
+			printf("Skipping archive %s\n", path);
+			free(path);
+			continue;
+		}
+
+		files->paths[count++] = path;
+	}
+
+	files->count = count;
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	if ( !ParseOptions(argc, argv, &options) )
+	{
+		return 1;
+	}
+
+	FileList files;
+
+	if ( !FileList_Scan(options.inputDir, &files) )
+	{
+		return 1;
+	}
+
+	RemoveArchives(&files);
+
+	const bool success = PackWriter_Write(options.outputPath, options.inputDir, &files, &options.writerOptions);
+
+	FileList_Free(&files);
+	return success ? 0 : 1;
+}
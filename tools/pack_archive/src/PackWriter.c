@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "PackWriter.h"
+#include "Filesystem/PackArchiveFormat.h"
+#include "Utils/LZ4Utils.h"
+
+typedef struct PackRecord
+{
+	PackArchive_IndexEntry entry;
+	const char* path;
+} PackRecord;
+
+typedef struct Writer
+{
+	FILE* file;
+	uint64_t offset;
+	uint64_t totalSize;
+	uint64_t totalStoredSize;
+	size_t numCompressed;
+} Writer;
+
+static int CompareRecords(const void* lhs, const void* rhs)
+{
+	const PackRecord* a = (const PackRecord*)lhs;
+	const PackRecord* b = (const PackRecord*)rhs;
+
+	if ( a->entry.pathHash != b->entry.pathHash )
+	{
+		return a->entry.pathHash < b->entry.pathHash ? -1 : 1;
+	}
+
+	const size_t lengthA = a->entry.pathLength;
+	const size_t lengthB = b->entry.pathLength;
+	const int result = memcmp(a->path, b->path, lengthA < lengthB ? lengthA : lengthB);
+
+	if ( result != 0 )
+	{
+		return result;
+	}
+
+	return lengthA < lengthB ? -1 : (lengthA > lengthB ? 1 : 0);
+}
+
+static bool WriteBytes(Writer* writer, const void* data, size_t size)
+{
+	if ( size > 0 && fwrite(data, 1, size, writer->file) != size )
+	{
+		fprintf(stderr, "Failed to write to archive\n");
+		return false;
+	}
+
+	writer->offset += size;
+	return true;
+}
+
+static bool WritePadding(Writer* writer)
+{
+	static const uint8_t zeroes[PACK_ARCHIVE_ALIGNMENT] = {0};
+	const uint64_t aligned = PackArchive_AlignOffset(writer->offset);
+
+	return WriteBytes(writer, zeroes, (size_t)(aligned - writer->offset));
+}
+
+// Caller takes ownership of the returned data, which is never null on success.
+static uint8_t* ReadWholeFile(const char* path, size_t* outSize)
+{
+	FILE* file = fopen(path, "rb");
+
+	if ( !file )
+	{
+		fprintf(stderr, "Could not open %s\n", path);
+		return NULL;
+	}
+
+	size_t size = 0;
+	size_t capacity = 64 * 1024;
+	uint8_t* data = (uint8_t*)malloc(capacity);
+
+	while ( data )
+	{
+		size += fread(data + size, 1, capacity - size, file);
+
+		if ( size < capacity )
+		{
+			break;
+		}
+
+		capacity *= 2;
+
+		uint8_t* newData = (uint8_t*)realloc(data, capacity);
+
+		if ( !newData )
+		{
+			free(data);
+		}
+
+		data = newData;
+	}
+
+	const bool failed = !data || ferror(file);
+	fclose(file);
+
+	if ( failed )
+	{
+		fprintf(stderr, "Could not read %s\n", path);
+		free(data);
+		return NULL;
+	}
+
+	*outSize = size;
+	return data;
+}
+
+static bool WriteRecordData(Writer* writer, const char* inputDir, PackRecord* record, const PackWriterOptions* options)
+{
+	char nativePath[4096];
+	const int charsWritten = snprintf(nativePath, sizeof(nativePath), "%s/%s", inputDir, record->path);
+
+	if ( charsWritten < 0 || (size_t)charsWritten >= sizeof(nativePath) )
+	{
+		fprintf(stderr, "Path was too long: %s/%s\n", inputDir, record->path);
+		return false;
+	}
+
+	size_t size = 0;
+	uint8_t* data = ReadWholeFile(nativePath, &size);
+
+	if ( !data )
+	{
+		return false;
+	}
+
+	const uint8_t* storedData = data;
+	size_t storedSize = size;
+	uint8_t* compressed = NULL;
+
+	record->entry.compression = PACK_ARCHIVE_COMPRESSION_NONE;
+
+	if ( options->compress && size > 0 )
+	{
+		const size_t bound = LZ4Utils_CompressBound(size);
+		compressed = (uint8_t*)malloc(bound);
+
+		const size_t compressedSize = compressed ? LZ4Utils_Compress(data, size, compressed, bound) : 0;
+
+		// Only worth it if the data actually gets smaller, since
+		// data that is not compressed can be read without a copy.
+		if ( compressedSize > 0 && compressedSize < size )
+		{
+			storedData = compressed;
+			storedSize = compressedSize;
+			record->entry.compression = PACK_ARCHIVE_COMPRESSION_LZ4;
+			++writer->numCompressed;
+		}
+	}
+
+	bool success = WritePadding(writer);
+
+	if ( success )
+	{
+		record->entry.dataOffset = writer->offset;
+		record->entry.storedSize = storedSize;
+		record->entry.size = size;
+
+		success = WriteBytes(writer, storedData, storedSize);
+	}
+
+	if ( success && options->verbose )
+	{
+		printf(
+			"  %s: %zu bytes%s\n",
+			record->path,
+			size,
+			record->entry.compression == PACK_ARCHIVE_COMPRESSION_LZ4 ? " (compressed)" : ""
+		);
+	}
+
+	writer->totalSize += size;
+	writer->totalStoredSize += storedSize;
+
+	free(compressed);
+	free(data);
+
+	return success;
+}
+
+static bool CreateRecords(const FileList* files, PackRecord* records)
+{
+	uint64_t pathOffset = 0;
+
+	for ( size_t index = 0; index < files->count; ++index )
+	{
+		PackRecord* record = &records[index];
+		const size_t pathLength = strlen(files->paths[index]);
+
+		record->path = files->paths[index];
+		record->entry.pathHash = PackArchive_HashPath(record->path, pathLength);
+		record->entry.pathLength = (uint32_t)pathLength;
+
+		pathOffset += pathLength;
+
+		if ( pathLength > UINT32_MAX || pathOffset > UINT32_MAX )
+		{
+			fprintf(stderr, "Total length of file paths was too long for an archive\n");
+			return false;
+		}
+	}
+
+	// The index is sorted so that the engine can binary search it,
+	// and paths are then laid out in the same order as the index.
+	qsort(records, files->count, sizeof(PackRecord), &CompareRecords);
+	pathOffset = 0;
+
+	for ( size_t index = 0; index < files->count; ++index )
+	{
+		if ( index > 0 && CompareRecords(&records[index - 1], &records[index]) == 0 )
+		{
+			fprintf(stderr, "File %s was listed more than once\n", records[index].path);
+			return false;
+		}
+
+		records[index].entry.pathOffset = (uint32_t)pathOffset;
+		pathOffset += records[index].entry.pathLength;
+	}
+
+	return true;
+}
+
+static bool WriteArchive(
+	Writer* writer,
+	const char* inputDir,
+	PackRecord* records,
+	size_t numRecords,
+	const PackWriterOptions* options
+)
+{
+	PackArchive_FileHeader header;
+	memset(&header, 0, sizeof(header));
+
+	// The header is written again at the end, once all the offsets are known.
+	if ( !WriteBytes(writer, &header, sizeof(header)) )
+	{
+		return false;
+	}
+
+	for ( size_t index = 0; index < numRecords; ++index )
+	{
+		if ( !WriteRecordData(writer, inputDir, &records[index], options) )
+		{
+			return false;
+		}
+	}
+
+	if ( !WritePadding(writer) )
+	{
+		return false;
+	}
+
+	header.indexOffset = writer->offset;
+
+	for ( size_t index = 0; index < numRecords; ++index )
+	{
+		if ( !WriteBytes(writer, &records[index].entry, sizeof(records[index].entry)) )
+		{
+			return false;
+		}
+	}
+
+	header.pathsOffset = writer->offset;
+
+	for ( size_t index = 0; index < numRecords; ++index )
+	{
+		if ( !WriteBytes(writer, records[index].path, records[index].entry.pathLength) )
+		{
+			return false;
+		}
+	}
+
+	memcpy(header.magic, PACK_ARCHIVE_MAGIC, sizeof(header.magic));
+	header.version = PACK_ARCHIVE_VERSION;
+	header.numEntries = (uint32_t)numRecords;
+	header.pathsSize = writer->offset - header.pathsOffset;
+
+	if ( fseek(writer->file, 0, SEEK_SET) != 0 )
+	{
+		fprintf(stderr, "Failed to write archive header\n");
+		return false;
+	}
+
+	return WriteBytes(writer, &header, sizeof(header));
+}
+
+bool PackWriter_Write(
+	const char* outputPath,
+	const char* inputDir,
+	const FileList* files,
+	const PackWriterOptions* options
+)
+{
+	if ( files->count > UINT32_MAX )
+	{
+		fprintf(stderr, "Too many files to pack into one archive\n");
+		return false;
+	}
+
+	PackRecord* records = (PackRecord*)calloc(files->count > 0 ? files->count : 1, sizeof(PackRecord));
+
+	if ( !records )
+	{
+		fprintf(stderr, "Out of memory when creating archive index\n");
+		return false;
+	}
+
+	if ( !CreateRecords(files, records) )
+	{
+		free(records);
+		return false;
+	}
+
+	Writer writer;
+	memset(&writer, 0, sizeof(writer));
+
+	writer.file = fopen(outputPath, "wb");
+
+	if ( !writer.file )
+	{
+		fprintf(stderr, "Could not open %s for writing\n", outputPath);
+		free(records);
+		return false;
+	}
+
+	bool success = WriteArchive(&writer, inputDir, records, files->count, options);
+	success = fclose(writer.file) == 0 && success;
+
+	if ( success )
+	{
+		printf(
+			"Packed %zu files (%zu compressed) into %s: %llu bytes stored as %llu bytes\n",
+			files->count,
+			writer.numCompressed,
+			outputPath,
+			(unsigned long long)writer.totalSize,
+			(unsigned long long)writer.totalStoredSize
+		);
+	}
+	else
+	{
+		remove(outputPath);
+	}
+
+	free(records);
+	return success;
+}
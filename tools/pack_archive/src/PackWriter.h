@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include "FileList.h"
+
+typedef struct PackWriterOptions
+{
+	// If set, files are stored LZ4 compressed where this makes them smaller.
+	bool compress;
+
+	// If set, each file is printed as it is packed.
+	bool verbose;
+} PackWriterOptions;
+
+// Writes every file in the list, which is relative to the input directory,
+// to a pack archive. On failure, an error is printed, any partially written
+// archive is deleted, and false is returned.
+bool PackWriter_Write(
+	const char* outputPath,
+	const char* inputDir,
+	const FileList* files,
+	const PackWriterOptions* options
+);